@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_CALIBRATION_H_
+#define TIM_CALIBRATION_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tim/vx/types.h"
+
+namespace tim {
+
+namespace vx {
+class Context;
+class Graph;
+class Tensor;
+}  // namespace vx
+
+namespace transform {
+
+enum class CalibrationMethod {
+  MIN_MAX,    // range is the min/max seen over the calibration set
+  PERCENTILE  // range is clipped to a percentile of a histogram
+};
+
+struct CalibrationOption {
+  /// UINT8 or INT8, used for every activation and per-tensor weight.
+  vx::DataType activation_type = vx::DataType::UINT8;
+  CalibrationMethod method = CalibrationMethod::MIN_MAX;
+  /// Kept fraction of values in percent, only used by PERCENTILE.
+  float percentile = 99.99f;
+  uint32_t histogram_bins = 2048;
+  /// Quantize conv/fc weights as int8 SYMMETRIC_PER_CHANNEL.
+  bool per_channel_weights = true;
+};
+
+/// One calibration sample: float data for every graph input, in the order of
+/// Graph::InputsTensor().
+using CalibrationSample = std::vector<std::vector<float>>;
+
+/// Run the float graph over `samples`, record the range of every FLOAT32
+/// tensor and build a quantized clone of it.
+///
+/// Activations and constants become asymmetric `activation_type`, weights of
+/// conv/fc ops optionally int8 per-channel, their biases INT32 with
+/// scale = input_scale * weight_scale. Tensors of other data types are copied
+/// as is. Returns nullptr graph if calibration failed.
+std::pair<
+    /*quantized graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and quantized graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+Calibrate(const std::shared_ptr<vx::Graph>& src_graph,
+          std::shared_ptr<vx::Context>& ctx,
+          const std::vector<CalibrationSample>& samples,
+          const CalibrationOption& option = CalibrationOption());
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
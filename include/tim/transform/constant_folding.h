@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_CONSTANT_FOLDING_H_
+#define TIM_CONSTANT_FOLDING_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace tim {
+
+namespace vx {
+class Context;
+class Graph;
+class Tensor;
+class Operation;
+}  // namespace vx
+
+namespace transform {
+/// Evaluate every subgraph whose inputs are all constant once, at build time,
+/// and replace it with the resulting constant tensors.
+///
+/// Foldable operations are executed in a throwaway graph created from `ctx`,
+/// operations producing graph outputs are always kept.
+std::pair<
+    /*graph after constant folding*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and graph after folding*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+ConstantFolding(const std::shared_ptr<vx::Graph>& src_graph,
+                std::shared_ptr<vx::Context>& ctx);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -14,6 +14,9 @@ class Operation;
 }  // namespace vx
 
 namespace transform {
+/// Rewrite mean/stddev normalization subgraphs in place. Kept for existing
+/// callers, PatternFusion() with DefaultFusionRules() matches the same
+/// structure when building a fused graph.
 void MeanStdDevNormalization(std::shared_ptr<vx::Graph>& src_graph);
 
 }  // namespace transform
@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_PATTERN_FUSION_H_
+#define TIM_PATTERN_FUSION_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tim {
+
+namespace vx {
+class Context;
+class Graph;
+class Tensor;
+class Operation;
+}  // namespace vx
+
+namespace transform {
+
+/// Operand of a pattern node, refers to another pattern node, a captured
+/// tensor or a captured constant tensor.
+struct PatternOperand {
+  enum class Type { NODE, INPUT, CONSTANT };
+  using TensorPredicate = std::function<bool(const std::shared_ptr<vx::Tensor>&)>;
+
+  Type type;
+  int32_t node{-1};
+  std::string name;
+  TensorPredicate predicate;
+  // Optional operand may be absent or bound to a placeholder
+  bool optional{false};
+};
+
+/// Declarative subgraph pattern. Nodes are matched backward from the root
+/// (the last added node) through tensor producers.
+class Pattern {
+ public:
+  using OpPredicate = std::function<bool(const std::shared_ptr<vx::Operation>&)>;
+
+  /// Output of pattern node `index`
+  static PatternOperand Node(int32_t index);
+  /// Any tensor, captured as `name`. Same name must bind the same tensor.
+  static PatternOperand Input(const std::string& name);
+  /// Constant tensor, captured as `name`
+  static PatternOperand Const(const std::string& name,
+                              PatternOperand::TensorPredicate predicate = nullptr);
+  /// Constant tensor whose elements are all close to `value`
+  static PatternOperand Scalar(const std::string& name, float value);
+  static PatternOperand Optional(PatternOperand operand);
+
+  /// Add a node matching op kind (VSI_NN_OP_*), return its index.
+  /// Operands of commutative nodes with two inputs are tried in both orders.
+  int32_t AddNode(int32_t kind, const std::vector<PatternOperand>& operands,
+                  bool commutative = false, OpPredicate predicate = nullptr);
+
+  struct PatternNode {
+    int32_t kind;
+    std::vector<PatternOperand> operands;
+    bool commutative;
+    OpPredicate predicate;
+  };
+  const std::vector<PatternNode>& Nodes() const { return nodes_; }
+  int32_t Root() const { return static_cast<int32_t>(nodes_.size()) - 1; }
+
+ private:
+  std::vector<PatternNode> nodes_;
+};
+
+struct PatternMatch {
+  /// Matched operation of each pattern node
+  std::vector<std::shared_ptr<vx::Operation>> ops;
+  /// Captured tensors by operand name
+  std::map<std::string, std::shared_ptr<vx::Tensor>> tensors;
+
+  std::shared_ptr<vx::Operation> Root() const { return ops.back(); }
+};
+
+/// Tensor mapping from source graph into the fused graph, used by rewrites.
+class FusionContext {
+ public:
+  FusionContext(const std::shared_ptr<vx::Graph>& src_graph,
+                std::shared_ptr<vx::Graph>& fused_graph);
+
+  const std::shared_ptr<vx::Graph>& SrcGraph() const { return src_graph_; }
+  std::shared_ptr<vx::Graph>& FusedGraph() { return fused_graph_; }
+
+  /// Return tensor in fused graph for `t_src`, create it on first use
+  std::shared_ptr<vx::Tensor> Map(const std::shared_ptr<vx::Tensor>& t_src);
+  void UpdateTensorMap(const std::shared_ptr<vx::Tensor>& t_src,
+                       const std::shared_ptr<vx::Tensor>& t_fused);
+
+ private:
+  const std::shared_ptr<vx::Graph>& src_graph_;
+  std::shared_ptr<vx::Graph>& fused_graph_;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      tensor_map_;
+};
+
+class FusionRule {
+ public:
+  virtual ~FusionRule() {}
+  virtual const char* Name() const = 0;
+  /// Alternative patterns rewritten by this rule
+  virtual const std::vector<Pattern>& Patterns() const = 0;
+  /// Extra check on a structural match, before it is committed
+  virtual bool Check(const PatternMatch& match) const {
+    (void)match;
+    return true;
+  }
+  /// Create the replacement in fused graph, it must produce the root output
+  virtual void Rewrite(FusionContext& ctx, const PatternMatch& match) = 0;
+};
+
+/// Built-in rules: mean/stddev normalization, Conv2d+BatchNorm,
+/// GELU/Swish/HardSwish decompositions and Multiply+Add.
+std::vector<std::shared_ptr<FusionRule>> DefaultFusionRules();
+
+std::pair<
+    /*graph after fusion*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and graph after fusion*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+PatternFusion(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx,
+              const std::vector<std::shared_ptr<FusionRule>>& rules =
+                  DefaultFusionRules());
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
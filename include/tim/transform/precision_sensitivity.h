@@ -0,0 +1,67 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_PRECISION_SENSITIVITY_H_
+#define TIM_PRECISION_SENSITIVITY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tim/transform/calibration.h"
+#include "tim/vx/compile_option.h"
+
+namespace tim {
+
+namespace vx {
+class Graph;
+}  // namespace vx
+
+namespace transform {
+
+struct OpSensitivity {
+  uint32_t uid;
+  /// ovxlib op name, as taken by CompileOption::setOpPrecisionByKind()
+  std::string kind;
+  /// Mean absolute difference of the FLOAT32 graph outputs against the FP32
+  /// run when only this operation is lowered
+  float error;
+};
+
+/// Lower each operation of `kinds` alone to `precision` and measure how much
+/// the graph outputs move over `samples`. Returns the operations ranked least
+/// sensitive first, feed the head of the list to
+/// CompileOption::setOpPrecisionByUid(). Every trial runs a CloneShared()
+/// copy of `graph`, which is left untouched.
+std::vector<OpSensitivity> RankPrecisionSensitivity(
+    const std::shared_ptr<vx::Graph>& graph,
+    const std::vector<CalibrationSample>& samples,
+    vx::Precision precision = vx::Precision::FP16,
+    const std::vector<std::string>& kinds = {"CONV1D", "CONV2D",
+                                             "GROUPED_CONV2D", "FCL2",
+                                             "MATRIXMUL"});
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
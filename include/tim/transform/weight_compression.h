@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_WEIGHT_COMPRESSION_H_
+#define TIM_WEIGHT_COMPRESSION_H_
+
+#include <memory>
+#include <vector>
+
+#include "tim/vx/tensor.h"
+
+namespace tim {
+
+namespace vx {
+class Graph;
+}  // namespace vx
+
+namespace transform {
+
+struct WeightCompressionOption {
+  /// 4 or 8.
+  uint32_t bits = 4;
+  /// Number of consecutive elements along `axis` sharing one scale, must
+  /// divide the axis size. 0 means a single group, i.e. per-channel.
+  uint32_t group_size = 0;
+  /// Reduction axis of the weight: 0 for FullyConnected {in, out}, 1 for the
+  /// second input of Matmul {N, K}.
+  uint32_t axis = 0;
+  /// Symmetric INT4/INT8 if true, otherwise UINT4/UINT8 with zero points.
+  bool symmetric = true;
+};
+
+/// Group-wise quantized weight. Group g of channel c covers
+/// [g * group_size, (g + 1) * group_size) along `axis`; its scale and zero
+/// point live in `scales`/`zero_points` laid out as `shape` with the axis
+/// size replaced by the group count.
+struct CompressedWeight {
+  vx::ShapeType shape;
+  WeightCompressionOption option;
+  /// INT4, UINT4, INT8 or UINT8
+  vx::DataType type = vx::DataType::UNKNOWN;
+  /// 4-bit values are packed two per byte along shape[0], low nibble first,
+  /// an odd row ends with a half filled byte.
+  std::vector<uint8_t> data;
+  std::vector<float> scales;
+  /// Empty if symmetric.
+  std::vector<int32_t> zero_points;
+
+  /// Bytes of data plus scales and zero points.
+  size_t ByteSize() const;
+};
+
+/// Quantize a 2D fp32 weight, returns an empty `data` on invalid input.
+CompressedWeight CompressWeight(const float* weight,
+                                const vx::ShapeType& shape,
+                                const WeightCompressionOption& option =
+                                    WeightCompressionOption());
+
+/// Host side reference of the dequantization done on device.
+std::vector<float> DecompressWeight(const CompressedWeight& weight);
+
+/// Create `weight` as a packed constant in `graph` to feed
+/// FullyConnected/Matmul as their weight input. Returns nullptr on invalid
+/// input.
+///
+/// With FLOAT16 and a single group per channel the returned tensor is the
+/// packed constant itself, quantized per channel, and the consumer
+/// dequantizes it on load.
+///
+/// Otherwise the packed constant is followed by the ops that dequantize it
+/// group-wise, and the returned `float_type` tensor has the original shape.
+/// These ops run on every graph Run(): a DataConvert to uint8 unless stored
+/// as UINT8, a DataConvert to `float_type`, a Multiply by the scales, an Add of
+/// the zero points if asymmetric and Reshapes around them if grouped. The
+/// full float weight is rebuilt each time, which trades the memory saving
+/// for extra bandwidth and compute per inference.
+std::shared_ptr<vx::Tensor> CreateCompressedWeight(
+    const std::shared_ptr<vx::Graph>& graph, const CompressedWeight& weight,
+    vx::DataType float_type = vx::DataType::FLOAT32);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
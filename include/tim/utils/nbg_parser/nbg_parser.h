@@ -151,6 +151,15 @@ typedef enum _nbg_network_property_e
     NBG_PARSER_NETWORK_NAME_SIZE       = 128 + NBG_PARSER_NETWORK_NAME,
 } nbg_network_property_e;
 
+typedef enum _nbg_parser_flag_e
+{
+    /* !< \brief Copy all sections into parser owned memory, same as nbg_parser_init() */
+    NBG_PARSER_FLAG_NONE               = 0,
+    /* !< \brief Only read the header and entry tables. Input/output descriptors are indexed
+         in place, so the NBG buffer must stay valid until nbg_parser_destroy() */
+    NBG_PARSER_FLAG_LAZY               = 1 << 0,
+} nbg_parser_flag_e;
+
 /*
 @brief, Query NBG parser library version
 */
@@ -168,6 +177,33 @@ nbg_status_e nbg_parser_init(
     nbg_parser_data *nbg
     );
 
+/*
+@brief, Initialize NBG parser with nbg_parser_flag_e flags.
+@param IN buffer, NBG data in memory.
+@param IN size, the size of NBG data.
+@param IN flags, bitwise OR of nbg_parser_flag_e.
+@param OUT nbg, the NBG parser object.
+*/
+nbg_status_e nbg_parser_init_ex(
+    void *buffer,
+    nbg_uint32_t size,
+    nbg_uint32_t flags,
+    nbg_parser_data *nbg
+    );
+
+/*
+@brief, Map NBG file read-only and initialize NBG parser on the mapping without copying.
+       NBG_PARSER_FLAG_LAZY is always applied, the mapping is released by nbg_parser_destroy().
+@param IN path, NBG file path.
+@param IN flags, bitwise OR of nbg_parser_flag_e.
+@param OUT nbg, the NBG parser object.
+*/
+nbg_status_e nbg_parser_open(
+    const nbg_char_t *path,
+    nbg_uint32_t flags,
+    nbg_parser_data *nbg
+    );
+
 /*
 @brief, query the input info of network.
 @param IN nbg, the NBG parser object created by nbg_parser_init().
@@ -47,6 +47,7 @@ typedef struct _nbg_reader
     vip_uint32_t    total_size;
     vip_uint8_t     *data;
     vip_uint8_t     *current_data;
+    vip_uint32_t    error; /* set when a read runs past total_size */
 } nbg_reader_t;
 
 typedef struct _nbg_parser_data
@@ -82,6 +83,16 @@ typedef struct _nbg_parser_data
     vip_uint32_t                    n_ICDT;
 
     nbg_reader_t                    reader;
+
+    /* nbg_parser_flag_e flags used to create this object. */
+    vip_uint32_t                    flags;
+    /* Byte size of one input/output entry for this NBG version. */
+    vip_uint32_t                    io_entry_size;
+    /* inputs/outputs point into the NBG buffer rather than parser owned memory. */
+    vip_uint32_t                    io_borrowed;
+    /* Read-only file mapping owned by the parser, created by nbg_parser_open(). */
+    void                           *map_base;
+    vip_uint64_t                    map_size;
 } nbg_parser_data_t;
 
 #if defined(__cplusplus)
@@ -31,9 +31,9 @@ extern "C"{
 
 #define VERSION_MAJOR           1
 
-#define VERSION_MINOR           1
+#define VERSION_MINOR           2
 
-#define VERSION_SUB_MINOR       2
+#define VERSION_SUB_MINOR       0
 
 #if defined(__cplusplus)
 }
@@ -24,8 +24,10 @@
 #ifndef TIM_VX_COMPILE_OPTION_H_
 #define TIM_VX_COMPILE_OPTION_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 
 #if defined(ENABLE_PLATFORM)
 #include "platform/platform.h"
@@ -33,6 +35,15 @@
 
 namespace tim {
 namespace vx {
+
+/// Arithmetic precision of a float operation
+enum class Precision {
+  FP32,
+  FP16,
+  BF16,
+  INT8_WEIGHT_ONLY  // int8 weight dequantized on device, computed in fp16
+};
+
 struct CompileOptionImpl;
 class CompileOption {
  public:
@@ -42,6 +53,16 @@ class CompileOption {
   bool isRelaxMode() const;
   bool setRelaxMode(bool enable = false);
 
+  /// Run every operation of `op_kind` in `precision`, the kind is the ovxlib
+  /// op name, e.g. "CONV2D", "FCL2" or "MATRIXMUL". FLOAT32 tensors crossing
+  /// a precision boundary get DataConvert operations inserted at compile
+  /// time. Operations not covered keep the graph-wide relax mode.
+  bool setOpPrecisionByKind(const std::string& op_kind, Precision precision);
+  /// Same for a single operation, takes priority over its kind
+  bool setOpPrecisionByUid(uint32_t op_uid, Precision precision);
+  Precision getOpPrecision(const std::string& op_kind, uint32_t op_uid) const;
+  bool hasOpPrecision() const;
+
 #if defined(ENABLE_PLATFORM)
   void setDeviceId(::tim::vx::platform::IDevice::device_id_t device);
   ::tim::vx::platform::IDevice::device_id_t getDeviceId();
@@ -24,6 +24,7 @@
 #ifndef TIM_VX_CONTEXT_H_
 #define TIM_VX_CONTEXT_H_
 
+#include <cstddef>
 #include <memory>
 
 namespace tim {
@@ -40,6 +41,15 @@ class Context {
   virtual bool isClOnly() = 0;
   virtual bool hasSP() = 0;
 
+  /// Limit the memory held by the compiled graphs and executables of this
+  /// context to `bytes` in total, 0 for no limit. A compile which doesn't
+  /// fit fails and logs its breakdown; memory is given back once the graph
+  /// or executable is released.
+  virtual void SetMemoryBudget(size_t bytes) = 0;
+  virtual size_t MemoryBudget() = 0;
+  /// Memory currently accounted against the budget
+  virtual size_t MemoryInUse() = 0;
+
   static std::shared_ptr<Context> Create();
 };
 
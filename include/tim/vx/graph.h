@@ -31,6 +31,8 @@
 #include <openssl/evp.h>
 #include <string>
 #endif
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <vector>
 #include <map>
@@ -45,6 +47,27 @@ struct DmaBufferDesc;
 class Operation;
 class CompileOption;
 
+/// Device memory in bytes by kind
+struct MemoryReport {
+  size_t constant = 0;
+  size_t input = 0;
+  size_t output = 0;
+  /// Sum of the intermediate tensors, an upper bound since the driver may
+  /// reuse memory between them
+  size_t intermediate = 0;
+  size_t command = 0;
+  /// Binary graphs which hold both constants and commands
+  size_t binary = 0;
+  size_t others = 0;
+
+  size_t Total() const {
+    return constant + input + output + intermediate + command + binary +
+           others;
+  }
+  /// Breakdown for logging, e.g. "total 1024 (constant 512, input 256, ...)"
+  std::string ToString() const;
+};
+
 class Graph {
  public:
   virtual ~Graph() {}
@@ -60,21 +83,70 @@ class Graph {
                                                const DmaBufferDesc& dmafd) = 0;
 
   /// Create a tensor with given `TensorSpec`.
-  /// spec.attr_ must be TensorAttribute::Input or Output
+  /// spec.attr_ must be TensorAttribute::Input, Output or Constant. A constant
+  /// tensor references `data` without copy, so it must outlive the graph.
   virtual std::shared_ptr<Tensor> CreateIOTensor(const TensorSpec& spec,
                                                  void* data = nullptr) = 0;
 
   /// Create a placeholder tensor for optional inputs of operations
   virtual std::shared_ptr<Tensor> CreateTensorPlaceHolder() = 0;
 
+  /// Create a tensor sharing the memory of region [start, end) of `parent`
+  /// without copy. `parent` must be an input, output or constant tensor of
+  /// this graph; the view of a constant is constant, other views are
+  /// transient. Operations on a view are not ordered against operations on
+  /// its parent. Returns nullptr if the region is invalid.
+  virtual std::shared_ptr<Tensor> CreateTensorView(
+      const std::shared_ptr<Tensor>& parent,
+      const std::vector<uint32_t>& start,
+      const std::vector<uint32_t>& end) = 0;
+
   /// Freeze graph
   virtual bool Compile() = 0;
 
   /// Compile to BinaryGraph
   virtual bool CompileToBinary(void* buf, size_t* size) = 0;
 
+  /// Compile() on a background thread, the graph is kept alive until the
+  /// returned future is ready. The graph must not be modified meanwhile.
+  virtual std::future<bool> CompileAsync() = 0;
+
   virtual bool Run() = 0;
 
+  /// Run the graph as a loop body at most `max_iteration` times.
+  /// Inputs in creation order: iteration index (INT32, shape {1}), condition
+  /// in (BOOL8, shape {1}) and the loop variables. Outputs in creation order:
+  /// condition out and the loop variables. The loop stops once condition out
+  /// is false. Loop variables are carried between iterations by swapping the
+  /// input and output handles, so their buffers are exchanged; read the
+  /// results from the outputs with CopyDataFromTensor() or map(true).
+  virtual bool RunLoop(int32_t max_iteration) = 0;
+
+  /// Create a graph in the same context with the same operations and fresh
+  /// input/output/transient tensors, while constant tensors are shared with
+  /// this graph instead of being copied. Composed operations are cloned as the
+  /// builtin operations they expand to. The clone keeps this graph alive.
+  virtual std::shared_ptr<Graph> CloneShared() = 0;
+
+  /// Rewrite constant `tensor` of this graph with `data` in place, e.g. to
+  /// refresh weights between runs. Only the operations reading it are rebuilt
+  /// and a compiled graph is verified again without a new setup. Copies made
+  /// by the precision policy follow the new data, an int8 weight keeps its
+  /// scale. `data` is in the layout of the tensor spec, rewrites of the
+  /// constant at setup (int8 stored as uint8, permuted and rotated
+  /// deconvolution weights) are applied to it again. Returns false if a
+  /// reader was expanded at setup or the constant was rewritten in a way that
+  /// can't be replayed; both need a new graph. Also returns false while the
+  /// constant is shared with a graph created by CloneShared(), on either
+  /// side, since the clone's readers can't be rebuilt.
+  virtual bool UpdateConstant(const std::shared_ptr<Tensor>& tensor,
+                              const void* data) = 0;
+
+  /// Memory of the tensors and binary graphs of this graph. Tensors added at
+  /// setup are included once the graph is compiled, operation workspaces and
+  /// constants shared through CloneShared() are not.
+  virtual MemoryReport GetMemoryReport() const = 0;
+
   template <typename OpType, typename... Params>
   std::shared_ptr<OpType> CreateOperation(Params... parameters) {
     auto op = std::make_shared<OpType>(this, parameters...);
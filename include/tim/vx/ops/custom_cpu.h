@@ -0,0 +1,104 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_OPS_CUSTOM_CPU_H_
+#define TIM_VX_OPS_CUSTOM_CPU_H_
+
+#include <functional>
+#include "tim/vx/operation.h"
+#include "tim/vx/types.h"
+
+namespace tim {
+namespace vx {
+namespace ops {
+
+/**
+ * ## CustomCpuOp
+ *
+ * Base class of host-CPU custom operations. The operation is instanced
+ * through the ovxlib CPU kernel backend, so it runs inside the graph
+ * between device operations without leaving vxProcessGraph.
+ *
+ * Compute() receives the mapped input and output buffers in the tensor's
+ * own data type. Outputs are written back to the graph after Compute()
+ * returns true. ParallelFor() splits work over a thread pool shared by
+ * all CPU custom operations of the process.
+ */
+
+struct CpuTensorSpan {
+  void* data;
+  size_t size_in_bytes;
+  ShapeType shape;
+  DataType type;
+
+  template <typename T>
+  T* Data() const {
+    return reinterpret_cast<T*>(data);
+  }
+  size_t ElementCount() const {
+    size_t count = 1;
+    for (auto d : shape) {
+      count *= d;
+    }
+    return count;
+  }
+};
+
+class CustomCpuOp : public Operation {
+ public:
+  CustomCpuOp(Graph* graph, uint32_t input_num, uint32_t output_num,
+              int32_t kernel_id, const char* kernel_name);
+
+  ~CustomCpuOp();
+
+  /// Fill outputs_size_ from inputs_size_
+  virtual void SetupShapeInfor() = 0;
+
+  virtual bool Compute(const std::vector<CpuTensorSpan>& inputs,
+                       const std::vector<CpuTensorSpan>& outputs) = 0;
+
+  /// Call func(begin, end) for chunks of [0, count), at least `grain`
+  /// items each, and return when all chunks are done. Nested calls from
+  /// inside a chunk run serially. If func throws, chunks not yet started
+  /// are skipped and the first exception is rethrown to the caller.
+  static void ParallelFor(size_t count,
+                          const std::function<void(size_t, size_t)>& func,
+                          size_t grain = 1);
+  /// Number of threads used by ParallelFor, including the caller
+  static size_t Concurrency();
+
+  std::vector<tim::vx::ShapeType> inputs_size_;
+  std::vector<tim::vx::ShapeType> outputs_size_;
+
+  const char* func_name_;
+  void* vx_node_;
+
+  uint32_t input_num_;
+  uint32_t output_num_;
+};
+
+}  // namespace ops
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_OPS_CUSTOM_CPU_H_ */
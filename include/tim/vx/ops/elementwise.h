@@ -64,6 +64,11 @@ namespace ops {
  * ## FloorDiv
  *
  * FloorDiv(x, y): floor( x / y ). This operation supports broadcasting.
+ *
+ * ## ATimesBPlusC
+ *
+ * ATimesBPlusC(a, b, c): a * b + c. Fused multiply-add, this operation supports
+ * broadcasting.
  */
 
 #define DECLARE_ELEMENTWISE_OP(NAME)                   \
@@ -95,6 +100,13 @@ class Div : public BuiltinOp {
   std::shared_ptr<Operation> Clone(std::shared_ptr<Graph>& graph) const override;
 };
 
+class ATimesBPlusC : public BuiltinOp {
+ public:
+  ATimesBPlusC(Graph* graph);
+
+  std::shared_ptr<Operation> Clone(std::shared_ptr<Graph>& graph) const override;
+};
+
 #undef DECLARE_ELEMENTWISE_OP
 
 }  // namespace ops
@@ -64,12 +64,19 @@ class LiteNativeExecutable : public IExecutable {
   bool Verify() override;
   std::shared_ptr<ITensorHandle> AllocateTensor(
       const TensorSpec& tensor_spec) override;
+  MemoryReport GetMemoryReport() const override;
 
   vip_network network_;
+  /// False if the network buffers exceed the memory budget of the context
+  /// or the network can't be prepared
+  bool prepared_;
 
  private:
   void SetBuffer(vip_memory_t* dst, gcvip_videomemory_t* src);
 
+  MemoryReport memory_;
+  bool memory_reserved_;
+
   int32_t input_count_;
   int32_t output_count_;
 
@@ -24,6 +24,8 @@
 #ifndef TIM_VX_NATIVE_H_
 #define TIM_VX_NATIVE_H_
 
+#include <future>
+
 #include "tim/vx/platform/platform.h"
 
 namespace tim {
@@ -84,6 +86,48 @@ class NativeTensorHandle : public ITensorHandle {
   bool CopyDataFromTensor(void* data) override;
 };
 
+/// Data-parallel executor: the graph is compiled once to NBG and one
+/// NativeExecutable is instantiated on every given device. Requests are
+/// dispatched to the replica with the fewest pending requests.
+class ReplicatedExecutor {
+ public:
+  ReplicatedExecutor(const std::vector<std::shared_ptr<IDevice>>& devices);
+  ReplicatedExecutor(const std::vector<std::shared_ptr<IDevice>>& devices,
+                     const std::shared_ptr<Context>& context);
+  ~ReplicatedExecutor();
+
+  /// Compile graph to NBG and create one executable per device
+  bool Compile(const std::shared_ptr<Graph>& graph);
+
+  /// Queue one inference, inputs and outputs follow the order of
+  /// Graph::InputsTensor()/OutputsTensor() and must stay valid until the
+  /// returned future is ready
+  std::future<bool> Submit(const std::vector<const void*>& inputs,
+                           const std::vector<void*>& outputs);
+  bool Run(const std::vector<const void*>& inputs,
+           const std::vector<void*>& outputs);
+  void WaitIdle();
+
+  size_t ReplicaCount() const;
+  /// Pending (queued and running) requests over all replicas
+  size_t QueueDepth() const;
+  /// Pending requests of the replica bound to devices[replica]
+  size_t QueueDepth(size_t replica) const;
+  std::shared_ptr<IExecutable> Executable(size_t replica) const;
+
+ private:
+  struct Request;
+  struct Replica;
+  void Work(Replica* replica);
+  void Stop();
+
+  std::vector<std::shared_ptr<IDevice>> devices_;
+  std::shared_ptr<Context> context_;
+  std::vector<std::unique_ptr<Replica>> replicas_;
+  std::vector<uint32_t> input_bytes_;
+  std::mutex dispatch_mutex_;
+};
+
 }  // namespace platform
 }  // namespace vx
 }  // namespace tim
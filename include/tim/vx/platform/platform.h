@@ -24,7 +24,13 @@
 #ifndef TIM_VX_PLATFORM_H_
 #define TIM_VX_PLATFORM_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <functional>
 #include <iostream>
@@ -111,6 +117,8 @@ class IExecutable : public std::enable_shared_from_this<IExecutable> {
   virtual std::shared_ptr<ITensorHandle> AllocateTensor(
       const TensorSpec& tensor_spec) = 0;
   virtual std::shared_ptr<IExecutor> Executor() const;
+  /// Memory of the executable, by default the one of NBGraph()
+  virtual MemoryReport GetMemoryReport() const;
 
  protected:
   std::weak_ptr<IExecutor> executor_;
@@ -131,12 +139,82 @@ class ExecutableSet : public IExecutable {
   bool Verify() override;
   std::shared_ptr<ITensorHandle> AllocateTensor(
       const TensorSpec& tensor_spec) override;
+  MemoryReport GetMemoryReport() const override;
   std::vector<std::shared_ptr<IExecutable>> Executables() const;
 
  protected:
   std::vector<std::shared_ptr<IExecutable>> executables_;
 };
 
+/// Holds the executable that currently serves requests. Get() always
+/// returns a complete executable; Swap() replaces it atomically so a new
+/// model version can be brought up while the old one keeps running.
+class ExecutableSlot {
+ public:
+  explicit ExecutableSlot(
+      const std::shared_ptr<IExecutable>& executable = nullptr);
+  std::shared_ptr<IExecutable> Get() const;
+  /// Install `executable` and return the previously installed one
+  std::shared_ptr<IExecutable> Swap(
+      const std::shared_ptr<IExecutable>& executable);
+
+ private:
+  std::shared_ptr<IExecutable> executable_;
+};
+
+/// One graph compilation queued on a CompileQueue
+class CompileTask {
+ public:
+  CompileTask(const std::shared_ptr<Graph>& graph,
+              const std::shared_ptr<ExecutableSlot>& slot);
+  /// A queued task never starts; a running one is finished by the driver
+  /// but its result is dropped and not installed into the slot. Cancelling
+  /// a finished task has no effect.
+  void Cancel();
+  bool IsCancelled() const;
+  /// Wait for the result, nullptr if compilation failed or was cancelled
+  std::shared_ptr<IExecutable> Get() const;
+  std::shared_future<std::shared_ptr<IExecutable>> Future() const;
+
+ private:
+  friend class CompileQueue;
+  void Finish(const std::shared_ptr<IExecutable>& executable);
+
+  std::shared_ptr<Graph> graph_;
+  std::shared_ptr<ExecutableSlot> slot_;
+  std::mutex mutex_;  // orders Cancel() against the result of Finish()
+  std::atomic<bool> cancelled_;
+  std::atomic<bool> finished_;
+  std::promise<std::shared_ptr<IExecutable>> promise_;
+  std::shared_future<std::shared_ptr<IExecutable>> future_;
+};
+
+/// Compiles graphs for an executor on a bounded pool of background workers.
+/// When a task finishes successfully and was not cancelled, its executable
+/// is swapped into the slot given at Enqueue().
+class CompileQueue {
+ public:
+  CompileQueue(const std::shared_ptr<IExecutor>& executor,
+               size_t workers = 1);
+  /// Cancel queued tasks and wait for running ones
+  ~CompileQueue();
+  std::shared_ptr<CompileTask> Enqueue(
+      const std::shared_ptr<Graph>& graph,
+      const std::shared_ptr<ExecutableSlot>& slot = nullptr);
+  /// Tasks waiting for a worker
+  size_t Pending() const;
+
+ private:
+  void Work();
+
+  std::shared_ptr<IExecutor> executor_;
+  mutable std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::deque<std::shared_ptr<CompileTask>> queue_;
+  std::vector<std::thread> workers_;
+  bool stop_;
+};
+
 class ITensorHandle {
  public:
   virtual ~ITensorHandle(){};
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_VX_SEQUENCE_RUNNER_H_
+#define TIM_VX_SEQUENCE_RUNNER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tim {
+namespace vx {
+
+class Graph;
+class Tensor;
+
+/// Run a single time step cell graph over a whole sequence.
+///
+/// The sequence ops (UnidirectionalSequenceLstm/GRU/RNN) unroll every time
+/// step into the graph, so graph size and compile time grow with the
+/// sequence length. A SequenceRunner compiles one step once and executes it
+/// per time step instead, carrying the recurrent states by swapping the
+/// handles of the state outputs and inputs, without host copies.
+///
+/// Cell graph inputs in creation order: x_t followed by the states.
+/// Cell graph outputs in creation order: y_t followed by the states, the
+/// state outputs matching the state inputs in order, shape and data type.
+/// After Run() the last states are held by the state inputs, so a following
+/// Run() continues the sequence; call ResetStates() to start a new one.
+class SequenceRunner {
+ public:
+  explicit SequenceRunner(const std::shared_ptr<Graph>& cell);
+
+  /// Run `time_step` steps. `input` holds time_step contiguous x_t and
+  /// `output` receives time_step contiguous y_t, or only the last one if
+  /// `return_sequences` is false.
+  bool Run(const void* input, uint32_t time_step, void* output,
+           bool return_sequences = true);
+
+  /// Fill all states with zero.
+  bool ResetStates();
+
+  /// Tensor holding the latest value of state `index`.
+  std::shared_ptr<Tensor> State(uint32_t index) const;
+
+  uint32_t StateCount() const {
+    return static_cast<uint32_t>(state_inputs_.size());
+  }
+
+ private:
+  std::shared_ptr<Graph> cell_;
+  std::shared_ptr<Tensor> step_input_;
+  std::shared_ptr<Tensor> step_output_;
+  std::vector<std::shared_ptr<Tensor>> state_inputs_;
+  std::vector<std::shared_ptr<Tensor>> state_outputs_;
+  bool valid_;
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_SEQUENCE_RUNNER_H_ */
@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_VX_SERIALIZATION_H_
+#define TIM_VX_SERIALIZATION_H_
+
+#include <memory>
+#include <string>
+
+namespace tim {
+namespace vx {
+
+class Context;
+class Graph;
+
+/// Serialize a graph into a portable, device independent file.
+///
+/// The file records tensor specs (including quantization), graph inputs and
+/// outputs, every builtin operation with its parameters, and a constant
+/// section where each constant tensor starts on a 64-byte boundary.
+/// Composed operations are stored as the builtin operations they expand to.
+/// Returns false if the graph holds an operation which cannot be serialized
+/// (NBG, custom operations).
+bool SaveGraph(const std::shared_ptr<Graph>& graph, const std::string& path);
+
+/// Load a graph written by `SaveGraph`.
+///
+/// The file is memory mapped and constant tensors are created directly on top
+/// of the mapping instead of copying the weights; the mapping is released
+/// together with the returned graph. Returns nullptr on failure.
+std::shared_ptr<Graph> LoadGraph(const std::shared_ptr<Context>& ctx,
+                                 const std::string& path);
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_SERIALIZATION_H_ */
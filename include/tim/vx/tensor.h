@@ -157,6 +157,13 @@ class Tensor {
   virtual bool SwapHandleWithCache(std::shared_ptr<tim::vx::Tensor> tensor) = 0;
   virtual bool FlushCacheForHandle() = 0;
   virtual bool InvalidateCacheForHandle() = 0;
+  /// Bind the memory of `producer`, an OUTPUT tensor of another graph, as
+  /// the handle of this INPUT tensor so that chained graphs pass data without
+  /// host copies. Shape, data type and quantization must match and both
+  /// tensors must be created from handle. The producer graph is kept alive by
+  /// the graph of this tensor. Swapping the producer handle afterwards breaks
+  /// the binding.
+  virtual bool ShareHandleWith(const std::shared_ptr<Tensor>& producer) = 0;
   virtual void* map(bool invalidate_cpu_cache = false) = 0;
   virtual void unmap() = 0;
   virtual bool IsPlaceHolder() = 0;
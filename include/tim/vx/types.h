@@ -40,7 +40,8 @@ enum class DataType {
   FLOAT32,
   BOOL8,
   INT4,
-  UINT4
+  UINT4,
+  BFLOAT16
 };
 
 enum class QuantType {
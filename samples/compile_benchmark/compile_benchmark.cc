@@ -0,0 +1,546 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+// Timings of compile and run paths whose correctness is covered by the unit
+// tests: sequence_runner_test.cc, const_pipeline_test.cc,
+// weight_compression_test.cc and cpu_kernel_test.cc.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/vx/sequence_runner.h"
+#include "tim/transform/weight_compression.h"
+#include "context_private.h"
+#include "graph_private.h"
+#include "vsi_nn_pub.h"
+#include "vsi_nn_types_prv.h"
+#include "utils/vsi_nn_arena.h"
+#include "utils/vsi_nn_const_pipeline.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double Ms(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+std::shared_ptr<tim::vx::Tensor> ConstTensor(
+    const std::shared_ptr<tim::vx::Graph>& graph,
+    const tim::vx::ShapeType& shape) {
+  size_t count = 1;
+  for (auto d : shape) {
+    count *= d;
+  }
+  std::vector<float> data(count, 0.01f);
+  tim::vx::TensorSpec spec(tim::vx::DataType::FLOAT32, shape,
+                           tim::vx::TensorAttribute::CONSTANT);
+  return graph->CreateTensor(spec, data.data());
+}
+
+std::shared_ptr<tim::vx::Tensor> Tensor(
+    const std::shared_ptr<tim::vx::Graph>& graph,
+    const tim::vx::ShapeType& shape, tim::vx::TensorAttribute attr) {
+  tim::vx::TensorSpec spec(tim::vx::DataType::FLOAT32, shape, attr);
+  return graph->CreateTensor(spec);
+}
+
+std::vector<std::shared_ptr<tim::vx::Tensor>> LstmInputs(
+    const std::shared_ptr<tim::vx::Graph>& g,
+    const std::shared_ptr<tim::vx::Tensor>& x,
+    const std::shared_ptr<tim::vx::Tensor>& h,
+    const std::shared_ptr<tim::vx::Tensor>& c, uint32_t n_input,
+    uint32_t n_cell) {
+  return {
+      x, h, c,
+      ConstTensor(g, {n_input, n_cell}), ConstTensor(g, {n_input, n_cell}),
+      ConstTensor(g, {n_input, n_cell}), ConstTensor(g, {n_input, n_cell}),
+      ConstTensor(g, {n_cell, n_cell}),  ConstTensor(g, {n_cell, n_cell}),
+      ConstTensor(g, {n_cell, n_cell}),  ConstTensor(g, {n_cell, n_cell}),
+      g->CreateTensorPlaceHolder(), /*weight_c2i*/
+      g->CreateTensorPlaceHolder(), /*weight_c2f*/
+      g->CreateTensorPlaceHolder(), /*weight_c2o*/
+      ConstTensor(g, {n_cell}),          ConstTensor(g, {n_cell}),
+      ConstTensor(g, {n_cell}),          ConstTensor(g, {n_cell}),
+  };
+}
+
+std::shared_ptr<tim::vx::ops::UnidirectionalSequenceLstm> Lstm(
+    const std::shared_ptr<tim::vx::Graph>& g) {
+  return g->CreateOperation<tim::vx::ops::UnidirectionalSequenceLstm>(
+      0.0, 0.0, tim::vx::ops::UnidirectionalSequenceLstm::ActivationType::kTANH,
+      0.0, false, tim::vx::ops::UnidirectionalSequenceLstm::kSIGMOID, true);
+}
+
+// UnidirectionalSequenceLstm over `n_step` steps, every step is expanded
+// into internal nodes at setup.
+std::shared_ptr<tim::vx::Graph> UnrolledLstm(
+    const std::shared_ptr<tim::vx::Context>& ctx, uint32_t n_step,
+    uint32_t n_input, uint32_t n_cell) {
+  const uint32_t n_batch = 1;
+  auto g = ctx->CreateGraph();
+  auto seq_in =
+      Tensor(g, {n_input, n_step, n_batch}, tim::vx::TensorAttribute::INPUT);
+  auto seq_out =
+      Tensor(g, {n_cell, n_step, n_batch}, tim::vx::TensorAttribute::OUTPUT);
+  (*Lstm(g))
+      .BindInputs(LstmInputs(g, seq_in, g->CreateTensorPlaceHolder(),
+                             g->CreateTensorPlaceHolder(), n_input, n_cell))
+      .BindOutputs({
+          seq_out,
+          Tensor(g, {n_cell, n_batch}, tim::vx::TensorAttribute::OUTPUT),
+          Tensor(g, {n_cell, n_batch}, tim::vx::TensorAttribute::OUTPUT),
+      });
+  return g;
+}
+
+// UnidirectionalSequenceLstm unrolled over the whole sequence against one
+// step compiled once and driven by a SequenceRunner.
+bool BenchLstmUnrolledVsCell(const std::shared_ptr<tim::vx::Context>& ctx) {
+  const uint32_t n_batch = 1, n_step = 256, n_input = 64, n_cell = 128;
+  std::vector<float> input(n_input * n_step * n_batch, 0.5f);
+
+  auto g = UnrolledLstm(ctx, n_step, n_input, n_cell);
+  auto seq_in = g->InputsTensor()[0];
+  auto t0 = Clock::now();
+  if (!g->Compile()) return false;
+  auto t1 = Clock::now();
+  if (!seq_in->CopyDataToTensor(input.data())) return false;
+  if (!g->Run()) return false;
+  auto t2 = Clock::now();
+
+  auto cell = ctx->CreateGraph();
+  auto x = Tensor(cell, {n_input, 1, n_batch}, tim::vx::TensorAttribute::INPUT);
+  auto h_in = Tensor(cell, {n_cell, n_batch}, tim::vx::TensorAttribute::INPUT);
+  auto c_in = Tensor(cell, {n_cell, n_batch}, tim::vx::TensorAttribute::INPUT);
+  auto y = Tensor(cell, {n_cell, 1, n_batch}, tim::vx::TensorAttribute::OUTPUT);
+  auto h_out =
+      Tensor(cell, {n_cell, n_batch}, tim::vx::TensorAttribute::OUTPUT);
+  auto c_out =
+      Tensor(cell, {n_cell, n_batch}, tim::vx::TensorAttribute::OUTPUT);
+  (*Lstm(cell))
+      .BindInputs(LstmInputs(cell, x, h_in, c_in, n_input, n_cell))
+      .BindOutputs({y, h_out, c_out});
+
+  tim::vx::SequenceRunner runner(cell);
+  auto t3 = Clock::now();
+  if (!cell->Compile()) return false;
+  auto t4 = Clock::now();
+  std::vector<float> output(n_cell * n_step * n_batch);
+  if (!runner.ResetStates()) return false;
+  if (!runner.Run(input.data(), n_step, output.data())) return false;
+  auto t5 = Clock::now();
+
+  std::cout << "lstm " << n_step << " steps unrolled: compile " << Ms(t0, t1)
+            << " ms, " << n_step / (Ms(t1, t2) / 1000) << " steps/s"
+            << std::endl;
+  std::cout << "lstm " << n_step << " steps compact:  compile " << Ms(t3, t4)
+            << " ms, " << n_step / (Ms(t4, t5) / 1000) << " steps/s"
+            << std::endl;
+  return true;
+}
+
+// Compile of a long unrolled LSTM with internal nodes, tensors and link list
+// items carved from the graph arena, against a context whose tiny arena
+// blocks give every allocation its own malloc as before the arena.
+bool BenchLstmArena() {
+  const uint32_t n_step = 512, n_input = 64, n_cell = 128;
+  for (int32_t block_size : {0, 16}) {
+    auto ctx = tim::vx::Context::Create();
+    if (!ctx) return false;
+    std::static_pointer_cast<tim::vx::ContextImpl>(ctx)
+        ->context()
+        ->options.graph_arena_block_size = block_size;
+    auto g = UnrolledLstm(ctx, n_step, n_input, n_cell);
+
+    auto t0 = Clock::now();
+    if (!g->Compile()) return false;
+    auto t1 = Clock::now();
+    auto graph = reinterpret_cast<vsi_nn_graph_prv_t*>(
+        std::static_pointer_cast<tim::vx::GraphImpl>(g)->graph());
+    vsi_nn_arena_stat_t stat = {};
+    vsi_nn_arena_get_stat(graph->arena, &stat);
+    g.reset();
+    auto t2 = Clock::now();
+
+    std::cout << "lstm " << n_step << " steps "
+              << (block_size ? "malloc" : "arena ") << ": compile "
+              << Ms(t0, t1) << " ms, release " << Ms(t1, t2) << " ms, "
+              << stat.alloc_count << " allocations in " << stat.block_count
+              << " blocks, " << stat.alloc_bytes << " bytes" << std::endl;
+  }
+  return true;
+}
+
+// Permute then rotate of many deconvolution sized weights, one pass per
+// transform against both transforms chained in one pass.
+bool BenchConstPipeline(const std::shared_ptr<tim::vx::Context>& ctx) {
+  const size_t n_tensor = 64;
+  const tim::vx::ShapeType shape = {3, 3, 256, 256};
+  std::vector<int8_t> data(3 * 3 * 256 * 256, 1);
+  auto graph = ctx->CreateGraph();
+  auto low_graph = std::static_pointer_cast<tim::vx::GraphImpl>(graph)->graph();
+  tim::vx::Quantization quant(tim::vx::QuantType::ASYMMETRIC, 0.5f, 3);
+  tim::vx::TensorSpec spec(tim::vx::DataType::INT8, shape,
+                           tim::vx::TensorAttribute::CONSTANT, quant);
+
+  std::vector<vsi_nn_tensor_t*> separate, chained;
+  for (size_t i = 0; i < 2 * n_tensor; i++) {
+    auto tensor = graph->CreateTensor(spec, data.data());
+    auto low_tensor = vsi_nn_GetTensor(low_graph, tensor->GetId());
+    if (!low_tensor) return false;
+    (i % 2 ? chained : separate).push_back(low_tensor);
+  }
+  vsi_nn_const_permute_param_t param = {};
+  param.perm[0] = 0;
+  param.perm[1] = 1;
+  param.perm[2] = 3;
+  param.perm[3] = 2;
+  param.dim_num = 4;
+
+  vsi_nn_const_pipeline_t* pipeline = vsi_nn_const_pipeline_create(low_graph);
+  if (!pipeline) return false;
+  vsi_status status = VSI_SUCCESS;
+  auto t0 = Clock::now();
+  for (auto t : separate) {
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_add(
+          pipeline, t, vsi_nn_const_transform_permute, &param, sizeof(param));
+    }
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_run(pipeline, nullptr);
+    }
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_add(
+          pipeline, t, vsi_nn_const_transform_rotate_180, nullptr, 0);
+    }
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_run(pipeline, nullptr);
+    }
+  }
+  auto t1 = Clock::now();
+  for (auto t : chained) {
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_add(
+          pipeline, t, vsi_nn_const_transform_permute, &param, sizeof(param));
+    }
+    if (VSI_SUCCESS == status) {
+      status = vsi_nn_const_pipeline_add(
+          pipeline, t, vsi_nn_const_transform_rotate_180, nullptr, 0);
+    }
+  }
+  vsi_nn_const_pipeline_stat_t stat = {};
+  if (VSI_SUCCESS == status) {
+    status = vsi_nn_const_pipeline_run(pipeline, &stat);
+  }
+  auto t2 = Clock::now();
+  vsi_nn_const_pipeline_release(&pipeline);
+  if (VSI_SUCCESS != status) return false;
+
+  std::cout << n_tensor << " weights permute+rotate, separate passes: "
+            << Ms(t0, t1) << " ms, chained: " << Ms(t1, t2) << " ms, "
+            << (stat.bytes_read + stat.bytes_written) / (1 << 20)
+            << " MB touched" << std::endl;
+  return true;
+}
+
+// FullyConnected 1024x1024 over a group-wise 8-bit and 4-bit weight, average
+// of 10 runs after a warm up run.
+bool BenchCompressedFullyConnected(
+    const std::shared_ptr<tim::vx::Context>& ctx) {
+  const uint32_t in = 1024, out = 1024, runs = 10;
+  std::vector<float> weight(in * out), input(in);
+  for (size_t i = 0; i < weight.size(); i++) {
+    weight[i] = 0.05f * std::sin(0.37f * i) * (1 + (i % 5));
+  }
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = std::sin(0.37f * i) * (1 + (i % 5));
+  }
+  std::vector<float> exact(out, 0.0f);
+  for (uint32_t o = 0; o < out; o++) {
+    for (uint32_t i = 0; i < in; i++) {
+      exact[o] += input[i] * weight[o * in + i];
+    }
+  }
+
+  for (uint32_t bits : {8u, 4u}) {
+    tim::transform::WeightCompressionOption option;
+    option.bits = bits;
+    option.group_size = 128;
+    auto compressed =
+        tim::transform::CompressWeight(weight.data(), {in, out}, option);
+
+    auto graph = ctx->CreateGraph();
+    auto x = Tensor(graph, {in, 1}, tim::vx::TensorAttribute::INPUT);
+    auto y = Tensor(graph, {out, 1}, tim::vx::TensorAttribute::OUTPUT);
+    auto fc_weight = tim::transform::CreateCompressedWeight(graph, compressed);
+    if (!fc_weight) return false;
+    graph->CreateOperation<tim::vx::ops::FullyConnected>(0, out)
+        ->BindInputs({x, fc_weight})
+        .BindOutput(y);
+    if (!graph->Compile()) return false;
+    if (!x->CopyDataToTensor(input.data())) return false;
+    if (!graph->Run()) return false;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < runs; i++) {
+      if (!graph->Run()) return false;
+    }
+    auto t1 = Clock::now();
+    std::vector<float> output(out);
+    if (!y->CopyDataFromTensor(output.data())) return false;
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < exact.size(); i++) {
+      max_error = std::max(max_error, std::fabs(exact[i] - output[i]));
+    }
+    std::cout << "fully_connected " << in << "x" << out << " int" << bits
+              << " group " << option.group_size << ": " << Ms(t0, t1) / runs
+              << " ms, weight " << compressed.ByteSize() << " bytes ("
+              << in * out * sizeof(float) << " fp32), max error " << max_error
+              << std::endl;
+  }
+  return true;
+}
+
+
+// Scalar loops the custom CPU kernels ran before the thread pool, used as
+// the baseline of BenchCpuKernels.
+void ScalarSoftmax(const std::vector<float>& src, uint32_t axis_size,
+                   std::vector<float>& dst) {
+  for (size_t base = 0; base < src.size(); base += axis_size) {
+    float max = src[base];
+    for (uint32_t i = 0; i < axis_size; i++) {
+      max = std::max(max, src[base + i]);
+    }
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < axis_size; i++) {
+      dst[base + i] = std::exp(src[base + i] - max);
+      sum += dst[base + i];
+    }
+    for (uint32_t i = 0; i < axis_size; i++) {
+      dst[base + i] = dst[base + i] / sum;
+    }
+  }
+}
+
+void ScalarWarpBilinear(const std::vector<float>& src, uint32_t width,
+                        uint32_t height, const float* m, bool perspective,
+                        std::vector<float>& dst) {
+  // Samples outside of the image read as 0 for affine, 205 for perspective
+  const float border = perspective ? 205.0f : 0.0f;
+  auto pixel = [&](float x, float y) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return border;
+    return src[static_cast<size_t>(y) * width + static_cast<size_t>(x)];
+  };
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      float xf, yf;
+      if (perspective) {
+        float z = x * m[2] + y * m[5] + m[8];
+        xf = (x * m[0] + y * m[3] + m[6]) / z;
+        yf = (x * m[1] + y * m[4] + m[7]) / z;
+      } else {
+        xf = x * m[0] + y * m[2] + m[4];
+        yf = x * m[1] + y * m[3] + m[5];
+      }
+      float x0 = std::floor(xf), y0 = std::floor(yf);
+      float ar = xf - x0, ab = yf - y0;
+      float al = 1.0f - ar, at = 1.0f - ab;
+      dst[y * width + x] =
+          pixel(x0, y0) * al * at + pixel(x0 + 1, y0) * ar * at +
+          pixel(x0, y0 + 1) * al * ab + pixel(x0 + 1, y0 + 1) * ar * ab;
+    }
+  }
+}
+
+// Build a single node ovxlib graph of `op` over a {width, height, 1} fp32
+// tensor, run it once as warm up, then `runs` times. Returns the average ms
+// per run, or a negative value on failure.
+double RunCpuKernel(vsi_nn_op_t op, uint32_t input_num, uint32_t width,
+                    uint32_t height,
+                    const std::function<void(vsi_nn_node_t*)>& configure,
+                    const std::vector<float>& input, uint32_t runs,
+                    std::vector<float>& output) {
+  vsi_nn_context_t ctx = vsi_nn_CreateContext();
+  vsi_nn_graph_t* graph = ctx ? vsi_nn_CreateGraph(ctx, 3, 1) : nullptr;
+  double ms = -1.0;
+  if (graph) {
+    vsi_nn_tensor_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.dim_num = 3;
+    attr.size[0] = width;
+    attr.size[1] = height;
+    attr.size[2] = 1;
+    attr.dtype.vx_type = VSI_NN_TYPE_FLOAT32;
+    vsi_nn_tensor_id_t in_id =
+        vsi_nn_AddTensor(graph, VSI_NN_TENSOR_ID_AUTO, &attr, nullptr);
+    vsi_nn_tensor_id_t out_id =
+        vsi_nn_AddTensor(graph, VSI_NN_TENSOR_ID_AUTO, &attr, nullptr);
+    vsi_nn_node_t* node = vsi_nn_AddNode(graph, op, input_num, 1, nullptr);
+    if (node) {
+      node->input.tensors[0] = in_id;
+      node->output.tensors[0] = out_id;
+      configure(node);
+      vsi_nn_SetGraphInputs(graph, &in_id, 1);
+      vsi_nn_SetGraphOutputs(graph, &out_id, 1);
+    }
+    std::vector<float> data(input);
+    if (node && VSI_SUCCESS == vsi_nn_SetupGraph(graph, FALSE) &&
+        VSI_SUCCESS == vsi_nn_VerifyGraph(graph) &&
+        VSI_SUCCESS == vsi_nn_CopyDataToTensor(
+                           graph, vsi_nn_GetTensor(graph, in_id),
+                           reinterpret_cast<uint8_t*>(data.data())) &&
+        VSI_SUCCESS == vsi_nn_RunGraph(graph)) {
+      bool ok = true;
+      auto t0 = Clock::now();
+      for (uint32_t i = 0; i < runs && ok; i++) {
+        ok = VSI_SUCCESS == vsi_nn_RunGraph(graph);
+      }
+      auto t1 = Clock::now();
+      float* buffer = ok ? vsi_nn_ConvertTensorToFloat32Data(
+                               graph, vsi_nn_GetTensor(graph, out_id))
+                         : nullptr;
+      if (buffer) {
+        output.assign(buffer, buffer + output.size());
+        free(buffer);
+        ms = Ms(t0, t1) / runs;
+      }
+    }
+  }
+  vsi_nn_ReleaseGraph(&graph);
+  vsi_nn_ReleaseContext(&ctx);
+  return ms;
+}
+
+// The custom softmax, warp affine and warp perspective CPU kernels on the
+// thread pool with SIMD helpers, against the scalar loops they replaced.
+// Kernel times include reading and writing the vx tensors.
+bool BenchCpuKernels() {
+  const uint32_t width = 1920, height = 1080, runs = 5;
+  std::vector<float> image(width * height);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = static_cast<float>((i * 7) % 255);
+  }
+  const float affine[6] = {0.9f, 0.1f, -0.1f, 0.9f, 40.0f, 20.0f};
+  const float perspective[9] = {0.9f,     0.05f, 0.00002f,
+                                -0.05f,   0.9f,  0.00001f,
+                                30.0f,    10.0f, 1.0f};
+
+  struct Case {
+    const char* name;
+    vsi_nn_op_t op;
+    uint32_t input_num;
+    std::function<void(vsi_nn_node_t*)> configure;
+    std::function<void(std::vector<float>&)> scalar;
+  };
+  std::vector<Case> cases = {
+      {"softmax", VSI_NN_OP_CUSTOM_SOFTMAX, 1,
+       [](vsi_nn_node_t* node) { node->nn_param.custom_softmax.axis = 0; },
+       [&](std::vector<float>& dst) { ScalarSoftmax(image, width, dst); }},
+      {"warp_affine", VSI_NN_OP_CUSTOM_WARP_AFFINE, 2,
+       [&](vsi_nn_node_t* node) {
+         node->nn_param.custom_warp_affine.matrix = affine;
+         node->nn_param.custom_warp_affine.type =
+             VSI_NN_INTERPOLATION_BILINEAR;
+         node->nn_param.custom_warp_affine.rgb_type =
+             VSI_NN_WARP_AFFINE_TYPE_NONE;
+         node->input.tensors[1] = VSI_NN_TENSOR_ID_NA;
+       },
+       [&](std::vector<float>& dst) {
+         ScalarWarpBilinear(image, width, height, affine, false, dst);
+       }},
+      {"warp_perspective", VSI_NN_OP_CUSTOM_WARP_PERSPECTIVE, 1,
+       [&](vsi_nn_node_t* node) {
+         node->nn_param.custom_warp_perspective.matrix = perspective;
+         node->nn_param.custom_warp_perspective.type =
+             VSI_NN_INTERPOLATION_BILINEAR;
+       },
+       [&](std::vector<float>& dst) {
+         ScalarWarpBilinear(image, width, height, perspective, true, dst);
+       }},
+  };
+
+  for (const auto& c : cases) {
+    std::vector<float> scalar(image.size()), pooled(image.size());
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < runs; i++) {
+      c.scalar(scalar);
+    }
+    auto t1 = Clock::now();
+    double pooled_ms = RunCpuKernel(c.op, c.input_num, width, height,
+                                    c.configure, image, runs, pooled);
+    if (pooled_ms < 0) return false;
+
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < scalar.size(); i++) {
+      max_diff = std::max(max_diff, std::fabs(scalar[i] - pooled[i]));
+    }
+    std::cout << "cpu " << c.name << " " << width << "x" << height
+              << ": scalar " << Ms(t0, t1) / runs << " ms, pooled "
+              << pooled_ms << " ms (" << vsi_nn_kernel_cpu_thread_num()
+              << " threads), max diff " << max_diff << std::endl;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  (void)argc, (void)argv;
+  auto ctx = tim::vx::Context::Create();
+  if (!ctx) {
+    std::cout << "Failed to create context" << std::endl;
+    return -1;
+  }
+
+  int ret = 0;
+  if (!BenchLstmUnrolledVsCell(ctx)) {
+    std::cout << "lstm unrolled vs cell failed" << std::endl;
+    ret = -1;
+  }
+  if (!BenchLstmArena()) {
+    std::cout << "lstm arena failed" << std::endl;
+    ret = -1;
+  }
+  if (!BenchConstPipeline(ctx)) {
+    std::cout << "const pipeline failed" << std::endl;
+    ret = -1;
+  }
+  if (!BenchCompressedFullyConnected(ctx)) {
+    std::cout << "compressed fully_connected failed" << std::endl;
+    ret = -1;
+  }
+  if (!BenchCpuKernels()) {
+    std::cout << "cpu kernels failed" << std::endl;
+    ret = -1;
+  }
+  return ret;
+}
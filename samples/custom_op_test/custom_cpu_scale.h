@@ -0,0 +1,78 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_OPS_CUSTOM_CPU_SCALE_H_
+#define TIM_VX_OPS_CUSTOM_CPU_SCALE_H_
+
+#include "tim/vx/ops/custom_base.h"
+#include "tim/vx/ops/custom_cpu.h"
+
+namespace tim {
+namespace vx {
+namespace ops {
+
+// out = in * scale + bias, computed on the host cpu
+class CustomCpuScale : public CustomCpuOp {
+ public:
+  CustomCpuScale(Graph* graph, float scale, float bias)
+      : CustomCpuOp(graph, 1, 1, CustomCpuScale::kernel_id_,
+                    CustomCpuScale::kernel_name_),
+        scale_(scale),
+        bias_(bias) {}
+
+ protected:
+  float scale_;
+  float bias_;
+  static const char* kernel_name_;
+  static int32_t kernel_id_;
+
+  void SetupShapeInfor() override { outputs_size_[0] = inputs_size_[0]; }
+
+  bool Compute(const std::vector<CpuTensorSpan>& inputs,
+               const std::vector<CpuTensorSpan>& outputs) override {
+    if (inputs[0].type != DataType::FLOAT32 ||
+        outputs[0].type != DataType::FLOAT32) {
+      return false;
+    }
+    const float* in = inputs[0].Data<float>();
+    float* out = outputs[0].Data<float>();
+    ParallelFor(outputs[0].ElementCount(),
+                [&](size_t begin, size_t end) {
+                  for (size_t i = begin; i < end; i++) {
+                    out[i] = in[i] * scale_ + bias_;
+                  }
+                },
+                1024);
+    return true;
+  }
+
+  std::shared_ptr<Operation> Clone(
+      std::shared_ptr<Graph>& graph) const override {
+    return graph->CreateOperation<CustomCpuScale>(scale_, bias_);
+  }
+};
+
+}  // namespace ops
+}  // namespace vx
+}  // namespace tim
+#endif
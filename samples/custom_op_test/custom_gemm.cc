@@ -22,6 +22,7 @@
 *
 *****************************************************************************/
 #include "custom_gemm.h"
+#include "custom_cpu_scale.h"
 
 namespace tim {
 namespace vx {
@@ -30,6 +31,9 @@ namespace ops {
 const char* CustomGemm::kernel_name_ = "xxxx_name12345";
 int32_t CustomGemm::kernel_id_ = -1 * (++gobal_kernel_id_);
 
+const char* CustomCpuScale::kernel_name_ = "cpu_scale";
+int32_t CustomCpuScale::kernel_id_ = -1 * (++gobal_kernel_id_);
+
 
 }  // namespace ops
 }  // namespace vx
@@ -25,6 +25,7 @@
 #include "tim/vx/graph.h"
 #include "tim/vx/ops.h"
 #include "custom_gemm.h"
+#include "custom_cpu_scale.h"
 #include <tuple>
 
 void custom_gemm_single_test(){
@@ -234,9 +235,61 @@ void custom_gemm_op_and_custom_gemm_op_test(){
     std::cout<<std::endl; 
 }
 
+void custom_cpu_op_and_add_op_test(){
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType shape({4, 2});
+    tim::vx::TensorSpec in_spec(tim::vx::DataType::FLOAT32,
+                    shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec tmp_spec(tim::vx::DataType::FLOAT32,
+                    shape, tim::vx::TensorAttribute::TRANSIENT);
+    tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32,
+                    shape, tim::vx::TensorAttribute::OUTPUT);
+
+    auto a_tensor = graph->CreateTensor(in_spec);
+    auto b_tensor = graph->CreateTensor(in_spec);
+    auto c_tensor = graph->CreateTensor(tmp_spec);
+    auto out_tensor = graph->CreateTensor(out_spec);
+
+    std::vector<float> a_data = {
+        1, 2, 3, 4,
+        -1, -2, -3, -4
+    };
+    std::vector<float> b_data = {
+        1, 1, 1, 1,
+        0, 0, 0, 0
+    };
+    std::vector<float> golden = {
+        5, 7, 9, 11,
+        -1, -3, -5, -7
+    };
+
+    a_tensor->CopyDataToTensor(a_data.data(), a_data.size() * sizeof(float));
+    b_tensor->CopyDataToTensor(b_data.data(), b_data.size() * sizeof(float));
+
+    auto op_add = graph->CreateOperation<tim::vx::ops::AddN>(2);
+    (*op_add).BindInputs({a_tensor, b_tensor}).BindOutputs({c_tensor});
+
+    auto op_scale = graph->CreateOperation<tim::vx::ops::CustomCpuScale>(2.0f, 1.0f);
+    (*op_scale).BindInputs({c_tensor}).BindOutputs({out_tensor});
+
+    graph->Compile();
+    graph->Run();
+
+    std::vector<float> output(golden.size());
+    out_tensor->CopyDataFromTensor(output.data());
+    std::cout<<"the diff between golan and result:"<<std::endl;
+    for(uint32_t i=0;i<output.size();i++){
+        std::cout<<output[i] - golden[i]<<" ";
+    }
+    std::cout<<std::endl;
+}
+
 int main(){
     custom_gemm_single_test();
     custom_gemm_op_and_add_op_test();
     custom_gemm_op_and_custom_gemm_op_test();
+    custom_cpu_op_and_add_op_test();
     return 1;
 }
\ No newline at end of file
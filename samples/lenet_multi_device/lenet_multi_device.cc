@@ -170,5 +170,30 @@ int main(int argc, char** argv) {
   }
   printTopN(output_data1.data(), output_data1.size(), 5);
 
+  // replicate one graph over all devices, requests go to the least loaded one
+  auto graph2 = lenet(context0);
+  tim::vx::platform::ReplicatedExecutor replicated(devices, context0);
+  if (!replicated.Compile(graph2)) {
+    std::cout << "Replicated compile fail." << std::endl;
+    return -1;
+  }
+  const int request_num = 8;
+  std::vector<std::vector<float>> outputs(request_num,
+                                          std::vector<float>(1 * 10));
+  std::vector<std::future<bool>> requests;
+  for (int i = 0; i < request_num; i++) {
+    requests.push_back(
+        replicated.Submit({input_data.data()}, {outputs[i].data()}));
+  }
+  std::cout << "Queue depth: " << replicated.QueueDepth() << std::endl;
+  for (int i = 0; i < request_num; i++) {
+    if (!requests[i].get()) {
+      std::cout << "Replicated request " << i << " fail." << std::endl;
+      return -1;
+    }
+  }
+  printTopN(outputs[request_num - 1].data(), outputs[request_num - 1].size(),
+            5);
+
   return 0;
 }
@@ -110,7 +110,8 @@ int main(int argc, char** argv) {
 
     nbg_parser_data nbg = NBG_NULL;
 
-    nbg_parser_init(nbg_buf.data(), nbg_size, &nbg);
+    // Only I/O descriptors are needed, nbg_buf outlives the parser.
+    nbg_parser_init_ex(nbg_buf.data(), nbg_size, NBG_PARSER_FLAG_LAZY, &nbg);
 
     // Get Inputs
     int input_count = 0;
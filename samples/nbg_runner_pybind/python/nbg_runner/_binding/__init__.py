@@ -1,4 +1,5 @@
 from ._nbg_runner import (
+    HANDLE_ALIGNMENT,
     OVXExecutor,
     OVXTensorInfo
 )
\ No newline at end of file
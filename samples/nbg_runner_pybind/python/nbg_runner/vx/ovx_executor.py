@@ -1,5 +1,6 @@
-from typing import List, Tuple, Sequence
+from typing import List, Tuple, Sequence, Union
 from numpy.typing import NDArray
+import asyncio
 import numpy as np
 from pathlib import Path
 from nbg_runner import _binding
@@ -15,9 +16,19 @@ class OVXTensorInfo:
     fixed_point_pos: int = ...
 
 
+def _aligned_empty(shape: Tuple[int, ...], dtype: str) -> NDArray:
+    alignment: int = _binding.HANDLE_ALIGNMENT
+    np_dtype = np.dtype(dtype)
+    nbytes = int(np.prod(shape)) * np_dtype.itemsize
+    raw = np.empty(nbytes + alignment, dtype=np.uint8)
+    offset = -raw.ctypes.data % alignment
+    return raw[offset:offset + nbytes].view(np_dtype).reshape(shape)
+
+
 class OVXExecutor:
-    def __init__(self, nbg_path: Path) -> None:
-        self._exec = _binding.OVXExecutor(nbg_path)
+    def __init__(self, nbg: Union[Path, bytes, bytearray, memoryview]) -> None:
+        # In-memory NBG data is borrowed, not copied.
+        self._exec = _binding.OVXExecutor(nbg)
         self._exec.init()
 
     def get_num_inputs(self) -> int:
@@ -66,5 +77,49 @@ class OVXExecutor:
 
         return output_tensors
 
+    def allocate_input(self, index: int) -> NDArray:
+        info = self.get_input_info(index)
+        return _aligned_empty(info.shape, info.dtype)
+
+    def allocate_output(self, index: int) -> NDArray:
+        info = self.get_output_info(index)
+        return _aligned_empty(info.shape, info.dtype)
+
+    def bind_input(self, index: int, input_tensor: NDArray) -> None:
+        """Use input_tensor memory directly as graph input, no copy is made.
+
+        The array must be C-contiguous, match the input shape and dtype size,
+        and be aligned to HANDLE_ALIGNMENT bytes (see allocate_input).
+        """
+        self._exec.bind_input(index, input_tensor)
+
+    def bind_output(self, index: int, output_tensor: NDArray) -> None:
+        """Let the graph write output index directly into output_tensor."""
+        self._exec.bind_output(index, output_tensor)
+
+    def unbind_input(self, index: int) -> None:
+        self._exec.unbind_input(index)
+
+    def unbind_output(self, index: int) -> None:
+        self._exec.unbind_output(index)
+
+    def bind_inputs(self, input_tensors: Sequence[NDArray]) -> None:
+        for i, tensor in enumerate(input_tensors):
+            self.bind_input(i, tensor)
+
+    def bind_outputs(self, output_tensors: Sequence[NDArray]) -> None:
+        for i, tensor in enumerate(output_tensors):
+            self.bind_output(i, tensor)
+
     def run(self) -> None:
+        # The GIL is released while the graph runs.
         self._exec.run()
+
+    async def run_async(self) -> None:
+        """Awaitable run on the default executor of the running loop.
+
+        Runs of the same executor are serialized; use several executors to
+        overlap requests.
+        """
+        loop = asyncio.get_running_loop()
+        await loop.run_in_executor(None, self._exec.run)
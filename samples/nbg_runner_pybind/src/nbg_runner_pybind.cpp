@@ -30,6 +30,7 @@
 #include <array>
 #include <filesystem>
 #include <string_view>
+#include <vector>
 
 #include "vx/ovx_executor.hpp"
 #include "vx/utils.hpp"
@@ -38,27 +39,120 @@ namespace vsi::nbg_runner::python {
 namespace py = pybind11;
 namespace fs = std::filesystem;
 
+/** \brief Executor which keeps bound NumPy arrays alive while the graph
+ * reads from or writes into them. */
+class PyOVXExecutor : public vx::OVXExecutor {
+ public:
+  using OVXExecutor::OVXExecutor;
+
+  ~PyOVXExecutor() {
+    // Detach arrays before they are released together with this object.
+    for (size_t i = 0; i < bound_inputs_.size(); i++) {
+      if (bound_inputs_[i]) {
+        bind_input(i, nullptr, 0);
+      }
+    }
+    for (size_t i = 0; i < bound_outputs_.size(); i++) {
+      if (bound_outputs_[i]) {
+        bind_output(i, nullptr, 0);
+      }
+    }
+  }
+
+  void bind_array(size_t index, const py::array& array, bool is_input) {
+    if (index >= (is_input ? get_num_inputs() : get_num_outputs())) {
+      throw std::out_of_range(is_input ? "Invalid input index."
+                                       : "Invalid output index.");
+    }
+    auto tensor_info = is_input ? get_input_info(index) : get_output_info(index);
+    if (!(array.flags() & py::array::c_style)) {
+      throw std::invalid_argument("Tensor handle must be C-contiguous.");
+    }
+    if (!is_input && !array.writeable()) {
+      throw std::invalid_argument("Output tensor handle must be writeable.");
+    }
+    if (static_cast<size_t>(array.itemsize()) !=
+        vx::get_vx_dtype_bytes(tensor_info.data_type)) {
+      throw std::invalid_argument("Tensor element size mismatch.");
+    }
+    if (static_cast<size_t>(array.ndim()) != tensor_info.rank) {
+      throw std::invalid_argument("Tensor rank mismatch.");
+    }
+    for (size_t i = 0; i < tensor_info.rank; i++) {
+      if (static_cast<size_t>(array.shape(tensor_info.rank - i - 1)) !=
+          tensor_info.shape[i]) {
+        throw std::invalid_argument("Tensor shape mismatch.");
+      }
+    }
+
+    // Inputs are only read by the graph, so read-only arrays are accepted.
+    void* data = const_cast<void*>(array.data());
+    auto nbytes = static_cast<size_t>(array.nbytes());
+    auto& bound = is_input ? bound_inputs_ : bound_outputs_;
+    if (bound.size() <= index) {
+      bound.resize(index + 1);
+    }
+    {
+      py::gil_scoped_release release;
+      if (is_input) {
+        bind_input(index, data, nbytes);
+      } else {
+        bind_output(index, data, nbytes);
+      }
+    }
+    bound[index] = array;
+  }
+
+  void unbind_array(size_t index, bool is_input) {
+    auto& bound = is_input ? bound_inputs_ : bound_outputs_;
+    {
+      py::gil_scoped_release release;
+      if (is_input) {
+        bind_input(index, nullptr, 0);
+      } else {
+        bind_output(index, nullptr, 0);
+      }
+    }
+    if (index < bound.size()) {
+      bound[index] = py::object();
+    }
+  }
+
+ private:
+  std::vector<py::object> bound_inputs_;
+  std::vector<py::object> bound_outputs_;
+};
+
 PYBIND11_MODULE(_nbg_runner, m) {
   using namespace vsi::nbg_runner::vx;
 
+  m.attr("HANDLE_ALIGNMENT") = py::int_(OVXExecutor::kHandleAlignment);
+
   // clang-format off
-  py::class_<OVXExecutor>(m, "OVXExecutor")
-    .def(py::init<const fs::path&>())
+  py::class_<PyOVXExecutor>(m, "OVXExecutor")
+    // Borrow the NBG bytes instead of copying them, the buffer object is kept
+    // alive by the executor.
     .def(py::init([](const py::buffer& nbg_buffer) {
       auto buffer_info = nbg_buffer.request(false);
-      return std::make_unique<OVXExecutor>(reinterpret_cast<char*>(buffer_info.ptr), buffer_info.size);
-    }))
+      return std::make_unique<PyOVXExecutor>(
+        reinterpret_cast<char*>(buffer_info.ptr),
+        static_cast<size_t>(buffer_info.size * buffer_info.itemsize),
+        true);
+    }), py::keep_alive<1, 2>())
+    // Registered after the buffer overload so bytes are not taken as a path.
+    .def(py::init<const fs::path&>())
     .def("init", &OVXExecutor::init)
     .def("get_num_inputs", &OVXExecutor::get_num_inputs)
     .def("get_num_outputs", &OVXExecutor::get_num_outputs)
     .def("get_input_info", &OVXExecutor::get_input_info)
     .def("get_output_info", &OVXExecutor::get_output_info)
-    .def("set_input", [](OVXExecutor* executor, size_t index, const py::buffer& buffer) {
+    .def("set_input", [](PyOVXExecutor* executor, size_t index, const py::buffer& buffer) {
       auto buffer_info = buffer.request(false);
       std::array<size_t, OVXTensorInfo::kMaxRank> vx_shape = {0};
       std::array<size_t, OVXTensorInfo::kMaxRank> vx_strides = {0};
       std::reverse_copy(buffer_info.shape.cbegin(), buffer_info.shape.cend(), vx_shape.begin());
       std::reverse_copy(buffer_info.strides.cbegin(), buffer_info.strides.cend(), vx_strides.begin());
+      py::gil_scoped_release release;
       executor->copy_to_input(
         index,
         buffer_info.ptr,
@@ -67,7 +161,7 @@ PYBIND11_MODULE(_nbg_runner, m) {
         vx_strides.data()
       );
     })
-    .def("get_output", [](OVXExecutor* executor, size_t index) -> py::array {
+    .def("get_output", [](PyOVXExecutor* executor, size_t index) -> py::array {
       auto tensor_info = executor->get_output_info(index);
       auto np_dtype = py::dtype(get_vx_dtype_str(tensor_info.data_type).data());
       auto np_shape = std::vector<ssize_t>(tensor_info.rank);
@@ -79,16 +173,31 @@ PYBIND11_MODULE(_nbg_runner, m) {
       std::array<size_t, OVXTensorInfo::kMaxRank> vx_strides = {0};
       std::reverse_copy(buffer_info.strides.cbegin(), buffer_info.strides.cend(), vx_strides.begin());
 
-      executor->copy_from_output(
-        index,
-        buffer_info.ptr,
-        tensor_info.rank,
-        tensor_info.shape.data(),
-        vx_strides.data()
-      );
+      {
+        py::gil_scoped_release release;
+        executor->copy_from_output(
+          index,
+          buffer_info.ptr,
+          tensor_info.rank,
+          tensor_info.shape.data(),
+          vx_strides.data()
+        );
+      }
       return np_tensor;
     })
-    .def("run", &OVXExecutor::run)
+    .def("bind_input", [](PyOVXExecutor* executor, size_t index, const py::array& array) {
+      executor->bind_array(index, array, true);
+    }, py::arg("index"), py::arg("array").noconvert())
+    .def("bind_output", [](PyOVXExecutor* executor, size_t index, const py::array& array) {
+      executor->bind_array(index, array, false);
+    }, py::arg("index"), py::arg("array").noconvert())
+    .def("unbind_input", [](PyOVXExecutor* executor, size_t index) {
+      executor->unbind_array(index, true);
+    })
+    .def("unbind_output", [](PyOVXExecutor* executor, size_t index) {
+      executor->unbind_array(index, false);
+    })
+    .def("run", &OVXExecutor::run, py::call_guard<py::gil_scoped_release>())
   ;
 
   py::class_<OVXTensorInfo>(m, "OVXTensorInfo")
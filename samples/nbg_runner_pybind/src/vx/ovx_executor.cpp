@@ -28,15 +28,22 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <stdexcept>
 
 #include "utils.hpp"
 
 namespace vsi::nbg_runner::vx {
 
-OVXExecutor::OVXExecutor(const char* nbg_data, size_t nbg_size) {
-  nbg_buffer_ = std::vector<char>(nbg_data, nbg_data + nbg_size);
+OVXExecutor::OVXExecutor(const char* nbg_data, size_t nbg_size, bool borrow) {
+  if (borrow) {
+    nbg_data_ = nbg_data;
+  } else {
+    nbg_buffer_ = std::vector<char>(nbg_data, nbg_data + nbg_size);
+    nbg_data_ = nbg_buffer_.data();
+  }
 }
 
 OVXExecutor::OVXExecutor(const fs::path& nbg_path) {
@@ -45,13 +52,17 @@ OVXExecutor::OVXExecutor(const fs::path& nbg_path) {
 
   nbg_buffer_.resize(nbg_size);
   nbg_file.read(nbg_buffer_.data(), static_cast<std::streamsize>(nbg_size));
+  nbg_data_ = nbg_buffer_.data();
 }
 
 OVXExecutor::~OVXExecutor() {
+  // Hand caller-owned handles back before the tensors go away.
   for (auto& tensor : input_tensors_) {
+    vxSwapTensorHandle(tensor, nullptr, nullptr);
     vxReleaseTensor(&tensor);
   }
   for (auto& tensor : output_tensors_) {
+    vxSwapTensorHandle(tensor, nullptr, nullptr);
     vxReleaseTensor(&tensor);
   }
 
@@ -76,7 +87,8 @@ int OVXExecutor::init() {
   }
 
   nbg_kernel_ = vxImportKernelFromURL(
-      context_, VX_VIVANTE_IMPORT_KERNEL_FROM_POINTER, nbg_buffer_.data());
+      context_, VX_VIVANTE_IMPORT_KERNEL_FROM_POINTER,
+      const_cast<char*>(nbg_data_));
   status = vxGetStatus(reinterpret_cast<vx_reference>(nbg_kernel_));
   if (status != VX_SUCCESS) {
     throw std::runtime_error("Failed to import NBG kernel.");
@@ -95,23 +107,12 @@ int OVXExecutor::init() {
     throw std::runtime_error("Failed to create NBG node.");
   }
 
-  // Create input tensors and bind to NBG node.
+  // Create handle-backed input tensors and bind to NBG node, so caller
+  // memory can be swapped in later without copies.
+  input_buffers_.resize(num_inputs);
   for (size_t i = 0; i < num_inputs; i++) {
-    const auto& tensor_info = input_tensors_infos_[i];
-    std::array<uint32_t, OVXTensorInfo::kMaxRank> shape;
-    std::transform(tensor_info.shape.cbegin(), tensor_info.shape.cend(),
-                   shape.begin(),
-                   [](size_t s) { return static_cast<uint32_t>(s); });
-
-    vx_tensor_create_params_t tensor_create_params = {
-        .num_of_dims = static_cast<uint32_t>(tensor_info.rank),
-        .sizes = shape.data(),
-        .data_format = tensor_info.data_type,
-        .quant_format = tensor_info.quant_type,
-        .quant_data = tensor_info.quant_param,
-    };
-    vx_tensor input_tensor = vxCreateTensor2(context_, &tensor_create_params,
-                                             sizeof(tensor_create_params));
+    vx_tensor input_tensor =
+        create_handle_tensor(input_tensors_infos_[i], input_buffers_[i]);
     if (input_tensor == nullptr) {
       throw std::runtime_error("Failed to create input vx tensor.");
     }
@@ -119,25 +120,14 @@ int OVXExecutor::init() {
     vxSetParameterByIndex(nbg_node_, i,
                           reinterpret_cast<vx_reference>(input_tensor));
     input_tensors_.push_back(input_tensor);
+    input_handles_.push_back(input_buffers_[i].get());
   }
 
-  // Create output tensors and bind to NBG node.
+  // Create handle-backed output tensors and bind to NBG node.
+  output_buffers_.resize(num_outputs);
   for (size_t i = 0; i < num_outputs; i++) {
-    const auto& tensor_info = output_tensors_infos_[i];
-    std::array<uint32_t, OVXTensorInfo::kMaxRank> shape;
-    std::transform(tensor_info.shape.cbegin(), tensor_info.shape.cend(),
-                   shape.begin(),
-                   [](size_t s) { return static_cast<uint32_t>(s); });
-
-    vx_tensor_create_params_t tensor_create_params = {
-        .num_of_dims = static_cast<uint32_t>(tensor_info.rank),
-        .sizes = shape.data(),
-        .data_format = tensor_info.data_type,
-        .quant_format = tensor_info.quant_type,
-        .quant_data = tensor_info.quant_param,
-    };
-    vx_tensor output_tensor = vxCreateTensor2(context_, &tensor_create_params,
-                                              sizeof(tensor_create_params));
+    vx_tensor output_tensor =
+        create_handle_tensor(output_tensors_infos_[i], output_buffers_[i]);
     if (output_tensor == nullptr) {
       throw std::runtime_error("Failed to create output vx tensor.");
     }
@@ -145,6 +135,7 @@ int OVXExecutor::init() {
     vxSetParameterByIndex(nbg_node_, num_inputs + i,
                           reinterpret_cast<vx_reference>(output_tensor));
     output_tensors_.push_back(output_tensor);
+    output_handles_.push_back(output_buffers_[i].get());
   }
 
   status = vxVerifyGraph(graph_);
@@ -155,6 +146,68 @@ int OVXExecutor::init() {
   return static_cast<int>(status);
 }
 
+static size_t get_tensor_bytes(const OVXTensorInfo& tensor_info) {
+  size_t nbytes = get_vx_dtype_bytes(tensor_info.data_type);
+  for (size_t i = 0; i < tensor_info.rank; i++) {
+    nbytes *= tensor_info.shape[i];
+  }
+  return nbytes;
+}
+
+vx_tensor OVXExecutor::create_handle_tensor(const OVXTensorInfo& tensor_info,
+                                            AlignedBuffer& buffer) {
+  size_t nbytes = get_tensor_bytes(tensor_info);
+  size_t alloc_bytes =
+      (nbytes + kHandleAlignment - 1) / kHandleAlignment * kHandleAlignment;
+  buffer.reset(std::aligned_alloc(kHandleAlignment, alloc_bytes));
+  if (!buffer) {
+    return nullptr;
+  }
+
+  std::array<uint32_t, OVXTensorInfo::kMaxRank> shape;
+  std::transform(tensor_info.shape.cbegin(), tensor_info.shape.cend(),
+                 shape.begin(),
+                 [](size_t s) { return static_cast<uint32_t>(s); });
+
+  vx_tensor_create_params_t tensor_create_params = {
+      .num_of_dims = static_cast<uint32_t>(tensor_info.rank),
+      .sizes = shape.data(),
+      .data_format = tensor_info.data_type,
+      .quant_format = tensor_info.quant_type,
+      .quant_data = tensor_info.quant_param,
+  };
+
+  // Dense strides in bytes, innermost dimension first.
+#if VX_VA40_EXT_SUPPORT
+  using addr_t = vx_size;
+  using addr_rank_t = vx_size;
+#else
+  using addr_t = vx_uint32;
+  using addr_rank_t = vx_uint8;
+#endif
+  std::array<addr_t, OVXTensorInfo::kMaxRank> addr_shape = {0};
+  std::array<addr_t, OVXTensorInfo::kMaxRank> addr_strides = {0};
+  addr_t stride = static_cast<addr_t>(get_vx_dtype_bytes(tensor_info.data_type));
+  for (size_t i = 0; i < tensor_info.rank; i++) {
+    addr_shape[i] = static_cast<addr_t>(tensor_info.shape[i]);
+    addr_strides[i] = stride;
+    stride *= addr_shape[i];
+  }
+
+  vx_tensor_addressing addr = vxCreateTensorAddressing(
+      context_, addr_shape.data(), addr_strides.data(),
+      static_cast<addr_rank_t>(tensor_info.rank));
+  if (addr == nullptr) {
+    return nullptr;
+  }
+
+  vx_tensor tensor = vxCreateTensorFromHandle2(
+      context_, &tensor_create_params, sizeof(tensor_create_params), addr,
+      buffer.get(), VX_MEMORY_TYPE_HOST);
+  vxReleaseTensorAddressing(&addr);
+  return tensor;
+}
+
 int OVXExecutor::query_nbg_io_infos() {
   uint32_t num_params;
   vxQueryKernel(nbg_kernel_, VX_KERNEL_PARAMETERS, &num_params,
@@ -223,6 +276,7 @@ int OVXExecutor::copy_to_input(size_t index, void* data, size_t rank,
     return VX_FAILURE;
   }
 
+  std::lock_guard<std::mutex> lock(run_mutex_);
   vx_tensor input_tensor = input_tensors_[index];
   auto tensor_info = input_tensors_infos_[index];
 
@@ -263,6 +317,7 @@ int OVXExecutor::copy_from_output(size_t index, void* data, size_t rank,
     return VX_FAILURE;
   }
 
+  std::lock_guard<std::mutex> lock(run_mutex_);
   vx_tensor output_tensor = output_tensors_[index];
 
   std::array<size_t, OVXTensorInfo::kMaxRank> view_start = {0};
@@ -277,14 +332,82 @@ int OVXExecutor::copy_from_output(size_t index, void* data, size_t rank,
   return VX_SUCCESS;
 }
 
+size_t OVXExecutor::get_input_bytes(size_t index) const {
+  return get_tensor_bytes(input_tensors_infos_.at(index));
+}
+
+size_t OVXExecutor::get_output_bytes(size_t index) const {
+  return get_tensor_bytes(output_tensors_infos_.at(index));
+}
+
+int OVXExecutor::bind_handle(vx_tensor tensor, const OVXTensorInfo& tensor_info,
+                             const AlignedBuffer& own_buffer, void* data,
+                             size_t nbytes, void*& bound) {
+  if (data == nullptr) {
+    data = own_buffer.get();
+  } else {
+    if (nbytes != get_tensor_bytes(tensor_info)) {
+      throw std::invalid_argument("Tensor handle size mismatch.");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % kHandleAlignment != 0) {
+      throw std::invalid_argument("Tensor handle is not aligned.");
+    }
+  }
+
+  if (data == bound) {
+    return VX_SUCCESS;
+  }
+
+  vx_status status = vxSwapTensorHandle(tensor, data, nullptr);
+  if (status != VX_SUCCESS) {
+    throw std::runtime_error("Failed to swap tensor handle.");
+  }
+  bound = data;
+
+  return VX_SUCCESS;
+}
+
+int OVXExecutor::bind_input(size_t index, void* data, size_t nbytes) {
+  if (index >= input_tensors_infos_.size()) {
+    throw std::out_of_range("Invalid input index.");
+  }
+
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  return bind_handle(input_tensors_[index], input_tensors_infos_[index],
+                     input_buffers_[index], data, nbytes,
+                     input_handles_[index]);
+}
+
+int OVXExecutor::bind_output(size_t index, void* data, size_t nbytes) {
+  if (index >= output_tensors_infos_.size()) {
+    throw std::out_of_range("Invalid output index.");
+  }
+
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  return bind_handle(output_tensors_[index], output_tensors_infos_[index],
+                     output_buffers_[index], data, nbytes,
+                     output_handles_[index]);
+}
+
 int OVXExecutor::run() {
   vx_status status;
+  std::lock_guard<std::mutex> lock(run_mutex_);
+
+  // Inputs written by the host through their handles.
+  for (auto& tensor : input_tensors_) {
+    vxFlushHandle(reinterpret_cast<vx_reference>(tensor));
+  }
 
   status = vxProcessGraph(graph_);
   if (status != VX_SUCCESS) {
     throw std::runtime_error("Failed to run OpenVX graph.");
   }
 
+  // Re-swapping the same handle hands up-to-date output data back to host.
+  for (size_t i = 0; i < output_tensors_.size(); i++) {
+    vxSwapTensorHandle(output_tensors_[i], output_handles_[i], nullptr);
+  }
+
   return static_cast<int>(status);
 }
 
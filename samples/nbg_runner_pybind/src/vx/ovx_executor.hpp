@@ -31,7 +31,10 @@
 #include <VX/vx_types.h>
 
 #include <array>
+#include <cstdlib>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 
@@ -51,7 +54,13 @@ struct OVXTensorInfo {
 
 class OVXExecutor {
  public:
-  explicit OVXExecutor(const char* nbg_data, size_t nbg_size);
+  /** \brief Byte alignment required for I/O tensor handles. */
+  static constexpr size_t kHandleAlignment = 64;
+
+  /** \brief Load NBG from memory. If `borrow` is set the caller keeps
+   * `nbg_data` alive for the executor lifetime and no copy is made. */
+  explicit OVXExecutor(const char* nbg_data, size_t nbg_size,
+                       bool borrow = false);
   explicit OVXExecutor(const fs::path& nbg_path);
 
   ~OVXExecutor();
@@ -79,10 +88,33 @@ class OVXExecutor {
   int copy_from_output(size_t index, void* data, size_t rank, const size_t* shape,
                 const size_t* strides);
 
+  /** \brief Bind caller-owned memory as I/O tensor handle (zero copy).
+   * `data` must be dense, `kHandleAlignment` aligned and hold exactly the
+   * tensor bytes. It must stay valid until it is unbound. Passing nullptr
+   * restores the executor-owned buffer. */
+  int bind_input(size_t index, void* data, size_t nbytes);
+  int bind_output(size_t index, void* data, size_t nbytes);
+
+  /** \brief Byte size of I/O tensor data. */
+  [[nodiscard]] size_t get_input_bytes(size_t index) const;
+  [[nodiscard]] size_t get_output_bytes(size_t index) const;
+
+  /** \brief Run graph. Safe to call from several threads, runs of the same
+   * executor are serialized. */
   int run();
 
  private:
+  struct AlignedDeleter {
+    void operator()(void* ptr) const { std::free(ptr); }
+  };
+  using AlignedBuffer = std::unique_ptr<void, AlignedDeleter>;
+
   int query_nbg_io_infos();
+  vx_tensor create_handle_tensor(const OVXTensorInfo& tensor_info,
+                                 AlignedBuffer& buffer);
+  int bind_handle(vx_tensor tensor, const OVXTensorInfo& tensor_info,
+                  const AlignedBuffer& own_buffer, void* data, size_t nbytes,
+                  void*& bound);
 
   /** \brief The OpenVX context for management of all OpenVX objects. */
   vx_context context_;
@@ -101,8 +133,19 @@ class OVXExecutor {
   /** \brief The OpenVX output tensors. */
   std::vector<vx_tensor> output_tensors_;
 
-  /** \brief The NBG buffer. */
+  /** \brief Executor-owned I/O tensor handles. */
+  std::vector<AlignedBuffer> input_buffers_;
+  std::vector<AlignedBuffer> output_buffers_;
+  /** \brief Currently bound I/O tensor handles. */
+  std::vector<void*> input_handles_;
+  std::vector<void*> output_handles_;
+  /** \brief Serializes graph execution and handle swapping. */
+  std::mutex run_mutex_;
+
+  /** \brief The NBG buffer, empty if NBG data is borrowed. */
   std::vector<char> nbg_buffer_;
+  /** \brief The NBG data used for import. */
+  const char* nbg_data_ = nullptr;
 };
 
 }  // namespace vsi::nbg_runner::vx
@@ -0,0 +1,516 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "op_impl.h"
+#include "quantization/vsi_nn_perchannel_symmetric_affine.h"
+
+namespace tim {
+namespace transform {
+namespace calibration_impl {
+
+using TensorMap =
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>;
+
+// Keep a non-zero scale for tensors which are constant zero
+constexpr float kMinRange = 1e-5f;
+
+struct TensorRange {
+  float min = std::numeric_limits<float>::max();
+  float max = std::numeric_limits<float>::lowest();
+  std::vector<uint64_t> histogram;
+  uint64_t count = 0;
+};
+
+using RangeMap = std::map<std::shared_ptr<vx::Tensor>, TensorRange>;
+
+bool IsFloat(const std::shared_ptr<vx::Tensor>& tensor) {
+  return !tensor->IsPlaceHolder() &&
+         tensor->GetDataType() == vx::DataType::FLOAT32;
+}
+
+std::vector<float> ReadFloat(const std::shared_ptr<vx::Tensor>& tensor) {
+  std::vector<float> data(tensor->GetSpec().GetElementNum());
+  tensor->CopyDataFromTensor(data.data());
+  return data;
+}
+
+// Ops whose input 1 is a weight and input 2 an optional bias accumulated in
+// int32 with scale = input_scale * weight_scale.
+bool HasWeight(const std::shared_ptr<vx::Operation>& op) {
+  switch (op->impl()->kind_) {
+    case VSI_NN_OP_CONV1D:
+    case VSI_NN_OP_CONV2D:
+    case VSI_NN_OP_GROUPED_CONV2D:
+    case VSI_NN_OP_FCL2:
+    case VSI_NN_OP_DECONVOLUTION:
+    case VSI_NN_OP_DECONVOLUTION1D:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Deconvolution weights are not laid out with the output channel outermost
+bool SupportPerChannel(const std::shared_ptr<vx::Operation>& op) {
+  return op->impl()->kind_ != VSI_NN_OP_DECONVOLUTION &&
+         op->impl()->kind_ != VSI_NN_OP_DECONVOLUTION1D;
+}
+
+// Output channel of a weight is the outermost dimension matching bias length,
+// depthwise conv2d keeps it in dimension 2.
+int32_t WeightChannelDim(const vx::ShapeType& shape, int64_t bias_length) {
+  for (int32_t d = (int32_t)shape.size() - 1; d >= 0; d--) {
+    if (bias_length < 0 || (int64_t)shape[d] == bias_length) {
+      return d;
+    }
+  }
+  return (int32_t)shape.size() - 1;
+}
+
+void SplitByChannel(const vx::ShapeType& shape, int32_t channel_dim,
+                    size_t& inner, size_t& channels) {
+  inner = 1;
+  channels = 1;
+  if (channel_dim < 0) return;
+  for (int32_t d = 0; d < channel_dim; d++) {
+    inner *= shape[d];
+  }
+  channels = shape[channel_dim];
+}
+
+void UpdateMinMax(const std::vector<float>& data, TensorRange& range) {
+  for (float v : data) {
+    range.min = std::min(range.min, v);
+    range.max = std::max(range.max, v);
+  }
+}
+
+// Histogram bins span the min/max collected by the first pass
+void UpdateHistogram(const std::vector<float>& data, uint32_t bins,
+                     TensorRange& range) {
+  if (range.histogram.empty()) {
+    range.histogram.resize(bins, 0);
+  }
+  float width = (range.max - range.min) / bins;
+  for (float v : data) {
+    size_t idx = width > 0 ? (size_t)((v - range.min) / width) : 0;
+    range.histogram[std::min(idx, (size_t)bins - 1)]++;
+  }
+  range.count += data.size();
+}
+
+// Drop (100 - percentile)% of the values, half from each tail
+std::pair<float, float> ClipRange(const TensorRange& range, float percentile) {
+  if (range.histogram.empty() || 0 == range.count) {
+    return std::make_pair(range.min, range.max);
+  }
+  size_t bins = range.histogram.size();
+  float width = (range.max - range.min) / bins;
+  double tail = range.count * (1.0 - percentile / 100.0) / 2.0;
+  uint64_t acc = 0;
+  size_t lo = 0;
+  while (lo < bins && acc + range.histogram[lo] <= tail) {
+    acc += range.histogram[lo++];
+  }
+  acc = 0;
+  size_t hi = bins;
+  while (hi > lo + 1 && acc + range.histogram[hi - 1] <= tail) {
+    acc += range.histogram[--hi];
+  }
+  return std::make_pair(range.min + lo * width, range.min + hi * width);
+}
+
+// Clone src_graph with every float tensor exposed as graph output, so that
+// intermediate values can be read back after each run.
+std::shared_ptr<vx::Graph> BuildProbeGraph(
+    const std::shared_ptr<vx::Graph>& src_graph,
+    std::shared_ptr<vx::Context>& ctx, TensorMap& probe_map) {
+  auto probe_graph = ctx->CreateGraph();
+  auto map_tensor = [&](const std::shared_ptr<vx::Tensor>& t_src) {
+    auto it = probe_map.find(t_src);
+    if (it != probe_map.end()) {
+      return it->second;
+    }
+    std::shared_ptr<vx::Tensor> t_probe;
+    if (t_src->IsPlaceHolder()) {
+      t_probe = probe_graph->CreateTensorPlaceHolder();
+    } else if (t_src->IsConstTensor()) {
+      std::vector<uint8_t> data(t_src->GetSpec().GetByteSize());
+      t_src->CopyDataFromTensor(data.data());
+      t_probe = probe_graph->CreateTensor(t_src->GetSpec(), data.data());
+    } else {
+      vx::TensorSpec spec(t_src->GetSpec());
+      if (IsFloat(t_src) && !(spec.attr_ & vx::TensorAttribute::INPUT)) {
+        spec.SetAttribute(vx::TensorAttribute::OUTPUT);
+      }
+      t_probe = probe_graph->CreateTensor(spec);
+    }
+    if (t_src->IsScalar()) {
+      t_probe->SetScalar(1);
+    }
+    probe_map[t_src] = t_probe;
+    return t_probe;
+  };
+
+  // Keep the order of graph inputs
+  for (const auto& t_src : src_graph->InputsTensor()) map_tensor(t_src);
+  for (const auto& op : src_graph->OpVector()) {
+    // Composed operations are cloned through their builtin operations
+    if (op->impl()->kind_ == -1) continue;
+    auto probe_op = op->Clone(probe_graph);
+    for (const auto& t_src : op->impl()->InputsTensor()) {
+      probe_op->BindInput(map_tensor(t_src));
+    }
+    for (const auto& t_src : op->impl()->OutputsTensor()) {
+      probe_op->BindOutput(map_tensor(t_src));
+    }
+  }
+  return probe_graph;
+}
+
+bool CollectRanges(const std::shared_ptr<vx::Graph>& src_graph,
+                   std::shared_ptr<vx::Context>& ctx,
+                   const std::vector<CalibrationSample>& samples,
+                   const CalibrationOption& option, RangeMap& ranges) {
+  TensorMap probe_map;
+  auto probe_graph = BuildProbeGraph(src_graph, ctx, probe_map);
+  if (!probe_graph->Compile()) {
+    VSILOGE("Calibration: compile float graph fail.");
+    return false;
+  }
+
+  auto inputs = probe_graph->InputsTensor();
+  int passes = CalibrationMethod::PERCENTILE == option.method ? 2 : 1;
+  for (int pass = 0; pass < passes; pass++) {
+    for (const auto& sample : samples) {
+      if (sample.size() != inputs.size()) {
+        VSILOGE("Calibration: sample has %d inputs, graph has %d.",
+                (int)sample.size(), (int)inputs.size());
+        return false;
+      }
+      for (size_t i = 0; i < inputs.size(); i++) {
+        if (inputs[i]->GetDataType() != vx::DataType::FLOAT32 ||
+            (int64_t)sample[i].size() != inputs[i]->GetSpec().GetElementNum()) {
+          VSILOGE("Calibration: input %d mismatch float data.", (int)i);
+          return false;
+        }
+        inputs[i]->CopyDataToTensor(sample[i].data(),
+                                    sample[i].size() * sizeof(float));
+      }
+      if (!probe_graph->Run()) {
+        VSILOGE("Calibration: run float graph fail.");
+        return false;
+      }
+      for (const auto& it : probe_map) {
+        if (!IsFloat(it.first) || it.first->IsConstTensor()) continue;
+        auto data = ReadFloat(it.second);
+        if (0 == pass) {
+          UpdateMinMax(data, ranges[it.first]);
+        } else {
+          UpdateHistogram(data, option.histogram_bins, ranges[it.first]);
+        }
+      }
+    }
+  }
+
+  for (const auto& it : probe_map) {
+    if (IsFloat(it.first) && it.first->IsConstTensor()) {
+      UpdateMinMax(ReadFloat(it.first), ranges[it.first]);
+    }
+  }
+  return true;
+}
+
+vx::Quantization AsymmetricQuant(float min, float max, vx::DataType type) {
+  // Zero must be exactly representable
+  min = std::min(min, 0.0f);
+  max = std::max(max, 0.0f);
+  if (max - min < kMinRange) {
+    max = min + kMinRange;
+  }
+  float scale = 0;
+  int32_t zero_point = 0;
+  vsi_nn_QuantAffineCalParam(VSI_NN_TYPE_UINT8, max, min, &scale,
+                             &zero_point);
+  if (vx::DataType::INT8 == type) {
+    zero_point -= 128;
+  }
+  return vx::Quantization(vx::QuantType::ASYMMETRIC, scale, zero_point);
+}
+
+vx::Quantization PerChannelQuant(const std::vector<float>& data,
+                                 const vx::ShapeType& shape,
+                                 int32_t channel_dim) {
+  size_t inner, channels;
+  SplitByChannel(shape, channel_dim, inner, channels);
+  std::vector<float> abs_max(channels, 0);
+  for (size_t i = 0; i < data.size(); i++) {
+    size_t c = (i / inner) % channels;
+    abs_max[c] = std::max(abs_max[c], std::fabs(data[i]));
+  }
+  std::vector<float> scales(channels);
+  for (size_t c = 0; c < channels; c++) {
+    // Symmetric over [-128, 127] so that abs_max maps to 127
+    float m = std::max(abs_max[c], kMinRange);
+    vsi_nn_QuantAffinePerchannelCalParam(VSI_NN_TYPE_INT8, m, -m * 128 / 127,
+                                         &scales[c]);
+  }
+  return vx::Quantization(vx::QuantType::SYMMETRIC_PER_CHANNEL, channel_dim,
+                          scales, std::vector<int32_t>(channels, 0));
+}
+
+template <typename T>
+std::vector<uint8_t> QuantizeData(const std::vector<float>& data,
+                                  const vx::ShapeType& shape,
+                                  const vx::Quantization& quant) {
+  std::vector<uint8_t> bytes(data.size() * sizeof(T));
+  T* dst = reinterpret_cast<T*>(bytes.data());
+  size_t inner, channels;
+  SplitByChannel(shape, quant.Scales().size() > 1 ? quant.ChannelDim() : -1,
+                 inner, channels);
+  const double lo = (double)std::numeric_limits<T>::lowest();
+  const double hi = (double)std::numeric_limits<T>::max();
+  for (size_t i = 0; i < data.size(); i++) {
+    size_t c = (i / inner) % channels;
+    double q = std::round((double)data[i] / quant.Scales()[c]) +
+               quant.ZeroPoints()[c];
+    dst[i] = (T)std::min(hi, std::max(lo, q));
+  }
+  return bytes;
+}
+
+class QuantizedGraphBuilder {
+ public:
+  QuantizedGraphBuilder(std::shared_ptr<vx::Graph> graph,
+                        const RangeMap& ranges,
+                        const CalibrationOption& option)
+      : graph_(std::move(graph)), ranges_(ranges), option_(option) {}
+
+  std::shared_ptr<vx::Tensor> Map(const std::shared_ptr<vx::Tensor>& t_src) {
+    auto it = tensor_map_.find(t_src);
+    if (it != tensor_map_.end()) {
+      return it->second;
+    }
+    if (t_src->IsPlaceHolder()) {
+      return Record(t_src, graph_->CreateTensorPlaceHolder());
+    }
+    auto range_it = ranges_.find(t_src);
+    if (!IsFloat(t_src) || range_it == ranges_.end()) {
+      return Create(t_src, t_src->GetSpec(), Read(t_src));
+    }
+    const auto& range = range_it->second;
+    auto clipped = std::make_pair(range.min, range.max);
+    if (CalibrationMethod::PERCENTILE == option_.method &&
+        !t_src->IsConstTensor()) {
+      clipped = ClipRange(range, option_.percentile);
+    }
+    auto quant =
+        AsymmetricQuant(clipped.first, clipped.second, option_.activation_type);
+    return CreateQuantized(t_src, option_.activation_type, quant);
+  }
+
+  std::shared_ptr<vx::Tensor> MapWeight(
+      const std::shared_ptr<vx::Operation>& op,
+      const std::shared_ptr<vx::Tensor>& t_src, int64_t bias_length) {
+    auto it = tensor_map_.find(t_src);
+    if (it != tensor_map_.end()) {
+      return it->second;
+    }
+    if (!option_.per_channel_weights || !SupportPerChannel(op)) {
+      return Map(t_src);
+    }
+    auto shape = t_src->GetShape();
+    auto quant = PerChannelQuant(ReadFloat(t_src), shape,
+                                 WeightChannelDim(shape, bias_length));
+    return CreateQuantized(t_src, vx::DataType::INT8, quant);
+  }
+
+  // Bias scale follows the quantized input and weight
+  std::shared_ptr<vx::Tensor> MapBias(
+      const std::shared_ptr<vx::Tensor>& t_src,
+      const std::shared_ptr<vx::Tensor>& input,
+      const std::shared_ptr<vx::Tensor>& weight) {
+    auto it = tensor_map_.find(t_src);
+    if (it != tensor_map_.end()) {
+      return it->second;
+    }
+    const auto& input_quant = input->GetQuantization();
+    const auto& weight_quant = weight->GetQuantization();
+    if (input_quant.Type() != vx::QuantType::ASYMMETRIC ||
+        weight_quant.Type() == vx::QuantType::NONE) {
+      return Map(t_src);
+    }
+    float input_scale = input_quant.Scales()[0];
+    vx::Quantization quant;
+    if (weight_quant.Type() == vx::QuantType::SYMMETRIC_PER_CHANNEL) {
+      std::vector<float> scales;
+      for (float s : weight_quant.Scales()) {
+        scales.push_back(input_scale * s);
+      }
+      quant = vx::Quantization(vx::QuantType::SYMMETRIC_PER_CHANNEL, 0, scales,
+                               std::vector<int32_t>(scales.size(), 0));
+    } else {
+      quant = vx::Quantization(vx::QuantType::ASYMMETRIC,
+                               input_scale * weight_quant.Scales()[0], 0);
+    }
+    return CreateQuantized(t_src, vx::DataType::INT32, quant);
+  }
+
+  const TensorMap& tensor_map() const { return tensor_map_; }
+
+ private:
+  std::vector<uint8_t> Read(const std::shared_ptr<vx::Tensor>& t_src) {
+    if (!t_src->IsConstTensor()) return {};
+    std::vector<uint8_t> data(t_src->GetSpec().GetByteSize());
+    t_src->CopyDataFromTensor(data.data());
+    return data;
+  }
+
+  std::shared_ptr<vx::Tensor> CreateQuantized(
+      const std::shared_ptr<vx::Tensor>& t_src, vx::DataType type,
+      const vx::Quantization& quant) {
+    vx::TensorSpec spec(t_src->GetSpec());
+    spec.SetDataType(type);
+    spec.quantization_ = quant;
+    std::vector<uint8_t> data;
+    if (t_src->IsConstTensor()) {
+      auto values = ReadFloat(t_src);
+      switch (type) {
+        case vx::DataType::INT8:
+          data = QuantizeData<int8_t>(values, spec.shape_, quant);
+          break;
+        case vx::DataType::INT32:
+          data = QuantizeData<int32_t>(values, spec.shape_, quant);
+          break;
+        default:
+          data = QuantizeData<uint8_t>(values, spec.shape_, quant);
+          break;
+      }
+    }
+    return Create(t_src, spec, data);
+  }
+
+  std::shared_ptr<vx::Tensor> Create(const std::shared_ptr<vx::Tensor>& t_src,
+                                     const vx::TensorSpec& spec,
+                                     const std::vector<uint8_t>& data) {
+    auto t_dst = data.empty() ? graph_->CreateTensor(spec)
+                              : graph_->CreateTensor(spec, data.data());
+    if (t_src->IsScalar()) {
+      t_dst->SetScalar(1);
+    }
+    return Record(t_src, t_dst);
+  }
+
+  std::shared_ptr<vx::Tensor> Record(const std::shared_ptr<vx::Tensor>& t_src,
+                                     std::shared_ptr<vx::Tensor> t_dst) {
+    tensor_map_[t_src] = t_dst;
+    return t_dst;
+  }
+
+  std::shared_ptr<vx::Graph> graph_;
+  const RangeMap& ranges_;
+  const CalibrationOption& option_;
+  TensorMap tensor_map_;
+};
+
+}  // namespace calibration_impl
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+Calibrate(const std::shared_ptr<vx::Graph>& src_graph,
+          std::shared_ptr<vx::Context>& ctx,
+          const std::vector<CalibrationSample>& samples,
+          const CalibrationOption& option) {
+  using namespace calibration_impl;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      graph_io_map;
+  if (option.activation_type != vx::DataType::UINT8 &&
+      option.activation_type != vx::DataType::INT8) {
+    VSILOGE("Calibration: activation type must be UINT8 or INT8.");
+    return std::make_pair(nullptr, graph_io_map);
+  }
+  if (samples.empty()) {
+    VSILOGE("Calibration: empty calibration set.");
+    return std::make_pair(nullptr, graph_io_map);
+  }
+
+  RangeMap ranges;
+  if (!CollectRanges(src_graph, ctx, samples, option, ranges)) {
+    return std::make_pair(nullptr, graph_io_map);
+  }
+
+  std::shared_ptr<vx::Graph> quant_graph = ctx->CreateGraph();
+  QuantizedGraphBuilder builder(quant_graph, ranges, option);
+  // Keep the order of graph inputs and outputs
+  for (const auto& t_src : src_graph->InputsTensor()) {
+    graph_io_map[t_src] = builder.Map(t_src);
+  }
+  for (const auto& t_src : src_graph->OutputsTensor()) {
+    graph_io_map[t_src] = builder.Map(t_src);
+  }
+
+  for (const auto& op : src_graph->OpVector()) {
+    if (op->impl()->kind_ == -1) continue;
+    auto src_inputs = op->impl()->InputsTensor();
+    std::vector<std::shared_ptr<vx::Tensor>> inputs;
+    for (size_t i = 0; i < src_inputs.size(); i++) {
+      const auto& t_src = src_inputs[i];
+      bool is_param = HasWeight(op) && IsFloat(t_src) &&
+                      t_src->IsConstTensor();
+      if (is_param && 1 == i) {
+        int64_t bias_length = -1;
+        if (src_inputs.size() > 2 && !src_inputs[2]->IsPlaceHolder()) {
+          bias_length = src_inputs[2]->GetSpec().GetElementNum();
+        }
+        inputs.push_back(builder.MapWeight(op, t_src, bias_length));
+      } else if (is_param && 2 == i) {
+        inputs.push_back(builder.MapBias(t_src, inputs[0], inputs[1]));
+      } else {
+        inputs.push_back(builder.Map(t_src));
+      }
+    }
+    std::vector<std::shared_ptr<vx::Tensor>> outputs;
+    for (const auto& t_src : op->impl()->OutputsTensor()) {
+      outputs.push_back(builder.Map(t_src));
+    }
+    auto quant_op = op->Clone(quant_graph);
+    quant_op->BindInputs(inputs);
+    quant_op->BindOutputs(outputs);
+  }
+  VSILOGD("Calibration quantized %d tensors over %d samples.",
+          (int)ranges.size(), (int)samples.size());
+
+  return std::make_pair(quant_graph, graph_io_map);
+}
+
+}  // namespace transform
+}  // namespace tim
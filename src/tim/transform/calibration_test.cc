@@ -0,0 +1,100 @@
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/calibration.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+TEST(Calibration, min_max_fully_connected) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 2},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {2, 3},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {3},
+                                tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> weight_data = {-3, 3, 2, 1, 0, 4};
+  std::vector<float> bias_data = {0.1, 0.4, 0.6};
+  auto input = src_graph->CreateTensor(input_spec);
+  auto weight = src_graph->CreateTensor(weight_spec, weight_data.data());
+  auto bias = src_graph->CreateTensor(bias_spec, bias_data.data());
+  auto output = src_graph->CreateTensor(output_spec);
+  auto fc = src_graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 3);
+  (*fc).BindInputs({input, weight, bias}).BindOutput(output);
+
+  std::vector<tim::transform::CalibrationSample> samples = {
+      {{1, 4, 2, 6}}, {{0, 1, 3, 2}}, {{6, 5, 0, 1}}};
+  auto quantized = tim::transform::Calibrate(src_graph, ctx, samples);
+  auto quant_graph = quantized.first;
+  ASSERT_TRUE(quant_graph);
+  auto quant_input = quantized.second[input];
+  auto quant_output = quantized.second[output];
+  EXPECT_EQ(tim::vx::DataType::UINT8, quant_input->GetDataType());
+  EXPECT_EQ(tim::vx::QuantType::ASYMMETRIC,
+            quant_input->GetQuantization().Type());
+  EXPECT_EQ(tim::vx::DataType::UINT8, quant_output->GetDataType());
+
+  // Input range [0, 6] observed over the calibration set
+  float input_scale = quant_input->GetQuantization().Scales()[0];
+  int32_t input_zp = quant_input->GetQuantization().ZeroPoints()[0];
+  EXPECT_NEAR(6.0f / 255, input_scale, 1e-6);
+  EXPECT_EQ(0, input_zp);
+
+  std::vector<float> in_data = {1, 4, 2, 6};
+  std::vector<float> golden = {9.1, 6.4, 16.6, 12.1, 10.4, 24.6};
+  auto in_u8 = Quantize<uint8_t>(in_data, input_scale, input_zp);
+  EXPECT_TRUE(quant_input->CopyDataToTensor(in_u8.data(), in_u8.size()));
+  EXPECT_TRUE(quant_graph->Compile());
+  EXPECT_TRUE(quant_graph->Run());
+
+  std::vector<uint8_t> out_u8(golden.size());
+  EXPECT_TRUE(quant_output->CopyDataFromTensor(out_u8.data()));
+  float output_scale = quant_output->GetQuantization().Scales()[0];
+  int32_t output_zp = quant_output->GetQuantization().ZeroPoints()[0];
+  auto out = Dequantize<uint8_t>(out_u8, output_scale, output_zp);
+  EXPECT_TRUE(ArraysMatch(golden, out, 2 * output_scale));
+}
+
+TEST(Calibration, percentile_clips_outlier) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  tim::vx::TensorSpec io_spec(tim::vx::DataType::FLOAT32, {1000},
+                              tim::vx::TensorAttribute::INPUT);
+  auto input = src_graph->CreateTensor(io_spec);
+  io_spec.SetAttribute(tim::vx::TensorAttribute::OUTPUT);
+  auto output = src_graph->CreateTensor(io_spec);
+  auto relu = src_graph->CreateOperation<tim::vx::ops::Relu>();
+  (*relu).BindInput(input).BindOutput(output);
+
+  std::vector<float> sample(1000);
+  for (size_t i = 0; i < sample.size(); i++) {
+    sample[i] = (float)i / sample.size();
+  }
+  sample[0] = 100.0f;
+  std::vector<tim::transform::CalibrationSample> samples = {{sample}};
+
+  tim::transform::CalibrationOption min_max;
+  auto minmax_graph =
+      tim::transform::Calibrate(src_graph, ctx, samples, min_max);
+  ASSERT_TRUE(minmax_graph.first);
+  EXPECT_NEAR(100.0f / 255,
+              minmax_graph.second[input]->GetQuantization().Scales()[0], 1e-5);
+
+  tim::transform::CalibrationOption percentile;
+  percentile.method = tim::transform::CalibrationMethod::PERCENTILE;
+  percentile.percentile = 99.0f;
+  percentile.activation_type = tim::vx::DataType::INT8;
+  auto clipped_graph =
+      tim::transform::Calibrate(src_graph, ctx, samples, percentile);
+  ASSERT_TRUE(clipped_graph.first);
+  auto clipped_input = clipped_graph.second[input];
+  EXPECT_EQ(tim::vx::DataType::INT8, clipped_input->GetDataType());
+  EXPECT_GT(2.0f / 255, clipped_input->GetQuantization().Scales()[0]);
+  EXPECT_EQ(-128, clipped_input->GetQuantization().ZeroPoints()[0]);
+}
@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/constant_folding.h"
+
+#include <algorithm>
+#include <set>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "op_impl.h"
+
+namespace tim {
+namespace transform {
+namespace constant_folding_impl {
+
+using TensorData = std::map<std::shared_ptr<vx::Tensor>, std::vector<uint8_t>>;
+
+bool IsKnownTensor(const std::shared_ptr<vx::Tensor>& tensor,
+                   const TensorData& folded) {
+  return tensor->IsPlaceHolder() || tensor->IsConstTensor() ||
+         folded.end() != folded.find(tensor);
+}
+
+// Op can be folded if every input is constant or already folded, and none of
+// its outputs is graph output or has unknown shape.
+bool IsFoldable(const std::shared_ptr<vx::Graph>& src_graph,
+                const std::shared_ptr<vx::Operation>& op,
+                const TensorData& folded) {
+  if (op->impl()->kind_ == -1) return false;  // composed op
+  auto inputs = op->impl()->InputsTensor();
+  if (inputs.empty()) return false;
+  for (const auto& tensor : inputs) {
+    if (!IsKnownTensor(tensor, folded)) return false;
+  }
+  auto graph_outputs = src_graph->OutputsTensor();
+  for (const auto& tensor : op->impl()->OutputsTensor()) {
+    if (tensor->GetShape().empty() ||
+        graph_outputs.end() !=
+            std::find(graph_outputs.begin(), graph_outputs.end(), tensor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<uint8_t> ReadConstant(const std::shared_ptr<vx::Tensor>& tensor,
+                                  const TensorData& folded) {
+  auto it = folded.find(tensor);
+  if (it != folded.end()) {
+    return it->second;
+  }
+  std::vector<uint8_t> data(tensor->GetSpec().GetByteSize());
+  tensor->CopyDataFromTensor(data.data());
+  return data;
+}
+
+// Run op in a throwaway graph, outputs are recorded in folded on success
+bool Evaluate(const std::shared_ptr<vx::Operation>& op,
+              std::shared_ptr<vx::Context>& ctx, TensorData& folded) {
+  auto eval_graph = ctx->CreateGraph();
+  std::vector<std::shared_ptr<vx::Tensor>> inputs;
+  std::vector<std::vector<uint8_t>> inputs_data;
+  for (const auto& tensor : op->impl()->InputsTensor()) {
+    if (tensor->IsPlaceHolder()) {
+      inputs.push_back(eval_graph->CreateTensorPlaceHolder());
+      continue;
+    }
+    inputs_data.push_back(ReadConstant(tensor, folded));
+    vx::TensorSpec spec(tensor->GetSpec());
+    spec.SetAttribute(vx::TensorAttribute::CONSTANT);
+    inputs.push_back(
+        eval_graph->CreateTensor(spec, inputs_data.back().data()));
+  }
+  std::vector<std::shared_ptr<vx::Tensor>> outputs;
+  for (const auto& tensor : op->impl()->OutputsTensor()) {
+    vx::TensorSpec spec(tensor->GetSpec());
+    spec.SetAttribute(vx::TensorAttribute::OUTPUT);
+    outputs.push_back(eval_graph->CreateTensor(spec));
+  }
+
+  auto eval_op = op->Clone(eval_graph);
+  eval_op->BindInputs(inputs);
+  eval_op->BindOutputs(outputs);
+  if (!eval_graph->Compile() || !eval_graph->Run()) {
+    VSILOGW("Op %d: evaluation failed, keep it in graph.",
+            op->impl()->kind_);
+    return false;
+  }
+
+  auto src_outputs = op->impl()->OutputsTensor();
+  for (size_t i = 0; i < outputs.size(); i++) {
+    std::vector<uint8_t> data(outputs[i]->GetSpec().GetByteSize());
+    if (!outputs[i]->CopyDataFromTensor(data.data())) {
+      return false;
+    }
+    folded[src_outputs[i]] = std::move(data);
+  }
+  return true;
+}
+
+std::shared_ptr<vx::Tensor> MapTensor(
+    const std::shared_ptr<vx::Tensor>& t_src,
+    std::shared_ptr<vx::Graph>& folded_graph, const TensorData& folded,
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>&
+        tensor_map) {
+  auto it = tensor_map.find(t_src);
+  if (it != tensor_map.end()) {
+    return it->second;
+  }
+  std::shared_ptr<vx::Tensor> t_dst;
+  if (t_src->IsPlaceHolder()) {
+    t_dst = folded_graph->CreateTensorPlaceHolder();
+  } else if (IsKnownTensor(t_src, folded)) {
+    auto data = ReadConstant(t_src, folded);
+    vx::TensorSpec spec(t_src->GetSpec());
+    spec.SetAttribute(vx::TensorAttribute::CONSTANT);
+    t_dst = folded_graph->CreateTensor(spec, data.data());
+  } else {
+    t_dst = folded_graph->CreateTensor(t_src->GetSpec());
+  }
+  tensor_map[t_src] = t_dst;
+  return t_dst;
+}
+
+}  // namespace constant_folding_impl
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+ConstantFolding(const std::shared_ptr<vx::Graph>& src_graph,
+                std::shared_ptr<vx::Context>& ctx) {
+  using namespace constant_folding_impl;
+  std::shared_ptr<vx::Graph> folded_graph = ctx->CreateGraph();
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      graph_io_map;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      tensor_map;
+
+  // Fold until fixpoint, op_vector is not guaranteed in topological order
+  TensorData folded;
+  std::set<std::shared_ptr<vx::Operation>> folded_ops;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto& op : src_graph->OpVector()) {
+      if (folded_ops.end() != folded_ops.find(op) ||
+          !IsFoldable(src_graph, op, folded)) {
+        continue;
+      }
+      if (Evaluate(op, ctx, folded)) {
+        folded_ops.insert(op);
+        changed = true;
+      }
+    }
+  }
+  VSILOGD("Constant folding removed %d ops.", (int)folded_ops.size());
+
+  for (const auto& t_src : src_graph->InputsTensor()) {
+    auto input = folded_graph->CreateTensor(t_src->GetSpec());
+    tensor_map[t_src] = input;
+    graph_io_map[t_src] = input;
+  }
+  for (const auto& t_src : src_graph->OutputsTensor()) {
+    auto output = folded_graph->CreateTensor(t_src->GetSpec());
+    tensor_map[t_src] = output;
+    graph_io_map[t_src] = output;
+  }
+
+  for (const auto& op : src_graph->OpVector()) {
+    if (folded_ops.end() != folded_ops.find(op)) continue;
+    std::vector<std::shared_ptr<vx::Tensor>> inputs;
+    for (const auto& t_src : op->impl()->InputsTensor()) {
+      inputs.push_back(MapTensor(t_src, folded_graph, folded, tensor_map));
+    }
+    std::vector<std::shared_ptr<vx::Tensor>> outputs;
+    for (const auto& t_src : op->impl()->OutputsTensor()) {
+      outputs.push_back(MapTensor(t_src, folded_graph, folded, tensor_map));
+    }
+    auto folded_op = op->Clone(folded_graph);
+    folded_op->BindInputs(inputs);
+    folded_op->BindOutputs(outputs);
+  }
+
+  return std::make_pair(folded_graph, graph_io_map);
+}
+
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,59 @@
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/constant_folding.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+TEST(ConstantFolding, reshape_transpose_of_weight) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({2, 3});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = src_graph->CreateTensor(input_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {6},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  std::vector<float> weight_data = {1, 2, 3, 4, 5, 6};
+  auto weight = src_graph->CreateTensor(weight_spec, weight_data.data());
+
+  tim::vx::TensorSpec reshaped_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                    tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec transposed_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                      tim::vx::TensorAttribute::TRANSIENT);
+  auto reshaped = src_graph->CreateTensor(reshaped_spec);
+  auto transposed = src_graph->CreateTensor(transposed_spec);
+
+  auto reshape = src_graph->CreateOperation<tim::vx::ops::Reshape>(
+      std::vector<uint32_t>({3, 2}));
+  (*reshape).BindInput(weight).BindOutput(reshaped);
+  auto transpose = src_graph->CreateOperation<tim::vx::ops::Transpose>(
+      std::vector<uint32_t>({1, 0}));
+  (*transpose).BindInput(reshaped).BindOutput(transposed);
+  auto add = src_graph->CreateOperation<tim::vx::ops::Add>();
+  (*add).BindInputs({input, transposed}).BindOutput(output);
+
+  auto transform = tim::transform::ConstantFolding(src_graph, ctx);
+  auto folded_graph = transform.first;
+  auto graph_io_map = transform.second;
+  EXPECT_EQ(folded_graph->OpVector().size(), 1u);
+  EXPECT_TRUE(folded_graph->Compile());
+
+  std::vector<float> input_data = {10, 20, 30, 40, 50, 60};
+  auto folded_input = graph_io_map[src_graph->InputsTensor()[0]];
+  auto folded_output = graph_io_map[src_graph->OutputsTensor()[0]];
+  folded_input->CopyDataToTensor(input_data.data(),
+                                 input_data.size() * sizeof(float));
+  EXPECT_TRUE(folded_graph->Run());
+
+  std::vector<float> golden = {11, 24, 32, 45, 53, 66};
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(folded_output->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(golden, out_data);
+}
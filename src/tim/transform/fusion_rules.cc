@@ -0,0 +1,442 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#include "tim/transform/pattern_fusion.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "tim/vx/ops/activations.h"
+#include "tim/vx/ops/conv2d.h"
+#include "tim/vx/ops/elementwise.h"
+#include "tim/vx/ops/instancenormalization.h"
+#include "tim/vx/ops/layernormalization.h"
+#include "op_impl.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+const float kSqrt2 = 1.41421356f;
+
+std::vector<float> ReadFloat(const std::shared_ptr<vx::Tensor>& tensor) {
+  std::vector<float> values;
+  float* data = tensor->ConvertTensorToFloat32Data();
+  if (data) {
+    values.assign(data, data + tensor->GetSpec().GetElementNum());
+    vsi_nn_Free(data);
+  }
+  return values;
+}
+
+bool IsFloat(const std::shared_ptr<vx::Tensor>& tensor) {
+  return (tensor->GetDataType() == vx::DataType::FLOAT32 ||
+          tensor->GetDataType() == vx::DataType::FLOAT16) &&
+         tensor->GetQuantization().Type() == vx::QuantType::NONE;
+}
+
+bool IsUnscaledMultiply(const std::shared_ptr<vx::Operation>& op) {
+  return op->impl()->node()->nn_param.multiply.scale == 1.0f;
+}
+
+bool IsUnscaledDiv(const std::shared_ptr<vx::Operation>& op) {
+  return op->impl()->node()->nn_param.divide.scale == 1.0f;
+}
+
+// Bind single input `x` to a newly created op which produces the root output
+void BindUnary(FusionContext& ctx, const PatternMatch& match,
+               const std::shared_ptr<vx::Operation>& op) {
+  op->BindInput(ctx.Map(match.tensors.at("x")));
+  op->BindOutput(ctx.Map(match.Root()->impl()->OutputsTensor()[0]));
+}
+
+/*
+ Conv2d(x, w, b) -> BatchNorm(mean, var, gamma, beta)
+   => Conv2d(x, w * s, (b - mean) * s + beta), s = gamma / sqrt(var + eps)
+*/
+class ConvBatchNormFusion : public FusionRule {
+ public:
+  ConvBatchNormFusion() {
+    Pattern pattern;
+    auto conv = pattern.AddNode(
+        VSI_NN_OP_CONV2D,
+        {Pattern::Input("x"), Pattern::Const("w"),
+         Pattern::Optional(Pattern::Const("b"))},
+        false, [](const std::shared_ptr<vx::Operation>& op) {
+          auto conv2d = std::dynamic_pointer_cast<vx::ops::Conv2d>(op);
+          // Output channel must be the last kernel dimension
+          return conv2d && op->impl()->node()->nn_param.conv2d.multiplier == 0 &&
+                 (conv2d->KernelDataLayout() == vx::DataLayout::WHIcOc ||
+                  conv2d->KernelDataLayout() == vx::DataLayout::IcWHOc);
+        });
+    pattern.AddNode(VSI_NN_OP_BATCH_NORM,
+                    {Pattern::Node(conv), Pattern::Const("mean"),
+                     Pattern::Const("var"), Pattern::Const("gamma"),
+                     Pattern::Const("beta")});
+    patterns_.push_back(pattern);
+  }
+
+  const char* Name() const override { return "ConvBatchNorm"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  bool Check(const PatternMatch& match) const override {
+    auto w = match.tensors.at("w");
+    if (w->GetDataType() != vx::DataType::FLOAT32 || !IsFloat(w) ||
+        match.ops[0]->impl()->layout_ != match.ops[1]->impl()->layout_) {
+      return false;
+    }
+    auto oc = w->GetShape().back();
+    auto b = match.tensors.find("b");
+    if (b != match.tensors.end() &&
+        (!IsFloat(b->second) || b->second->GetSpec().GetElementNum() != oc)) {
+      return false;
+    }
+    for (const auto& name : {"mean", "var", "gamma", "beta"}) {
+      if (match.tensors.at(name)->GetSpec().GetElementNum() != oc) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    auto w_src = match.tensors.at("w");
+    uint32_t oc = w_src->GetShape().back();
+    float eps = match.ops[1]->impl()->node()->nn_param.batch_norm.eps;
+    auto w = ReadFloat(w_src);
+    auto mean = ReadFloat(match.tensors.at("mean"));
+    auto var = ReadFloat(match.tensors.at("var"));
+    auto gamma = ReadFloat(match.tensors.at("gamma"));
+    auto beta = ReadFloat(match.tensors.at("beta"));
+    std::vector<float> b(oc, 0.0f);
+    auto b_src = match.tensors.find("b");
+    if (b_src != match.tensors.end()) {
+      b = ReadFloat(b_src->second);
+    }
+
+    size_t inner = w.size() / oc;
+    for (uint32_t c = 0; c < oc; c++) {
+      float scale = gamma[c] / std::sqrt(var[c] + eps);
+      for (size_t i = 0; i < inner; i++) {
+        w[c * inner + i] *= scale;
+      }
+      b[c] = (b[c] - mean[c]) * scale + beta[c];
+    }
+
+    auto& graph = ctx.FusedGraph();
+    vx::TensorSpec w_spec(vx::DataType::FLOAT32, w_src->GetShape(),
+                          vx::TensorAttribute::CONSTANT);
+    vx::TensorSpec b_spec(vx::DataType::FLOAT32, {oc},
+                          vx::TensorAttribute::CONSTANT);
+    auto conv = match.ops[0]->Clone(graph);
+    conv->BindInputs({ctx.Map(match.tensors.at("x")),
+                      graph->CreateTensor(w_spec, w.data()),
+                      graph->CreateTensor(b_spec, b.data())});
+    conv->BindOutput(ctx.Map(match.Root()->impl()->OutputsTensor()[0]));
+  }
+
+ private:
+  std::vector<Pattern> patterns_;
+};
+
+/*
+ x * 0.5 * (1 + erf(x / sqrt(2)))  => Gelu(x)
+*/
+class GeluFusion : public FusionRule {
+ public:
+  GeluFusion() {
+    for (int variant = 0; variant < 2; variant++) {
+      Pattern pattern;
+      auto scaled =
+          variant == 0
+              ? pattern.AddNode(VSI_NN_OP_DIVIDE,
+                                {Pattern::Input("x"),
+                                 Pattern::Scalar("sqrt2", kSqrt2)},
+                                false, IsUnscaledDiv)
+              : pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                                {Pattern::Input("x"),
+                                 Pattern::Scalar("sqrt2", 1.0f / kSqrt2)},
+                                true, IsUnscaledMultiply);
+      auto erf = pattern.AddNode(VSI_NN_OP_ERF, {Pattern::Node(scaled)});
+      auto add = pattern.AddNode(
+          VSI_NN_OP_ADD, {Pattern::Node(erf), Pattern::Scalar("one", 1.0f)},
+          true);
+      auto mul = pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                                 {Pattern::Input("x"), Pattern::Node(add)},
+                                 true, IsUnscaledMultiply);
+      pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                      {Pattern::Node(mul), Pattern::Scalar("half", 0.5f)},
+                      true, IsUnscaledMultiply);
+      patterns_.push_back(pattern);
+    }
+  }
+
+  const char* Name() const override { return "Gelu"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    BindUnary(ctx, match,
+              ctx.FusedGraph()->CreateOperation<vx::ops::Gelu>(false));
+  }
+
+ private:
+  std::vector<Pattern> patterns_;
+};
+
+/*
+ x * HardSigmoid(x) | x * Relu6(x + 3) / 6  => HardSwish(x)
+*/
+class HardSwishFusion : public FusionRule {
+ public:
+  HardSwishFusion() {
+    Pattern hard_sigmoid;
+    auto sigmoid = hard_sigmoid.AddNode(
+        VSI_NN_OP_HARD_SIGMOID, {Pattern::Input("x")}, false,
+        [](const std::shared_ptr<vx::Operation>& op) {
+          const auto& param = op->impl()->node()->nn_param.hard_sigmoid;
+          return std::fabs(param.alpha - 1.0f / 6) < 1e-4f &&
+                 std::fabs(param.beta - 0.5f) < 1e-4f;
+        });
+    hard_sigmoid.AddNode(VSI_NN_OP_MULTIPLY,
+                         {Pattern::Input("x"), Pattern::Node(sigmoid)}, true,
+                         IsUnscaledMultiply);
+    patterns_.push_back(hard_sigmoid);
+
+    for (int variant = 0; variant < 2; variant++) {
+      Pattern relu6;
+      auto add = relu6.AddNode(
+          VSI_NN_OP_ADD, {Pattern::Input("x"), Pattern::Scalar("three", 3.0f)},
+          true);
+      auto clip = relu6.AddNode(VSI_NN_OP_RELU6, {Pattern::Node(add)});
+      auto mul = relu6.AddNode(VSI_NN_OP_MULTIPLY,
+                               {Pattern::Input("x"), Pattern::Node(clip)}, true,
+                               IsUnscaledMultiply);
+      if (variant == 0) {
+        relu6.AddNode(VSI_NN_OP_DIVIDE,
+                      {Pattern::Node(mul), Pattern::Scalar("six", 6.0f)},
+                      false, IsUnscaledDiv);
+      } else {
+        relu6.AddNode(VSI_NN_OP_MULTIPLY,
+                      {Pattern::Node(mul), Pattern::Scalar("six", 1.0f / 6)},
+                      true, IsUnscaledMultiply);
+      }
+      patterns_.push_back(relu6);
+    }
+  }
+
+  const char* Name() const override { return "HardSwish"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    BindUnary(ctx, match,
+              ctx.FusedGraph()->CreateOperation<vx::ops::HardSwish>());
+  }
+
+ private:
+  std::vector<Pattern> patterns_;
+};
+
+/*
+ x * Sigmoid(x)  => Swish(x)
+*/
+class SwishFusion : public FusionRule {
+ public:
+  SwishFusion() {
+    Pattern pattern;
+    auto sigmoid = pattern.AddNode(VSI_NN_OP_SIGMOID, {Pattern::Input("x")});
+    pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                    {Pattern::Input("x"), Pattern::Node(sigmoid)}, true,
+                    IsUnscaledMultiply);
+    patterns_.push_back(pattern);
+  }
+
+  const char* Name() const override { return "Swish"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    BindUnary(ctx, match, ctx.FusedGraph()->CreateOperation<vx::ops::Swish>());
+  }
+
+ private:
+  std::vector<Pattern> patterns_;
+};
+
+/*
+ Multiply(a, b) -> Add(c)  => ATimesBPlusC(a, b, c)
+*/
+class MulAddFusion : public FusionRule {
+ public:
+  MulAddFusion() {
+    Pattern pattern;
+    auto mul = pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                               {Pattern::Input("a"), Pattern::Input("b")},
+                               false, IsUnscaledMultiply);
+    pattern.AddNode(VSI_NN_OP_ADD, {Pattern::Node(mul), Pattern::Input("c")},
+                    true);
+    patterns_.push_back(pattern);
+  }
+
+  const char* Name() const override { return "MulAdd"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  // Keep requantization of the product for quantized graphs
+  bool Check(const PatternMatch& match) const override {
+    for (const auto& op : match.ops) {
+      for (const auto& tensor : op->impl()->OutputsTensor()) {
+        if (!IsFloat(tensor)) return false;
+      }
+    }
+    for (const auto& captured : match.tensors) {
+      if (!IsFloat(captured.second)) return false;
+    }
+    return true;
+  }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    auto op = ctx.FusedGraph()->CreateOperation<vx::ops::ATimesBPlusC>();
+    op->BindInputs({ctx.Map(match.tensors.at("a")),
+                    ctx.Map(match.tensors.at("b")),
+                    ctx.Map(match.tensors.at("c"))});
+    op->BindOutput(ctx.Map(match.Root()->impl()->OutputsTensor()[0]));
+  }
+
+ private:
+  std::vector<Pattern> patterns_;
+};
+
+/*
+ x - mean(x) normalized by rsqrt(mean((x - mean(x))^2) + eps), scaled by
+ gamma and shifted by beta, see MeanStdDevNormalization() for the layout
+   => LayerNormalization over one axis, InstanceNormalization over W, H of
+      a CWHN tensor
+*/
+class MeanStdDevNormFusion : public FusionRule {
+ public:
+  enum { MEAN_0, SUB_0, POW, MEAN_1, ADD_0, RSQRT, MUL_0, MUL_1, MUL_2 };
+
+  MeanStdDevNormFusion() {
+    auto is_mean = [](const std::shared_ptr<vx::Operation>& op) {
+      const auto& param = op->impl()->node()->nn_param.reduce;
+      return param.type == VSI_NN_REDUCE_MEAN && param.keep_dim;
+    };
+    Pattern pattern;
+    auto mean0 =
+        pattern.AddNode(VSI_NN_OP_REDUCE, {Pattern::Input("x")}, false, is_mean);
+    auto sub0 = pattern.AddNode(VSI_NN_OP_SUBTRACT,
+                                {Pattern::Input("x"), Pattern::Node(mean0)});
+    auto pow = pattern.AddNode(
+        VSI_NN_OP_POW, {Pattern::Node(sub0), Pattern::Scalar("two", 2.0f)});
+    auto mean1 =
+        pattern.AddNode(VSI_NN_OP_REDUCE, {Pattern::Node(pow)}, false, is_mean);
+    auto add0 = pattern.AddNode(
+        VSI_NN_OP_ADD, {Pattern::Node(mean1), Pattern::Const("eps")}, true);
+    auto rsqrt = pattern.AddNode(VSI_NN_OP_RSQRT, {Pattern::Node(add0)});
+    auto mul0 = pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                                {Pattern::Node(rsqrt), Pattern::Const("gamma")},
+                                true, IsUnscaledMultiply);
+    auto mul1 = pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                                {Pattern::Input("x"), Pattern::Node(mul0)},
+                                true, IsUnscaledMultiply);
+    auto mul2 = pattern.AddNode(VSI_NN_OP_MULTIPLY,
+                                {Pattern::Node(mean0), Pattern::Node(mul0)},
+                                true, IsUnscaledMultiply);
+    auto sub1 = pattern.AddNode(VSI_NN_OP_SUBTRACT,
+                                {Pattern::Const("beta"), Pattern::Node(mul2)});
+    pattern.AddNode(VSI_NN_OP_ADD, {Pattern::Node(mul1), Pattern::Node(sub1)},
+                    true);
+    patterns_.push_back(pattern);
+  }
+
+  const char* Name() const override { return "MeanStdDevNorm"; }
+  const std::vector<Pattern>& Patterns() const override { return patterns_; }
+
+  bool Check(const PatternMatch& match) const override {
+    auto axes = ReduceAxes(match.ops[MEAN_0]);
+    if (axes != ReduceAxes(match.ops[MEAN_1]) ||
+        match.tensors.at("eps")->GetSpec().GetElementNum() != 1) {
+      return false;
+    }
+    const auto& shape = match.tensors.at("x")->GetShape();
+    uint32_t channel = 0;
+    if (axes.size() == 1 && axes[0] >= 0 && axes[0] < (int32_t)shape.size()) {
+      channel = shape[axes[0]];
+    } else if (shape.size() == 4 && axes == std::vector<int32_t>({1, 2})) {
+      channel = shape[0];
+    } else {
+      return false;
+    }
+    return match.tensors.at("gamma")->GetSpec().GetElementNum() == channel &&
+           match.tensors.at("beta")->GetSpec().GetElementNum() == channel;
+  }
+
+  void Rewrite(FusionContext& ctx, const PatternMatch& match) override {
+    auto x = match.tensors.at("x");
+    auto axes = ReduceAxes(match.ops[MEAN_0]);
+    float eps = ReadFloat(match.tensors.at("eps"))[0];
+    auto gamma = ReadFloat(match.tensors.at("gamma"));
+    auto beta = ReadFloat(match.tensors.at("beta"));
+
+    // Parameters are shaped for broadcast along the normalized channel
+    int32_t channel_axis = axes.size() == 1 ? axes[0] : 0;
+    vx::ShapeType shape(x->GetShape().size(), 1);
+    shape[channel_axis] = x->GetShape()[channel_axis];
+    vx::TensorSpec param_spec(vx::DataType::FLOAT32, shape,
+                              vx::TensorAttribute::CONSTANT);
+    auto& graph = ctx.FusedGraph();
+    std::shared_ptr<vx::Operation> norm;
+    if (axes.size() == 1) {
+      norm = graph->CreateOperation<vx::ops::LayerNormalization>(axes[0], eps);
+    } else {
+      norm = graph->CreateOperation<vx::ops::InstanceNormalization>(
+          eps, vx::DataLayout::CWHN);
+    }
+    norm->BindInputs({ctx.Map(x), graph->CreateTensor(param_spec, beta.data()),
+                      graph->CreateTensor(param_spec, gamma.data())});
+    norm->BindOutput(ctx.Map(match.Root()->impl()->OutputsTensor()[0]));
+  }
+
+ private:
+  static std::vector<int32_t> ReduceAxes(
+      const std::shared_ptr<vx::Operation>& op) {
+    const auto& param = op->impl()->node()->nn_param.reduce;
+    std::vector<int32_t> axes(param.axis, param.axis + param.axis_num);
+    std::sort(axes.begin(), axes.end());
+    return axes;
+  }
+
+  std::vector<Pattern> patterns_;
+};
+
+}  // namespace
+
+std::vector<std::shared_ptr<FusionRule>> DefaultFusionRules() {
+  // Larger patterns first, MulAdd would otherwise split activations
+  return {std::make_shared<MeanStdDevNormFusion>(),
+          std::make_shared<ConvBatchNormFusion>(),
+          std::make_shared<GeluFusion>(), std::make_shared<HardSwishFusion>(),
+          std::make_shared<SwishFusion>(), std::make_shared<MulAddFusion>()};
+}
+
+}  // namespace transform
+}  // namespace tim
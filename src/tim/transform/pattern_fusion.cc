@@ -0,0 +1,312 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/pattern_fusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "op_impl.h"
+
+namespace tim {
+namespace transform {
+
+PatternOperand Pattern::Node(int32_t index) {
+  PatternOperand operand;
+  operand.type = PatternOperand::Type::NODE;
+  operand.node = index;
+  return operand;
+}
+
+PatternOperand Pattern::Input(const std::string& name) {
+  PatternOperand operand;
+  operand.type = PatternOperand::Type::INPUT;
+  operand.name = name;
+  return operand;
+}
+
+PatternOperand Pattern::Const(const std::string& name,
+                              PatternOperand::TensorPredicate predicate) {
+  PatternOperand operand;
+  operand.type = PatternOperand::Type::CONSTANT;
+  operand.name = name;
+  operand.predicate = predicate;
+  return operand;
+}
+
+PatternOperand Pattern::Scalar(const std::string& name, float value) {
+  return Const(name, [value](const std::shared_ptr<vx::Tensor>& tensor) {
+    float* data = tensor->ConvertTensorToFloat32Data();
+    if (!data) return false;
+    bool same = true;
+    float tolerance = 1e-3f * std::max(1.0f, std::fabs(value));
+    for (int64_t i = 0; i < tensor->GetSpec().GetElementNum(); i++) {
+      if (std::fabs(data[i] - value) > tolerance) {
+        same = false;
+        break;
+      }
+    }
+    vsi_nn_Free(data);
+    return same;
+  });
+}
+
+PatternOperand Pattern::Optional(PatternOperand operand) {
+  operand.optional = true;
+  return operand;
+}
+
+int32_t Pattern::AddNode(int32_t kind,
+                         const std::vector<PatternOperand>& operands,
+                         bool commutative, OpPredicate predicate) {
+  nodes_.push_back({kind, operands, commutative, predicate});
+  return Root();
+}
+
+FusionContext::FusionContext(const std::shared_ptr<vx::Graph>& src_graph,
+                             std::shared_ptr<vx::Graph>& fused_graph)
+    : src_graph_(src_graph), fused_graph_(fused_graph) {}
+
+std::shared_ptr<vx::Tensor> FusionContext::Map(
+    const std::shared_ptr<vx::Tensor>& t_src) {
+  auto it = tensor_map_.find(t_src);
+  if (it != tensor_map_.end()) {
+    return it->second;
+  }
+  std::shared_ptr<vx::Tensor> t_fused;
+  if (t_src->IsPlaceHolder()) {
+    t_fused = fused_graph_->CreateTensorPlaceHolder();
+  } else if (t_src->IsConstTensor()) {
+    std::vector<uint8_t> data(t_src->GetSpec().GetByteSize());
+    t_src->CopyDataFromTensor(data.data());
+    t_fused = fused_graph_->CreateTensor(t_src->GetSpec(), data.data());
+  } else {
+    t_fused = fused_graph_->CreateTensor(t_src->GetSpec());
+  }
+  tensor_map_[t_src] = t_fused;
+  return t_fused;
+}
+
+void FusionContext::UpdateTensorMap(
+    const std::shared_ptr<vx::Tensor>& t_src,
+    const std::shared_ptr<vx::Tensor>& t_fused) {
+  tensor_map_[t_src] = t_fused;
+}
+
+namespace pattern_fusion_impl {
+
+class Matcher {
+ public:
+  Matcher(const std::shared_ptr<vx::Graph>& graph, const Pattern& pattern)
+      : graph_(graph), pattern_(pattern) {
+    match_.ops.resize(pattern.Nodes().size());
+  }
+
+  bool Run(const std::shared_ptr<vx::Operation>& root) {
+    if (pattern_.Nodes().empty() || !MatchNode(pattern_.Root(), root, match_)) {
+      return false;
+    }
+    return IsExclusive();
+  }
+
+  const PatternMatch& Match() const { return match_; }
+
+ private:
+  bool MatchNode(int32_t index, const std::shared_ptr<vx::Operation>& op,
+                 PatternMatch& state) {
+    const auto& node = pattern_.Nodes()[index];
+    if (state.ops[index]) {
+      return state.ops[index] == op;
+    }
+    if (op->impl()->kind_ != node.kind || (node.predicate && !node.predicate(op))) {
+      return false;
+    }
+    if (state.ops.end() != std::find(state.ops.begin(), state.ops.end(), op)) {
+      return false;  // op already taken by another pattern node
+    }
+
+    auto inputs = op->impl()->InputsTensor();
+    size_t required = std::count_if(
+        node.operands.begin(), node.operands.end(),
+        [](const PatternOperand& operand) { return !operand.optional; });
+    if (inputs.size() < required || inputs.size() > node.operands.size()) {
+      return false;
+    }
+
+    std::vector<std::vector<size_t>> orders = {{0, 1}};
+    if (node.commutative && node.operands.size() == 2 && inputs.size() == 2) {
+      orders.push_back({1, 0});
+    }
+    for (const auto& order : orders) {
+      PatternMatch trial = state;
+      trial.ops[index] = op;
+      bool matched = true;
+      for (size_t i = 0; i < node.operands.size() && matched; i++) {
+        size_t input_idx = i < order.size() ? order[i] : i;
+        auto tensor = input_idx < inputs.size() ? inputs[input_idx] : nullptr;
+        matched = MatchOperand(node.operands[i], tensor, trial);
+      }
+      if (matched) {
+        state = trial;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool MatchOperand(const PatternOperand& operand,
+                    const std::shared_ptr<vx::Tensor>& tensor,
+                    PatternMatch& state) {
+    if (!tensor || tensor->IsPlaceHolder()) {
+      return operand.optional;
+    }
+    switch (operand.type) {
+      case PatternOperand::Type::NODE: {
+        auto producer = graph_->GetProducerOp(tensor);
+        return producer && MatchNode(operand.node, producer, state);
+      }
+      case PatternOperand::Type::CONSTANT:
+        if (!tensor->IsConstTensor() ||
+            (operand.predicate && !operand.predicate(tensor))) {
+          return false;
+        }
+        break;
+      case PatternOperand::Type::INPUT:
+        break;
+    }
+    auto bound = state.tensors.find(operand.name);
+    if (bound != state.tensors.end()) {
+      return bound->second == tensor;
+    }
+    state.tensors[operand.name] = tensor;
+    return true;
+  }
+
+  // Outputs of inner nodes must only be consumed inside the pattern
+  bool IsExclusive() const {
+    auto graph_outputs = graph_->OutputsTensor();
+    for (size_t i = 0; i < match_.ops.size(); i++) {
+      if (!match_.ops[i]) return false;
+      if (static_cast<int32_t>(i) == pattern_.Root()) continue;
+      for (const auto& tensor : match_.ops[i]->impl()->OutputsTensor()) {
+        if (graph_outputs.end() !=
+            std::find(graph_outputs.begin(), graph_outputs.end(), tensor)) {
+          return false;
+        }
+        for (const auto& consumer : graph_->GetConsumersOp(tensor)) {
+          if (match_.ops.end() ==
+              std::find(match_.ops.begin(), match_.ops.end(), consumer)) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  const std::shared_ptr<vx::Graph>& graph_;
+  const Pattern& pattern_;
+  PatternMatch match_;
+};
+
+}  // namespace pattern_fusion_impl
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+PatternFusion(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx,
+              const std::vector<std::shared_ptr<FusionRule>>& rules) {
+  std::shared_ptr<vx::Graph> fused_graph = ctx->CreateGraph();
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      graph_io_map;
+  FusionContext fusion_ctx(src_graph, fused_graph);
+
+  for (const auto& t_src : src_graph->InputsTensor()) {
+    auto input = fused_graph->CreateTensor(t_src->GetSpec());
+    fusion_ctx.UpdateTensorMap(t_src, input);
+    graph_io_map[t_src] = input;
+  }
+  for (const auto& t_src : src_graph->OutputsTensor()) {
+    auto output = fused_graph->CreateTensor(t_src->GetSpec());
+    fusion_ctx.UpdateTensorMap(t_src, output);
+    graph_io_map[t_src] = output;
+  }
+
+  // Rules are applied in priority order, one op belongs to one match at most
+  std::set<std::shared_ptr<vx::Operation>> claimed;
+  std::map<std::shared_ptr<vx::Operation>,
+           std::pair<FusionRule*, PatternMatch>>
+      root_matches;
+  for (const auto& rule : rules) {
+    for (const auto& op : src_graph->OpVector()) {
+      if (claimed.end() != claimed.find(op)) continue;
+      for (const auto& pattern : rule->Patterns()) {
+        pattern_fusion_impl::Matcher matcher(src_graph, pattern);
+        if (!matcher.Run(op)) continue;
+        const auto& match = matcher.Match();
+        bool overlapped = std::any_of(
+            match.ops.begin(), match.ops.end(),
+            [&claimed](const std::shared_ptr<vx::Operation>& matched) {
+              return claimed.end() != claimed.find(matched);
+            });
+        if (overlapped || !rule->Check(match)) continue;
+
+        claimed.insert(match.ops.begin(), match.ops.end());
+        root_matches[op] = std::make_pair(rule.get(), match);
+        VSILOGD("Fusion rule %s matched %d ops.", rule->Name(),
+                (int)match.ops.size());
+        break;
+      }
+    }
+  }
+
+  for (const auto& op : src_graph->OpVector()) {
+    auto root_match = root_matches.find(op);
+    if (root_match != root_matches.end()) {
+      root_match->second.first->Rewrite(fusion_ctx, root_match->second.second);
+      continue;
+    }
+    if (claimed.end() != claimed.find(op)) continue;
+
+    std::vector<std::shared_ptr<vx::Tensor>> inputs;
+    for (const auto& t_src : op->impl()->InputsTensor()) {
+      inputs.push_back(fusion_ctx.Map(t_src));
+    }
+    std::vector<std::shared_ptr<vx::Tensor>> outputs;
+    for (const auto& t_src : op->impl()->OutputsTensor()) {
+      outputs.push_back(fusion_ctx.Map(t_src));
+    }
+    auto fused_op = op->Clone(fused_graph);
+    fused_op->BindInputs(inputs);
+    fused_op->BindOutputs(outputs);
+  }
+
+  return std::make_pair(fused_graph, graph_io_map);
+}
+
+}  // namespace transform
+}  // namespace tim
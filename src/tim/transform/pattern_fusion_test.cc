@@ -0,0 +1,173 @@
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/pattern_fusion.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+TEST(PatternFusion, swish) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+  tim::vx::ShapeType shape({4});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = src_graph->CreateTensor(input_spec);
+  auto sigmoid_out = src_graph->CreateTensor(transient_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+
+  auto sigmoid = src_graph->CreateOperation<tim::vx::ops::Sigmoid>();
+  (*sigmoid).BindInput(input).BindOutput(sigmoid_out);
+  auto mul = src_graph->CreateOperation<tim::vx::ops::Multiply>();
+  (*mul).BindInputs({sigmoid_out, input}).BindOutput(output);
+
+  auto transform = tim::transform::PatternFusion(src_graph, ctx);
+  auto fused_graph = transform.first;
+  auto graph_io_map = transform.second;
+  EXPECT_EQ(fused_graph->OpVector().size(), 1u);
+  EXPECT_TRUE(fused_graph->Compile());
+
+  std::vector<float> input_data = {-2.0f, -0.5f, 0.5f, 2.0f};
+  graph_io_map[input]->CopyDataToTensor(input_data.data(),
+                                        input_data.size() * sizeof(float));
+  EXPECT_TRUE(fused_graph->Run());
+
+  std::vector<float> golden;
+  for (auto x : input_data) {
+    golden.push_back(x / (1.0f + std::exp(-x)));
+  }
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(graph_io_map[output]->CopyDataFromTensor(out_data.data()));
+  EXPECT_THAT(out_data, ElementsAreArray(ArrayFloatNear(golden, 1e-3f)));
+}
+
+TEST(PatternFusion, mul_add) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+  tim::vx::ShapeType shape({3});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> scale_data = {1.0f, 2.0f, 3.0f};
+  std::vector<float> shift_data = {0.5f, 0.5f, 0.5f};
+  auto input = src_graph->CreateTensor(input_spec);
+  auto scale = src_graph->CreateTensor(const_spec, scale_data.data());
+  auto shift = src_graph->CreateTensor(const_spec, shift_data.data());
+  auto product = src_graph->CreateTensor(transient_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+
+  auto mul = src_graph->CreateOperation<tim::vx::ops::Multiply>();
+  (*mul).BindInputs({input, scale}).BindOutput(product);
+  auto add = src_graph->CreateOperation<tim::vx::ops::Add>();
+  (*add).BindInputs({shift, product}).BindOutput(output);
+
+  auto transform = tim::transform::PatternFusion(src_graph, ctx);
+  auto fused_graph = transform.first;
+  auto graph_io_map = transform.second;
+  EXPECT_EQ(fused_graph->OpVector().size(), 1u);
+  EXPECT_TRUE(fused_graph->Compile());
+
+  std::vector<float> input_data = {1.0f, 2.0f, 3.0f};
+  graph_io_map[input]->CopyDataToTensor(input_data.data(),
+                                        input_data.size() * sizeof(float));
+  EXPECT_TRUE(fused_graph->Run());
+
+  std::vector<float> golden = {1.5f, 4.5f, 9.5f};
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(graph_io_map[output]->CopyDataFromTensor(out_data.data()));
+  EXPECT_THAT(out_data, ElementsAreArray(ArrayFloatNear(golden, 1e-5f)));
+}
+
+TEST(PatternFusion, mean_stddev_layer_norm) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+  tim::vx::ShapeType shape({3, 2});
+  tim::vx::ShapeType reduced_shape({1, 2});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec scalar_spec(tim::vx::DataType::FLOAT32, {1},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec param_spec(tim::vx::DataType::FLOAT32, {3, 1},
+                                 tim::vx::TensorAttribute::CONSTANT);
+  auto transient = [&src_graph](const tim::vx::ShapeType& s) {
+    return src_graph->CreateTensor(tim::vx::TensorSpec(
+        tim::vx::DataType::FLOAT32, s, tim::vx::TensorAttribute::TRANSIENT));
+  };
+  std::vector<float> two = {2.0f}, eps = {1e-5f};
+  std::vector<float> gamma_data = {1.0f, 2.0f, 0.5f};
+  std::vector<float> beta_data = {0.0f, 1.0f, -1.0f};
+  auto input = src_graph->CreateTensor(input_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+  auto gamma = src_graph->CreateTensor(param_spec, gamma_data.data());
+  auto beta = src_graph->CreateTensor(param_spec, beta_data.data());
+  auto mean0_out = transient(reduced_shape), sub0_out = transient(shape),
+       pow_out = transient(shape), mean1_out = transient(reduced_shape),
+       add0_out = transient(reduced_shape), rsqrt_out = transient(reduced_shape),
+       mul0_out = transient(shape), mul1_out = transient(shape),
+       mul2_out = transient(shape), sub1_out = transient(shape);
+
+  std::vector<int32_t> axis = {0};
+  src_graph->CreateOperation<tim::vx::ops::ReduceMean>(axis, true)
+      ->BindInput(input).BindOutput(mean0_out);
+  src_graph->CreateOperation<tim::vx::ops::Sub>()
+      ->BindInputs({input, mean0_out}).BindOutput(sub0_out);
+  src_graph->CreateOperation<tim::vx::ops::Pow>()
+      ->BindInputs({sub0_out, src_graph->CreateTensor(scalar_spec, two.data())})
+      .BindOutput(pow_out);
+  src_graph->CreateOperation<tim::vx::ops::ReduceMean>(axis, true)
+      ->BindInput(pow_out).BindOutput(mean1_out);
+  src_graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({mean1_out, src_graph->CreateTensor(scalar_spec, eps.data())})
+      .BindOutput(add0_out);
+  src_graph->CreateOperation<tim::vx::ops::Rsqrt>()
+      ->BindInput(add0_out).BindOutput(rsqrt_out);
+  src_graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({rsqrt_out, gamma}).BindOutput(mul0_out);
+  src_graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({input, mul0_out}).BindOutput(mul1_out);
+  src_graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({mean0_out, mul0_out}).BindOutput(mul2_out);
+  src_graph->CreateOperation<tim::vx::ops::Sub>()
+      ->BindInputs({beta, mul2_out}).BindOutput(sub1_out);
+  src_graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({mul1_out, sub1_out}).BindOutput(output);
+
+  auto transform = tim::transform::PatternFusion(src_graph, ctx);
+  auto fused_graph = transform.first;
+  auto graph_io_map = transform.second;
+  ASSERT_EQ(fused_graph->OpVector().size(), 1u);
+  EXPECT_TRUE(std::dynamic_pointer_cast<tim::vx::ops::LayerNormalization>(
+      fused_graph->OpVector()[0]));
+  EXPECT_TRUE(fused_graph->Compile());
+
+  std::vector<float> input_data = {1.0f, 2.0f, 3.0f, -4.0f, 0.0f, 4.0f};
+  graph_io_map[input]->CopyDataToTensor(input_data.data(),
+                                        input_data.size() * sizeof(float));
+  EXPECT_TRUE(fused_graph->Run());
+
+  std::vector<float> golden;
+  for (size_t row = 0; row < 2; row++) {
+    const float* x = input_data.data() + row * 3;
+    float mean = (x[0] + x[1] + x[2]) / 3;
+    float var = 0;
+    for (size_t i = 0; i < 3; i++) var += (x[i] - mean) * (x[i] - mean) / 3;
+    for (size_t i = 0; i < 3; i++) {
+      golden.push_back((x[i] - mean) / std::sqrt(var + eps[0]) * gamma_data[i] +
+                       beta_data[i]);
+    }
+  }
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(graph_io_map[output]->CopyDataFromTensor(out_data.data()));
+  EXPECT_THAT(out_data, ElementsAreArray(ArrayFloatNear(golden, 1e-3f)));
+}
@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/precision_sensitivity.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "op_impl.h"
+
+namespace tim {
+namespace transform {
+namespace precision_sensitivity_impl {
+
+using Outputs = std::vector<std::vector<float>>;
+
+// Operations CloneShared() keeps, in the same order in the clone
+std::vector<std::shared_ptr<vx::Operation>> BuiltinOps(
+    const std::shared_ptr<vx::Graph>& graph) {
+  std::vector<std::shared_ptr<vx::Operation>> ops;
+  for (const auto& op : graph->OpVector()) {
+    if (op->impl()->kind_ != -1 && op->impl()->node()) {
+      ops.push_back(op);
+    }
+  }
+  return ops;
+}
+
+// Run `graph` over every sample, FLOAT32 outputs are concatenated per sample
+bool RunSamples(const std::shared_ptr<vx::Graph>& graph,
+                const std::vector<CalibrationSample>& samples,
+                std::vector<Outputs>& results) {
+  auto inputs = graph->InputsTensor();
+  for (const auto& sample : samples) {
+    if (sample.size() != inputs.size()) {
+      VSILOGE("Precision sensitivity: sample has %d inputs, graph has %d.",
+              (int)sample.size(), (int)inputs.size());
+      return false;
+    }
+    for (size_t i = 0; i < inputs.size(); i++) {
+      inputs[i]->CopyDataToTensor(sample[i].data(),
+                                  sample[i].size() * sizeof(float));
+    }
+    if (!graph->Run()) {
+      return false;
+    }
+    Outputs outputs;
+    for (const auto& tensor : graph->OutputsTensor()) {
+      if (tensor->GetDataType() != vx::DataType::FLOAT32) continue;
+      std::vector<float> data(tensor->GetSpec().GetElementNum());
+      tensor->CopyDataFromTensor(data.data());
+      outputs.push_back(std::move(data));
+    }
+    results.push_back(std::move(outputs));
+  }
+  return true;
+}
+
+float MeanAbsError(const std::vector<Outputs>& golden,
+                   const std::vector<Outputs>& actual) {
+  double sum = 0;
+  size_t count = 0;
+  for (size_t s = 0; s < golden.size(); s++) {
+    for (size_t o = 0; o < golden[s].size(); o++) {
+      for (size_t i = 0; i < golden[s][o].size(); i++) {
+        sum += std::fabs(golden[s][o][i] - actual[s][o][i]);
+      }
+      count += golden[s][o].size();
+    }
+  }
+  return count ? (float)(sum / count) : 0.0f;
+}
+
+}  // namespace precision_sensitivity_impl
+
+std::vector<OpSensitivity> RankPrecisionSensitivity(
+    const std::shared_ptr<vx::Graph>& graph,
+    const std::vector<CalibrationSample>& samples,
+    vx::Precision precision, const std::vector<std::string>& kinds) {
+  using namespace precision_sensitivity_impl;
+  std::vector<OpSensitivity> ranking;
+
+  auto reference = graph->CloneShared();
+  reference->SetCompileOption(vx::CompileOption());
+  std::vector<Outputs> golden;
+  if (!RunSamples(reference, samples, golden)) {
+    VSILOGE("Precision sensitivity: FP32 reference run fail.");
+    return ranking;
+  }
+
+  auto src_ops = BuiltinOps(graph);
+  for (size_t i = 0; i < src_ops.size(); i++) {
+    const char* kind = vsi_nn_OpGetName(src_ops[i]->impl()->kind_);
+    if (!kind || kinds.end() == std::find(kinds.begin(), kinds.end(), kind)) {
+      continue;
+    }
+    auto trial = graph->CloneShared();
+    vx::CompileOption option;
+    option.setOpPrecisionByUid(BuiltinOps(trial)[i]->uid(), precision);
+    trial->SetCompileOption(option);
+    std::vector<Outputs> lowered;
+    if (!RunSamples(trial, samples, lowered)) {
+      VSILOGW("Precision sensitivity: op %u fail in lower precision.",
+              src_ops[i]->uid());
+      continue;
+    }
+    ranking.push_back({src_ops[i]->uid(), kind, MeanAbsError(golden, lowered)});
+  }
+
+  std::stable_sort(ranking.begin(), ranking.end(),
+                   [](const OpSensitivity& a, const OpSensitivity& b) {
+                     return a.error < b.error;
+                   });
+  return ranking;
+}
+
+}  // namespace transform
+}  // namespace tim
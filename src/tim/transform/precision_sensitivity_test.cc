@@ -0,0 +1,48 @@
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/precision_sensitivity.h"
+
+#include "gtest/gtest.h"
+
+TEST(PrecisionSensitivity, rank_two_fully_connected) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 1},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {2, 2},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec hidden_spec(tim::vx::DataType::FLOAT32, {2, 1},
+                                  tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {2, 1},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> weight0 = {1.0001f, 0.0003f, 2.0007f, 3.0009f};
+  std::vector<float> weight1 = {1, 2, 3, 4};
+  auto input = graph->CreateTensor(input_spec);
+  auto hidden = graph->CreateTensor(hidden_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto fc0 = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 2);
+  (*fc0)
+      .BindInputs({input, graph->CreateTensor(weight_spec, weight0.data())})
+      .BindOutput(hidden);
+  auto fc1 = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 2);
+  (*fc1)
+      .BindInputs({hidden, graph->CreateTensor(weight_spec, weight1.data())})
+      .BindOutput(output);
+
+  std::vector<tim::transform::CalibrationSample> samples = {{{100, 200}},
+                                                            {{300, 50}}};
+  auto ranking = tim::transform::RankPrecisionSensitivity(graph, samples);
+  ASSERT_EQ(2u, ranking.size());
+  EXPECT_EQ("FCL2", ranking[0].kind);
+  EXPECT_LE(0.0f, ranking[0].error);
+  EXPECT_LE(ranking[0].error, ranking[1].error);
+  EXPECT_NE(ranking[0].uid, ranking[1].uid);
+  for (const auto& entry : ranking) {
+    EXPECT_TRUE(fc0->uid() == entry.uid || fc1->uid() == entry.uid);
+  }
+
+  // The source graph is untouched by the trials
+  EXPECT_EQ(2u, graph->OpVector().size());
+}
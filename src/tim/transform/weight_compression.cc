@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/weight_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/ops/elementwise.h"
+#include "tim/vx/ops/reshape.h"
+#include "tim/vx/ops/simple_operations.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace transform {
+namespace weight_compression_impl {
+
+bool IsValid(const vx::ShapeType& shape,
+             const WeightCompressionOption& option) {
+  if (shape.size() != 2 || (option.bits != 4 && option.bits != 8) ||
+      option.axis > 1) {
+    return false;
+  }
+  uint32_t axis_size = shape[option.axis];
+  return axis_size > 0 && shape[1 - option.axis] > 0 &&
+         (option.group_size == 0 || axis_size % option.group_size == 0);
+}
+
+uint32_t GroupSize(const vx::ShapeType& shape,
+                   const WeightCompressionOption& option) {
+  return option.group_size == 0 ? shape[option.axis] : option.group_size;
+}
+
+// Shape of scales/zero points: `shape` with the axis size set to the group
+// count
+vx::ShapeType ScaleShape(const vx::ShapeType& shape,
+                         const WeightCompressionOption& option) {
+  vx::ShapeType scale_shape(shape);
+  scale_shape[option.axis] = shape[option.axis] / GroupSize(shape, option);
+  return scale_shape;
+}
+
+size_t ScaleIndex(size_t index, const vx::ShapeType& shape,
+                  const vx::ShapeType& scale_shape, uint32_t axis,
+                  uint32_t group_size) {
+  uint32_t coord[2] = {static_cast<uint32_t>(index % shape[0]),
+                       static_cast<uint32_t>(index / shape[0])};
+  coord[axis] /= group_size;
+  return coord[0] + static_cast<size_t>(coord[1]) * scale_shape[0];
+}
+
+vx::DataType StorageType(const WeightCompressionOption& option) {
+  if (option.bits == 4) {
+    return option.symmetric ? vx::DataType::INT4 : vx::DataType::UINT4;
+  }
+  return option.symmetric ? vx::DataType::INT8 : vx::DataType::UINT8;
+}
+
+// Same layout as vsi_nn_Pack4bitData: pairs along shape[0]
+std::vector<uint8_t> Pack4Bit(const std::vector<uint8_t>& values,
+                              uint32_t row) {
+  size_t rows = values.size() / row;
+  size_t packed_row = (row + 1) / 2;
+  std::vector<uint8_t> packed(rows * packed_row, 0);
+  for (size_t r = 0; r < rows; ++r) {
+    for (uint32_t i = 0; i < row; ++i) {
+      uint8_t nibble = values[r * row + i] & 0x0F;
+      packed[r * packed_row + i / 2] |= (i % 2) ? (nibble << 4) : nibble;
+    }
+  }
+  return packed;
+}
+
+std::vector<int32_t> Unpack(const CompressedWeight& weight) {
+  size_t count = weight.shape[0] * weight.shape[1];
+  std::vector<int32_t> values(count);
+  bool is_signed = weight.type == vx::DataType::INT4 ||
+                   weight.type == vx::DataType::INT8;
+  if (weight.option.bits == 8) {
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = is_signed ? static_cast<int8_t>(weight.data[i])
+                            : weight.data[i];
+    }
+    return values;
+  }
+  uint32_t row = weight.shape[0];
+  size_t packed_row = (row + 1) / 2;
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t byte = weight.data[(i / row) * packed_row + (i % row) / 2];
+    int32_t nibble = ((i % row) % 2) ? (byte >> 4) : (byte & 0x0F);
+    values[i] = (is_signed && nibble > 7) ? nibble - 16 : nibble;
+  }
+  return values;
+}
+
+std::shared_ptr<vx::Tensor> CreateScaleTensor(
+    const std::shared_ptr<vx::Graph>& graph, const vx::ShapeType& shape,
+    const std::vector<float>& values, vx::DataType float_type) {
+  vx::TensorSpec spec(float_type, shape, vx::TensorAttribute::CONSTANT);
+  if (float_type == vx::DataType::FLOAT16) {
+    std::vector<uint16_t> fp16(values.size());
+    std::transform(values.begin(), values.end(), fp16.begin(),
+                   [](float v) { return vsi_nn_Fp32ToFp16(v); });
+    return graph->CreateTensor(spec, fp16.data());
+  }
+  return graph->CreateTensor(spec, values.data());
+}
+
+}  // namespace weight_compression_impl
+
+using namespace weight_compression_impl;
+
+size_t CompressedWeight::ByteSize() const {
+  return data.size() + scales.size() * sizeof(float) +
+         zero_points.size() * sizeof(int32_t);
+}
+
+CompressedWeight CompressWeight(const float* weight,
+                                const vx::ShapeType& shape,
+                                const WeightCompressionOption& option) {
+  CompressedWeight result;
+  result.shape = shape;
+  result.option = option;
+  if (!weight || !IsValid(shape, option)) {
+    VSILOGE("Invalid weight for compression");
+    return result;
+  }
+  result.type = StorageType(option);
+  uint32_t group_size = GroupSize(shape, option);
+  auto scale_shape = ScaleShape(shape, option);
+  size_t count = shape[0] * shape[1];
+  size_t scale_count = scale_shape[0] * scale_shape[1];
+
+  // Ranges always include 0 so that zero weights stay exact
+  std::vector<float> min_value(scale_count, 0.0f);
+  std::vector<float> max_value(scale_count, 0.0f);
+  for (size_t i = 0; i < count; ++i) {
+    size_t s = ScaleIndex(i, shape, scale_shape, option.axis, group_size);
+    min_value[s] = std::min(min_value[s], weight[i]);
+    max_value[s] = std::max(max_value[s], weight[i]);
+  }
+
+  int32_t qmin, qmax;
+  if (option.symmetric) {
+    qmax = (1 << (option.bits - 1)) - 1;
+    qmin = -qmax - 1;
+  } else {
+    qmax = (1 << option.bits) - 1;
+    qmin = 0;
+  }
+  result.scales.resize(scale_count);
+  if (!option.symmetric) {
+    result.zero_points.resize(scale_count);
+  }
+  for (size_t s = 0; s < scale_count; ++s) {
+    float scale;
+    if (option.symmetric) {
+      scale = std::max(-min_value[s], max_value[s]) / qmax;
+    } else {
+      scale = (max_value[s] - min_value[s]) / qmax;
+    }
+    // All zero group
+    if (scale <= 0.0f) {
+      scale = 1.0f;
+    }
+    result.scales[s] = scale;
+    if (!option.symmetric) {
+      result.zero_points[s] =
+          std::min(qmax, std::max(qmin, static_cast<int32_t>(
+                                            std::round(-min_value[s] / scale))));
+    }
+  }
+
+  std::vector<uint8_t> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    size_t s = ScaleIndex(i, shape, scale_shape, option.axis, group_size);
+    int32_t zp = option.symmetric ? 0 : result.zero_points[s];
+    int32_t q =
+        static_cast<int32_t>(std::round(weight[i] / result.scales[s])) + zp;
+    values[i] = static_cast<uint8_t>(std::min(qmax, std::max(qmin, q)));
+  }
+  result.data = option.bits == 4 ? Pack4Bit(values, shape[0]) : values;
+  return result;
+}
+
+std::vector<float> DecompressWeight(const CompressedWeight& weight) {
+  if (weight.data.empty()) {
+    return {};
+  }
+  uint32_t group_size = GroupSize(weight.shape, weight.option);
+  auto scale_shape = ScaleShape(weight.shape, weight.option);
+  auto values = Unpack(weight);
+  std::vector<float> result(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    size_t s = ScaleIndex(i, weight.shape, scale_shape, weight.option.axis,
+                          group_size);
+    int32_t zp = weight.zero_points.empty() ? 0 : weight.zero_points[s];
+    result[i] = (values[i] - zp) * weight.scales[s];
+  }
+  return result;
+}
+
+std::shared_ptr<vx::Tensor> CreateCompressedWeight(
+    const std::shared_ptr<vx::Graph>& graph, const CompressedWeight& weight,
+    vx::DataType float_type) {
+  if (weight.data.empty() ||
+      (float_type != vx::DataType::FLOAT32 &&
+       float_type != vx::DataType::FLOAT16)) {
+    VSILOGE("Invalid compressed weight");
+    return nullptr;
+  }
+  const auto& shape = weight.shape;
+  const auto& option = weight.option;
+  uint32_t group_size = GroupSize(shape, option);
+  uint32_t groups = shape[option.axis] / group_size;
+
+  // One group per channel fits the per-channel quantization of the packed
+  // constant itself: the consumer dequantizes it on load next to its fp16
+  // input, nothing is expanded on device
+  if (float_type == vx::DataType::FLOAT16 && groups == 1) {
+    bool symmetric = weight.zero_points.empty();
+    vx::Quantization quant(
+        symmetric ? vx::QuantType::SYMMETRIC_PER_CHANNEL
+                  : vx::QuantType::ASYMMETRIC_PER_CHANNEL,
+        static_cast<int32_t>(1 - option.axis), weight.scales,
+        symmetric ? std::vector<int32_t>(weight.scales.size(), 0)
+                  : weight.zero_points);
+    vx::TensorSpec spec(weight.type, shape, vx::TensorAttribute::CONSTANT,
+                        quant);
+    return graph->CreateTensor(spec, weight.data.data());
+  }
+
+  // Stored as raw integers, 4-bit data stays packed in the constant
+  vx::TensorSpec q_spec(weight.type, shape, vx::TensorAttribute::CONSTANT,
+                        vx::Quantization(vx::QuantType::ASYMMETRIC, 1.0f, 0));
+  auto q = graph->CreateTensor(q_spec, weight.data.data());
+
+  // Widen to uint8 first, the only target 4-bit data can be converted to;
+  // signed values are offset by 128 to stay in range
+  int32_t offset = option.symmetric ? 128 : 0;
+  auto u8 = q;
+  if (weight.type != vx::DataType::UINT8) {
+    vx::TensorSpec u8_spec(
+        vx::DataType::UINT8, shape, vx::TensorAttribute::TRANSIENT,
+        vx::Quantization(vx::QuantType::ASYMMETRIC, 1.0f, offset));
+    u8 = graph->CreateTensor(u8_spec);
+    graph->CreateOperation<vx::ops::DataConvert>()->BindInput(q).BindOutput(
+        u8);
+  }
+
+  // Group-wise dequantization: split the axis into {group_size, groups} and
+  // broadcast one scale (and zero point) per group and channel
+  vx::ShapeType grouped_shape(shape);
+  if (groups > 1) {
+    grouped_shape.insert(grouped_shape.begin() + option.axis + 1, groups);
+    grouped_shape[option.axis] = group_size;
+  }
+  vx::ShapeType scale_shape(grouped_shape);
+  scale_shape[option.axis] = 1;
+
+  vx::TensorSpec float_spec(float_type, grouped_shape,
+                            vx::TensorAttribute::TRANSIENT);
+  auto values = graph->CreateTensor(float_spec);
+  auto value_src = u8;
+  if (groups > 1) {
+    vx::TensorSpec u8_spec(u8->GetSpec());
+    u8_spec.SetShape(grouped_shape);
+    u8_spec.SetAttribute(vx::TensorAttribute::TRANSIENT);
+    value_src = graph->CreateTensor(u8_spec);
+    graph->CreateOperation<vx::ops::Reshape>(grouped_shape)
+        ->BindInput(u8)
+        .BindOutput(value_src);
+  }
+  graph->CreateOperation<vx::ops::DataConvert>()
+      ->BindInput(value_src)
+      .BindOutput(values);
+
+  if (!weight.zero_points.empty()) {
+    std::vector<float> neg_zp(weight.zero_points.begin(),
+                              weight.zero_points.end());
+    std::transform(neg_zp.begin(), neg_zp.end(), neg_zp.begin(),
+                   [](float zp) { return -zp; });
+    auto zp = CreateScaleTensor(graph, scale_shape, neg_zp, float_type);
+    auto shifted = graph->CreateTensor(float_spec);
+    graph->CreateOperation<vx::ops::Add>()
+        ->BindInputs({values, zp})
+        .BindOutput(shifted);
+    values = shifted;
+  }
+  auto scales = CreateScaleTensor(graph, scale_shape, weight.scales, float_type);
+  auto scaled = graph->CreateTensor(float_spec);
+  graph->CreateOperation<vx::ops::Multiply>()
+      ->BindInputs({values, scales})
+      .BindOutput(scaled);
+
+  if (groups == 1) {
+    return scaled;
+  }
+  auto output = graph->CreateTensor(
+      vx::TensorSpec(float_type, shape, vx::TensorAttribute::TRANSIENT));
+  graph->CreateOperation<vx::ops::Reshape>(shape)->BindInput(scaled).BindOutput(
+      output);
+  return output;
+}
+
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,200 @@
+#include <cmath>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/weight_compression.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<float> Wave(size_t size, float amplitude) {
+  std::vector<float> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = amplitude * std::sin(0.37f * i) * (1 + (i % 5));
+  }
+  return data;
+}
+
+// FullyConnected over a compressed weight of shape {in, out}
+void RunFullyConnected(const tim::transform::CompressedWeight& weight,
+                       const std::vector<float>& in_data, uint32_t batch,
+                       std::vector<float>& out_data) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  uint32_t in = weight.shape[0];
+  uint32_t out = weight.shape[1];
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {in, batch},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {out, batch},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto fc_weight = tim::transform::CreateCompressedWeight(graph, weight);
+  EXPECT_TRUE(fc_weight);
+  auto fc = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, out);
+  (*fc).BindInputs({input, fc_weight}).BindOutput(output);
+
+  EXPECT_TRUE(graph->Compile());
+  EXPECT_TRUE(input->CopyDataToTensor(in_data.data(),
+                                      in_data.size() * sizeof(float)));
+  EXPECT_TRUE(graph->Run());
+  out_data.resize(out * batch);
+  EXPECT_TRUE(output->CopyDataFromTensor(out_data.data()));
+}
+
+std::vector<float> FullyConnectedGolden(const std::vector<float>& weight,
+                                        const std::vector<float>& input,
+                                        uint32_t in, uint32_t out,
+                                        uint32_t batch) {
+  std::vector<float> golden(out * batch, 0.0f);
+  for (uint32_t b = 0; b < batch; b++) {
+    for (uint32_t o = 0; o < out; o++) {
+      for (uint32_t i = 0; i < in; i++) {
+        golden[b * out + o] += input[b * in + i] * weight[o * in + i];
+      }
+    }
+  }
+  return golden;
+}
+
+}  // namespace
+
+TEST(WeightCompression, group_int4_round_trip) {
+  // {in, out} = {8, 3}, two groups of 4 along in
+  std::vector<float> weight = {
+      0.7, -0.1, 0.3, 0.0,   8, -4, 2, 1,
+      -1,  1,    0.5, -0.5,  0, 0, 0, 0,
+      3,   2,    1,   0,     -0.25, 0.5, 0.125, 0.0625};
+  tim::transform::WeightCompressionOption option;
+  option.group_size = 4;
+  auto compressed = tim::transform::CompressWeight(weight.data(), {8, 3},
+                                                   option);
+
+  EXPECT_EQ(tim::vx::DataType::INT4, compressed.type);
+  // Two 4-bit values per byte, one scale per group and channel
+  EXPECT_EQ(12u, compressed.data.size());
+  EXPECT_EQ(6u, compressed.scales.size());
+  EXPECT_TRUE(compressed.zero_points.empty());
+  EXPECT_FLOAT_EQ(0.1f, compressed.scales[0]);
+  EXPECT_FLOAT_EQ(8.0f / 7, compressed.scales[1]);
+  // All zero group keeps a valid scale
+  EXPECT_FLOAT_EQ(1.0f, compressed.scales[3]);
+  // Low nibble first: 7 and -1
+  EXPECT_EQ(0xF7, compressed.data[0]);
+
+  auto restored = tim::transform::DecompressWeight(compressed);
+  ASSERT_EQ(weight.size(), restored.size());
+  for (size_t i = 0; i < weight.size(); i++) {
+    size_t scale_index = (i / 8) * 2 + (i % 8) / 4;
+    EXPECT_NEAR(weight[i], restored[i],
+                compressed.scales[scale_index] * 0.501f)
+        << "index " << i;
+  }
+}
+
+TEST(WeightCompression, asymmetric_matmul_axis) {
+  // Matmul weight {N, K} = {2, 4}, groups of 2 along K
+  std::vector<float> weight = {1, 2, 3, 4, 5, 6, 7, 8};
+  tim::transform::WeightCompressionOption option;
+  option.group_size = 2;
+  option.axis = 1;
+  option.symmetric = false;
+  auto compressed = tim::transform::CompressWeight(weight.data(), {2, 4},
+                                                   option);
+
+  EXPECT_EQ(tim::vx::DataType::UINT4, compressed.type);
+  EXPECT_EQ(4u, compressed.data.size());
+  ASSERT_EQ(4u, compressed.scales.size());
+  EXPECT_EQ(4u, compressed.zero_points.size());
+  // Group {2, 4}: column N = 1, K in [0, 2), range [0, 4]
+  EXPECT_FLOAT_EQ(4.0f / 15, compressed.scales[1]);
+  EXPECT_EQ(0, compressed.zero_points[1]);
+
+  auto restored = tim::transform::DecompressWeight(compressed);
+  for (size_t i = 0; i < weight.size(); i++) {
+    size_t scale_index = (i % 2) + ((i / 2) / 2) * 2;
+    EXPECT_NEAR(weight[i], restored[i],
+                compressed.scales[scale_index] * 0.501f)
+        << "index " << i;
+  }
+}
+
+TEST(WeightCompression, invalid_group_size) {
+  std::vector<float> weight(12, 1.0f);
+  tim::transform::WeightCompressionOption option;
+  option.group_size = 5;
+  auto compressed = tim::transform::CompressWeight(weight.data(), {6, 2},
+                                                   option);
+  EXPECT_TRUE(compressed.data.empty());
+
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  EXPECT_FALSE(tim::transform::CreateCompressedWeight(graph, compressed));
+}
+
+TEST(WeightCompression, fully_connected_group_int4) {
+  const uint32_t in = 16, out = 4, batch = 2;
+  auto weight = Wave(in * out, 0.2f);
+  auto input = Wave(in * batch, 1.0f);
+  tim::transform::WeightCompressionOption option;
+  option.group_size = 8;
+  auto compressed =
+      tim::transform::CompressWeight(weight.data(), {in, out}, option);
+
+  std::vector<float> output;
+  RunFullyConnected(compressed, input, batch, output);
+  auto golden = FullyConnectedGolden(tim::transform::DecompressWeight(compressed),
+                                     input, in, out, batch);
+  EXPECT_TRUE(ArraysMatch(golden, output, 1e-3f));
+}
+
+TEST(WeightCompression, per_channel_fp16_stays_packed) {
+  const uint32_t in = 16, out = 4;
+  auto weight = Wave(in * out, 0.2f);
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::transform::WeightCompressionOption option;
+  option.symmetric = false;
+  auto per_channel =
+      tim::transform::CompressWeight(weight.data(), {in, out}, option);
+  auto packed = tim::transform::CreateCompressedWeight(
+      graph, per_channel, tim::vx::DataType::FLOAT16);
+  ASSERT_TRUE(packed);
+  EXPECT_EQ(tim::vx::DataType::UINT4, packed->GetDataType());
+  const auto& quant = packed->GetQuantization();
+  EXPECT_EQ(tim::vx::QuantType::ASYMMETRIC_PER_CHANNEL, quant.Type());
+  EXPECT_EQ(1, quant.ChannelDim());
+  EXPECT_EQ(per_channel.scales, quant.Scales());
+  EXPECT_EQ(per_channel.zero_points, quant.ZeroPoints());
+  EXPECT_EQ(tim::vx::ShapeType({in, out}), packed->GetShape());
+
+  // Group-wise scales need the expansion on device
+  option.group_size = 8;
+  auto grouped =
+      tim::transform::CompressWeight(weight.data(), {in, out}, option);
+  auto expanded = tim::transform::CreateCompressedWeight(
+      graph, grouped, tim::vx::DataType::FLOAT16);
+  ASSERT_TRUE(expanded);
+  EXPECT_EQ(tim::vx::DataType::FLOAT16, expanded->GetDataType());
+  EXPECT_EQ(tim::vx::ShapeType({in, out}), expanded->GetShape());
+}
+
+TEST(WeightCompression, byte_size) {
+  const uint32_t in = 256, out = 4;
+  auto weight = Wave(in * out, 0.05f);
+  for (uint32_t bits : {8u, 4u}) {
+    tim::transform::WeightCompressionOption option;
+    option.bits = bits;
+    option.group_size = 128;
+    auto compressed =
+        tim::transform::CompressWeight(weight.data(), {in, out}, option);
+    // data plus one fp32 scale per 128 weights
+    EXPECT_EQ(in * out * bits / 8 + in * out / 128 * sizeof(float),
+              compressed.ByteSize())
+        << bits << " bits";
+  }
+}
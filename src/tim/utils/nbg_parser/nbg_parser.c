@@ -30,6 +30,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /* Some functions, depends on runtime system, need to be modified on RTOS or DSP */
 
 #define nbg_printf   printf
@@ -72,63 +81,111 @@ static nbg_char_t* nbg_strcpy(nbg_char_t *dst, const nbg_char_t *src)
     return dst;
 }
 
-/*********************** NBG parser internal functions ***********/
-
-#define OLD_NBG_FORMAT_DIMS_NUM     4
-static vip_int8_t read_byte(nbg_reader_t *reader)
+static void* nbg_map_file(const nbg_char_t *path, vip_uint64_t *size)
 {
-    vip_int8_t data = 0;
-    if (reader->offset <= reader->total_size) {
-        data = *((vip_int8_t *)reader->current_data);
-
-        reader->offset += sizeof(vip_int8_t);
-        reader->current_data += sizeof(vip_int8_t);
+    void *base = NBG_NULL;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NBG_NULL;
+    LARGE_INTEGER file_size;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NBG_NULL, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, NBG_NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NBG_NULL;
     }
-    else {
-        nbg_printf("fail to read nbg data, out of buffer, offset=%d, total size=%d\n",
-                    reader->offset, reader->total_size);
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NBG_NULL, PAGE_READONLY, 0, 0, NBG_NULL);
+        if (mapping != NBG_NULL) {
+            /* The view keeps the mapping object alive. */
+            base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            *size = (vip_uint64_t)file_size.QuadPart;
+        }
     }
+    CloseHandle(file);
+#else
+    struct stat st;
+    int fd = open(path, O_RDONLY);
 
-    return data;
+    if (fd < 0) {
+        return NBG_NULL;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        base = mmap(NBG_NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            base = NBG_NULL;
+        }
+        else {
+            *size = (vip_uint64_t)st.st_size;
+        }
+    }
+    close(fd);
+#endif
+    return base;
 }
 
-static vip_uint32_t read_uInt(nbg_reader_t *reader)
+static void nbg_unmap_file(void *base, vip_uint64_t size)
 {
-    vip_uint32_t data = 0;
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, (size_t)size);
+#endif
+}
 
-    if (reader->offset <= reader->total_size) {
-        data = *((vip_uint32_t *)reader->current_data);
+/*********************** NBG parser internal functions ***********/
 
-        reader->offset += sizeof(vip_uint32_t);
-        reader->current_data += sizeof(vip_uint32_t);
-    }
-    else {
+#define OLD_NBG_FORMAT_DIMS_NUM     4
+static vip_uint32_t reader_check(nbg_reader_t *reader, vip_uint32_t size)
+{
+    if ((vip_uint64_t)reader->offset + size > reader->total_size) {
         nbg_printf("fail to read nbg data, out of buffer, offset=%d, total size=%d\n",
                     reader->offset, reader->total_size);
+        reader->error = 1;
+        return 0;
     }
 
-    return data;
+    return 1;
 }
 
 static nbg_status_e read_data(nbg_reader_t *reader, void *dst, vip_uint32_t size)
 {
     nbg_status_e status = NBG_SUCCESS;
 
-    if (reader->offset <= reader->total_size) {
+    if (reader_check(reader, size)) {
         nbg_memcpy(dst, reader->current_data, size);
 
         reader->offset += size;
         reader->current_data += size;
     }
     else {
-        nbg_printf("fail to read nbg data, out of buffer, offset=%d, total size=%d\n",
-                    reader->offset, reader->total_size);
         status = NBG_ERROR_FAILURE;
     }
 
     return status;
 }
 
+static vip_int8_t read_byte(nbg_reader_t *reader)
+{
+    vip_int8_t data = 0;
+
+    read_data(reader, &data, sizeof(data));
+
+    return data;
+}
+
+static vip_uint32_t read_uInt(nbg_reader_t *reader)
+{
+    vip_uint32_t data = 0;
+
+    /* NBG data is not guaranteed to be 4 bytes aligned, copy instead of deref. */
+    read_data(reader, &data, sizeof(data));
+
+    return data;
+}
+
 static nbg_status_e reader_locate(
     nbg_reader_t *reader,
     vip_uint32_t location
@@ -209,6 +266,20 @@ static nbg_status_e  read_bin_entry(nbg_reader_t *reader, gcvip_bin_entry_t *ent
     return status;
 }
 
+static vip_uint32_t get_io_entry_size(vip_uint32_t version)
+{
+    vip_uint32_t size = sizeof(gcvip_bin_inout_entry_t);
+
+    if (version < 0x0001000B) {
+        size -= (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM) * sizeof(vip_uint32_t);
+    }
+    if (version < 0x00010004) {
+        size -= sizeof(vip_char_t) * MAX_IO_NAME_LEGTH;
+    }
+
+    return size;
+}
+
 static nbg_status_e read_nbg_dyn_data(nbg_parser_data_t *nbg)
 {
     nbg_status_e status = NBG_SUCCESS;
@@ -226,21 +297,7 @@ static nbg_status_e read_nbg_dyn_data(nbg_parser_data_t *nbg)
         reader_locate(reader, nbg->fixed.input_table.offset);
         read_data(reader, nbg->inputs, nbg->fixed.input_table.size);
 
-        if (nbg->fixed.header.version >= 0x0001000B) {
-            nbg->n_inputs = nbg->fixed.input_table.size / sizeof(gcvip_bin_inout_entry_t);
-        }
-        else if ((nbg->fixed.header.version >= 0x00010004) &&
-                 (nbg->fixed.header.version < 0x0001000B)) {
-            nbg_uint32_t size = 0;
-            size = sizeof(gcvip_bin_inout_entry_t) - (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM) * sizeof(nbg_uint32_t);
-            nbg->n_inputs = nbg->fixed.input_table.size / size;
-        }
-        else {
-            nbg_uint32_t size = 0;
-            size = (sizeof(gcvip_bin_inout_entry_t) - sizeof(vip_char_t) * MAX_IO_NAME_LEGTH -
-                                (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM) * sizeof(nbg_uint32_t));
-            nbg->n_inputs = nbg->fixed.input_table.size / size;
-        }
+        nbg->n_inputs = nbg->fixed.input_table.size / nbg->io_entry_size;
     }
 
     /* read output data */
@@ -255,21 +312,7 @@ static nbg_status_e read_nbg_dyn_data(nbg_parser_data_t *nbg)
         reader_locate(reader, nbg->fixed.output_table.offset);
         read_data(reader, nbg->outputs, nbg->fixed.output_table.size);
 
-        if (nbg->fixed.header.version >= 0x0001000B) {
-            nbg->n_outputs = nbg->fixed.output_table.size / sizeof(gcvip_bin_inout_entry_t);
-        }
-        else if ((nbg->fixed.header.version >= 0x00010004) &&
-                 (nbg->fixed.header.version < 0x0001000B)) {
-            nbg_uint32_t size = 0;
-            size = sizeof(gcvip_bin_inout_entry_t) - (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM) * sizeof(nbg_uint32_t);
-            nbg->n_outputs = nbg->fixed.output_table.size / size;
-        }
-        else {
-            nbg_uint32_t size = 0;
-            size = sizeof(gcvip_bin_inout_entry_t) - sizeof(vip_char_t) * MAX_IO_NAME_LEGTH -
-                                (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM) * sizeof(nbg_uint32_t);
-            nbg->n_outputs = nbg->fixed.output_table.size / size;
-        }
+        nbg->n_outputs = nbg->fixed.output_table.size / nbg->io_entry_size;
     }
 
     /* read layer data */
@@ -543,6 +586,67 @@ static nbg_status_e read_nbg_fix_data(nbg_parser_data_t *nbg)
         nbg->fixed.ppu_param_table.size = 0;
     }
 
+    if (reader->error) {
+        nbg_printf("NBG fixed section is truncated\n");
+        goOnError(NBG_ERROR_FORMAT);
+    }
+
+    nbg->io_entry_size = get_io_entry_size(nbg->fixed.header.version);
+
+onError:
+    return status;
+}
+
+/* Index input/output descriptors in place, no other dynamic section is read. */
+static nbg_status_e index_nbg_io_data(nbg_parser_data_t *nbg)
+{
+    nbg_status_e status = NBG_SUCCESS;
+    nbg_reader_t *reader = &nbg->reader;
+    gcvip_bin_entry_t *tables[2];
+    gcvip_bin_inout_entry_t **entries[2];
+    vip_uint32_t *counts[2];
+    vip_uint32_t i = 0;
+
+    tables[0] = &nbg->fixed.input_table;
+    tables[1] = &nbg->fixed.output_table;
+    entries[0] = &nbg->inputs;
+    entries[1] = &nbg->outputs;
+    counts[0] = &nbg->n_inputs;
+    counts[1] = &nbg->n_outputs;
+
+    nbg->io_borrowed = 1;
+    for (i = 0; i < 2; i++) {
+        if ((vip_uint64_t)tables[i]->offset + tables[i]->size > reader->total_size) {
+            nbg_printf("input/output table out of buffer, offset=%d, size=%d, total size=%d\n",
+                       tables[i]->offset, tables[i]->size, reader->total_size);
+            goOnError(NBG_ERROR_FORMAT);
+        }
+        if (((vip_address_t)(reader->data + tables[i]->offset) & 0x3) != 0) {
+            /* Descriptors are read as 32bit fields, fall back to copy if misaligned. */
+            nbg->io_borrowed = 0;
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        *counts[i] = tables[i]->size / nbg->io_entry_size;
+        if (tables[i]->size == 0) {
+            continue;
+        }
+
+        if (nbg->io_borrowed) {
+            *entries[i] = (gcvip_bin_inout_entry_t *)(reader->data + tables[i]->offset);
+        }
+        else {
+            *entries[i] = (gcvip_bin_inout_entry_t *)nbg_malloc(tables[i]->size);
+            if (*entries[i] == NBG_NULL) {
+                nbg_printf("failed to malloc memory for inputs/outputs\n");
+                goOnError(NBG_ERROR_OUT_OF_MEMORY);
+            }
+            reader_locate(reader, tables[i]->offset);
+            read_data(reader, *entries[i], tables[i]->size);
+        }
+    }
+
 onError:
     return status;
 }
@@ -550,27 +654,15 @@ onError:
 static void *get_io_ptr_by_index(
     nbg_parser_data_t *nbg,
     gcvip_bin_inout_entry_t *io_ptr,
-    vip_int32_t index
+    vip_uint32_t count,
+    vip_uint32_t index
 )
 {
-    void *ptr_io = NBG_NULL;
-    vip_uint32_t size_04 = 0, size_0B = 0;
-
-    size_04 = sizeof(gcvip_bin_inout_entry_t) - sizeof(vip_int8_t) * MAX_IO_NAME_LEGTH -
-              sizeof (vip_uint32_t) * (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM);
-    size_0B = sizeof(gcvip_bin_inout_entry_t) - sizeof (vip_uint32_t) * (MAX_NUM_DIMS - OLD_NBG_FORMAT_DIMS_NUM);
-
-    if (nbg->fixed.header.version >= 0x0001000B) {
-        ptr_io = (void *)(io_ptr + index);
-    }
-    else if ((nbg->fixed.header.version >= 0x00010004) && (nbg->fixed.header.version < 0x0001000B)) {
-         ptr_io = (void *)((vip_int8_t *)io_ptr + index * size_0B);
-    }
-    else {
-        ptr_io = (void *)((vip_int8_t *)io_ptr + index * size_04);
+    if ((io_ptr == NBG_NULL) || (index >= count)) {
+        return NBG_NULL;
     }
 
-    return ptr_io;
+    return (void *)((vip_uint8_t *)io_ptr + index * nbg->io_entry_size);
 }
 
 static nbg_status_e query_input_output(
@@ -876,10 +968,33 @@ nbg_uint32_t nbg_parser_version(void)
 @param, nbg_t*, the nbg object created by NBG data.
 */
 nbg_status_e nbg_parser_init(void *buffer, nbg_uint32_t size, nbg_parser_data *nbg)
+{
+    return nbg_parser_init_ex(buffer, size, NBG_PARSER_FLAG_NONE, nbg);
+}
+
+/*
+@brief, Initialize NBG parser with nbg_parser_flag_e flags.
+@param, buffer. a pointer to the start of the NBG data
+@param size, the size of NBG data.
+@param flags, bitwise OR of nbg_parser_flag_e.
+@param, nbg_t*, the nbg object created by NBG data.
+*/
+nbg_status_e nbg_parser_init_ex(
+    void *buffer,
+    nbg_uint32_t size,
+    nbg_uint32_t flags,
+    nbg_parser_data *nbg
+    )
 {
     nbg_parser_data_t *nbg_data = NBG_NULL;
     nbg_status_e status = NBG_SUCCESS;
 
+    if ((buffer == NBG_NULL) || (nbg == NBG_NULL)) {
+        nbg_printf("failed to init nbg parser, parameter is NULL, buffer=%p, nbg=%p\n",
+                   buffer, (void *)nbg);
+        return NBG_ERROR_INVALID_ARGUMENTS;
+    }
+
     nbg_data = (nbg_parser_data_t *)nbg_malloc(sizeof(nbg_parser_data_t));
     if (nbg_data != NBG_NULL) {
         nbg_memset(nbg_data, sizeof(nbg_parser_data_t));
@@ -887,6 +1002,7 @@ nbg_status_e nbg_parser_init(void *buffer, nbg_uint32_t size, nbg_parser_data *n
         nbg_data->reader.data = (vip_uint8_t*)buffer;
         nbg_data->reader.total_size = size;
         nbg_data->reader.offset = 0;
+        nbg_data->flags = flags;
 
         status  = read_nbg_fix_data(nbg_data);
         if (status != NBG_SUCCESS) {
@@ -894,7 +1010,15 @@ nbg_status_e nbg_parser_init(void *buffer, nbg_uint32_t size, nbg_parser_data *n
             goOnError(status);
         }
 
-        status = read_nbg_dyn_data(nbg_data);
+        if (flags & NBG_PARSER_FLAG_LAZY) {
+            status = index_nbg_io_data(nbg_data);
+        }
+        else {
+            status = read_nbg_dyn_data(nbg_data);
+            if ((status == NBG_SUCCESS) && nbg_data->reader.error) {
+                status = NBG_ERROR_FORMAT;
+            }
+        }
         if (status != NBG_SUCCESS) {
             nbg_printf("failed to read dynmic section data\n");
             goOnError(status);
@@ -902,14 +1026,64 @@ nbg_status_e nbg_parser_init(void *buffer, nbg_uint32_t size, nbg_parser_data *n
     }
     else {
         nbg_printf("failed to malloc memory for nbg object\n");
-        goOnError(status);
+        goOnError(NBG_ERROR_OUT_OF_MEMORY);
     }
 
-    if (nbg != NBG_NULL) {
-        *nbg = (nbg_parser_data)nbg_data;
-    }
+    *nbg = (nbg_parser_data)nbg_data;
+    return status;
 
 onError:
+    if (nbg_data != NBG_NULL) {
+        nbg_parser_destroy((nbg_parser_data)nbg_data);
+    }
+    *nbg = NBG_NULL;
+    return status;
+}
+
+/*
+@brief, Map NBG file and initialize NBG parser on the mapping.
+@param path, NBG file path.
+@param flags, bitwise OR of nbg_parser_flag_e, NBG_PARSER_FLAG_LAZY is implied.
+@param, nbg_t*, the nbg object created by NBG data.
+*/
+nbg_status_e nbg_parser_open(
+    const nbg_char_t *path,
+    nbg_uint32_t flags,
+    nbg_parser_data *nbg
+    )
+{
+    nbg_status_e status = NBG_SUCCESS;
+    nbg_parser_data_t *nbg_data = NBG_NULL;
+    vip_uint64_t map_size = 0;
+    void *map_base = NBG_NULL;
+
+    if ((path == NBG_NULL) || (nbg == NBG_NULL)) {
+        nbg_printf("failed to open nbg, parameter is NULL\n");
+        return NBG_ERROR_INVALID_ARGUMENTS;
+    }
+
+    map_base = nbg_map_file(path, &map_size);
+    if (map_base == NBG_NULL) {
+        nbg_printf("failed to map nbg file %s\n", path);
+        return NBG_ERROR_FAILURE;
+    }
+    if (map_size > 0xFFFFFFFFULL) {
+        nbg_printf("nbg file %s is too large\n", path);
+        nbg_unmap_file(map_base, map_size);
+        return NBG_ERROR_NOT_SUPPORT;
+    }
+
+    status = nbg_parser_init_ex(map_base, (nbg_uint32_t)map_size,
+                                flags | NBG_PARSER_FLAG_LAZY, nbg);
+    if (status != NBG_SUCCESS) {
+        nbg_unmap_file(map_base, map_size);
+        return status;
+    }
+
+    nbg_data = (nbg_parser_data_t *)*nbg;
+    nbg_data->map_base = map_base;
+    nbg_data->map_size = map_size;
+
     return status;
 }
 
@@ -942,7 +1116,8 @@ nbg_status_e nbg_parser_query_input(
         return NBG_ERROR_FAILURE;
     }
 
-    input = (gcvip_bin_inout_entry_t *)get_io_ptr_by_index(nbg_data, nbg_data->inputs, index);
+    input = (gcvip_bin_inout_entry_t *)get_io_ptr_by_index(nbg_data, nbg_data->inputs,
+                                                            nbg_data->n_inputs, index);
 
     status = query_input_output(nbg, input, property, value, size);
     if (status != NBG_SUCCESS) {
@@ -981,7 +1156,8 @@ nbg_status_e nbg_parser_query_output(
         return NBG_ERROR_FAILURE;
     }
 
-    output = (gcvip_bin_inout_entry_t *)get_io_ptr_by_index(nbg_data, nbg_data->outputs, index);
+    output = (gcvip_bin_inout_entry_t *)get_io_ptr_by_index(nbg_data, nbg_data->outputs,
+                                                             nbg_data->n_outputs, index);
 
     status = query_input_output(nbg, output, property, value, size);
     if (status != NBG_SUCCESS) {
@@ -1098,6 +1274,10 @@ nbg_status_e nbg_parser_destroy(
         nbg_data->reader.total_size = 0;
         nbg_data->reader.offset = 0;
 
+        if (nbg_data->io_borrowed) {
+            nbg_data->inputs = NBG_NULL;
+            nbg_data->outputs = NBG_NULL;
+        }
         if (nbg_data->inputs != NBG_NULL) {
             nbg_free(nbg_data->inputs);
             nbg_data->inputs = NBG_NULL;
@@ -1146,6 +1326,10 @@ nbg_status_e nbg_parser_destroy(
             nbg_free(nbg_data->LCD);
             nbg_data->LCD = NBG_NULL;
         }
+        if (nbg_data->map_base != NBG_NULL) {
+            nbg_unmap_file(nbg_data->map_base, nbg_data->map_size);
+            nbg_data->map_base = NBG_NULL;
+        }
 
         nbg_free(nbg);
     }
@@ -0,0 +1,276 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tim/utils/nbg_parser/nbg_parser.h"
+#include "tim/utils/nbg_parser/gc_vip_nbg_format.h"
+
+namespace {
+
+// Newest NBG_FORMAT_VERSION the parser reads, nbg_parser_impl.h is C only.
+const vip_uint32_t kNbgVersion = 0x00010014;
+
+// A synthetic NBG with two inputs, one output, one layer and a LCD blob.
+// `pad` shifts the dynamic section so the I/O tables are misaligned.
+struct TestNbg {
+  explicit TestNbg(size_t pad = 0) {
+    gcvip_bin_inout_entry_t io[3];
+    memset(io, 0, sizeof(io));
+    const char* names[] = {"data", "weight_scale", "prob"};
+    for (vip_uint32_t i = 0; i < 3; i++) {
+      io[i].dim_count = 4;
+      for (vip_uint32_t d = 0; d < 4; d++) {
+        io[i].dim_size[d] = 1 + i + d * 3;
+      }
+      io[i].data_format = NBG_BUFFER_FORMAT_UINT8;
+      io[i].data_type = NBG_BUFFER_TYPE_TENSOR;
+      io[i].quan_format = NBG_BUFFER_QUANTIZE_AFFINE_ASYMMETRIC;
+      io[i].tf_scale = 0.5f / (i + 1);
+      io[i].tf_zerop = 128 - i;
+      strncpy(io[i].name, names[i], sizeof(io[i].name) - 1);
+    }
+    gcvip_bin_layer_t layer;
+    memset(&layer, 0, sizeof(layer));
+    strncpy(layer.name, "conv", sizeof(layer.name) - 1);
+
+    // Header, pool, sram and 16 entry tables.
+    const size_t fixed_size =
+        4 + 4 * 6 + NETWORK_NAME_SIZE + sizeof(gcvip_bin_feature_database_t) +
+        4 * 7 + 16 * sizeof(gcvip_bin_entry_t);
+    input_offset = fixed_size + pad;
+    output_offset = input_offset + 2 * sizeof(gcvip_bin_inout_entry_t);
+    const size_t layer_offset = output_offset + sizeof(gcvip_bin_inout_entry_t);
+    lcd_offset = layer_offset + sizeof(layer);
+    const size_t lcd_size = 4096;
+
+    Append("VPMN", 4);
+    AppendU32(kNbgVersion);
+    AppendU32(0xBA);
+    char name[NETWORK_NAME_SIZE] = "synthetic";
+    Append(name, sizeof(name));
+    AppendU32(1);  // layer_count
+    AppendU32(1);  // operation_count
+    AppendU32(2);  // input_count
+    AppendU32(1);  // output_count
+    gcvip_bin_feature_database_t feature_db;
+    memset(&feature_db, 0, sizeof(feature_db));
+    Append(&feature_db, sizeof(feature_db));
+    for (int i = 0; i < 7; i++) {
+      AppendU32(0);  // pool, axi sram, vip sram
+    }
+    AppendEntry(input_offset, 2 * sizeof(gcvip_bin_inout_entry_t));
+    AppendEntry(output_offset, sizeof(gcvip_bin_inout_entry_t));
+    AppendEntry(layer_offset, sizeof(layer));
+    AppendEntry(0, 0);  // operation
+    AppendEntry(0, 0);  // LCD table
+    AppendEntry(lcd_offset, lcd_size);
+    for (int i = 0; i < 10; i++) {
+      AppendEntry(0, 0);
+    }
+    EXPECT_EQ(fixed_size, data.size());
+
+    data.resize(input_offset, 0);
+    Append(io, sizeof(io));
+    Append(&layer, sizeof(layer));
+    data.resize(lcd_offset + lcd_size, 0x5A);
+  }
+
+  void Append(const void* src, size_t size) {
+    const char* bytes = static_cast<const char*>(src);
+    data.insert(data.end(), bytes, bytes + size);
+  }
+  void AppendU32(vip_uint32_t value) { Append(&value, sizeof(value)); }
+  void AppendEntry(size_t offset, size_t size) {
+    AppendU32(static_cast<vip_uint32_t>(offset));
+    AppendU32(static_cast<vip_uint32_t>(size));
+  }
+
+  std::vector<char> data;
+  size_t input_offset;
+  size_t output_offset;
+  size_t lcd_offset;
+};
+
+typedef nbg_status_e (*QueryIo)(nbg_parser_data, nbg_uint32_t, nbg_uint32_t,
+                                void*, nbg_uint32_t);
+
+// Every property a runner reads from one input or output, as text.
+std::string DumpIo(nbg_parser_data nbg, QueryIo query, nbg_uint32_t index) {
+  const nbg_uint32_t props[] = {NBG_PARSER_BUFFER_PROP_QUANT_FORMAT,
+                                NBG_PARSER_BUFFER_PROP_DATA_FORMAT,
+                                NBG_PARSER_BUFFER_PROP_DATA_TYPE,
+                                NBG_PARSER_BUFFER_PROP_FIXED_POINT_POS,
+                                NBG_PARSER_BUFFER_PROP_ZERO_POINT,
+                                NBG_PARSER_BUFFER_PROP_NAME_SIZE};
+  std::string dump;
+  nbg_uint32_t value = 0;
+  for (auto prop : props) {
+    EXPECT_EQ(NBG_SUCCESS, query(nbg, index, prop, &value, sizeof(value)));
+    dump += std::to_string(value) + ";";
+  }
+
+  nbg_float_t scale = 0;
+  EXPECT_EQ(NBG_SUCCESS, query(nbg, index, NBG_PARSER_BUFFER_PROP_SCALE,
+                               &scale, sizeof(scale)));
+  dump += std::to_string(scale) + ";";
+
+  nbg_uint32_t dims[MAX_NUM_DIMS] = {0};
+  nbg_uint32_t dim_num = 0;
+  EXPECT_EQ(NBG_SUCCESS,
+            query(nbg, index, NBG_PARSER_BUFFER_PROP_NUM_OF_DIMENSION,
+                  &dim_num, sizeof(dim_num)));
+  EXPECT_EQ(NBG_SUCCESS, query(nbg, index, NBG_PARSER_BUFFER_PROP_DIMENSIONS,
+                               dims, sizeof(dims)));
+  for (nbg_uint32_t i = 0; i < dim_num && i < MAX_NUM_DIMS; i++) {
+    dump += std::to_string(dims[i]) + ",";
+  }
+
+  char name[MAX_IO_NAME_LEGTH + 1] = {0};
+  EXPECT_EQ(NBG_SUCCESS, query(nbg, index, NBG_PARSER_BUFFER_PROP_NAME, name,
+                               sizeof(name)));
+  return dump + ";" + name;
+}
+
+// Network properties, then one entry per input and output.
+std::vector<std::string> Dump(nbg_parser_data nbg) {
+  std::vector<std::string> dump;
+  nbg_uint32_t inputs = 0;
+  nbg_uint32_t outputs = 0;
+  nbg_uint32_t cid = 0;
+  char name[NETWORK_NAME_SIZE + 1] = {0};
+  EXPECT_EQ(NBG_SUCCESS,
+            nbg_parser_query_network(nbg, NBG_PARSER_NETWORK_INPUT_COUNT,
+                                     &inputs, sizeof(inputs)));
+  EXPECT_EQ(NBG_SUCCESS,
+            nbg_parser_query_network(nbg, NBG_PARSER_NETWORK_OUTPUT_COUNT,
+                                     &outputs, sizeof(outputs)));
+  EXPECT_EQ(NBG_SUCCESS, nbg_parser_query_network(nbg, NBG_PARSER_NETWORK_CID,
+                                                  &cid, sizeof(cid)));
+  EXPECT_EQ(NBG_SUCCESS, nbg_parser_query_network(
+                             nbg, NBG_PARSER_NETWORK_NAME, name, sizeof(name)));
+  dump.push_back(std::to_string(inputs) + ";" + std::to_string(outputs) + ";" +
+                 std::to_string(cid) + ";" + name);
+  for (nbg_uint32_t i = 0; i < inputs; i++) {
+    dump.push_back("in:" + DumpIo(nbg, nbg_parser_query_input, i));
+  }
+  for (nbg_uint32_t i = 0; i < outputs; i++) {
+    dump.push_back("out:" + DumpIo(nbg, nbg_parser_query_output, i));
+  }
+  return dump;
+}
+
+std::vector<std::string> DumpBuffer(std::vector<char> data,
+                                    nbg_uint32_t flags) {
+  nbg_parser_data nbg = NBG_NULL;
+  EXPECT_EQ(NBG_SUCCESS,
+            nbg_parser_init_ex(data.data(), data.size(), flags, &nbg));
+  if (nbg == NBG_NULL) {
+    return {};
+  }
+  std::vector<std::string> dump = Dump(nbg);
+  EXPECT_EQ(NBG_SUCCESS, nbg_parser_destroy(nbg));
+  return dump;
+}
+
+}  // namespace
+
+TEST(nbg_parser, eager_lazy_and_mmap_agree) {
+  for (size_t pad : {0, 1}) {
+    TestNbg model(pad);
+    std::vector<std::string> golden = {
+        "2;1;186;synthetic",
+        "in:2;2;0;0;128;5;0.500000;1,4,7,10,;data",
+        "in:2;2;0;0;127;13;0.250000;2,5,8,11,;weight_scale",
+        "out:2;2;0;0;126;5;0.166667;3,6,9,12,;prob"};
+
+    EXPECT_EQ(golden, DumpBuffer(model.data, NBG_PARSER_FLAG_NONE))
+        << "pad " << pad;
+    EXPECT_EQ(golden, DumpBuffer(model.data, NBG_PARSER_FLAG_LAZY))
+        << "pad " << pad;
+
+    std::string path = testing::TempDir() + "nbg_parser_test.nbg";
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    fwrite(model.data.data(), 1, model.data.size(), file);
+    fclose(file);
+    nbg_parser_data mapped = NBG_NULL;
+    ASSERT_EQ(NBG_SUCCESS,
+              nbg_parser_open(path.c_str(), NBG_PARSER_FLAG_NONE, &mapped));
+    EXPECT_EQ(golden, Dump(mapped)) << "pad " << pad;
+    EXPECT_EQ(NBG_SUCCESS, nbg_parser_destroy(mapped));
+    remove(path.c_str());
+  }
+
+  nbg_parser_data missing = NBG_NULL;
+  EXPECT_NE(NBG_SUCCESS,
+            nbg_parser_open("/nonexistent/model.nbg", NBG_PARSER_FLAG_NONE,
+                            &missing));
+}
+
+TEST(nbg_parser, rejects_truncated_buffer) {
+  TestNbg model;
+  const nbg_uint32_t flags[] = {NBG_PARSER_FLAG_NONE, NBG_PARSER_FLAG_LAZY};
+  // Inside the header, the entry tables, the input and the output table.
+  const size_t cuts[] = {0, 2, 16, model.input_offset - 4,
+                         model.input_offset + 8, model.output_offset + 8};
+
+  for (auto flag : flags) {
+    for (size_t size : cuts) {
+      std::vector<char> truncated(model.data.begin(),
+                                  model.data.begin() + size);
+      truncated.reserve(1);  // keep data() non-null for the empty cut
+      nbg_parser_data nbg = NBG_NULL;
+      EXPECT_NE(NBG_SUCCESS,
+                nbg_parser_init_ex(truncated.data(), size, flag, &nbg))
+          << "flag " << flag << " size " << size;
+      EXPECT_EQ(NBG_NULL, nbg);
+    }
+  }
+
+  // A cut in the LCD only matters to the eager parser, which copies it.
+  std::vector<char> truncated(model.data.begin(),
+                              model.data.begin() + model.lcd_offset + 16);
+  nbg_parser_data nbg = NBG_NULL;
+  EXPECT_NE(NBG_SUCCESS, nbg_parser_init_ex(truncated.data(), truncated.size(),
+                                            NBG_PARSER_FLAG_NONE, &nbg));
+  EXPECT_EQ(NBG_NULL, nbg);
+  EXPECT_EQ(DumpBuffer(model.data, NBG_PARSER_FLAG_NONE),
+            DumpBuffer(truncated, NBG_PARSER_FLAG_LAZY));
+}
+
+TEST(nbg_parser, rejects_out_of_range_io_index) {
+  TestNbg model;
+  const nbg_uint32_t flags[] = {NBG_PARSER_FLAG_NONE, NBG_PARSER_FLAG_LAZY};
+
+  for (auto flag : flags) {
+    nbg_parser_data nbg = NBG_NULL;
+    ASSERT_EQ(NBG_SUCCESS, nbg_parser_init_ex(model.data.data(),
+                                              model.data.size(), flag, &nbg));
+    nbg_uint32_t value = 0;
+    EXPECT_EQ(NBG_SUCCESS,
+              nbg_parser_query_input(nbg, 1,
+                                     NBG_PARSER_BUFFER_PROP_NUM_OF_DIMENSION,
+                                     &value, sizeof(value)));
+    EXPECT_EQ(NBG_SUCCESS,
+              nbg_parser_query_output(nbg, 0,
+                                      NBG_PARSER_BUFFER_PROP_NUM_OF_DIMENSION,
+                                      &value, sizeof(value)));
+    for (nbg_uint32_t index : {2u, 3u, 0xFFFFFFFFu}) {
+      EXPECT_NE(NBG_SUCCESS,
+                nbg_parser_query_input(nbg, index,
+                                       NBG_PARSER_BUFFER_PROP_NUM_OF_DIMENSION,
+                                       &value, sizeof(value)))
+          << "flag " << flag << " input " << index;
+    }
+    for (nbg_uint32_t index : {1u, 2u, 0xFFFFFFFFu}) {
+      EXPECT_NE(NBG_SUCCESS,
+                nbg_parser_query_output(nbg, index,
+                                        NBG_PARSER_BUFFER_PROP_NUM_OF_DIMENSION,
+                                        &value, sizeof(value)))
+          << "flag " << flag << " output " << index;
+    }
+    EXPECT_EQ(NBG_SUCCESS, nbg_parser_destroy(nbg));
+  }
+}
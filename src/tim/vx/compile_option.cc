@@ -61,6 +61,8 @@ struct CompileOptionImpl {
 #endif
 
   RelaxModeType relax_mode_;
+  std::map<std::string, Precision> kind_precision_;
+  std::map<uint32_t, Precision> uid_precision_;
 };
 
 CompileOption::CompileOption() : impl_(new CompileOptionImpl()) {}
@@ -71,6 +73,35 @@ bool CompileOption::setRelaxMode(bool enable) {
   return this->impl_->RelaxMode() = enable;
 }
 
+bool CompileOption::setOpPrecisionByKind(const std::string& op_kind,
+                                         Precision precision) {
+  this->impl_->kind_precision_[op_kind] = precision;
+  return true;
+}
+
+bool CompileOption::setOpPrecisionByUid(uint32_t op_uid, Precision precision) {
+  this->impl_->uid_precision_[op_uid] = precision;
+  return true;
+}
+
+Precision CompileOption::getOpPrecision(const std::string& op_kind,
+                                        uint32_t op_uid) const {
+  auto uid_it = this->impl_->uid_precision_.find(op_uid);
+  if (uid_it != this->impl_->uid_precision_.end()) {
+    return uid_it->second;
+  }
+  auto kind_it = this->impl_->kind_precision_.find(op_kind);
+  if (kind_it != this->impl_->kind_precision_.end()) {
+    return kind_it->second;
+  }
+  return Precision::FP32;
+}
+
+bool CompileOption::hasOpPrecision() const {
+  return !this->impl_->kind_precision_.empty() ||
+         !this->impl_->uid_precision_.empty();
+}
+
 #if defined(ENABLE_PLATFORM)
   void CompileOption::setDeviceId(::tim::vx::platform::IDevice::device_id_t device) {
     this->impl_->setDeviceId(device);
@@ -0,0 +1,207 @@
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "graph_private.h"
+#include "vsi_nn_pub.h"
+#include "utils/vsi_nn_const_pipeline.h"
+
+namespace {
+
+vsi_nn_tensor_t* ConstInt8Tensor(const std::shared_ptr<tim::vx::Graph>& graph,
+                                 const tim::vx::ShapeType& shape,
+                                 const std::vector<int8_t>& data) {
+  tim::vx::Quantization quant(tim::vx::QuantType::ASYMMETRIC, 0.5f, 3);
+  tim::vx::TensorSpec spec(tim::vx::DataType::INT8, shape,
+                           tim::vx::TensorAttribute::CONSTANT, quant);
+  auto tensor = graph->CreateTensor(spec, data.data());
+  auto impl = std::static_pointer_cast<tim::vx::GraphImpl>(graph);
+  return vsi_nn_GetTensor(impl->graph(), tensor->GetId());
+}
+
+}  // namespace
+
+TEST(const_pipeline, chained_transforms_in_one_pass) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  auto low_graph = std::static_pointer_cast<tim::vx::GraphImpl>(graph)->graph();
+
+  // [w=2, h=2, c=1, n=2] permuted to [w=2, h=2, c=2, n=1]
+  std::vector<int8_t> data = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto tensor = ConstInt8Tensor(graph, {2, 2, 1, 2}, data);
+  ASSERT_TRUE(tensor);
+
+  vsi_nn_const_pipeline_t* pipeline = vsi_nn_const_pipeline_create(low_graph);
+  ASSERT_TRUE(pipeline);
+  vsi_nn_const_permute_param_t param = {};
+  param.perm[0] = 0;
+  param.perm[1] = 1;
+  param.perm[2] = 3;
+  param.perm[3] = 2;
+  param.dim_num = 4;
+  EXPECT_EQ(VSI_SUCCESS,
+            vsi_nn_const_pipeline_add(pipeline, tensor,
+                                      vsi_nn_const_transform_permute, &param,
+                                      sizeof(param)));
+  EXPECT_EQ(VSI_SUCCESS,
+            vsi_nn_const_pipeline_add(pipeline, tensor,
+                                      vsi_nn_const_transform_rotate_180,
+                                      nullptr, 0));
+  EXPECT_EQ(VSI_SUCCESS,
+            vsi_nn_const_pipeline_add(pipeline, tensor,
+                                      vsi_nn_const_transform_i8_to_u8,
+                                      nullptr, 0));
+  EXPECT_TRUE(vsi_nn_const_pipeline_contains(pipeline, tensor));
+
+  vsi_nn_const_pipeline_stat_t stat;
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, &stat));
+  EXPECT_EQ(1u, stat.tensor_count);
+  EXPECT_EQ(3u, stat.transform_count);
+  EXPECT_EQ(data.size(), stat.bytes_read);
+  EXPECT_EQ(data.size(), stat.bytes_written);
+  EXPECT_FALSE(vsi_nn_const_pipeline_contains(pipeline, tensor));
+  vsi_nn_const_pipeline_release(&pipeline);
+  EXPECT_EQ(nullptr, pipeline);
+
+  EXPECT_EQ(VSI_NN_TYPE_UINT8, tensor->attr.dtype.vx_type);
+  EXPECT_EQ(3 + 128, tensor->attr.dtype.zero_point);
+  EXPECT_EQ(2u, tensor->attr.size[2]);
+  EXPECT_EQ(1u, tensor->attr.size[3]);
+
+  // Each 2x2 slice is reversed, then the sign bit flipped
+  uint8_t* result = vsi_nn_ConvertTensorToData(low_graph, tensor);
+  ASSERT_TRUE(result);
+  std::vector<uint8_t> expected = {0x83, 0x82, 0x81, 0x80,
+                                   0x87, 0x86, 0x85, 0x84};
+  EXPECT_EQ(expected, std::vector<uint8_t>(result, result + expected.size()));
+  free(result);
+}
+
+TEST(const_pipeline, replay_on_new_data) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  auto low_graph = std::static_pointer_cast<tim::vx::GraphImpl>(graph)->graph();
+
+  std::vector<int8_t> data = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto tensor = ConstInt8Tensor(graph, {2, 2, 1, 2}, data);
+  auto other = ConstInt8Tensor(graph, {2, 2, 1, 2}, data);
+  ASSERT_TRUE(tensor);
+  ASSERT_TRUE(other);
+  std::vector<uint8_t> unchanged(data.begin(), data.end());
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_replay(
+                             low_graph, tensor, unchanged.data(),
+                             unchanged.size()))
+      << "Nothing applied yet";
+  EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.end()), unchanged);
+
+  // Two runs, both are replayed in order
+  vsi_nn_const_pipeline_t* pipeline = vsi_nn_const_pipeline_create(low_graph);
+  ASSERT_TRUE(pipeline);
+  EXPECT_EQ(VSI_SUCCESS,
+            vsi_nn_const_pipeline_add(pipeline, tensor,
+                                      vsi_nn_const_transform_i8_to_u8,
+                                      nullptr, 0));
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, nullptr));
+  EXPECT_EQ(VSI_SUCCESS,
+            vsi_nn_const_pipeline_add(pipeline, tensor,
+                                      vsi_nn_const_transform_rotate_180,
+                                      nullptr, 0));
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, nullptr));
+  vsi_nn_const_pipeline_release(&pipeline);
+
+  std::vector<int8_t> new_data = {-1, -2, -3, -4, 10, 20, 30, 40};
+  std::vector<uint8_t> replayed(new_data.begin(), new_data.end());
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_replay(
+                             low_graph, tensor, replayed.data(),
+                             replayed.size()));
+  std::vector<uint8_t> expected = {0x7C, 0x7D, 0x7E, 0x7F,
+                                   0xA8, 0x9E, 0x94, 0x8A};
+  EXPECT_EQ(expected, replayed);
+
+  // A rewrite outside of a pipeline can't be replayed
+  vsi_size_t perm[] = {1, 0, 2, 3};
+  vsi_nn_PermuteTensor(low_graph, other, perm, 4);
+  EXPECT_NE(VSI_SUCCESS, vsi_nn_const_pipeline_replay(
+                             low_graph, other, replayed.data(),
+                             replayed.size()));
+}
+
+TEST(const_pipeline, chained_matches_separate_passes) {
+  const size_t n_tensor = 4;
+  const tim::vx::ShapeType shape = {3, 3, 4, 2};
+  std::vector<int8_t> data(3 * 3 * 4 * 2);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<int8_t>(i * 7 - 100);
+  }
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  auto low_graph = std::static_pointer_cast<tim::vx::GraphImpl>(graph)->graph();
+
+  std::vector<vsi_nn_tensor_t*> separate, chained;
+  for (size_t i = 0; i < n_tensor; i++) {
+    separate.push_back(ConstInt8Tensor(graph, shape, data));
+    chained.push_back(ConstInt8Tensor(graph, shape, data));
+    ASSERT_TRUE(separate.back());
+    ASSERT_TRUE(chained.back());
+  }
+  vsi_nn_const_permute_param_t param = {};
+  param.perm[0] = 0;
+  param.perm[1] = 1;
+  param.perm[2] = 3;
+  param.perm[3] = 2;
+  param.dim_num = 4;
+
+  // One pipeline run per transform and tensor
+  for (auto t : separate) {
+    vsi_nn_const_pipeline_t* pipeline = vsi_nn_const_pipeline_create(low_graph);
+    ASSERT_TRUE(pipeline);
+    EXPECT_EQ(VSI_SUCCESS,
+              vsi_nn_const_pipeline_add(pipeline, t,
+                                        vsi_nn_const_transform_permute,
+                                        &param, sizeof(param)));
+    EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, nullptr));
+    EXPECT_EQ(VSI_SUCCESS,
+              vsi_nn_const_pipeline_add(pipeline, t,
+                                        vsi_nn_const_transform_rotate_180,
+                                        nullptr, 0));
+    EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, nullptr));
+    vsi_nn_const_pipeline_release(&pipeline);
+  }
+
+  vsi_nn_const_pipeline_t* pipeline = vsi_nn_const_pipeline_create(low_graph);
+  ASSERT_TRUE(pipeline);
+  for (auto t : chained) {
+    EXPECT_EQ(VSI_SUCCESS,
+              vsi_nn_const_pipeline_add(pipeline, t,
+                                        vsi_nn_const_transform_permute,
+                                        &param, sizeof(param)));
+    EXPECT_EQ(VSI_SUCCESS,
+              vsi_nn_const_pipeline_add(pipeline, t,
+                                        vsi_nn_const_transform_rotate_180,
+                                        nullptr, 0));
+  }
+  vsi_nn_const_pipeline_stat_t stat;
+  EXPECT_EQ(VSI_SUCCESS, vsi_nn_const_pipeline_run(pipeline, &stat));
+  vsi_nn_const_pipeline_release(&pipeline);
+  EXPECT_EQ(n_tensor, stat.tensor_count);
+  EXPECT_EQ(2 * n_tensor, stat.transform_count);
+  EXPECT_EQ(n_tensor * data.size(), stat.bytes_read);
+  EXPECT_EQ(n_tensor * data.size(), stat.bytes_written);
+
+  for (size_t i = 0; i < n_tensor; i++) {
+    EXPECT_EQ(4u, chained[i]->attr.size[3]);
+    EXPECT_EQ(separate[i]->attr.size[2], chained[i]->attr.size[2]);
+    uint8_t* expected = vsi_nn_ConvertTensorToData(low_graph, separate[i]);
+    uint8_t* result = vsi_nn_ConvertTensorToData(low_graph, chained[i]);
+    ASSERT_TRUE(expected);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + data.size()),
+              std::vector<uint8_t>(result, result + data.size()))
+        << "tensor " << i;
+    free(expected);
+    free(result);
+  }
+}
@@ -23,6 +23,8 @@
 *****************************************************************************/
 #include "tim/vx/context.h"
 
+#include <algorithm>
+
 #include "context_private.h"
 #include "graph_private.h"
 #include "tim/vx/graph.h"
@@ -32,7 +34,8 @@
 namespace tim {
 namespace vx {
 
-ContextImpl::ContextImpl() : context_(vsi_nn_CreateContext()) {}
+ContextImpl::ContextImpl()
+    : context_(vsi_nn_CreateContext()), memory_budget_(0), memory_in_use_(0) {}
 
 ContextImpl::~ContextImpl() {
   if (context_) {
@@ -62,5 +65,38 @@ bool ContextImpl::hasSP() {
     return 0 != context_->config.support_stream_processor;
 }
 
+void ContextImpl::SetMemoryBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  memory_budget_ = bytes;
+}
+
+size_t ContextImpl::MemoryBudget() {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  return memory_budget_;
+}
+
+size_t ContextImpl::MemoryInUse() {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  return memory_in_use_;
+}
+
+bool ContextImpl::ReserveMemory(const MemoryReport& report,
+                                const char* owner) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  size_t bytes = report.Total();
+  if (memory_budget_ > 0 && memory_in_use_ + bytes > memory_budget_) {
+    VSILOGE("%s exceeds memory budget %zu with %zu in use: %s", owner,
+            memory_budget_, memory_in_use_, report.ToString().c_str());
+    return false;
+  }
+  memory_in_use_ += bytes;
+  return true;
+}
+
+void ContextImpl::ReleaseMemory(size_t bytes) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  memory_in_use_ -= std::min(bytes, memory_in_use_);
+}
+
 }  // namespace vx
 }  // namespace tim
\ No newline at end of file
@@ -23,7 +23,10 @@
 *****************************************************************************/
 #ifndef TIM_VX_CONTEXT_PRIVATE_H_
 #define TIM_VX_CONTEXT_PRIVATE_H_
+#include <mutex>
+
 #include "tim/vx/context.h"
+#include "tim/vx/graph.h"
 #include "vsi_nn_pub.h"
 
 namespace tim {
@@ -38,9 +41,20 @@ class ContextImpl : public Context {
   std::shared_ptr<Graph> CreateGraph(const CompileOption&) override;
   bool isClOnly() override;
   bool hasSP() override;
+  void SetMemoryBudget(size_t bytes) override;
+  size_t MemoryBudget() override;
+  size_t MemoryInUse() override;
+
+  /// Account `report` of `owner` against the memory budget, return false and
+  /// log the breakdown if it doesn't fit
+  bool ReserveMemory(const MemoryReport& report, const char* owner);
+  void ReleaseMemory(size_t bytes);
 
  protected:
   vsi_nn_context_t context_;
+  std::mutex memory_mutex_;
+  size_t memory_budget_;
+  size_t memory_in_use_;
 };
 
 }  // namespace vx
@@ -22,12 +22,103 @@
 *
 *****************************************************************************/
 #include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "context_private.h"
+#include "kernel/vsi_nn_kernel.h"
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 TEST(Context, create) {
     auto ctx0 = tim::vx::Context::Create();
     {auto ctx0 = tim::vx::Context::Create();}
     auto ctx1 = tim::vx::Context::Create();
     EXPECT_TRUE(nullptr != ctx0);
     EXPECT_TRUE(nullptr != ctx1);
-}
\ No newline at end of file
+}
+
+TEST(Context, kernels_share_cached_program) {
+    auto ctx = tim::vx::Context::Create();
+    auto vx_ctx = std::static_pointer_cast<tim::vx::ContextImpl>(ctx)
+                      ->context()->c;
+    auto graph = ctx->CreateGraph();
+
+    // The 3D and 2D variants of erf are different kernels built from the
+    // same shader source, the second one must reuse the cached program.
+    for (auto shape : {tim::vx::ShapeType({4, 4, 2}),
+                       tim::vx::ShapeType({4, 4})}) {
+        tim::vx::TensorSpec in_spec(tim::vx::DataType::FLOAT32, shape,
+                                    tim::vx::TensorAttribute::INPUT);
+        tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::OUTPUT);
+        auto input = graph->CreateTensor(in_spec);
+        auto output = graph->CreateTensor(out_spec);
+        graph->CreateOperation<tim::vx::ops::Erf>()
+            ->BindInput(input)
+            .BindOutput(output);
+    }
+    EXPECT_TRUE(graph->Compile());
+
+    size_t programs = vsi_nn_kernel_program_cache_count(vx_ctx);
+    if (programs == 0) {
+        GTEST_SKIP() << "erf is not lowered to a shader kernel on this target";
+    }
+    EXPECT_EQ(programs, 1u);
+
+    // Compiling the same kernels again must not build any new program
+    auto again = ctx->CreateGraph();
+    tim::vx::TensorSpec in_spec(tim::vx::DataType::FLOAT32, {4, 4},
+                                tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32, {4, 4},
+                                 tim::vx::TensorAttribute::OUTPUT);
+    auto input = again->CreateTensor(in_spec);
+    auto output = again->CreateTensor(out_spec);
+    again->CreateOperation<tim::vx::ops::Erf>()->BindInput(input).BindOutput(
+        output);
+    EXPECT_TRUE(again->Compile());
+    EXPECT_EQ(vsi_nn_kernel_program_cache_count(vx_ctx), programs);
+}
+
+TEST(Context, concurrent_compiles_build_program_once) {
+    auto ctx = tim::vx::Context::Create();
+    auto vx_ctx = std::static_pointer_cast<tim::vx::ContextImpl>(ctx)
+                      ->context()->c;
+    const int graph_num = 4;
+    std::vector<std::shared_ptr<tim::vx::Graph>> graphs;
+    for (int i = 0; i < graph_num; ++i) {
+        auto graph = ctx->CreateGraph();
+        tim::vx::TensorSpec in_spec(tim::vx::DataType::FLOAT32, {4, 4},
+                                    tim::vx::TensorAttribute::INPUT);
+        tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32, {4, 4},
+                                     tim::vx::TensorAttribute::OUTPUT);
+        auto input = graph->CreateTensor(in_spec);
+        auto output = graph->CreateTensor(out_spec);
+        graph->CreateOperation<tim::vx::ops::Erf>()
+            ->BindInput(input)
+            .BindOutput(output);
+        graphs.push_back(graph);
+    }
+
+    // Graphs compiled on different threads build the shared program once,
+    // the others wait for that build instead of starting their own.
+    std::vector<char> compiled(graph_num, 0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < graph_num; ++i) {
+        workers.emplace_back(
+            [&graphs, &compiled, i]() { compiled[i] = graphs[i]->Compile(); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (int i = 0; i < graph_num; ++i) {
+        EXPECT_TRUE(compiled[i]);
+    }
+
+    size_t programs = vsi_nn_kernel_program_cache_count(vx_ctx);
+    if (programs == 0) {
+        GTEST_SKIP() << "erf is not lowered to a shader kernel on this target";
+    }
+    EXPECT_EQ(programs, 1u);
+}
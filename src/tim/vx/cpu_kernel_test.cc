@@ -0,0 +1,234 @@
+#include <atomic>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "vsi_nn_pub.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
+
+namespace {
+
+void CountTask(void* data, size_t begin, size_t end) {
+  auto* hits = reinterpret_cast<std::vector<std::atomic<int>>*>(data);
+  for (size_t i = begin; i < end; i++) {
+    (*hits)[i]++;
+  }
+}
+
+struct CpuKernelGraph {
+  CpuKernelGraph() {
+    ctx = vsi_nn_CreateContext();
+    graph = vsi_nn_CreateGraph(ctx, 3, 1);
+  }
+  ~CpuKernelGraph() {
+    vsi_nn_ReleaseGraph(&graph);
+    vsi_nn_ReleaseContext(&ctx);
+  }
+
+  vsi_nn_tensor_id_t AddTensor(const std::vector<vsi_size_t>& shape) {
+    vsi_nn_tensor_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.dim_num = shape.size();
+    for (size_t i = 0; i < shape.size(); i++) {
+      attr.size[i] = shape[i];
+    }
+    attr.dtype.vx_type = VSI_NN_TYPE_FLOAT32;
+    return vsi_nn_AddTensor(graph, VSI_NN_TENSOR_ID_AUTO, &attr, nullptr);
+  }
+
+  // Run the single node graph once and return its output as float32.
+  std::vector<float> Run(vsi_nn_node_t* node, vsi_nn_tensor_id_t input,
+                         vsi_nn_tensor_id_t output,
+                         const std::vector<float>& input_data) {
+    node->input.tensors[0] = input;
+    node->output.tensors[0] = output;
+    vsi_nn_SetGraphInputs(graph, &input, 1);
+    vsi_nn_SetGraphOutputs(graph, &output, 1);
+    EXPECT_EQ(VSI_SUCCESS, vsi_nn_SetupGraph(graph, FALSE));
+    EXPECT_EQ(VSI_SUCCESS, vsi_nn_VerifyGraph(graph));
+    std::vector<float> data(input_data);
+    EXPECT_EQ(VSI_SUCCESS,
+              vsi_nn_CopyDataToTensor(graph, vsi_nn_GetTensor(graph, input),
+                                      reinterpret_cast<uint8_t*>(data.data())));
+    EXPECT_EQ(VSI_SUCCESS, vsi_nn_RunGraph(graph));
+
+    auto tensor = vsi_nn_GetTensor(graph, output);
+    std::vector<float> result;
+    float* buffer = vsi_nn_ConvertTensorToFloat32Data(graph, tensor);
+    if (buffer) {
+      result.assign(buffer, buffer + vsi_nn_GetElementNum(tensor));
+      free(buffer);
+    }
+    return result;
+  }
+
+  vsi_nn_context_t ctx;
+  vsi_nn_graph_t* graph;
+};
+
+// 1, 2, ... within each plane of `plane` elements, plus 100 per plane
+std::vector<float> Ramp(size_t plane, size_t planes = 1) {
+  std::vector<float> data(plane * planes);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<float>(i % plane + 1 + 100 * (i / plane));
+  }
+  return data;
+}
+
+void ExpectNear(const std::vector<float>& golden,
+                const std::vector<float>& result) {
+  ASSERT_EQ(golden.size(), result.size());
+  for (size_t i = 0; i < golden.size(); i++) {
+    EXPECT_NEAR(golden[i], result[i], 1e-4f) << "index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(cpu_kernel, parallel_for_covers_each_index_once) {
+  const size_t count = 100003;
+  std::vector<std::atomic<int>> hits(count);
+  for (auto& h : hits) {
+    h = 0;
+  }
+
+  vsi_nn_kernel_cpu_parallel_for(count, 7, CountTask, &hits);
+
+  EXPECT_GE(vsi_nn_kernel_cpu_thread_num(), 1u);
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_EQ(1, hits[i].load()) << "index " << i;
+  }
+}
+
+TEST(cpu_kernel, simd_helpers) {
+  std::vector<float> data = {3, -1, 7, 2, 5, 0, -4, 6, 1};
+  std::vector<float> scaled(data.size());
+
+  EXPECT_FLOAT_EQ(7.0f,
+                  vsi_nn_kernel_cpu_max_f32(data.data(), data.size()));
+  EXPECT_FLOAT_EQ(19.0f,
+                  vsi_nn_kernel_cpu_sum_f32(data.data(), data.size()));
+  vsi_nn_kernel_cpu_scale_f32(data.data(), scaled.data(), data.size(), 0.5f);
+  for (size_t i = 0; i < data.size(); i++) {
+    EXPECT_FLOAT_EQ(data[i] * 0.5f, scaled[i]);
+  }
+}
+
+TEST(cpu_kernel, custom_softmax) {
+  CpuKernelGraph g;
+  std::vector<vsi_size_t> shape = {3, 2};
+  auto input = g.AddTensor(shape);
+  auto output = g.AddTensor(shape);
+  auto node = vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_SOFTMAX, 1, 1, nullptr);
+  node->nn_param.custom_softmax.axis = 0;
+  std::vector<float> data = {0, 0, 0, 1, 2, 3};
+  std::vector<float> golden = {1.0f / 3, 1.0f / 3, 1.0f / 3,
+                               0.09003057f, 0.24472847f, 0.66524096f};
+
+  ExpectNear(golden, g.Run(node, input, output, data));
+}
+
+TEST(cpu_kernel, custom_warp_affine_c1_bilinear) {
+  CpuKernelGraph g;
+  const float matrix[6] = {1.0f, 0.0f, 0.0f, 1.0f, 0.5f, 0.25f};
+  auto input = g.AddTensor({4, 3, 1});
+  auto output = g.AddTensor({4, 3, 1});
+  auto node =
+      vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_WARP_AFFINE, 2, 1, nullptr);
+  node->nn_param.custom_warp_affine.matrix = matrix;
+  node->nn_param.custom_warp_affine.type = VSI_NN_INTERPOLATION_BILINEAR;
+  node->nn_param.custom_warp_affine.rgb_type = VSI_NN_WARP_AFFINE_TYPE_NONE;
+  node->input.tensors[1] = VSI_NN_TENSOR_ID_NA;
+  // Samples outside of the image read as 0
+  std::vector<float> golden = {
+      2.5f,   3.5f,   4.5f,   2.5f,
+      6.5f,   7.5f,   8.5f,   4.5f,
+      7.125f, 7.875f, 8.625f, 4.5f,
+  };
+
+  ExpectNear(golden, g.Run(node, input, output, Ramp(12)));
+}
+
+TEST(cpu_kernel, custom_warp_affine_c3_nearest) {
+  CpuKernelGraph g;
+  // Transpose every plane of a 4x3x3 image into 3x4x3
+  const float matrix[6] = {0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+  auto input = g.AddTensor({4, 3, 3});
+  auto output = g.AddTensor({3, 4, 3});
+  auto node =
+      vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_WARP_AFFINE, 2, 1, nullptr);
+  node->nn_param.custom_warp_affine.matrix = matrix;
+  node->nn_param.custom_warp_affine.type =
+      VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR;
+  node->nn_param.custom_warp_affine.rgb_type = VSI_NN_WARP_AFFINE_TYPE_NONE;
+  node->input.tensors[1] = VSI_NN_TENSOR_ID_NA;
+  std::vector<float> golden = {
+      1,   5,   9,   2,   6,   10,  3,   7,   11,  4,   8,   12,
+      101, 105, 109, 102, 106, 110, 103, 107, 111, 104, 108, 112,
+      201, 205, 209, 202, 206, 210, 203, 207, 211, 204, 208, 212,
+  };
+
+  ExpectNear(golden, g.Run(node, input, output, Ramp(12, 3)));
+}
+
+TEST(cpu_kernel, custom_warp_affine_rgb_bilinear) {
+  CpuKernelGraph g;
+  // Interleaved 2x2 RGB image, shifted by half a pixel
+  const float matrix[6] = {1.0f, 0.0f, 0.0f, 1.0f, 0.5f, 0.0f};
+  auto input = g.AddTensor({6, 2, 1});
+  auto output = g.AddTensor({6, 2, 1});
+  auto node =
+      vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_WARP_AFFINE, 2, 1, nullptr);
+  node->nn_param.custom_warp_affine.matrix = matrix;
+  node->nn_param.custom_warp_affine.type = VSI_NN_INTERPOLATION_BILINEAR;
+  node->nn_param.custom_warp_affine.rgb_type = VSI_NN_WARP_AFFINE_TYPE_RGB;
+  node->input.tensors[1] = VSI_NN_TENSOR_ID_NA;
+  std::vector<float> golden = {
+      2.5f, 3.5f, 4.5f,  2.0f, 2.5f, 3.0f,
+      8.5f, 9.5f, 10.5f, 5.0f, 5.5f, 6.0f,
+  };
+
+  ExpectNear(golden, g.Run(node, input, output, Ramp(12)));
+}
+
+TEST(cpu_kernel, custom_warp_perspective_c1_bilinear) {
+  CpuKernelGraph g;
+  // z = 1 + 0.5 * x
+  const float matrix[9] = {1.0f, 0.0f, 0.5f, 0.0f, 1.0f,
+                           0.0f, 0.0f, 0.0f, 1.0f};
+  auto input = g.AddTensor({4, 3, 1});
+  auto output = g.AddTensor({4, 3, 1});
+  auto node =
+      vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_WARP_PERSPECTIVE, 1, 1, nullptr);
+  node->nn_param.custom_warp_perspective.matrix = matrix;
+  node->nn_param.custom_warp_perspective.type = VSI_NN_INTERPOLATION_BILINEAR;
+  std::vector<float> golden = {
+      1.0f, 1.6666667f, 2.0f, 2.2f,
+      5.0f, 4.3333333f, 4.0f, 3.8f,
+      9.0f, 7.0f,       6.0f, 5.4f,
+  };
+
+  ExpectNear(golden, g.Run(node, input, output, Ramp(12)));
+}
+
+TEST(cpu_kernel, custom_warp_perspective_c3_nearest) {
+  CpuKernelGraph g;
+  // Shift left by one pixel, samples outside of the image read as 205
+  const float matrix[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+                           0.0f, 1.0f, 0.0f, 1.0f};
+  auto input = g.AddTensor({4, 3, 3});
+  auto output = g.AddTensor({4, 3, 3});
+  auto node =
+      vsi_nn_AddNode(g.graph, VSI_NN_OP_CUSTOM_WARP_PERSPECTIVE, 1, 1, nullptr);
+  node->nn_param.custom_warp_perspective.matrix = matrix;
+  node->nn_param.custom_warp_perspective.type =
+      VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR;
+  std::vector<float> golden = {
+      2,   3,   4,   205, 6,   7,   8,   205, 10,  11,  12,  205,
+      102, 103, 104, 205, 106, 107, 108, 205, 110, 111, 112, 205,
+      202, 203, 204, 205, 206, 207, 208, 205, 210, 211, 212, 205,
+  };
+
+  ExpectNear(golden, g.Run(node, input, output, Ramp(12, 3)));
+}
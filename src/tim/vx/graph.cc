@@ -23,6 +23,7 @@
 *****************************************************************************/
 #include "tim/vx/graph.h"
 #include <algorithm>
+#include <cmath>
 
 #ifdef ENABLE_TENSOR_CACHE
 #include <openssl/evp.h>
@@ -35,11 +36,13 @@
 #include "tensor_private.h"
 #include "tim/vx/context.h"
 #include "tim/vx/ops/nbg.h"
+#include "tim/vx/ops/simple_operations.h"
 #include "tim/vx/compile_option.h"
 #include "vsi_nn_pub.h"
 
 namespace tim {
 namespace vx {
+
 #ifdef ENABLE_TENSOR_CACHE
 #define MD5_SECRET_LEN_16 (16)
 #define MD5_BYTE_STRING_LEN (4)
@@ -94,9 +97,22 @@ GraphImpl::GraphImpl(ContextImpl* context, const CompileOption& options)
       tensor_placeholder_(nullptr),
       not_consumed_input_cnt_(0),
       not_consumed_output_cnt_(0),
-      options_(options) {}
-
-GraphImpl::~GraphImpl() { vsi_nn_ReleaseGraph(&graph_); }
+      options_(options),
+      binary_bytes_(0),
+      memory_reserved_(false),
+      reserved_bytes_(0),
+      verified_(false) {}
+
+GraphImpl::~GraphImpl() {
+  if (memory_reserved_) {
+    context_->ReleaseMemory(reserved_bytes_);
+  }
+  // Shared tensors are released by the graph which created them
+  for (auto id : shared_tensors_) {
+    vsi_nn_MapRemove(graph_->tensor_table, (vsi_nn_map_key_t)id);
+  }
+  vsi_nn_ReleaseGraph(&graph_);
+}
 
 #ifdef ENABLE_TENSOR_CACHE
 std::map<std::string, std::shared_ptr<tim::vx::Tensor>>&
@@ -115,6 +131,7 @@ const std::string GraphImpl::CalculateCacheKey(const TensorSpec& spec,
     case DataType::INT16:
     case DataType::UINT16:
     case DataType::FLOAT16:
+    case DataType::BFLOAT16:
       data_size *= 2;
       break;
     case DataType::INT32:
@@ -325,6 +342,241 @@ std::shared_ptr<Tensor> GraphImpl::CreateTensorPlaceHolder() {
   return tensor_placeholder_;
 }
 
+std::shared_ptr<Tensor> GraphImpl::CreateTensorView(
+    const std::shared_ptr<Tensor>& parent, const ShapeType& start,
+    const ShapeType& end) {
+  auto parent_impl = std::dynamic_pointer_cast<TensorImpl>(parent);
+  if (!parent_impl || parent_impl->graph_ != this ||
+      !(parent_impl->spec_.attr_ &
+        (TensorAttribute::INPUT | TensorAttribute::OUTPUT |
+         TensorAttribute::CONSTANT))) {
+    VSILOGE("View parent must be an input, output or constant of this graph");
+    return nullptr;
+  }
+  const auto& shape = parent->GetShape();
+  if (start.size() != shape.size() || end.size() != shape.size()) {
+    VSILOGE("View rank mismatch with its parent");
+    return nullptr;
+  }
+
+  TensorSpec spec(parent_impl->spec_);
+  ShapeType view_shape(shape.size());
+  vsi_size_t view_start[VSI_NN_MAX_DIM_NUM] = {0};
+  vsi_size_t view_end[VSI_NN_MAX_DIM_NUM] = {0};
+  for (size_t i = 0; i < shape.size(); i++) {
+    if (start[i] >= end[i] || end[i] > shape[i]) {
+      VSILOGE("Invalid view range [%u, %u) of axis %zu", start[i], end[i], i);
+      return nullptr;
+    }
+    view_start[i] = start[i];
+    view_end[i] = end[i];
+    view_shape[i] = end[i] - start[i];
+  }
+  // Scales of a per-channel parent only hold for the whole channel axis
+  const auto& quant = spec.quantization_;
+  if (quant.Type() == QuantType::SYMMETRIC_PER_CHANNEL &&
+      view_shape[quant.ChannelDim()] != shape[quant.ChannelDim()]) {
+    VSILOGE("View can't slice the channel axis of a per-channel tensor");
+    return nullptr;
+  }
+
+  auto id = vsi_nn_AddTensorFromView(graph_, parent->GetId(), view_start,
+                                     view_end);
+  if (VSI_NN_TENSOR_ID_NA == id) {
+    return nullptr;
+  }
+  view_tensors_.push_back(id);
+  spec.SetShape(view_shape);
+  if (!(spec.attr_ & TensorAttribute::CONSTANT)) {
+    spec.SetAttribute(TensorAttribute::TRANSIENT);
+  }
+  return std::make_shared<TensorImpl>(this, spec, TensorImpl::ViewTag(), id);
+}
+
+namespace {
+// Weight of these operations is input 1, their float bias input 2 is kept
+// in FLOAT32 which the fp16/bf16 kernels accept
+bool IsWeightOp(int32_t kind) {
+  return VSI_NN_OP_CONV1D == kind || VSI_NN_OP_CONV2D == kind ||
+         VSI_NN_OP_GROUPED_CONV2D == kind || VSI_NN_OP_FCL2 == kind ||
+         VSI_NN_OP_DECONVOLUTION == kind || VSI_NN_OP_DECONVOLUTION1D == kind;
+}
+
+DataType ComputeType(Precision precision) {
+  return Precision::BF16 == precision ? DataType::BFLOAT16 : DataType::FLOAT16;
+}
+
+std::vector<float> ReadFloatConstant(const std::shared_ptr<Tensor>& tensor) {
+  std::vector<float> data(tensor->GetSpec().GetElementNum());
+  tensor->CopyDataFromTensor(data.data());
+  return data;
+}
+
+std::vector<uint16_t> ConvertToHalf(const float* data, size_t size,
+                                    DataType type) {
+  std::vector<uint16_t> converted(size);
+  for (size_t i = 0; i < size; i++) {
+    converted[i] = DataType::BFLOAT16 == type ? vsi_nn_Fp32ToBFp16(data[i])
+                                              : vsi_nn_Fp32ToFp16(data[i]);
+  }
+  return converted;
+}
+
+// Symmetric int8, return the number of saturated values
+size_t QuantizeToInt8(const float* data, size_t size, float scale,
+                      std::vector<int8_t>& quantized) {
+  size_t saturated = 0;
+  quantized.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    float q = std::round(data[i] / scale);
+    if (q > 127.0f || q < -127.0f) saturated++;
+    quantized[i] = (int8_t)std::min(127.0f, std::max(-127.0f, q));
+  }
+  return saturated;
+}
+}  // namespace
+
+std::shared_ptr<Tensor> GraphImpl::CreatePrecisionConvert(
+    const std::shared_ptr<Tensor>& src, const std::shared_ptr<Tensor>& dst) {
+  CreateOperation<ops::DataConvert>()->BindInput(src).BindOutput(dst);
+  // The convert takes over a binding of the rewired operation, keep the free
+  // input/output counters unchanged
+  if (src->GetSpec().attr_ & TensorAttribute::INPUT) ProduceInput();
+  if (dst->GetSpec().attr_ & TensorAttribute::OUTPUT) ProduceOutput();
+  return dst;
+}
+
+bool GraphImpl::ApplyPrecisionPolicy() {
+  if (!options_.hasOpPrecision()) return true;
+
+  // DataConvert operations are appended to op_vector_ while rewiring
+  auto ops = op_vector_;
+  std::map<const Operation*, Precision> op_precision;
+  for (const auto& op : ops) {
+    if (op->impl()->kind_ == -1 || !op->impl()->node()) continue;
+    const char* kind = vsi_nn_OpGetName(op->impl()->kind_);
+    auto precision = options_.getOpPrecision(kind ? kind : "", op->uid());
+    if (Precision::FP32 != precision) {
+      op_precision[op.get()] = precision;
+    }
+  }
+  if (op_precision.empty()) return true;
+
+  // Data type `op` reads `tensor` in
+  auto wanted_type = [&op_precision](const std::shared_ptr<Operation>& op,
+                                     const std::shared_ptr<Tensor>& tensor) {
+    auto it = op_precision.find(op.get());
+    if (it == op_precision.end()) return DataType::FLOAT32;
+    auto inputs = op->impl()->InputsTensor();
+    if (IsWeightOp(op->impl()->kind_) && inputs.size() > 2 &&
+        inputs[2] == tensor) {
+      return DataType::FLOAT32;
+    }
+    return ComputeType(it->second);
+  };
+  auto low_spec = [](const std::shared_ptr<Tensor>& tensor, DataType type) {
+    return TensorSpec(type, tensor->GetShape(), TensorAttribute::TRANSIENT);
+  };
+
+  // FLOAT32 tensor -> its copy in a lower precision, INT8 keys the fp16
+  // tensor dequantized from an int8 weight
+  std::map<std::shared_ptr<Tensor>, std::map<DataType, std::shared_ptr<Tensor>>>
+      variants;
+  int32_t rewired = 0;
+
+  // Outputs are produced in the compute type and converted back only if a
+  // FLOAT32 consumer or the graph output needs them
+  for (const auto& op : ops) {
+    auto it = op_precision.find(op.get());
+    if (it == op_precision.end()) continue;
+    DataType type = ComputeType(it->second);
+    auto& impl = op->impl();
+    for (size_t i = 0; i < impl->outputs_tensor_.size(); i++) {
+      auto tensor = impl->outputs_tensor_[i];
+      if (tensor->IsPlaceHolder() ||
+          DataType::FLOAT32 != tensor->GetDataType()) {
+        continue;
+      }
+      auto low = CreateTensor(low_spec(tensor, type));
+      impl->node()->output.tensors[i] = low->GetId();
+      impl->outputs_tensor_[i] = low;
+      tensor_producer_.erase(tensor);
+      tensor_producer_[low] = op;
+      variants[tensor][type] = low;
+
+      bool need_fp32 = tensor->GetSpec().attr_ & TensorAttribute::OUTPUT;
+      for (const auto& consumer : tensor_consumers_[tensor]) {
+        need_fp32 = need_fp32 || type != wanted_type(consumer, tensor);
+      }
+      if (need_fp32) {
+        CreatePrecisionConvert(low, tensor);
+      }
+      rewired++;
+    }
+  }
+
+  for (const auto& op : ops) {
+    auto it = op_precision.find(op.get());
+    if (it == op_precision.end()) continue;
+    auto& impl = op->impl();
+    for (size_t i = 0; i < impl->inputs_tensor_.size(); i++) {
+      auto tensor = impl->inputs_tensor_[i];
+      if (tensor->IsPlaceHolder() ||
+          DataType::FLOAT32 != tensor->GetDataType()) {
+        continue;
+      }
+      DataType type = wanted_type(op, tensor);
+      if (DataType::FLOAT32 == type) continue;
+      bool int8_weight = Precision::INT8_WEIGHT_ONLY == it->second &&
+                         IsWeightOp(impl->kind_) && 1 == i &&
+                         tensor->IsConstTensor();
+      DataType key = int8_weight ? DataType::INT8 : type;
+
+      auto& variant = variants[tensor];
+      std::shared_ptr<Tensor> low;
+      if (variant.end() != variant.find(key)) {
+        low = variant[key];
+      } else if (int8_weight) {
+        // Symmetric int8 weight, dequantized to fp16 by DataConvert
+        auto data = ReadFloatConstant(tensor);
+        float abs_max = 0;
+        for (float v : data) abs_max = std::max(abs_max, std::fabs(v));
+        float scale = abs_max > 0 ? abs_max / 127.0f : 1.0f;
+        std::vector<int8_t> quantized;
+        QuantizeToInt8(data.data(), data.size(), scale, quantized);
+        Quantization quant(QuantType::ASYMMETRIC, scale, 0);
+        TensorSpec spec(DataType::INT8, tensor->GetShape(),
+                        TensorAttribute::CONSTANT, quant);
+        auto weight = CreateTensor(spec, quantized.data());
+        const_variants_[tensor].push_back(weight);
+        low = CreatePrecisionConvert(weight,
+                                     CreateTensor(low_spec(tensor, type)));
+      } else if (tensor->IsConstTensor()) {
+        auto data = ReadFloatConstant(tensor);
+        auto converted = ConvertToHalf(data.data(), data.size(), type);
+        TensorSpec spec(type, tensor->GetShape(), TensorAttribute::CONSTANT);
+        low = CreateTensor(spec, converted.data());
+        const_variants_[tensor].push_back(low);
+      } else {
+        low = CreatePrecisionConvert(tensor,
+                                     CreateTensor(low_spec(tensor, type)));
+      }
+      variant[key] = low;
+
+      impl->node()->input.tensors[i] = low->GetId();
+      impl->inputs_tensor_[i] = low;
+      auto& consumers = tensor_consumers_[tensor];
+      consumers.erase(std::remove(consumers.begin(), consumers.end(), op),
+                      consumers.end());
+      tensor_consumers_[low].push_back(op);
+      rewired++;
+    }
+  }
+  VSILOGD("Precision policy: %d operations, %d tensors rewired.",
+          (int)op_precision.size(), rewired);
+  return true;
+}
+
 bool GraphImpl::Setup() {
   bool status = true;
 
@@ -342,6 +594,10 @@ bool GraphImpl::Setup() {
   }
   vsi_nn_SetGraphFastMode(graph_, is_fast_mode);
 
+  std::call_once(precision_once_, [&status, this]() {
+    status = ApplyPrecisionPolicy();
+  });
+
 #if defined(ENABLE_PLATFORM)
   auto id = options_.getDeviceId();
   vxSetGraphAttribute(graph_->g, VX_GRAPH_DEVICE_INDEX_VIV, (void*)(&id),
@@ -375,8 +631,18 @@ bool GraphImpl::Compile() {
         "consumed.");
   }
   status = Setup();
+  // Retried by later compiles until the graph fits into the budget
+  if (status && !memory_reserved_) {
+    auto report = GetMemoryReport();
+    if (!context_->ReserveMemory(report, "Graph")) {
+      return false;
+    }
+    memory_reserved_ = true;
+    reserved_bytes_ = report.Total();
+  }
   std::call_once(verify_graph_once_, [&status, this]() {
     status = (VSI_SUCCESS == vsi_nn_VerifyGraph(this->graph_));
+    verified_ = status;
   });
 
   return status;
@@ -386,9 +652,216 @@ bool GraphImpl::CompileToBinary(void* buf, size_t* size) {
   return ((Setup()) && (VSI_SUCCESS == vsi_nn_GenerateNBG(graph_, buf, size)));
 }
 
+std::future<bool> GraphImpl::CompileAsync() {
+  auto self = shared_from_this();
+  return std::async(std::launch::async, [self]() { return self->Compile(); });
+}
+
 bool GraphImpl::Run() {
   return ((Compile()) && (VSI_SUCCESS == vsi_nn_RunGraph(graph_)));
 }
 
+bool GraphImpl::RunLoop(int32_t max_iteration) {
+  return ((Compile()) &&
+          (VSI_SUCCESS == vsi_nn_ExecuteGraphLoopEx(graph_, max_iteration)));
+}
+
+bool GraphImpl::UpdateConstant(const std::shared_ptr<Tensor>& tensor,
+                               const void* data) {
+  auto impl = std::dynamic_pointer_cast<TensorImpl>(tensor);
+  if (!impl || impl->graph_ != this || !tensor->IsConstTensor() || !data) {
+    VSILOGE("Only constant tensors of this graph can be updated");
+    return false;
+  }
+  // Nodes of clones read shared constants but can't be rebuilt from here,
+  // a constant a clone shares belongs to the graph it was cloned from
+  auto shared_with_clone = [this](const std::shared_ptr<Tensor>& target) {
+    vsi_nn_tensor_t* t = vsi_nn_GetTensor(graph_, target->GetId());
+    for (const auto& weak_clone : clones_) {
+      auto clone = weak_clone.lock();
+      if (!clone) continue;
+      for (auto id : clone->shared_tensors_) {
+        if (vsi_nn_GetTensor(clone->graph_, id) == t) return true;
+      }
+    }
+    return false;
+  };
+  bool shared = shared_tensors_.end() != std::find(shared_tensors_.begin(),
+                                                   shared_tensors_.end(),
+                                                   tensor->GetId()) ||
+                shared_with_clone(tensor);
+  auto variants = const_variants_.find(tensor);
+  if (variants != const_variants_.end()) {
+    for (const auto& variant : variants->second) {
+      shared = shared || shared_with_clone(variant);
+    }
+  }
+  if (shared) {
+    VSILOGE("Constant tensor is shared through CloneShared() and can't be "
+            "updated");
+    return false;
+  }
+#ifdef ENABLE_TENSOR_CACHE
+  // The cache key is derived from the old data
+  for (auto it = cached_tensor_.begin(); it != cached_tensor_.end();) {
+    it = it->second == tensor ? cached_tensor_.erase(it) : std::next(it);
+  }
+#endif
+
+  // Rebuild the readers of `target` on top of `target_data`, which is in the
+  // layout `target` was created with; rewrites done at setup, e.g. int8 to
+  // uint8, are replayed by vsi_nn_UpdateConstTensor
+  uint32_t rebuilt = 0;
+  auto update = [this, &rebuilt](const std::shared_ptr<Tensor>& target,
+                                 const void* target_data) {
+    vsi_nn_tensor_t* t = vsi_nn_GetTensor(graph_, target->GetId());
+    if (!t) return false;
+    uint32_t size = vsi_nn_GetTensorSize(t->attr.size, t->attr.dim_num,
+                                         t->attr.dtype.vx_type);
+    const uint8_t* begin = static_cast<const uint8_t*>(target_data);
+    std::vector<uint8_t> data_copy(begin, begin + size);
+    if (!t->attr.is_created_from_handle &&
+        (t->attr.dtype.vx_type == VSI_NN_TYPE_INT4 ||
+         t->attr.dtype.vx_type == VSI_NN_TYPE_UINT4)) {
+      // 4-bit data is passed packed, see TensorImpl::CopyDataToTensor
+      std::vector<uint8_t> unpacked(vsi_nn_GetElementNum(t));
+      vsi_nn_Unpack4bitData(t, data_copy.data(), unpacked.data(),
+                            t->attr.dtype.vx_type);
+      data_copy.swap(unpacked);
+    }
+    uint32_t count = 0;
+    if (VSI_SUCCESS != vsi_nn_UpdateConstTensor(graph_, target->GetId(),
+                                                data_copy.data(), &count)) {
+      return false;
+    }
+    rebuilt += count;
+    return true;
+  };
+
+  if (!update(tensor, data)) return false;
+
+  if (variants != const_variants_.end()) {
+    const float* values = static_cast<const float*>(data);
+    size_t size = tensor->GetSpec().GetElementNum();
+    for (const auto& variant : variants->second) {
+      bool done = false;
+      if (DataType::INT8 == variant->GetDataType()) {
+        std::vector<int8_t> quantized;
+        float scale = variant->GetQuantization().Scales()[0];
+        if (QuantizeToInt8(values, size, scale, quantized) > 0) {
+          VSILOGW("Int8 weight saturated with the scale of its first data");
+        }
+        done = update(variant, quantized.data());
+      } else {
+        auto converted = ConvertToHalf(values, size, variant->GetDataType());
+        done = update(variant, converted.data());
+      }
+      if (!done) return false;
+    }
+  }
+
+  // Recreated vx nodes are verified by the driver, ovxlib setup is kept
+  if (rebuilt > 0 && verified_) {
+    return VSI_SUCCESS == vsi_nn_VerifyGraph(graph_);
+  }
+  return true;
+}
+
+std::string MemoryReport::ToString() const {
+  return "total " + std::to_string(Total()) + " (constant " +
+         std::to_string(constant) + ", input " + std::to_string(input) +
+         ", output " + std::to_string(output) + ", intermediate " +
+         std::to_string(intermediate) + ", command " +
+         std::to_string(command) + ", binary " + std::to_string(binary) +
+         ", others " + std::to_string(others) + ")";
+}
+
+MemoryReport GraphImpl::GetMemoryReport() const {
+  auto contains = [](const std::vector<vsi_nn_tensor_id_t>& ids,
+                     vsi_nn_tensor_id_t id) {
+    return ids.end() != std::find(ids.begin(), ids.end(), id);
+  };
+  MemoryReport report;
+  // Views alias their parent, shared tensors are owned by another graph
+  for (vsi_nn_tensor_id_t id = 0; id < graph_->cur_tid; id++) {
+    vsi_nn_tensor_t* tensor = vsi_nn_GetTensor(graph_, id);
+    if (!tensor || contains(view_tensors_, id) ||
+        contains(shared_tensors_, id)) {
+      continue;
+    }
+    size_t bytes = vsi_nn_GetTensorSize(tensor->attr.size, tensor->attr.dim_num,
+                                        tensor->attr.dtype.vx_type);
+    if (tensor->attr.is_const) {
+      report.constant += bytes;
+    } else if (contains(inputs_, id)) {
+      report.input += bytes;
+    } else if (contains(outputs_, id)) {
+      report.output += bytes;
+    } else {
+      report.intermediate += bytes;
+    }
+  }
+  report.binary = binary_bytes_;
+  return report;
+}
+
+vsi_nn_tensor_id_t GraphImpl::AttachSharedTensor(vsi_nn_tensor_t* tensor) {
+  auto id = vsi_nn_AttachTensorToGraph(graph_, VSI_NN_TENSOR_ID_AUTO, tensor);
+  if (VSI_NN_TENSOR_ID_NA != id) {
+    shared_tensors_.push_back(id);
+  }
+  return id;
+}
+
+std::shared_ptr<Graph> GraphImpl::CloneShared() {
+  auto clone = std::make_shared<GraphImpl>(context_, options_);
+  std::shared_ptr<Graph> clone_graph = clone;
+  // Shared constants are owned by this graph
+  clone->AttachResource(shared_from_this());
+  clones_.push_back(clone);
+
+  std::map<std::shared_ptr<Tensor>, std::shared_ptr<Tensor>> tensor_map;
+  auto map_tensor = [&](const std::shared_ptr<Tensor>& t) {
+    auto it = tensor_map.find(t);
+    if (it != tensor_map.end()) {
+      return it->second;
+    }
+    std::shared_ptr<Tensor> cloned;
+    if (t->IsPlaceHolder()) {
+      cloned = clone->CreateTensorPlaceHolder();
+    } else if (t->IsConstTensor()) {
+      cloned = std::make_shared<TensorImpl>(
+          clone.get(), t->GetSpec(), vsi_nn_GetTensor(graph_, t->GetId()));
+    } else {
+      cloned = clone->CreateTensor(t->GetSpec());
+    }
+    if (t->IsScalar()) {
+      cloned->SetScalar(1);
+    }
+    tensor_map[t] = cloned;
+    return cloned;
+  };
+  // Keep the order of graph inputs and outputs
+  for (const auto& t : inputs_tensor_) map_tensor(t);
+  for (const auto& t : outputs_tensor_) map_tensor(t);
+
+  for (const auto& op : op_vector_) {
+    // Composed operations are cloned through the builtin operations they
+    // have created in this graph
+    if (op->impl()->kind_ == -1 || !op->impl()->node()) {
+      continue;
+    }
+    auto cloned_op = op->Clone(clone_graph);
+    cloned_op->impl()->node()->vx_param = op->impl()->node()->vx_param;
+    for (const auto& t : op->impl()->InputsTensor()) {
+      cloned_op->BindInput(map_tensor(t));
+    }
+    for (const auto& t : op->impl()->OutputsTensor()) {
+      cloned_op->BindOutput(map_tensor(t));
+    }
+  }
+  return clone_graph;
+}
+
 }  // namespace vx
 }  // namespace tim
@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops/unidirectional_sequence_lstm.h"
+#include "graph_private.h"
+#include "vsi_nn_pub.h"
+#include "vsi_nn_types_prv.h"
+#include "utils/vsi_nn_arena.h"
+
+TEST(graph_arena, alloc_is_zeroed_aligned_and_counted) {
+  vsi_nn_arena_t* arena = vsi_nn_arena_create(1024);
+  ASSERT_TRUE(arena);
+
+  std::vector<uint8_t*> ptrs;
+  for (size_t i = 1; i < 200; i++) {
+    auto ptr = static_cast<uint8_t*>(vsi_nn_arena_alloc(arena, i));
+    ASSERT_TRUE(ptr);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % 16);
+    for (size_t j = 0; j < i; j++) {
+      ASSERT_EQ(0, ptr[j]);
+    }
+    memset(ptr, 0xFF, i);
+    ptrs.push_back(ptr);
+  }
+  // A large request must not waste the current block.
+  auto big = static_cast<uint8_t*>(vsi_nn_arena_alloc(arena, 4096));
+  ASSERT_TRUE(big);
+  memset(big, 0xFF, 4096);
+
+  vsi_nn_arena_stat_t stat;
+  vsi_nn_arena_get_stat(arena, &stat);
+  EXPECT_EQ(200u, stat.alloc_count);
+  EXPECT_GE(stat.reserved_bytes, stat.alloc_bytes);
+  EXPECT_LT(stat.block_count, stat.alloc_count / 4);
+
+  vsi_nn_arena_release(&arena);
+  EXPECT_EQ(nullptr, arena);
+}
+
+TEST(graph_arena, lstm_internal_nodes_use_graph_arena) {
+  const uint32_t n_batch = 1, n_step = 16, n_input = 64, n_cell = 128;
+  auto ctx = tim::vx::Context::Create();
+  auto g = ctx->CreateGraph();
+
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32,
+                                 {n_input, n_step, n_batch},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32,
+                                  {n_cell, n_step, n_batch},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec state_spec(tim::vx::DataType::FLOAT32, {n_cell, n_batch},
+                                 tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec i2x_weight_spec(tim::vx::DataType::FLOAT32,
+                                      {n_input, n_cell},
+                                      tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec r2x_weight_spec(tim::vx::DataType::FLOAT32,
+                                      {n_cell, n_cell},
+                                      tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {n_cell},
+                                tim::vx::TensorAttribute::CONSTANT);
+  std::vector<float> i2x_weight(n_input * n_cell, 0.01f);
+  std::vector<float> r2x_weight(n_cell * n_cell, 0.01f);
+  std::vector<float> bias(n_cell, 0.01f);
+
+  std::vector<std::shared_ptr<tim::vx::Tensor>> inputs = {
+      g->CreateTensor(input_spec),
+      g->CreateTensorPlaceHolder(), /*h_state*/
+      g->CreateTensorPlaceHolder(), /*c_state*/
+  };
+  for (int i = 0; i < 4; i++) {
+    inputs.push_back(g->CreateTensor(i2x_weight_spec, i2x_weight.data()));
+  }
+  for (int i = 0; i < 4; i++) {
+    inputs.push_back(g->CreateTensor(r2x_weight_spec, r2x_weight.data()));
+  }
+  for (int i = 0; i < 3; i++) {
+    inputs.push_back(g->CreateTensorPlaceHolder()); /*weight_c2x*/
+  }
+  for (int i = 0; i < 4; i++) {
+    inputs.push_back(g->CreateTensor(bias_spec, bias.data()));
+  }
+  auto op = g->CreateOperation<tim::vx::ops::UnidirectionalSequenceLstm>(
+      0.0, 0.0, tim::vx::ops::UnidirectionalSequenceLstm::ActivationType::kTANH,
+      0.0, false, tim::vx::ops::UnidirectionalSequenceLstm::kSIGMOID, true);
+  (*op).BindInputs(inputs).BindOutputs({
+      g->CreateTensor(output_spec),
+      g->CreateTensor(state_spec),
+      g->CreateTensor(state_spec),
+  });
+
+  ASSERT_TRUE(g->Compile());
+
+  auto graph = reinterpret_cast<vsi_nn_graph_prv_t*>(
+      std::static_pointer_cast<tim::vx::GraphImpl>(g)->graph());
+  vsi_nn_arena_stat_t stat;
+  vsi_nn_arena_get_stat(graph->arena, &stat);
+  // Each time step expands into several internal nodes and tensors, all of
+  // them carved from a few arena blocks.
+  EXPECT_GT(stat.alloc_count, n_step);
+  EXPECT_GE(stat.reserved_bytes, stat.alloc_bytes);
+  EXPECT_LT(stat.block_count, stat.alloc_count / 4);
+}
@@ -40,7 +40,8 @@
 namespace tim {
 namespace vx {
 
-class GraphImpl : public Graph {
+class GraphImpl : public Graph,
+                  public std::enable_shared_from_this<GraphImpl> {
  public:
   GraphImpl(ContextImpl* context,
             const CompileOption& options = CompileOption::DefaultOptions);
@@ -90,19 +91,37 @@ class GraphImpl : public Graph {
   std::shared_ptr<Tensor> CreateIOTensor(const TensorSpec& spec,
                                          void* data = nullptr) override;
   std::shared_ptr<Tensor> CreateTensorPlaceHolder() override;
+  std::shared_ptr<Tensor> CreateTensorView(
+      const std::shared_ptr<Tensor>& parent, const ShapeType& start,
+      const ShapeType& end) override;
 
   bool Compile() override;
   bool CompileToBinary(void* buf, size_t* size) override;
+  std::future<bool> CompileAsync() override;
   bool Run() override;
+  bool RunLoop(int32_t max_iteration) override;
+  std::shared_ptr<Graph> CloneShared() override;
+  bool UpdateConstant(const std::shared_ptr<Tensor>& tensor,
+                      const void* data) override;
+  MemoryReport GetMemoryReport() const override;
   void ProduceInput() { not_consumed_input_cnt_++; }
   void ProduceOutput() { not_consumed_output_cnt_++; }
   void ConsumeInput() { not_consumed_input_cnt_--; }
   void ConsumeOutput() { not_consumed_output_cnt_--; }
+  /// Keep `resource` alive until the low-level graph is released
+  void AttachResource(const std::shared_ptr<void>& resource) {
+    resources_.push_back(resource);
+  }
+  /// Attach a tensor owned by another graph of the same context
+  vsi_nn_tensor_id_t AttachSharedTensor(vsi_nn_tensor_t* tensor);
+  /// Account a binary graph of `bytes` run by an NBG operation
+  void AddBinarySize(size_t bytes) { binary_bytes_ += bytes; }
 
  protected:
   ContextImpl* context_;
   vsi_nn_graph_t* graph_;
   std::shared_ptr<Tensor> tensor_placeholder_;
+  std::once_flag precision_once_;
   std::once_flag setio_once_;
   std::once_flag setup_once_;
   std::once_flag verify_graph_once_;
@@ -120,10 +139,28 @@ class GraphImpl : public Graph {
   std::map<std::string, std::shared_ptr<tim::vx::Tensor>> cached_tensor_;
 #endif
   CompileOption options_;
+  std::vector<std::shared_ptr<void>> resources_;
+  std::vector<vsi_nn_tensor_id_t> shared_tensors_;
+  /// Graphs created by CloneShared(), they read the constants of this graph
+  std::vector<std::weak_ptr<GraphImpl>> clones_;
+  std::vector<vsi_nn_tensor_id_t> view_tensors_;
+  size_t binary_bytes_;
+  /// Memory accounted against the budget of context_ once compiled
+  bool memory_reserved_;
+  size_t reserved_bytes_;
+  /// Constants derived from a FLOAT32 constant by the precision policy
+  std::map<std::shared_ptr<Tensor>, std::vector<std::shared_ptr<Tensor>>>
+      const_variants_;
+  bool verified_;
 
  private:
   /// Setup graph
   bool Setup();
+  /// Rewire operations covered by the per-op precision of options_
+  bool ApplyPrecisionPolicy();
+  /// Insert a DataConvert from `src` to `dst`, return `dst`
+  std::shared_ptr<Tensor> CreatePrecisionConvert(
+      const std::shared_ptr<Tensor>& src, const std::shared_ptr<Tensor>& dst);
 };
 
 }  // namespace vx
@@ -24,6 +24,7 @@
 #include "tim/vx/context.h"
 #include "tim/vx/graph.h"
 #include "tim/vx/ops.h"
+#include "tim/vx/compile_option.h"
 
 #include "gtest/gtest.h"
 
@@ -90,6 +91,79 @@ TEST(graph, gen_binary_graph_with_simple_add) {
     EXPECT_EQ(output, expected_out);
 }
 
+TEST(graph, clone_shared_with_simple_add) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    std::vector<float> weight = {10.0f, 20.0f};
+    auto input_t = graph->CreateTensor(input_spec);
+    auto weight_t = graph->CreateTensor(const_spec, weight.data());
+    auto output_t = graph->CreateTensor(output_spec);
+
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({input_t, weight_t}).BindOutputs({output_t});
+
+    auto clone = graph->CloneShared();
+    ASSERT_TRUE(clone);
+    EXPECT_EQ(clone->OpVector().size(), 1);
+    ASSERT_EQ(clone->InputsTensor().size(), 1);
+    ASSERT_EQ(clone->OutputsTensor().size(), 1);
+    auto clone_weight = clone->GetConstantInputs();
+    ASSERT_EQ(clone_weight.size(), 1);
+    std::vector<float> shared_weight(2);
+    EXPECT_TRUE(clone_weight[0]->CopyDataFromTensor(shared_weight.data()));
+    EXPECT_EQ(shared_weight, weight);
+
+    std::vector<float> in = {1.0f, 2.0f};
+    std::vector<float> clone_in = {3.0f, 4.0f};
+    EXPECT_TRUE(input_t->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(clone->InputsTensor()[0]->CopyDataToTensor(
+        clone_in.data(), clone_in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Run());
+    EXPECT_TRUE(clone->Run());
+
+    std::vector<float> output(2), clone_output(2);
+    EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+    EXPECT_TRUE(clone->OutputsTensor()[0]->CopyDataFromTensor(clone_output.data()));
+    EXPECT_EQ(output, std::vector<float>({11.0f, 22.0f}));
+    EXPECT_EQ(clone_output, std::vector<float>({13.0f, 24.0f}));
+
+    // the clone keeps the shared constants alive
+    graph.reset();
+    EXPECT_TRUE(clone->Run());
+}
+
+TEST(graph, compile_async_with_simple_add) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto input_t0 = graph->CreateTensor(input_spec);
+    auto input_t1 = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({input_t0, input_t1}).BindOutputs({output_t});
+
+    auto compiled = graph->CompileAsync();
+    ASSERT_TRUE(compiled.get());
+
+    std::vector<float> in0 = {1.0f, 2.0f};
+    std::vector<float> in1 = {3.0f, 4.0f};
+    EXPECT_TRUE(input_t0->CopyDataToTensor(in0.data(), in0.size() * sizeof(float)));
+    EXPECT_TRUE(input_t1->CopyDataToTensor(in1.data(), in1.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output(2);
+    EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+    EXPECT_EQ(output, std::vector<float>({4.0f, 6.0f}));
+}
+
 // You can disable compile trace_test if only need replay
 // #undef ENABLE_API_TRACE
 #ifdef ENABLE_API_TRACE
@@ -170,3 +244,367 @@ TEST(graph, replay_test) {
 }
 
 #endif /* #if 0 */
+
+TEST(graph, run_loop_with_counter) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType shape({1});
+    tim::vx::TensorSpec index_spec(tim::vx::DataType::INT32, shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec cond_in_spec(tim::vx::DataType::BOOL8, shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec cond_out_spec(tim::vx::DataType::BOOL8, shape, tim::vx::TensorAttribute::OUTPUT);
+    tim::vx::TensorSpec var_in_spec(tim::vx::DataType::FLOAT32, shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec var_out_spec(tim::vx::DataType::FLOAT32, shape, tim::vx::TensorAttribute::OUTPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, shape, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec less_spec(tim::vx::DataType::BOOL8, shape, tim::vx::TensorAttribute::TRANSIENT);
+
+    // Loop inputs: index, cond_in, var; loop outputs: cond_out, var_out
+    auto index = graph->CreateTensor(index_spec);
+    auto cond_in = graph->CreateTensor(cond_in_spec);
+    auto var_in = graph->CreateTensor(var_in_spec);
+    auto cond_out = graph->CreateTensor(cond_out_spec);
+    auto var_out = graph->CreateTensor(var_out_spec);
+
+    float one = 1.0f, limit = 5.0f;
+    auto one_t = graph->CreateTensor(const_spec, &one);
+    auto limit_t = graph->CreateTensor(const_spec, &limit);
+    auto less_t = graph->CreateTensor(less_spec);
+
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({var_in, one_t}).BindOutputs({var_out});
+    auto less = graph->CreateOperation<tim::vx::ops::Less>();
+    (*less).BindInputs({var_out, limit_t}).BindOutputs({less_t});
+    auto logical_and = graph->CreateOperation<tim::vx::ops::LogicalAnd>();
+    (*logical_and).BindInputs({cond_in, less_t}).BindOutputs({cond_out});
+    (void)index;
+
+    float var = 0.0f;
+    uint8_t cond = 1;
+    EXPECT_TRUE(var_in->CopyDataToTensor(&var, sizeof(var)));
+    EXPECT_TRUE(cond_in->CopyDataToTensor(&cond, sizeof(cond)));
+
+    // Stops on the condition after 5 iterations
+    EXPECT_TRUE(graph->RunLoop(100));
+    float output = 0.0f;
+    EXPECT_TRUE(var_out->CopyDataFromTensor(&output));
+    EXPECT_EQ(output, 5.0f);
+
+    // Stops on max_iteration
+    EXPECT_TRUE(var_in->CopyDataToTensor(&var, sizeof(var)));
+    EXPECT_TRUE(cond_in->CopyDataToTensor(&cond, sizeof(cond)));
+    EXPECT_TRUE(graph->RunLoop(3));
+    EXPECT_TRUE(var_out->CopyDataFromTensor(&output));
+    EXPECT_EQ(output, 3.0f);
+}
+
+TEST(graph, share_handle_between_graphs) {
+    auto ctx = tim::vx::Context::Create();
+    auto backbone = ctx->CreateGraph();
+    auto head = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    tim::vx::TensorSpec bad_spec(tim::vx::DataType::FLOAT32, {3}, tim::vx::TensorAttribute::INPUT);
+
+    auto a_in = backbone->CreateTensor(input_spec);
+    auto a_out = backbone->CreateTensor(output_spec);
+    auto a_add = backbone->CreateOperation<tim::vx::ops::Add>();
+    (*a_add).BindInputs({a_in, a_in}).BindOutputs({a_out});
+
+    auto b_in = head->CreateTensor(input_spec);
+    auto b_out = head->CreateTensor(output_spec);
+    auto b_mul = head->CreateOperation<tim::vx::ops::Multiply>();
+    (*b_mul).BindInputs({b_in, b_in}).BindOutputs({b_out});
+
+    auto other = ctx->CreateGraph();
+    auto bad_in = other->CreateTensor(bad_spec);
+    EXPECT_FALSE(bad_in->ShareHandleWith(a_out)) << "Shape mismatch must be rejected";
+    EXPECT_FALSE(a_out->ShareHandleWith(b_in)) << "Only an INPUT can borrow from an OUTPUT";
+
+    EXPECT_TRUE(b_in->ShareHandleWith(a_out));
+
+    std::vector<float> in = {1.0f, 2.0f};
+    std::vector<float> expected_out = {4.0f, 16.0f};
+    EXPECT_TRUE(a_in->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(backbone->Run());
+    EXPECT_TRUE(head->Run());
+
+    std::vector<float> output(expected_out.size());
+    EXPECT_TRUE(b_out->CopyDataFromTensor(output.data()));
+    EXPECT_EQ(output, expected_out);
+}
+
+static std::shared_ptr<tim::vx::Tensor> BuildFcRelu(
+    const std::shared_ptr<tim::vx::Graph>& graph,
+    std::shared_ptr<tim::vx::Tensor>& output) {
+    static std::vector<float> weight = {-3, 3, 2, 1, 0, 4};
+    static std::vector<float> bias = {0.1, 0.4, 0.6};
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 1}, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {2, 3}, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {3}, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec fc_spec(tim::vx::DataType::FLOAT32, {3, 1}, tim::vx::TensorAttribute::TRANSIENT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {3, 1}, tim::vx::TensorAttribute::OUTPUT);
+
+    auto input = graph->CreateTensor(input_spec);
+    auto fc_out = graph->CreateTensor(fc_spec);
+    output = graph->CreateTensor(output_spec);
+    auto fc = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 3);
+    (*fc).BindInputs({input, graph->CreateTensor(weight_spec, weight.data()),
+                      graph->CreateTensor(bias_spec, bias.data())})
+        .BindOutputs({fc_out});
+    auto relu = graph->CreateOperation<tim::vx::ops::Relu>();
+    (*relu).BindInputs({fc_out}).BindOutputs({output});
+    return input;
+}
+
+TEST(graph, op_precision_policy) {
+    auto ctx = tim::vx::Context::Create();
+    std::vector<float> in = {1.0f, 4.0f};
+    std::vector<float> golden = {9.1f, 6.4f, 16.6f};
+
+    for (auto precision : {tim::vx::Precision::FP16, tim::vx::Precision::BF16,
+                           tim::vx::Precision::INT8_WEIGHT_ONLY}) {
+        tim::vx::CompileOption option;
+        option.setOpPrecisionByKind("FCL2", precision);
+        auto graph = ctx->CreateGraph(option);
+        std::shared_ptr<tim::vx::Tensor> output;
+        auto input = BuildFcRelu(graph, output);
+        EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+        EXPECT_TRUE(graph->Run());
+
+        // FC input and output cross the boundary to the FP32 relu, the int8
+        // weight is dequantized on device
+        size_t converts = tim::vx::Precision::INT8_WEIGHT_ONLY == precision ? 3 : 2;
+        EXPECT_EQ(2 + converts, graph->OpVector().size());
+
+        std::vector<float> output_data(golden.size());
+        EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+        for (size_t i = 0; i < golden.size(); i++) {
+            EXPECT_NEAR(golden[i], output_data[i], 0.2f);
+        }
+    }
+}
+
+TEST(graph, tensor_view_split_without_copy) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    // Rows {q, k} of a fused {2, 2} input, consumed without a Split
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 2}, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {2, 1}, tim::vx::TensorAttribute::OUTPUT);
+    auto input = graph->CreateTensor(input_spec);
+    auto output = graph->CreateTensor(output_spec);
+    auto q = graph->CreateTensorView(input, {0, 0}, {2, 1});
+    auto k = graph->CreateTensorView(input, {0, 1}, {2, 2});
+    ASSERT_TRUE(q);
+    ASSERT_TRUE(k);
+    EXPECT_EQ(tim::vx::ShapeType({2, 1}), q->GetShape());
+    EXPECT_EQ(tim::vx::TensorAttribute::TRANSIENT, q->GetSpec().attr_);
+
+    EXPECT_FALSE(graph->CreateTensorView(input, {0, 1}, {2, 3})) << "Out of range";
+    EXPECT_FALSE(graph->CreateTensorView(input, {1}, {2})) << "Rank mismatch";
+    EXPECT_FALSE(graph->CreateTensorView(q, {0, 0}, {1, 1})) << "Transient parent";
+
+    auto mul = graph->CreateOperation<tim::vx::ops::Multiply>();
+    (*mul).BindInputs({q, k}).BindOutputs({output});
+
+    std::vector<float> in = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> expected_out = {3.0f, 8.0f};
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Run());
+
+    std::vector<float> output_data(expected_out.size());
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    EXPECT_EQ(expected_out, output_data);
+}
+
+TEST(graph, update_constant_between_runs) {
+    auto ctx = tim::vx::Context::Create();
+    std::vector<float> in = {1.0f, 4.0f};
+    std::vector<float> weight = {-3, 3, 2, 1, 0, 4};
+    std::vector<float> new_weight = {1, 1, 1, 1, 1, 1};
+    std::vector<float> bias = {0.1, 0.4, 0.6};
+
+    // FP16 also rewrites the weight copy made by the precision policy
+    for (auto precision : {tim::vx::Precision::FP32, tim::vx::Precision::FP16}) {
+        tim::vx::CompileOption option;
+        option.setOpPrecisionByKind("FCL2", precision);
+        auto graph = ctx->CreateGraph(option);
+        tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 1}, tim::vx::TensorAttribute::INPUT);
+        tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {2, 3}, tim::vx::TensorAttribute::CONSTANT);
+        tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {3}, tim::vx::TensorAttribute::CONSTANT);
+        tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {3, 1}, tim::vx::TensorAttribute::OUTPUT);
+        auto input = graph->CreateTensor(input_spec);
+        auto weight_tensor = graph->CreateTensor(weight_spec, weight.data());
+        auto output = graph->CreateTensor(output_spec);
+        auto fc = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 3);
+        (*fc).BindInputs({input, weight_tensor, graph->CreateTensor(bias_spec, bias.data())})
+            .BindOutputs({output});
+
+        EXPECT_FALSE(graph->UpdateConstant(input, new_weight.data())) << "Not a constant";
+        EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+        EXPECT_TRUE(graph->Run());
+        std::vector<float> output_data(3);
+        EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+        std::vector<float> golden = {9.1f, 6.4f, 16.6f};
+        for (size_t i = 0; i < golden.size(); i++) {
+            EXPECT_NEAR(golden[i], output_data[i], 0.05f);
+        }
+
+        EXPECT_TRUE(graph->UpdateConstant(weight_tensor, new_weight.data()));
+        EXPECT_TRUE(graph->Run());
+        EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+        golden = {5.1f, 5.4f, 5.6f};
+        for (size_t i = 0; i < golden.size(); i++) {
+            EXPECT_NEAR(golden[i], output_data[i], 0.05f);
+        }
+    }
+}
+
+TEST(graph, update_constant_shared_with_clone) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2}, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, {2}, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {2}, tim::vx::TensorAttribute::OUTPUT);
+    std::vector<float> weight = {10.0f, 20.0f};
+    std::vector<float> new_weight = {1.0f, 2.0f};
+    auto input = graph->CreateTensor(input_spec);
+    auto weight_tensor = graph->CreateTensor(const_spec, weight.data());
+    auto output = graph->CreateTensor(output_spec);
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({input, weight_tensor}).BindOutputs({output});
+
+    // Neither side may rewrite a constant the clone reads
+    auto clone = graph->CloneShared();
+    ASSERT_TRUE(clone);
+    auto clone_weight = clone->GetConstantInputs();
+    ASSERT_EQ(clone_weight.size(), 1);
+    EXPECT_FALSE(graph->UpdateConstant(weight_tensor, new_weight.data()));
+    EXPECT_FALSE(clone->UpdateConstant(clone_weight[0], new_weight.data()));
+    std::vector<float> shared_weight(2);
+    EXPECT_TRUE(weight_tensor->CopyDataFromTensor(shared_weight.data()));
+    EXPECT_EQ(shared_weight, weight);
+
+    clone_weight.clear();
+    clone.reset();
+    EXPECT_TRUE(graph->UpdateConstant(weight_tensor, new_weight.data()));
+    std::vector<float> in = {1.0f, 2.0f};
+    EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output_data(2);
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    EXPECT_EQ(output_data, std::vector<float>({2.0f, 4.0f}));
+}
+
+TEST(graph, update_constant_int8_asymmetric_weight) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    tim::vx::Quantization quant(tim::vx::QuantType::ASYMMETRIC, 1.0f, 0);
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::INT8, {2, 1}, tim::vx::TensorAttribute::INPUT, quant);
+    tim::vx::TensorSpec weight_spec(tim::vx::DataType::INT8, {2, 3}, tim::vx::TensorAttribute::CONSTANT, quant);
+    tim::vx::TensorSpec bias_spec(tim::vx::DataType::INT32, {3}, tim::vx::TensorAttribute::CONSTANT, quant);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::INT8, {3, 1}, tim::vx::TensorAttribute::OUTPUT, quant);
+    std::vector<int8_t> in = {1, 4};
+    std::vector<int8_t> weight = {-3, 3, 2, 1, 0, 4};
+    std::vector<int32_t> bias = {1, 2, 3};
+    auto input = graph->CreateTensor(input_spec);
+    auto weight_tensor = graph->CreateTensor(weight_spec, weight.data());
+    auto output = graph->CreateTensor(output_spec);
+    auto fc = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 3);
+    (*fc).BindInputs({input, weight_tensor, graph->CreateTensor(bias_spec, bias.data())})
+        .BindOutputs({output});
+
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size()));
+    EXPECT_TRUE(graph->Run());
+    std::vector<int8_t> output_data(3);
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    EXPECT_EQ(std::vector<int8_t>({10, 8, 19}), output_data);
+
+    // Setup stores the weight as uint8, the int8 update is converted alike
+    std::vector<int8_t> new_weight = {-1, 1, 2, -2, 0, 1};
+    EXPECT_TRUE(graph->UpdateConstant(weight_tensor, new_weight.data()));
+    EXPECT_TRUE(graph->Run());
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    EXPECT_EQ(std::vector<int8_t>({4, -4, 7}), output_data);
+}
+
+TEST(graph, update_constant_deconv_weight) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 2, 1, 1}, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, {2, 2, 1, 1}, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {4, 4, 1, 1}, tim::vx::TensorAttribute::OUTPUT);
+    std::vector<float> in = {1, 2, 3, 4};
+    std::vector<float> kernel = {1, 2, 3, 4};
+    auto input = graph->CreateTensor(input_spec);
+    auto kernel_tensor = graph->CreateTensor(kernel_spec, kernel.data());
+    auto output = graph->CreateTensor(output_spec);
+    auto deconv = graph->CreateOperation<tim::vx::ops::DeConv2d>(
+        1, tim::vx::PadType::VALID,
+        std::array<uint32_t, 2>({2, 2}), /*ksize*/
+        std::array<uint32_t, 2>({2, 2}), /*stride*/
+        std::array<uint32_t, 2>({0, 0})  /*output_padding*/);
+    (*deconv).BindInputs({input, kernel_tensor}).BindOutputs({output});
+
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(input->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output_data(16);
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    std::vector<float> golden = {
+        1, 2, 2, 4,
+        3, 4, 6, 8,
+        3, 6, 4, 8,
+        9, 12, 12, 16};
+    EXPECT_EQ(golden, output_data);
+
+    // Setup permuted and rotated the kernel, the update is rewritten alike
+    std::vector<float> new_kernel = {0, 1, 0, 0};
+    EXPECT_TRUE(graph->UpdateConstant(kernel_tensor, new_kernel.data()));
+    EXPECT_TRUE(graph->Run());
+    EXPECT_TRUE(output->CopyDataFromTensor(output_data.data()));
+    golden = {
+        0, 1, 0, 2,
+        0, 0, 0, 0,
+        0, 3, 0, 4,
+        0, 0, 0, 0};
+    EXPECT_EQ(golden, output_data);
+}
+
+TEST(graph, memory_report_and_budget) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    std::shared_ptr<tim::vx::Tensor> output;
+    BuildFcRelu(graph, output);
+
+    auto report = graph->GetMemoryReport();
+    EXPECT_EQ(6 * sizeof(float) + 3 * sizeof(float), report.constant);
+    EXPECT_EQ(2 * sizeof(float), report.input);
+    EXPECT_EQ(3 * sizeof(float), report.output);
+    EXPECT_EQ(3 * sizeof(float), report.intermediate);
+    EXPECT_EQ(0u, report.binary);
+
+    ctx->SetMemoryBudget(report.constant);
+    EXPECT_FALSE(graph->Compile()) << "Exceeds the budget";
+    EXPECT_EQ(0u, ctx->MemoryInUse());
+
+    ctx->SetMemoryBudget(0);
+    EXPECT_TRUE(graph->Compile());
+    size_t in_use = ctx->MemoryInUse();
+    EXPECT_EQ(graph->GetMemoryReport().Total(), in_use);
+
+    // A second graph doesn't fit next to the first one
+    ctx->SetMemoryBudget(in_use + 1);
+    auto other = ctx->CreateGraph();
+    BuildFcRelu(other, output);
+    EXPECT_FALSE(other->Compile());
+    EXPECT_EQ(in_use, ctx->MemoryInUse());
+
+    graph.reset();
+    EXPECT_EQ(0u, ctx->MemoryInUse());
+    EXPECT_TRUE(other->Compile());
+}
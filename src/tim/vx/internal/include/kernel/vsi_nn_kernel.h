@@ -217,13 +217,13 @@ typedef struct
     vsi_nn_kernel_selector_func_t select;
 } vsi_nn_kernel_backend_t;
 
-vsi_nn_kernel_param_t * vsi_nn_kernel_param_create();
+OVXLIB_API vsi_nn_kernel_param_t * vsi_nn_kernel_param_create();
 
-void vsi_nn_kernel_param_release( vsi_nn_kernel_param_t ** params );
+OVXLIB_API void vsi_nn_kernel_param_release( vsi_nn_kernel_param_t ** params );
 
 void vsi_nn_kernel_param_clear( vsi_nn_kernel_param_t * params );
 
-vsi_bool vsi_nn_kernel_param_add_int32
+OVXLIB_API vsi_bool vsi_nn_kernel_param_add_int32
     ( vsi_nn_kernel_param_t * params, const char * key, int32_t value);
 
 int32_t vsi_nn_kernel_param_get_int32
@@ -235,7 +235,7 @@ vsi_bool vsi_nn_kernel_param_add_int64
 int64_t vsi_nn_kernel_param_get_int64
     ( const vsi_nn_kernel_param_t * params, const char * key);
 
-vsi_bool vsi_nn_kernel_param_add_float32
+OVXLIB_API vsi_bool vsi_nn_kernel_param_add_float32
     ( vsi_nn_kernel_param_t * params, const char * key, float value);
 
 float vsi_nn_kernel_param_get_float32
@@ -259,6 +259,10 @@ vsi_bool vsi_nn_kernel_param_add_const_buffer
 const void * vsi_nn_kernel_param_get_const_buffer
     ( const vsi_nn_kernel_param_t * params, const char * key, size_t * size);
 
+/** Flatten params to "key=value;" pairs, buffers are hashed. */
+vsi_bool vsi_nn_kernel_param_to_str
+    ( const vsi_nn_kernel_param_t * params, char * buf, size_t buf_size);
+
 /** Kernel register */
 #define REGISTER_KERNEL_BACKEND(kernel_name, kernel_type, func)   \
         _INITIALIZER(_register_kernel_##kernel_name##_##kernel_type) \
@@ -759,6 +763,18 @@ vsi_status vsi_nn_kernel_register_ext
     const char** resources
     );
 
+/** Release programs cached for the vx context. */
+OVXLIB_API void vsi_nn_kernel_program_cache_release
+    (
+    vx_context ctx
+    );
+
+/** Number of programs cached for the vx context. */
+OVXLIB_API size_t vsi_nn_kernel_program_cache_count
+    (
+    vx_context ctx
+    );
+
 vsi_bool vsi_nn_kernel_gpu_check_shape
     ( const vsi_size_t * shape, vsi_size_t rank );
 
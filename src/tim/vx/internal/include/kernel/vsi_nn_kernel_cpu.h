@@ -0,0 +1,232 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_KERNEL_CPU_H
+#define _VSI_NN_KERNEL_CPU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "vsi_nn_types.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VSI_NN_CPU_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VSI_NN_CPU_SIMD_NEON
+#endif
+
+__BEGIN_DECLS
+
+/**
+ * Execution helpers for CPU kernels.
+ *
+ * vsi_nn_kernel_cpu_parallel_for() splits [0, count) into chunks of at
+ * least `grain` items and runs them on a process-wide worker pool, the
+ * calling thread included. It returns when all chunks are done. Calls
+ * made while the pool is busy, or from inside a chunk, run serially on
+ * the calling thread. The pool size defaults to the number of online
+ * cores and can be set with VSI_NN_CPU_THREAD_NUM.
+ */
+typedef void (* vsi_nn_kernel_cpu_task_t)
+    (
+    void * data,
+    size_t begin,
+    size_t end
+    );
+
+#define VSI_NN_KERNEL_CPU_MAX_THREADS    (64)
+/* Rough count of scalar ops one chunk should hold to amortize dispatch. */
+#define VSI_NN_KERNEL_CPU_CHUNK_COST     (16384)
+
+OVXLIB_API void vsi_nn_kernel_cpu_parallel_for
+    (
+    size_t count,
+    size_t grain,
+    vsi_nn_kernel_cpu_task_t task,
+    void * data
+    );
+
+OVXLIB_API size_t vsi_nn_kernel_cpu_thread_num
+    (
+    void
+    );
+
+/* Items per chunk so a chunk holds about VSI_NN_KERNEL_CPU_CHUNK_COST ops. */
+static VSI_INLINE_API size_t vsi_nn_kernel_cpu_grain
+    (
+    size_t cost_per_item
+    )
+{
+    if ( cost_per_item == 0 )
+    {
+        return VSI_NN_KERNEL_CPU_CHUNK_COST;
+    }
+    return cost_per_item >= VSI_NN_KERNEL_CPU_CHUNK_COST ?
+        1 : VSI_NN_KERNEL_CPU_CHUNK_COST / cost_per_item;
+} /* vsi_nn_kernel_cpu_grain() */
+
+/*
+ * View a shape as [inner, axis, outer] around `axis` (dim 0 is innermost),
+ * which is the tiling every axis-wise CPU kernel iterates over.
+ */
+static VSI_INLINE_API void vsi_nn_kernel_cpu_split_shape
+    (
+    const vsi_size_t * shape,
+    size_t rank,
+    int32_t axis,
+    vsi_size_t * inner,
+    vsi_size_t * axis_size,
+    vsi_size_t * outer
+    )
+{
+    size_t i = 0;
+
+    *inner = 1;
+    *axis_size = 1;
+    *outer = 1;
+    if ( axis < 0 )
+    {
+        axis += (int32_t)rank;
+    }
+    for ( i = 0; i < rank; i++ )
+    {
+        if ( (int32_t)i < axis )
+        {
+            *inner *= shape[i];
+        }
+        else if ( (int32_t)i == axis )
+        {
+            *axis_size = shape[i];
+        }
+        else
+        {
+            *outer *= shape[i];
+        }
+    }
+} /* vsi_nn_kernel_cpu_split_shape() */
+
+/*
+ * 4-lane fp32 vector wrappers, SSE2 or NEON when available with a scalar
+ * fallback, so kernels are written once for every host.
+ */
+#if defined(VSI_NN_CPU_SIMD_SSE2)
+typedef __m128 vsi_nn_cpu_f32x4_t;
+#define vsi_nn_cpu_f32x4_load(p)        _mm_loadu_ps(p)
+#define vsi_nn_cpu_f32x4_store(p, v)    _mm_storeu_ps(p, v)
+#define vsi_nn_cpu_f32x4_set1(x)        _mm_set1_ps(x)
+#define vsi_nn_cpu_f32x4_add(a, b)      _mm_add_ps(a, b)
+#define vsi_nn_cpu_f32x4_sub(a, b)      _mm_sub_ps(a, b)
+#define vsi_nn_cpu_f32x4_mul(a, b)      _mm_mul_ps(a, b)
+#define vsi_nn_cpu_f32x4_max(a, b)      _mm_max_ps(a, b)
+#define vsi_nn_cpu_f32x4_min(a, b)      _mm_min_ps(a, b)
+#elif defined(VSI_NN_CPU_SIMD_NEON)
+typedef float32x4_t vsi_nn_cpu_f32x4_t;
+#define vsi_nn_cpu_f32x4_load(p)        vld1q_f32(p)
+#define vsi_nn_cpu_f32x4_store(p, v)    vst1q_f32(p, v)
+#define vsi_nn_cpu_f32x4_set1(x)        vdupq_n_f32(x)
+#define vsi_nn_cpu_f32x4_add(a, b)      vaddq_f32(a, b)
+#define vsi_nn_cpu_f32x4_sub(a, b)      vsubq_f32(a, b)
+#define vsi_nn_cpu_f32x4_mul(a, b)      vmulq_f32(a, b)
+#define vsi_nn_cpu_f32x4_max(a, b)      vmaxq_f32(a, b)
+#define vsi_nn_cpu_f32x4_min(a, b)      vminq_f32(a, b)
+#else
+typedef struct { float v[4]; } vsi_nn_cpu_f32x4_t;
+
+static VSI_INLINE_API vsi_nn_cpu_f32x4_t vsi_nn_cpu_f32x4_load(const float * p)
+{
+    vsi_nn_cpu_f32x4_t r;
+    r.v[0] = p[0]; r.v[1] = p[1]; r.v[2] = p[2]; r.v[3] = p[3];
+    return r;
+}
+
+static VSI_INLINE_API void vsi_nn_cpu_f32x4_store(float * p, vsi_nn_cpu_f32x4_t a)
+{
+    p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3];
+}
+
+static VSI_INLINE_API vsi_nn_cpu_f32x4_t vsi_nn_cpu_f32x4_set1(float x)
+{
+    vsi_nn_cpu_f32x4_t r;
+    r.v[0] = x; r.v[1] = x; r.v[2] = x; r.v[3] = x;
+    return r;
+}
+
+#define _VSI_NN_CPU_F32X4_BINARY(NAME, EXPR) \
+    static VSI_INLINE_API vsi_nn_cpu_f32x4_t vsi_nn_cpu_f32x4_##NAME \
+        (vsi_nn_cpu_f32x4_t a, vsi_nn_cpu_f32x4_t b) \
+    { \
+        int i; \
+        vsi_nn_cpu_f32x4_t r; \
+        for ( i = 0; i < 4; i++ ) { r.v[i] = EXPR; } \
+        return r; \
+    }
+_VSI_NN_CPU_F32X4_BINARY(add, a.v[i] + b.v[i])
+_VSI_NN_CPU_F32X4_BINARY(sub, a.v[i] - b.v[i])
+_VSI_NN_CPU_F32X4_BINARY(mul, a.v[i] * b.v[i])
+_VSI_NN_CPU_F32X4_BINARY(max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+_VSI_NN_CPU_F32X4_BINARY(min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+#undef _VSI_NN_CPU_F32X4_BINARY
+#endif
+
+static VSI_INLINE_API float vsi_nn_cpu_f32x4_reduce_add(vsi_nn_cpu_f32x4_t a)
+{
+    float v[4];
+    vsi_nn_cpu_f32x4_store(v, a);
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+static VSI_INLINE_API float vsi_nn_cpu_f32x4_reduce_max(vsi_nn_cpu_f32x4_t a)
+{
+    float v[4];
+    float m0, m1;
+    vsi_nn_cpu_f32x4_store(v, a);
+    m0 = v[0] > v[1] ? v[0] : v[1];
+    m1 = v[2] > v[3] ? v[2] : v[3];
+    return m0 > m1 ? m0 : m1;
+}
+
+/* Contiguous fp32 helpers built on the wrappers above. */
+OVXLIB_API float vsi_nn_kernel_cpu_max_f32
+    (
+    const float * src,
+    size_t size
+    );
+
+OVXLIB_API float vsi_nn_kernel_cpu_sum_f32
+    (
+    const float * src,
+    size_t size
+    );
+
+OVXLIB_API void vsi_nn_kernel_cpu_scale_f32
+    (
+    const float * src,
+    float * dst,
+    size_t size,
+    float scale
+    );
+
+__END_DECLS
+
+#endif
@@ -84,6 +84,26 @@ vsi_status vsi_nn_kernel_lut
     vsi_nn_kernel_lut_params *param
     );
 
+/* Build the index and value tables of param, VSI_NN_KERNEL_LUT_MAX_SIZE each. */
+OVXLIB_API vsi_status vsi_nn_kernel_lut_generate
+    (
+    vsi_nn_kernel_lut_params *param,
+    float *index,
+    float *value
+    );
+
+/*
+ * Tables of param from the process-wide cache vsi_nn_kernel_lut() uploads
+ * from, generated on first use. They are immutable and live as long as the
+ * process. Fails when the cache is full.
+ */
+OVXLIB_API vsi_status vsi_nn_kernel_lut_cached
+    (
+    vsi_nn_kernel_lut_params *param,
+    const float **index,
+    const float **value
+    );
+
 __END_DECLS
 
 #endif
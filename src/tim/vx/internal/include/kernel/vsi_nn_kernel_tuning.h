@@ -0,0 +1,107 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_KERNEL_TUNING_H
+#define _VSI_NN_KERNEL_TUNING_H
+
+#include <stdint.h>
+#include "kernel/vsi_nn_kernel.h"
+
+__BEGIN_DECLS
+
+/**
+ * Kernel tuning database.
+ *
+ * When VSI_NN_KERNEL_TUNING_DB points to a file, the kernel selector looks
+ * up the best backend for (kernel name, io shapes, dtypes, params) there
+ * before falling back to the static priority tables. With
+ * VSI_NN_ENABLE_KERNEL_TUNING=1, missing entries are measured by timing
+ * every viable backend in a scratch graph and the winner is appended to
+ * the database.
+ */
+#define VSI_NN_KERNEL_TUNING_KEY_SIZE   (2048)
+#define VSI_NN_KERNEL_TUNING_RUNS       (5)
+
+/**
+ * Whether the selector should consult the database at all, that is tuning
+ * is enabled for the context or a database path is configured.
+ */
+OVXLIB_API vsi_bool vsi_nn_kernel_tuning_active
+    (
+    const vsi_nn_context_t ctx
+    );
+
+OVXLIB_API vsi_bool vsi_nn_kernel_tuning_make_key
+    (
+    char * key,
+    size_t key_size,
+    const char * kernel_name,
+    vsi_nn_tensor_t ** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t ** outputs,
+    size_t output_num,
+    const vsi_nn_kernel_param_t * params
+    );
+
+OVXLIB_API vsi_bool vsi_nn_kernel_tuning_query
+    (
+    const char * key,
+    vsi_nn_kernel_type_e * type
+    );
+
+OVXLIB_API void vsi_nn_kernel_tuning_update
+    (
+    const char * key,
+    vsi_nn_kernel_type_e type
+    );
+
+/**
+ * Move the recorded backend of key to the head of selector priority.
+ * @return TRUE if the database holds a record for key.
+ */
+OVXLIB_API vsi_bool vsi_nn_kernel_tuning_reorder
+    (
+    const char * key,
+    vsi_nn_kernel_selector_t * selector
+    );
+
+/**
+ * Build the kernel in a scratch graph and time it.
+ * @return Average process time in microseconds, or a negative value
+ *         if the backend cannot be instanced.
+ */
+double vsi_nn_kernel_tuning_measure
+    (
+    vsi_nn_graph_t * graph,
+    vsi_nn_kernel_setup_func_t setup,
+    vsi_nn_kernel_t * kernel,
+    vsi_nn_tensor_t ** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t ** outputs,
+    size_t output_num,
+    const vsi_nn_kernel_param_t * params
+    );
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,180 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_POST_DETECTION_H_
+#define _VSI_NN_POST_DETECTION_H_
+
+#include "vsi_nn_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Shared detection post-processing: box decode, score top-k and NMS.
+ *
+ * Boxes are kept as structure-of-arrays so IoU of one box against a run
+ * of candidates is computed 4 lanes at a time. Coordinates are corners
+ * (x1, y1, x2, y2). `offset` is added to widths and heights, 1.0f for the
+ * pixel-inclusive convention of Caffe models and 0.0f otherwise.
+ */
+typedef struct _vsi_nn_detection_boxes_t
+{
+    float * x1;
+    float * y1;
+    float * x2;
+    float * y2;
+    float * score;
+    float * area;
+    int32_t * class_id;
+    uint32_t num;
+    uint32_t capacity;
+} vsi_nn_detection_boxes_t;
+
+/* Scales of TFLite style center-size box encoding. */
+typedef struct _vsi_nn_detection_box_coder_t
+{
+    float y_scale;
+    float x_scale;
+    float h_scale;
+    float w_scale;
+} vsi_nn_detection_box_coder_t;
+
+OVXLIB_API vsi_nn_detection_boxes_t * vsi_nn_detection_boxes_create
+    (
+    uint32_t capacity
+    );
+
+OVXLIB_API void vsi_nn_detection_boxes_release
+    (
+    vsi_nn_detection_boxes_t ** boxes
+    );
+
+/* Append one box, returns FALSE if the container is full. */
+OVXLIB_API vsi_bool vsi_nn_detection_boxes_push
+    (
+    vsi_nn_detection_boxes_t * boxes,
+    float x1,
+    float y1,
+    float x2,
+    float y2,
+    float score,
+    int32_t class_id
+    );
+
+/* dst = src[order[0..num)], dst must have room for num boxes. */
+OVXLIB_API void vsi_nn_detection_boxes_gather
+    (
+    const vsi_nn_detection_boxes_t * src,
+    const uint32_t * order,
+    uint32_t num,
+    vsi_nn_detection_boxes_t * dst
+    );
+
+/*
+ * Select up to k scores above threshold and write their indices to
+ * `index` sorted by descending score, ties by ascending index.
+ * k == 0 selects all. Returns the number of indices written.
+ */
+OVXLIB_API uint32_t vsi_nn_detection_topk
+    (
+    const float * score,
+    uint32_t num,
+    uint32_t stride,
+    float threshold,
+    uint32_t k,
+    uint32_t * index
+    );
+
+/*
+ * Greedy hard NMS over boxes already sorted by descending score. Writes
+ * the kept positions to `keep` in order and returns their count, stopping
+ * after max_keep boxes when max_keep > 0.
+ */
+OVXLIB_API uint32_t vsi_nn_detection_nms
+    (
+    vsi_nn_detection_boxes_t * boxes,
+    float iou_threshold,
+    float offset,
+    uint32_t max_keep,
+    uint32_t * keep
+    );
+
+/*
+ * Per-class top-k and NMS over `boxes` with a [num, class_num] score
+ * matrix, then merge the survivors of all classes by score. Boxes are
+ * shared by all classes when box_per_class is FALSE, otherwise box i of
+ * class c is box (i * class_num + c). Classes below class_start (e.g.
+ * background) are skipped. The result is left in out, out->num is its
+ * count; returns VSI_FAILURE if a buffer could not be allocated.
+ */
+OVXLIB_API vsi_status vsi_nn_detection_multiclass_nms
+    (
+    const vsi_nn_detection_boxes_t * boxes,
+    vsi_bool box_per_class,
+    const float * score,
+    uint32_t class_num,
+    uint32_t class_start,
+    float score_threshold,
+    float iou_threshold,
+    float offset,
+    uint32_t max_per_class,
+    uint32_t max_total,
+    vsi_nn_detection_boxes_t * out
+    );
+
+/*
+ * Decode TFLite style deltas [num, 4] (ty, tx, th, tw) against anchors
+ * [num, 4] (ycenter, xcenter, h, w) into corner boxes.
+ */
+OVXLIB_API void vsi_nn_detection_decode_center_size
+    (
+    const float * deltas,
+    const float * anchors,
+    uint32_t num,
+    const vsi_nn_detection_box_coder_t * coder,
+    vsi_nn_detection_boxes_t * boxes
+    );
+
+/*
+ * Decode Faster R-CNN deltas (dx, dy, dw, dh) against corner rois with the
+ * pixel-inclusive convention and clip to [0, width - 1] x [0, height - 1].
+ * `roi` and `delta` advance by roi_stride and delta_stride floats per box.
+ */
+OVXLIB_API void vsi_nn_detection_decode_roi
+    (
+    const float * roi,
+    uint32_t roi_stride,
+    const float * delta,
+    uint32_t delta_stride,
+    uint32_t num,
+    float width,
+    float height,
+    vsi_nn_detection_boxes_t * boxes
+    );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_ARENA_H
+#define _VSI_NN_ARENA_H
+
+#include <stddef.h>
+#include "vsi_nn_types.h"
+
+#if defined(__cplusplus)
+extern "C"{
+#endif
+
+/**
+ * Bump allocator for small objects sharing one lifetime, e.g. the
+ * structures a graph creates while expanding internal nodes. Memory is
+ * returned zero-initialized and is only released in bulk by
+ * vsi_nn_arena_release(). Not thread safe.
+ */
+typedef struct _vsi_nn_arena vsi_nn_arena_t;
+
+typedef struct _vsi_nn_arena_stat
+{
+    /** Number of vsi_nn_arena_alloc() calls served. */
+    size_t alloc_count;
+    /** Bytes handed out, including alignment padding. */
+    size_t alloc_bytes;
+    /** Number of blocks requested from the system. */
+    size_t block_count;
+    /** Bytes requested from the system. */
+    size_t reserved_bytes;
+} vsi_nn_arena_stat_t;
+
+/**
+ * Create an arena.
+ *
+ * @param[in] block_size Size of each system allocation, 0 for default.
+ *
+ * @return Arena on success, or NULL otherwise.
+ */
+OVXLIB_API vsi_nn_arena_t * vsi_nn_arena_create
+    (
+    size_t block_size
+    );
+
+/**
+ * Allocate zero-initialized memory aligned for any scalar type.
+ * Requests larger than a quarter block get a dedicated block.
+ *
+ * @param[in] arena Arena.
+ * @param[in] size Bytes to allocate.
+ *
+ * @return Memory on success, or NULL otherwise.
+ */
+OVXLIB_API void * vsi_nn_arena_alloc
+    (
+    vsi_nn_arena_t * arena,
+    size_t size
+    );
+
+/**
+ * Release the arena and everything allocated from it.
+ *
+ * @param[in] arena Arena to release, set to NULL on return.
+ */
+OVXLIB_API void vsi_nn_arena_release
+    (
+    vsi_nn_arena_t ** arena
+    );
+
+/**
+ * Query arena usage.
+ *
+ * @param[in] arena Arena.
+ * @param[out] stat Usage statistic.
+ */
+OVXLIB_API void vsi_nn_arena_get_stat
+    (
+    const vsi_nn_arena_t * arena,
+    vsi_nn_arena_stat_t * stat
+    );
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
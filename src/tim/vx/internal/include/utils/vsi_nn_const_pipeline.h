@@ -0,0 +1,206 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_CONST_PIPELINE_H
+#define _VSI_NN_CONST_PIPELINE_H
+
+#include <stddef.h>
+#include "vsi_nn_types.h"
+#include "vsi_nn_tensor.h"
+
+#if defined(__cplusplus)
+extern "C"{
+#endif
+
+/**
+ * Constant tensor transformation pipeline.
+ *
+ * Transforms queued for a constant tensor are chained: the tensor data is
+ * read once, every transform runs in place on the host buffer and the
+ * result is written back once. Tensors are transformed in parallel on the
+ * CPU kernel worker pool, reading and writing stay on the calling thread.
+ */
+typedef struct _vsi_nn_const_pipeline vsi_nn_const_pipeline_t;
+
+/**
+ * Transform host data of a constant tensor in place.
+ * The transform may update the shape, data type or quantization in `attr`
+ * as long as the data size is kept. It must not call OpenVX.
+ */
+typedef vsi_status (* vsi_nn_const_transform_t)
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    );
+
+#define VSI_NN_CONST_PIPELINE_MAX_TRANSFORMS    (4)
+#define VSI_NN_CONST_TRANSFORM_PARAM_SIZE       (128)
+
+typedef struct _vsi_nn_const_pipeline_stat
+{
+    /** Number of tensors processed. */
+    size_t tensor_count;
+    /** Number of transforms applied. */
+    size_t transform_count;
+    /** Bytes read from tensors. */
+    size_t bytes_read;
+    /** Bytes written to tensors. */
+    size_t bytes_written;
+} vsi_nn_const_pipeline_stat_t;
+
+/** Parameter of vsi_nn_const_transform_permute/transpose(). */
+typedef struct _vsi_nn_const_permute_param
+{
+    vsi_size_t perm[VSI_NN_MAX_DIM_NUM];
+    vsi_size_t dim_num;
+} vsi_nn_const_permute_param_t;
+
+OVXLIB_API vsi_nn_const_pipeline_t * vsi_nn_const_pipeline_create
+    (
+    vsi_nn_graph_t * graph
+    );
+
+/**
+ * Queue a transform for a constant tensor, after those already queued
+ * for the same tensor.
+ *
+ * @param[in] pipeline Pipeline.
+ * @param[in] tensor Constant tensor.
+ * @param[in] transform Transform function.
+ * @param[in] param Transform parameter, copied, may be NULL.
+ * @param[in] param_size Size of param, at most VSI_NN_CONST_TRANSFORM_PARAM_SIZE.
+ *
+ * @return VSI_SUCCESS on success, or error code otherwise.
+ */
+OVXLIB_API vsi_status vsi_nn_const_pipeline_add
+    (
+    vsi_nn_const_pipeline_t * pipeline,
+    vsi_nn_tensor_t * tensor,
+    vsi_nn_const_transform_t transform,
+    const void * param,
+    size_t param_size
+    );
+
+OVXLIB_API vsi_bool vsi_nn_const_pipeline_contains
+    (
+    const vsi_nn_const_pipeline_t * pipeline,
+    const vsi_nn_tensor_t * tensor
+    );
+
+/**
+ * Run all queued transforms and clear the queue.
+ *
+ * @param[in] pipeline Pipeline.
+ * @param[out] stat Statistic of this run, may be NULL.
+ *
+ * @return VSI_SUCCESS on success, or error code otherwise.
+ */
+OVXLIB_API vsi_status vsi_nn_const_pipeline_run
+    (
+    vsi_nn_const_pipeline_t * pipeline,
+    vsi_nn_const_pipeline_stat_t * stat
+    );
+
+OVXLIB_API void vsi_nn_const_pipeline_release
+    (
+    vsi_nn_const_pipeline_t ** pipeline
+    );
+
+/**
+ * Record that a constant tensor of the graph was rewritten outside of a
+ * pipeline, new data for it can't be replayed any more.
+ *
+ * @param[in] graph Graph owning the tensor.
+ * @param[in] tensor Constant tensor.
+ */
+OVXLIB_API void vsi_nn_const_pipeline_record_rewrite
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_tensor_t * tensor
+    );
+
+/**
+ * Apply the transforms every pipeline run of the graph applied to a
+ * constant tensor so far, in order, to new data of the tensor.
+ *
+ * @param[in] graph Graph owning the tensor.
+ * @param[in] tensor Constant tensor.
+ * @param[in,out] data Data in the layout the tensor had before the first
+ *                transform, rewritten in place to its current layout.
+ * @param[in] size Size of data.
+ *
+ * @return VSI_SUCCESS on success, or VSI_FAILURE if the tensor was also
+ *         rewritten outside of a pipeline or a rewrite of the graph could
+ *         not be recorded.
+ */
+OVXLIB_API vsi_status vsi_nn_const_pipeline_replay
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_tensor_t * tensor,
+    uint8_t * data,
+    vsi_size_t size
+    );
+
+/** Flip the sign bit, turning asymmetric int8 data into uint8. */
+OVXLIB_API vsi_status vsi_nn_const_transform_i8_to_u8
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    );
+
+/** Rotate every [w, h] kernel slice by 180 degrees. */
+OVXLIB_API vsi_status vsi_nn_const_transform_rotate_180
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    );
+
+/** Permute data and shape, param is vsi_nn_const_permute_param_t. */
+OVXLIB_API vsi_status vsi_nn_const_transform_permute
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    );
+
+/** Transpose data keeping the shape, param is vsi_nn_const_permute_param_t. */
+OVXLIB_API vsi_status vsi_nn_const_transform_transpose
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    );
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -81,6 +81,10 @@ typedef struct _vsi_nn_runtime_option_t
     int32_t enable_rgb88_planar_nhwc;
     int32_t enable_slice_optimize;
     int32_t enable_batch_opt;
+    int32_t enable_kernel_tuning;
+    /* Block size of graph arenas in bytes, 0 for the default. A block
+     * smaller than 64 bytes gives every allocation its own block. */
+    int32_t graph_arena_block_size;
 } vsi_nn_runtime_option_t;
 
 /**
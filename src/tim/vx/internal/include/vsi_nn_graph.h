@@ -587,6 +587,31 @@ OVXLIB_API void vsi_nn_RemoveNode
     vsi_nn_node_id_t      id
     );
 
+/**
+ * Update const tensor
+ * Rewrite the data of a const tensor in place. Once the graph is set up,
+ * the vx nodes reading it are recreated so that the driver takes the new
+ * data; other nodes are untouched. The graph must be verified again.
+ * Transforms a const pipeline applied to the tensor at setup, such as int8
+ * to uint8 or a deconvolution weight permute and rotate, are replayed on
+ * the new data first.
+ *
+ * @param[in] graph Graph handle
+ * @param[in] id Const tensor id.
+ * @param[in] data New data, in the layout the tensor was created with.
+ * @param[out] node_count Number of recreated nodes, can be NULL.
+ * @return VSI_SUCCESS on success, or VSI_FAILURE if a consumer was expanded
+ *         to internal nodes or the tensor was rewritten outside of a const
+ *         pipeline at setup, which needs a new setup.
+ */
+OVXLIB_API vsi_status vsi_nn_UpdateConstTensor
+    (
+    vsi_nn_graph_t      * graph,
+    vsi_nn_tensor_id_t    id,
+    uint8_t             * data,
+    uint32_t            * node_count
+    );
+
 /**
  * Sort graph node
  * Sort the nodes with the execution sequence.
@@ -783,6 +808,22 @@ vsi_nn_tensor_id_t vsi_nn_get_tensor_id
     const vsi_nn_tensor_t * tensor
     );
 
+/**
+ * Allocate zero-initialized memory which lives until the graph is released.
+ * Used for small graph-lifetime structures such as internal nodes, never
+ * free() the returned pointer.
+ *
+ * @param[in] graph Graph handle
+ * @param[in] size Bytes to allocate
+ *
+ * @return Memory on success, or NULL otherwise.
+ */
+void * vsi_nn_graph_arena_alloc
+    (
+    vsi_nn_graph_t* graph,
+    size_t size
+    );
+
 OVXLIB_API vsi_status vsi_nn_SetGraphPriority
     (
     vsi_nn_graph_t* graph,
@@ -814,6 +855,28 @@ OVXLIB_API vsi_status vsi_nn_ExecuteGraphLoop
     vsi_nn_tensor_t *max_iteration_tensor
     );
 
+/**
+ * Execute loop graph
+ * Run a loop body graph at most max_iteration times.
+ * Graph inputs are iteration_index, iteration_cond_in and the loop variables,
+ * graph outputs are iteration_cond_out and the loop variables. The loop stops
+ * once iteration_cond_out becomes FALSE.
+ * Loop variables created from handle are carried to the next iteration by
+ * swapping the input and output handles instead of copying, so the buffers
+ * of these tensors are exchanged after execution. The outputs always hold
+ * the values of the last iteration.
+ *
+ * @param[in] graph Loop body graph.
+ * @param[in] max_iteration Maximum iteration count.
+ *
+ * @return VSI_SUCCESS on success, or error core otherwise.
+ */
+OVXLIB_API vsi_status vsi_nn_ExecuteGraphLoopEx
+    (
+    vsi_nn_graph_t* graph,
+    int32_t max_iteration
+    );
+
 OVXLIB_API vsi_status vsi_nn_SetGraphTransformOption
     (
     vsi_nn_graph_t* graph,
@@ -34,6 +34,7 @@
 #include "utils/vsi_nn_util.h"
 #include "utils/vsi_nn_dtype_util.h"
 #include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
 #include "libnnext/vsi_nn_vxkernel.h"
 
 #define _CPU_ARG_NUM            (1)
@@ -47,6 +48,64 @@
 
 __BEGIN_DECLS
 
+typedef struct
+{
+    const float * input;
+    float * output;
+    vsi_size_t inner;
+    vsi_size_t axis_size;
+} _softmax_task_t;
+
+/* One task item is one softmax vector, [begin, end) over outer * inner. */
+static void _softmax_rows
+    (
+    void * data,
+    size_t begin,
+    size_t end
+    )
+{
+    _softmax_task_t * t = (_softmax_task_t *)data;
+    size_t n = 0;
+    vsi_size_t i = 0;
+
+    for ( n = begin; n < end; n++ )
+    {
+        vsi_size_t outer_idx = (vsi_size_t)n / t->inner;
+        vsi_size_t inner_idx = (vsi_size_t)n % t->inner;
+        const float * src = t->input + outer_idx * t->axis_size * t->inner + inner_idx;
+        float * dst = t->output + outer_idx * t->axis_size * t->inner + inner_idx;
+        float fMax = 0.0f;
+        float fProbSum = 0.0f;
+
+        if ( t->inner == 1 )
+        {
+            fMax = vsi_nn_kernel_cpu_max_f32( src, t->axis_size );
+            for ( i = 0; i < t->axis_size; i++ )
+            {
+                dst[i] = expf( src[i] - fMax );
+            }
+            fProbSum = vsi_nn_kernel_cpu_sum_f32( dst, t->axis_size );
+            vsi_nn_kernel_cpu_scale_f32( dst, dst, t->axis_size, 1.0f / fProbSum );
+            continue;
+        }
+
+        fMax = src[0];
+        for ( i = 1; i < t->axis_size; i++ )
+        {
+            fMax = vsi_nn_max( fMax, src[i * t->inner] );
+        }
+        for ( i = 0; i < t->axis_size; i++ )
+        {
+            dst[i * t->inner] = expf( src[i * t->inner] - fMax );
+            fProbSum += dst[i * t->inner];
+        }
+        for ( i = 0; i < t->axis_size; i++ )
+        {
+            dst[i * t->inner] /= fProbSum;
+        }
+    }
+} /* _softmax_rows() */
+
 DEF_KERNEL_EXECUTOR(_softmax_exec)
     (
     vsi_nn_kernel_node_t node,
@@ -59,10 +118,10 @@ DEF_KERNEL_EXECUTOR(_softmax_exec)
     vsi_nn_kernel_tensor_t tensors[_CPU_IO_NUM] = { NULL };
     vsi_nn_kernel_tensor_attr_t* attr[_CPU_IO_NUM] = { NULL };
     uint32_t i = 0;
-    uint32_t out_elements;
+    vsi_size_t out_elements;
+    vsi_size_t outer = 1;
     int32_t sf_axis;
-    float fMax = 0.0;
-    float fProbSum = 0.0f;
+    _softmax_task_t task;
 
     VSI_UNREFERENCED(node);
     VSI_UNREFERENCED(param_size);
@@ -77,8 +136,14 @@ DEF_KERNEL_EXECUTOR(_softmax_exec)
 
     status = vsi_nn_kernel_scalar_read_int32((vsi_nn_kernel_scalar_t)param[2], &sf_axis);
     CHECK_STATUS_FAIL_GOTO(status, final );
+    if ( sf_axis < -(int32_t)attr[0]->shape->size || sf_axis >= (int32_t)attr[0]->shape->size )
+    {
+        VSILOGE("Invalid softmax axis %d.", sf_axis);
+        status = VSI_FAILURE;
+        goto final;
+    }
 
-    out_elements = (uint32_t)vsi_nn_kernel_tensor_attr_get_size( attr[1] );
+    out_elements = vsi_nn_kernel_tensor_attr_get_size( attr[1] );
 
     /* alloc the float32 data buffer */
     buffer[1] = (float *)malloc(out_elements * sizeof(float));
@@ -89,20 +154,13 @@ DEF_KERNEL_EXECUTOR(_softmax_exec)
     CHECK_PTR_FAIL_GOTO( buffer[0], "Create input buffer fail.", final );
 
     /* Softmax implement */
-    for ( i = 0; i < out_elements; i++)
-    {
-        fMax = buffer[0][i] > fMax ? buffer[0][i] : fMax;
-    }
+    task.input = buffer[0];
+    task.output = buffer[1];
+    vsi_nn_kernel_cpu_split_shape( attr[0]->shape->data, attr[0]->shape->size,
+        sf_axis, &task.inner, &task.axis_size, &outer );
+    vsi_nn_kernel_cpu_parallel_for( (size_t)(outer * task.inner),
+        vsi_nn_kernel_cpu_grain( (size_t)task.axis_size * 4 ), _softmax_rows, &task );
 
-    for ( i = 0; i < out_elements; i++)
-    {
-        buffer[1][i] = (float)expf(buffer[0][i] - fMax);
-        fProbSum += buffer[1][i];
-    }
-    for ( i = 0; i < out_elements; i++)
-    {
-        buffer[1][i] =  buffer[1][i] / fProbSum;
-    }
     status = vsi_nn_kernel_tensor_write_from_float(
         tensors[1], attr[1], buffer[1], out_elements );
 
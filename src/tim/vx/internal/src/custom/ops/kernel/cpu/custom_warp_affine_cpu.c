@@ -35,6 +35,7 @@
 #include "vsi_nn_tensor_util.h"
 #include "utils/vsi_nn_util.h"
 #include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
 #include "libnnext/vx_lib_nnext.h"
 
 __BEGIN_DECLS
@@ -113,6 +114,116 @@ static vsi_bool _read_pixel
     return TRUE;
 }
 
+typedef struct
+{
+    const float * input;
+    float * output;
+    vsi_nn_kernel_tensor_attr_t * in_attr;
+    vsi_size_t width;
+    vsi_size_t height;
+    float matrix[6];
+    int32_t type;
+    int32_t rgb_type;
+} _warp_affine_task_t;
+
+/* One task item is one output row, [begin, end) over batch * height. */
+static void _warp_affine_rows
+    (
+    void * data,
+    size_t begin,
+    size_t end
+    )
+{
+    _warp_affine_task_t * t = (_warp_affine_task_t *)data;
+    vsi_nn_kernel_tensor_attr_t * in_attr = t->in_attr;
+    vsi_size_t in_plane = in_attr->shape->data[0] * in_attr->shape->data[1];
+    const float * m = t->matrix;
+    size_t n = 0;
+    vsi_size_t x = 0;
+
+    for ( n = begin; n < end; n++ )
+    {
+        vsi_size_t b = (vsi_size_t)n / t->height;
+        vsi_size_t y = (vsi_size_t)n % t->height;
+        float *src_base = (float *)t->input + b * in_plane;
+        float *dst_row = t->output + (b * t->height + y) * t->width;
+
+        if ( t->rgb_type == VSI_NN_WARP_AFFINE_TYPE_RGB )
+        {
+            vsi_size_t width = t->width / 3;
+            for (x = 0; x < width; x++)
+            {
+                float xf = 0;
+                float yf = 0;
+                float dst = 0;
+
+                _transform_affine(x, y, m, &xf, &yf);
+
+                if (t->type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
+                {
+                    _read_pixel(src_base, in_attr, 3 * floorf(xf), floorf(yf), &dst);
+                    dst_row[3 * x] = dst;
+                    _read_pixel(src_base, in_attr, 3 * floorf(xf) + 1, floorf(yf), &dst);
+                    dst_row[3 * x + 1] = dst;
+                    _read_pixel(src_base, in_attr, 3 * floorf(xf) + 2, floorf(yf), &dst);
+                    dst_row[3 * x + 2] = dst;
+                }
+                else
+                {
+                    float tl = 0, tr = 0, bl = 0, br = 0;
+                    float ar = xf - floorf(xf);
+                    float ab = yf - floorf(yf);
+                    float al = 1.0f - ar;
+                    float at = 1.0f - ab;
+                    vsi_size_t c = 0;
+
+                    for (c = 0; c < 3; c++)
+                    {
+                        _read_pixel(src_base, in_attr, 3 * floorf(xf) + c, floorf(yf), &tl);
+                        _read_pixel(src_base, in_attr, 3 * (floorf(xf) + 1) + c, floorf(yf), &tr);
+                        _read_pixel(src_base, in_attr, 3 * floorf(xf) + c, floorf(yf) + 1, &bl);
+                        _read_pixel(src_base, in_attr, 3 * (floorf(xf) + 1) + c, floorf(yf) + 1, &br);
+
+                        dst_row[3 * x + c] =
+                            tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (x = 0; x < t->width; x++)
+            {
+                float xf = 0;
+                float yf = 0;
+                float dst = 0;
+
+                _transform_affine(x, y, m, &xf, &yf);
+                if (t->type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
+                {
+                    _read_pixel(src_base, in_attr, xf, yf, &dst);
+                    dst_row[x] = dst;
+                }
+                else
+                {
+                    float tl = 0, tr = 0, bl = 0, br = 0;
+                    float ar = xf - floorf(xf);
+                    float ab = yf - floorf(yf);
+                    float al = 1.0f - ar;
+                    float at = 1.0f - ab;
+
+                    _read_pixel(src_base, in_attr, floorf(xf), floorf(yf), &tl);
+                    _read_pixel(src_base, in_attr, floorf(xf) + 1, floorf(yf), &tr);
+                    _read_pixel(src_base, in_attr, floorf(xf), floorf(yf) + 1, &bl);
+                    _read_pixel(src_base, in_attr, floorf(xf) + 1, floorf(yf) + 1, &br);
+
+                    dst_row[x] = tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
+                }
+            }
+        }
+    }
+} /* _warp_affine_rows() */
+
 /*
  * Kernel function
  */
@@ -131,13 +242,9 @@ DEF_KERNEL_EXECUTOR(_compute)
     int32_t rgb_type = 0;
     float matrix[6] = {0};
     vsi_size_t i = 0;
-    vsi_size_t b = 0;
-    vsi_size_t x = 0;
-    vsi_size_t y = 0;
     vsi_size_t out_elements = 0;
-    vsi_size_t width = 0;
-    vsi_size_t height = 0;
     vsi_size_t outer_size = 1;
+    _warp_affine_task_t task;
 
     VSI_UNREFERENCED(node);
     VSI_UNREFERENCED(param_size);
@@ -187,110 +294,20 @@ DEF_KERNEL_EXECUTOR(_compute)
         }
     }
 
-    width = attr[2]->shape->data[0];
-    height = attr[2]->shape->data[1];
+    task.input = buffer[0];
+    task.output = buffer[2];
+    task.in_attr = attr[0];
+    task.width = attr[2]->shape->data[0];
+    task.height = attr[2]->shape->data[1];
+    memcpy( task.matrix, matrix, sizeof(matrix) );
+    task.type = type;
+    task.rgb_type = rgb_type;
     for(i = 2; i < (vsi_size_t)attr[2]->shape->size; ++i)
     {
         outer_size *= attr[2]->shape->data[i];
     }
-    // Do something
-    for (b = 0; b < outer_size; b++)
-    {
-        float *src_base = buffer[0] + b * attr[0]->shape->data[0] * attr[0]->shape->data[1];
-        float *dst_base = buffer[2] + b * width * height;
-
-        if ( rgb_type == VSI_NN_WARP_AFFINE_TYPE_RGB )
-        {
-            width = width / 3;
-            for (y = 0; y < height; y++)
-            {
-                for (x = 0; x < width; x++)
-                {
-                    float xf = 0;
-                    float yf = 0;
-                    float dst = 0;
-
-                    _transform_affine(x, y, matrix, &xf, &yf);
-
-                    if (type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
-                    {
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf), floorf(yf), &dst);
-                        dst_base[y * 3 * width + 3 * x] = dst;
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 1, floorf(yf), &dst);
-                        dst_base[y * 3 * width + 3 * x + 1] = dst;
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 2, floorf(yf), &dst);
-                        dst_base[y * 3 * width + 3 * x + 2] = dst;
-                    }
-                    else
-                    {
-                        float tl = 0, tr = 0, bl = 0, br = 0;
-                        float ar = xf - floorf(xf);
-                        float ab = yf - floorf(yf);
-                        float al = 1.0f - ar;
-                        float at = 1.0f - ab;
-
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf), floorf(yf), &tl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1), floorf(yf), &tr);
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf), floorf(yf) + 1, &bl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1), floorf(yf) + 1, &br);
-
-                        dst_base[y * 3 * width + 3 * x] =
-                            tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
-
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 1, floorf(yf), &tl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1) + 1, floorf(yf), &tr);
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 1, floorf(yf) + 1, &bl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1) + 1, floorf(yf) + 1, &br);
-
-                        dst_base[y * 3 * width + 3 * x + 1] =
-                            tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
-
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 2, floorf(yf), &tl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1) + 2, floorf(yf), &tr);
-                        _read_pixel(src_base, attr[0], 3 * floorf(xf) + 2, floorf(yf) + 1, &bl);
-                        _read_pixel(src_base, attr[0], 3 * (floorf(xf) + 1) + 2, floorf(yf) + 1, &br);
-
-                        dst_base[y * 3 * width + 3 * x + 2] =
-                            tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
-                    }
-                }
-            }
-        }
-        else
-        {
-            for (y = 0; y < height; y++)
-            {
-                for (x = 0; x < width; x++)
-                {
-                    float xf = 0;
-                    float yf = 0;
-                    float dst = 0;
-
-                    _transform_affine(x, y, matrix, &xf, &yf);
-                    if (type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
-                    {
-                        _read_pixel(src_base, attr[0], xf, yf, &dst);
-                        dst_base[y * width + x] = dst;
-                    }
-                    else
-                    {
-                        float tl = 0, tr = 0, bl = 0, br = 0;
-                        float ar = xf - floorf(xf);
-                        float ab = yf - floorf(yf);
-                        float al = 1.0f - ar;
-                        float at = 1.0f - ab;
-
-                        _read_pixel(src_base, attr[0], floorf(xf), floorf(yf), &tl);
-                        _read_pixel(src_base, attr[0], floorf(xf) + 1, floorf(yf), &tr);
-                        _read_pixel(src_base, attr[0], floorf(xf), floorf(yf) + 1, &bl);
-                        _read_pixel(src_base, attr[0], floorf(xf) + 1, floorf(yf) + 1, &br);
-
-                        dst_base[y * width + x] = tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
-                    }
-                }
-            }
-        }
-    }
+    vsi_nn_kernel_cpu_parallel_for( (size_t)(outer_size * task.height),
+        vsi_nn_kernel_cpu_grain( (size_t)task.width * 16 ), _warp_affine_rows, &task );
 
     status = vsi_nn_kernel_tensor_write_from_float( tensors[2], attr[2],
             buffer[2], out_elements );
@@ -35,6 +35,7 @@
 #include "vsi_nn_tensor_util.h"
 #include "utils/vsi_nn_util.h"
 #include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
 #include "libnnext/vx_lib_nnext.h"
 
 __BEGIN_DECLS
@@ -114,6 +115,69 @@ static vsi_bool _read_pixel
     return TRUE;
 }
 
+typedef struct
+{
+    const float * input;
+    float * output;
+    vsi_nn_kernel_tensor_attr_t * in_attr;
+    vsi_size_t width;
+    vsi_size_t height;
+    float matrix[9];
+    int32_t type;
+} _warp_perspective_task_t;
+
+/* One task item is one output row, [begin, end) over batch * height. */
+static void _warp_perspective_rows
+    (
+    void * data,
+    size_t begin,
+    size_t end
+    )
+{
+    _warp_perspective_task_t * t = (_warp_perspective_task_t *)data;
+    vsi_nn_kernel_tensor_attr_t * in_attr = t->in_attr;
+    vsi_size_t in_plane = in_attr->shape->data[0] * in_attr->shape->data[1];
+    size_t n = 0;
+    vsi_size_t x = 0;
+
+    for ( n = begin; n < end; n++ )
+    {
+        vsi_size_t b = (vsi_size_t)n / t->height;
+        vsi_size_t y = (vsi_size_t)n % t->height;
+        float *src_base = (float *)t->input + b * in_plane;
+        float *dst_row = t->output + (b * t->height + y) * t->width;
+
+        for (x = 0; x < t->width; x++)
+        {
+            float xf = 0;
+            float yf = 0;
+            float dst = 0;
+
+            _transform_perspective(x, y, t->matrix, &xf, &yf);
+            if (t->type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
+            {
+                _read_pixel(src_base, in_attr, xf, yf, &dst);
+                dst_row[x] = dst;
+            }
+            else
+            {
+                float tl = 0, tr = 0, bl = 0, br = 0;
+                float ar = xf - floorf(xf);
+                float ab = yf - floorf(yf);
+                float al = 1.0f - ar;
+                float at = 1.0f - ab;
+
+                _read_pixel(src_base, in_attr, floorf(xf), floorf(yf), &tl);
+                _read_pixel(src_base, in_attr, floorf(xf) + 1, floorf(yf), &tr);
+                _read_pixel(src_base, in_attr, floorf(xf), floorf(yf) + 1, &bl);
+                _read_pixel(src_base, in_attr, floorf(xf) + 1, floorf(yf) + 1, &br);
+
+                dst_row[x] = tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
+            }
+        }
+    }
+} /* _warp_perspective_rows() */
+
 /*
  * Kernel function
  */
@@ -131,13 +195,9 @@ DEF_KERNEL_EXECUTOR(_compute)
     int32_t type = 0;
     float matrix[9] = {0};
     vsi_size_t i = 0;
-    vsi_size_t b = 0;
-    vsi_size_t x = 0;
-    vsi_size_t y = 0;
     vsi_size_t out_elements = 0;
-    vsi_size_t width = 0;
-    vsi_size_t height = 0;
     vsi_size_t outer_size = 1;
+    _warp_perspective_task_t task;
 
     VSI_UNREFERENCED(node);
     VSI_UNREFERENCED(param_size);
@@ -170,49 +230,19 @@ DEF_KERNEL_EXECUTOR(_compute)
         CHECK_STATUS_FAIL_GOTO(status, final );
     }
 
-    width = attr[1]->shape->data[0];
-    height = attr[1]->shape->data[1];
+    task.input = buffer[0];
+    task.output = buffer[1];
+    task.in_attr = attr[0];
+    task.width = attr[1]->shape->data[0];
+    task.height = attr[1]->shape->data[1];
+    memcpy( task.matrix, matrix, sizeof(matrix) );
+    task.type = type;
     for(i = 2; i < (vsi_size_t)attr[1]->shape->size; ++i)
     {
         outer_size *= attr[1]->shape->data[i];
     }
-    // Do something
-    for (b = 0; b < outer_size; b++)
-    {
-        float *src_base = buffer[0] + b * attr[0]->shape->data[0] * attr[0]->shape->data[1];
-        float *dst_base = buffer[1] + b * width * height;
-        for (y = 0; y < height; y++)
-        {
-            for (x = 0; x < width; x++)
-            {
-                float xf = 0;
-                float yf = 0;
-                float dst = 0;
-
-                _transform_perspective(x, y, matrix, &xf, &yf);
-                if (type == VSI_NN_INTERPOLATION_NEAREST_NEIGHBOR)
-                {
-                    _read_pixel(src_base, attr[0], xf, yf, &dst);
-                    dst_base[y * width + x] = dst;
-                }
-                else
-                {
-                    float tl = 0, tr = 0, bl = 0, br = 0;
-                    float ar = xf - floorf(xf);
-                    float ab = yf - floorf(yf);
-                    float al = 1.0f - ar;
-                    float at = 1.0f - ab;
-
-                    _read_pixel(src_base, attr[0], floorf(xf), floorf(yf), &tl);
-                    _read_pixel(src_base, attr[0], floorf(xf) + 1, floorf(yf), &tr);
-                    _read_pixel(src_base, attr[0], floorf(xf), floorf(yf) + 1, &bl);
-                    _read_pixel(src_base, attr[0], floorf(xf) + 1, floorf(yf) + 1, &br);
-
-                    dst_base[y * width + x] = tl * al * at + tr * ar * at + bl * al * ab + br * ar * ab;
-                }
-            }
-        }
-    }
+    vsi_nn_kernel_cpu_parallel_for( (size_t)(outer_size * task.height),
+        vsi_nn_kernel_cpu_grain( (size_t)task.width * 16 ), _warp_perspective_rows, &task );
 
     status = vsi_nn_kernel_tensor_write_from_float( tensors[1], attr[1],
             buffer[1], out_elements );
@@ -26,6 +26,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 #include "vsi_nn_context.h"
 #include "vsi_nn_prv.h"
 #include "vsi_nn_types.h"
@@ -33,6 +38,7 @@
 #include "vsi_nn_log.h"
 #include "vsi_nn_error.h"
 #include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_tuning.h"
 #include "utils/vsi_nn_math.h"
 #include "vsi_nn_tensor_util.h"
 #include "utils/vsi_nn_dtype_util.h"
@@ -51,12 +57,66 @@ typedef struct
     void* reserve_mem;
 } kernel_program_info_t;
 
+/*
+ * Built programs are cached per vx context and keyed by kernel type,
+ * source format, source names and build options. Kernels compiled from
+ * the same source share one program instead of rebuilding it. An entry
+ * is added before its program is built, threads asking for the same key
+ * meanwhile wait for that build instead of starting their own.
+ */
+typedef struct _kernel_program_cache
+{
+    struct _kernel_program_cache * next;
+    vx_context ctx;
+    char * key;
+    vx_program program;
+    vsi_bool building;
+} kernel_program_cache_t;
+
+static kernel_program_cache_t * _program_cache = NULL;
+
+/*
+ * The program cache lock only guards cache lookups and inserts, programs
+ * are built without any lock so graphs set up on different threads build
+ * in parallel. The kernel register lock guards adding kernels to the vx
+ * context, so a kernel name is registered once.
+ */
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+static SRWLOCK _program_cache_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE _program_cache_cond = CONDITION_VARIABLE_INIT;
+#define _PROGRAM_CACHE_LOCK()       AcquireSRWLockExclusive( &_program_cache_lock )
+#define _PROGRAM_CACHE_UNLOCK()     ReleaseSRWLockExclusive( &_program_cache_lock )
+#define _PROGRAM_CACHE_WAIT()       \
+    SleepConditionVariableSRW( &_program_cache_cond, &_program_cache_lock, INFINITE, 0 )
+#define _PROGRAM_CACHE_NOTIFY()     WakeAllConditionVariable( &_program_cache_cond )
+static SRWLOCK _kernel_register_lock = SRWLOCK_INIT;
+#define _KERNEL_REGISTER_LOCK()     AcquireSRWLockExclusive( &_kernel_register_lock )
+#define _KERNEL_REGISTER_UNLOCK()   ReleaseSRWLockExclusive( &_kernel_register_lock )
+#else
+static pthread_mutex_t _program_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _program_cache_cond = PTHREAD_COND_INITIALIZER;
+#define _PROGRAM_CACHE_LOCK()       pthread_mutex_lock( &_program_cache_lock )
+#define _PROGRAM_CACHE_UNLOCK()     pthread_mutex_unlock( &_program_cache_lock )
+#define _PROGRAM_CACHE_WAIT()       \
+    pthread_cond_wait( &_program_cache_cond, &_program_cache_lock )
+#define _PROGRAM_CACHE_NOTIFY()     pthread_cond_broadcast( &_program_cache_cond )
+static pthread_mutex_t _kernel_register_lock = PTHREAD_MUTEX_INITIALIZER;
+#define _KERNEL_REGISTER_LOCK()     pthread_mutex_lock( &_kernel_register_lock )
+#define _KERNEL_REGISTER_UNLOCK()   pthread_mutex_unlock( &_kernel_register_lock )
+#endif
+
 static vsi_status _kernel_init_obj
     (
     vx_kernel_description_t* info,
     vx_kernel obj
     );
 
+static vsi_bool _kernel_registered
+    (
+    vx_context ctx,
+    const char* name
+    );
+
 static vsi_status _cpu_register
     (
     vsi_nn_graph_t* graph,
@@ -226,9 +286,15 @@ static vsi_status _cpu_register
     vx_kernel_description_t* info;
     vx_kernel obj;
 
-    status = VSI_FAILURE;
+    status = VSI_SUCCESS;
     info = &kernel->info;
 
+    _KERNEL_REGISTER_LOCK();
+    if( _kernel_registered( graph->ctx->c, info->name ) )
+    {
+        _KERNEL_REGISTER_UNLOCK();
+        return status;
+    }
     obj = vxAddUserKernel(
         graph->ctx->c,
         info->name,
@@ -247,7 +313,9 @@ static vsi_status _cpu_register
     else
     {
         VSILOGE( "Add kernel %s fail.", info->name );
+        status = VSI_FAILURE;
     }
+    _KERNEL_REGISTER_UNLOCK();
     return status;
 } /* _cpu_register() */
 
@@ -538,59 +606,34 @@ final:
     return program;
 } /* _create_program_from_executable() */
 
-static vsi_status _gpu_register
+#define MAX_BUILDPROGRAM_LEN 1024
+
+static void _gpu_build_option
     (
     vsi_nn_graph_t* graph,
-    vsi_nn_kernel_t* kernel
+    vsi_nn_kernel_t* kernel,
+    char* cmd,
+    size_t cmd_size
     )
 {
-    vsi_status status;
-    vx_kernel_description_t* info;
-    vx_kernel obj;
-    vsi_nn_context_t context;
-    vx_program program = NULL;
+    vsi_nn_context_t context = graph->ctx;
     const vsi_nn_gpu_source_fmt_e active_fmt = kernel->gpu.active_source_fmt;
-
-#define MAX_BUILDPROGRAM_LEN 1024
-    char cmd[MAX_BUILDPROGRAM_LEN] = { 0 };
     size_t cost_bytes = 0;
 
-    memset( cmd, 0, sizeof(char) * MAX_BUILDPROGRAM_LEN );
-    context = graph->ctx;
-
-    status = VSI_FAILURE;
-    info = &(kernel->info);
-
-    switch( active_fmt )
-    {
-        case VSI_NN_GPU_SOURCE_FMT_CODE:
-            program = _create_program_from_code( graph, kernel );
-            break;
-        case VSI_NN_GPU_SOURCE_FMT_EXECUTABLE:
-            program = _create_program_from_executable( graph, kernel );
-            break;
-        default:
-            VSILOGE("Unknown source format %d", kernel->gpu.active_source_fmt);
-            break;
-    }
-    if( NULL == program )
-    {
-        return status;
-    }
-
+    memset( cmd, 0, sizeof(char) * cmd_size );
     if( context->config.evis.ver == VSI_NN_HW_EVIS_NONE )
     {
         // set default evis version is 2
         if( VSI_NN_KERNEL_TYPE_EVIS == kernel->type )
         {
-            cost_bytes = snprintf( cmd, MAX_BUILDPROGRAM_LEN,
+            cost_bytes = snprintf( cmd, cmd_size,
                     "-cl-viv-vx-extension -D VX_VERSION=2 -D USE_40BITS_VA=%d",
                     context->config.use_40bits_va );
         }
     }
     else
     {
-        cost_bytes = snprintf( cmd, MAX_BUILDPROGRAM_LEN,
+        cost_bytes = snprintf( cmd, cmd_size,
                 "-cl-viv-vx-extension -D VX_VERSION=%d -D USE_40BITS_VA=%d",
                 context->config.evis.ver, context->config.use_40bits_va );
     }
@@ -598,9 +641,9 @@ static vsi_status _gpu_register
     if( kernel->gpu.sources[active_fmt].build_option.data )
     {
         vsi_nn_kernel_build_option_t * option = &kernel->gpu.sources[active_fmt].build_option;
-        if( MAX_BUILDPROGRAM_LEN - cost_bytes > strlen( option->data ) + 1 )
+        if( cmd_size - cost_bytes > strlen( option->data ) + 1 )
         {
-            snprintf( &cmd[cost_bytes], MAX_BUILDPROGRAM_LEN - cost_bytes,
+            snprintf( &cmd[cost_bytes], cmd_size - cost_bytes,
                     " %s", option->data );
         }
         else
@@ -609,146 +652,375 @@ static vsi_status _gpu_register
             VSI_ASSERT( FALSE );
         }
     }
+} /* _gpu_build_option() */
 
-    status = vxBuildProgram( program, cmd );
+/*
+ * Create and build the program of a gpu kernel, no lock is held here.
+ * resources is only used by the code format of vsi_nn_kernel_register_ext().
+ */
+static vx_program _gpu_build_program
+    (
+    vsi_nn_graph_t* graph,
+    vsi_nn_kernel_t* kernel,
+    const char** resources,
+    const char* cmd
+    )
+{
+    vsi_status status;
+    vx_program program = NULL;
 
+    switch( kernel->gpu.active_source_fmt )
+    {
+        case VSI_NN_GPU_SOURCE_FMT_CODE:
+            if( resources )
+            {
+                program = _create_program_from_code_ext( graph, kernel, resources );
+            }
+            else
+            {
+                program = _create_program_from_code( graph, kernel );
+            }
+            break;
+        case VSI_NN_GPU_SOURCE_FMT_EXECUTABLE:
+            program = _create_program_from_executable( graph, kernel );
+            break;
+        default:
+            VSILOGE("Unknown source format %d", kernel->gpu.active_source_fmt);
+            break;
+    }
+    if( NULL == program )
+    {
+        return NULL;
+    }
+
+    status = vxBuildProgram( program, cmd );
     if( VSI_SUCCESS != status )
     {
         VSILOGE("Build program fail.");
-        return status;
+        vxReleaseProgram( &program );
     }
+    return program;
+} /* _gpu_build_program() */
 
-    obj = vxAddKernelInProgram(
-        program,
-        info->name,
-        info->enumeration,
-        info->numParams,
-        info->validate,
-        info->initialize,
-        info->deinitialize
-        );
+static char* _program_cache_key
+    (
+    vsi_nn_kernel_t* kernel,
+    const char* cmd
+    )
+{
+    const vsi_nn_gpu_source_fmt_e active_fmt = kernel->gpu.active_source_fmt;
+    const vsi_nn_kernel_source_info_t* source_info = &kernel->gpu.sources[active_fmt];
+    size_t len = strlen( cmd ) + 16;
+    size_t i;
+    char* key = NULL;
 
-    if( obj )
+    for( i = 0; i < source_info->num; i ++ )
     {
-        status = _kernel_init_obj( info, obj );
-        //vxReleaseKernel( &obj );
+        len += strlen( source_info->data[i] ) + 1;
     }
-    else
+    key = (char*)malloc( len );
+    CHECK_PTR_FAIL_GOTO( key, "Create buffer fail.", final );
+    snprintf( key, len, "%d:%d|", kernel->type, active_fmt );
+    for( i = 0; i < source_info->num; i ++ )
     {
-        VSILOGE( "Add kernel %s fail.", info->name );
+        strncat( key, source_info->data[i], len - strlen( key ) - 1 );
+        strncat( key, "|", len - strlen( key ) - 1 );
     }
-    if( program )
+    strncat( key, cmd, len - strlen( key ) - 1 );
+final:
+    return key;
+} /* _program_cache_key() */
+
+/*
+ * Callers must hold _PROGRAM_CACHE_LOCK for the helpers below.
+ */
+static kernel_program_cache_t* _program_cache_find
+    (
+    vx_context ctx,
+    const char* key
+    )
+{
+    kernel_program_cache_t* item = _program_cache;
+    while( item )
     {
-        vxReleaseProgram( &program );
+        if( item->ctx == ctx && strcmp( item->key, key ) == 0 )
+        {
+            return item;
+        }
+        item = item->next;
     }
-    return status;
-} /* _gpu_register() */
+    return NULL;
+} /* _program_cache_find() */
 
-static vsi_status _gpu_register_ext
+static void _program_cache_remove
+    (
+    kernel_program_cache_t* item
+    )
+{
+    kernel_program_cache_t** link = &_program_cache;
+    while( *link )
+    {
+        if( *link == item )
+        {
+            *link = item->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    if( item->program )
+    {
+        vxReleaseProgram( &item->program );
+    }
+    free( item->key );
+    free( item );
+} /* _program_cache_remove() */
+
+static vsi_bool _program_cache_building
+    (
+    vx_context ctx
+    )
+{
+    kernel_program_cache_t* item;
+    for( item = _program_cache; item; item = item->next )
+    {
+        if( item->ctx == ctx && item->building )
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+} /* _program_cache_building() */
+
+/*
+ * Return the built program for kernel and cmd. The first caller for a key
+ * inserts a building entry and builds outside the lock, later callers wait
+ * for it. If the build fails the entry is dropped and a waiter retries.
+ * cached is set to TRUE when the program is owned by the cache, otherwise
+ * the caller releases it.
+ */
+static vx_program _program_cache_acquire
     (
     vsi_nn_graph_t* graph,
     vsi_nn_kernel_t* kernel,
-    const char** resources
+    const char* cmd,
+    vsi_bool* cached
     )
 {
-    vsi_status status;
-    vx_kernel_description_t* info;
-    vx_kernel obj;
-    vsi_nn_context_t context;
+    vx_context ctx = graph->ctx->c;
+    kernel_program_cache_t* item = NULL;
     vx_program program = NULL;
-    const vsi_nn_gpu_source_fmt_e active_fmt = kernel->gpu.active_source_fmt;
+    char* key = NULL;
 
-#define MAX_BUILDPROGRAM_LEN 1024
-    char cmd[MAX_BUILDPROGRAM_LEN] = { 0 };
-    size_t cost_bytes = 0;
-
-    memset( cmd, 0, sizeof(char) * MAX_BUILDPROGRAM_LEN );
-    context = graph->ctx;
-
-    status = VSI_FAILURE;
-    info = &(kernel->info);
+    *cached = FALSE;
+    key = _program_cache_key( kernel, cmd );
+    if( NULL == key )
+    {
+        return _gpu_build_program( graph, kernel, NULL, cmd );
+    }
 
-    switch( active_fmt )
+    _PROGRAM_CACHE_LOCK();
+    item = _program_cache_find( ctx, key );
+    while( item && item->building )
     {
-        case VSI_NN_GPU_SOURCE_FMT_CODE:
-            program = _create_program_from_code_ext( graph, kernel,resources );
-            break;
-        case VSI_NN_GPU_SOURCE_FMT_EXECUTABLE:
-            program = _create_program_from_executable( graph, kernel );
-            break;
-        default:
-            VSILOGE("Unknown source format %d", kernel->gpu.active_source_fmt);
-            break;
+        _PROGRAM_CACHE_WAIT();
+        item = _program_cache_find( ctx, key );
     }
-    if( NULL == program )
+    if( item )
     {
-        return status;
+        VSILOGD("Reuse program for kernel %s", kernel->info.name);
+        program = item->program;
+        *cached = TRUE;
+        _PROGRAM_CACHE_UNLOCK();
+        free( key );
+        return program;
+    }
+    item = (kernel_program_cache_t*)malloc( sizeof(kernel_program_cache_t) );
+    if( item )
+    {
+        /* Key is owned by cache now. */
+        item->ctx = ctx;
+        item->key = key;
+        item->program = NULL;
+        item->building = TRUE;
+        item->next = _program_cache;
+        _program_cache = item;
+        key = NULL;
     }
+    _PROGRAM_CACHE_UNLOCK();
+    vsi_nn_safe_free( key );
 
-    if( context->config.evis.ver == VSI_NN_HW_EVIS_NONE )
+    program = _gpu_build_program( graph, kernel, NULL, cmd );
+
+    if( item )
     {
-        // set default evis version is 2
-        if( VSI_NN_KERNEL_TYPE_EVIS == kernel->type )
+        _PROGRAM_CACHE_LOCK();
+        if( program )
         {
-            cost_bytes = snprintf( cmd, MAX_BUILDPROGRAM_LEN,
-                    "-cl-viv-vx-extension -D VX_VERSION=2 -D USE_40BITS_VA=%d",
-                    context->config.use_40bits_va );
+            item->program = program;
+            item->building = FALSE;
+            *cached = TRUE;
+        }
+        else
+        {
+            _program_cache_remove( item );
         }
+        _PROGRAM_CACHE_NOTIFY();
+        _PROGRAM_CACHE_UNLOCK();
     }
-    else
+    return program;
+} /* _program_cache_acquire() */
+
+void vsi_nn_kernel_program_cache_release
+    (
+    vx_context ctx
+    )
+{
+    kernel_program_cache_t* item;
+    kernel_program_cache_t* next;
+    _PROGRAM_CACHE_LOCK();
+    while( _program_cache_building( ctx ) )
     {
-        cost_bytes = snprintf( cmd, MAX_BUILDPROGRAM_LEN,
-                "-cl-viv-vx-extension -D VX_VERSION=%d -D USE_40BITS_VA=%d",
-                context->config.evis.ver, context->config.use_40bits_va );
+        _PROGRAM_CACHE_WAIT();
     }
-    // Pack build option
-    if( kernel->gpu.sources[active_fmt].build_option.data )
+    for( item = _program_cache; item; item = next )
     {
-        vsi_nn_kernel_build_option_t * option = &kernel->gpu.sources[active_fmt].build_option;
-        if( MAX_BUILDPROGRAM_LEN - cost_bytes > strlen( option->data ) + 1 )
+        next = item->next;
+        if( item->ctx == ctx )
         {
-            snprintf( &cmd[cost_bytes], MAX_BUILDPROGRAM_LEN - cost_bytes,
-                    " %s", option->data );
+            _program_cache_remove( item );
         }
-        else
+    }
+    _PROGRAM_CACHE_UNLOCK();
+} /* vsi_nn_kernel_program_cache_release() */
+
+size_t vsi_nn_kernel_program_cache_count
+    (
+    vx_context ctx
+    )
+{
+    size_t count = 0;
+    kernel_program_cache_t* item;
+    _PROGRAM_CACHE_LOCK();
+    for( item = _program_cache; item; item = item->next )
+    {
+        if( item->ctx == ctx && !item->building )
         {
-            VSILOGE("Build option is too long!");
-            VSI_ASSERT( FALSE );
+            count ++;
         }
     }
+    _PROGRAM_CACHE_UNLOCK();
+    return count;
+} /* vsi_nn_kernel_program_cache_count() */
 
-    status = vxBuildProgram( program, cmd );
-
-    if( VSI_SUCCESS != status )
+/*
+ * Callers must hold _KERNEL_REGISTER_LOCK.
+ */
+static vsi_bool _kernel_registered
+    (
+    vx_context ctx,
+    const char* name
+    )
+{
+    vx_kernel obj;
+    obj = vxGetKernelByName( ctx, name );
+    if( VSI_SUCCESS != vxGetStatus( (vx_reference)obj ) )
     {
-        VSILOGE("Build program fail.");
-        return status;
+        return FALSE;
     }
+    vxReleaseKernel( &obj );
+    return TRUE;
+} /* _kernel_registered() */
+
+/*
+ * Add the kernel to program under _KERNEL_REGISTER_LOCK. A kernel
+ * registered by another thread while this one built its program
+ * is taken as success.
+ */
+static vsi_status _gpu_add_kernel
+    (
+    vsi_nn_graph_t* graph,
+    vx_program program,
+    vx_kernel_description_t* info
+    )
+{
+    vsi_status status = VSI_SUCCESS;
+    vx_kernel obj;
 
-    obj = vxAddKernelInProgram(
-        program,
-        info->name,
-        info->enumeration,
-        info->numParams,
-        info->validate,
-        info->initialize,
-        info->deinitialize
-        );
+    _KERNEL_REGISTER_LOCK();
+    if( !_kernel_registered( graph->ctx->c, info->name ) )
+    {
+        obj = vxAddKernelInProgram(
+            program,
+            info->name,
+            info->enumeration,
+            info->numParams,
+            info->validate,
+            info->initialize,
+            info->deinitialize
+            );
 
-    if( obj )
-    {
-        status = _kernel_init_obj( info, obj );
-        //vxReleaseKernel( &obj );
+        if( obj )
+        {
+            status = _kernel_init_obj( info, obj );
+            //vxReleaseKernel( &obj );
+        }
+        else
+        {
+            VSILOGE( "Add kernel %s fail.", info->name );
+            status = VSI_FAILURE;
+        }
     }
-    else
+    _KERNEL_REGISTER_UNLOCK();
+    return status;
+} /* _gpu_add_kernel() */
+
+static vsi_status _gpu_register
+    (
+    vsi_nn_graph_t* graph,
+    vsi_nn_kernel_t* kernel
+    )
+{
+    vsi_status status;
+    vx_program program = NULL;
+    vsi_bool cached = FALSE;
+    char cmd[MAX_BUILDPROGRAM_LEN] = { 0 };
+
+    _gpu_build_option( graph, kernel, cmd, MAX_BUILDPROGRAM_LEN );
+    program = _program_cache_acquire( graph, kernel, cmd, &cached );
+    if( NULL == program )
     {
-        VSILOGE( "Add kernel %s fail.", info->name );
+        return VSI_FAILURE;
     }
-    if( program )
+
+    status = _gpu_add_kernel( graph, program, &kernel->info );
+    if( !cached )
     {
         vxReleaseProgram( &program );
     }
     return status;
+} /* _gpu_register() */
+
+static vsi_status _gpu_register_ext
+    (
+    vsi_nn_graph_t* graph,
+    vsi_nn_kernel_t* kernel,
+    const char** resources
+    )
+{
+    vsi_status status;
+    vx_program program = NULL;
+    char cmd[MAX_BUILDPROGRAM_LEN] = { 0 };
+
+    _gpu_build_option( graph, kernel, cmd, MAX_BUILDPROGRAM_LEN );
+    program = _gpu_build_program( graph, kernel, resources, cmd );
+    if( NULL == program )
+    {
+        return VSI_FAILURE;
+    }
+
+    status = _gpu_add_kernel( graph, program, &kernel->info );
+    vxReleaseProgram( &program );
+    return status;
 } /* _gpu_register_ext() */
 
 static vsi_status _kernel_init_obj
@@ -797,7 +1069,7 @@ static vsi_status _kernel_init_obj
     return status;
 } /* _kernel_init_obj() */
 
-vsi_status vsi_nn_kernel_register
+static vsi_status _kernel_register
     (
     vsi_nn_graph_t* graph,
     vsi_nn_kernel_t* kernel
@@ -822,6 +1094,15 @@ vsi_status vsi_nn_kernel_register
         break;
     }
     return status;
+} /* _kernel_register() */
+
+vsi_status vsi_nn_kernel_register
+    (
+    vsi_nn_graph_t* graph,
+    vsi_nn_kernel_t* kernel
+    )
+{
+    return _kernel_register( graph, kernel );
 } /* vsi_nn_kernel_register() */
 
 vsi_status vsi_nn_kernel_register_ext
@@ -831,10 +1112,7 @@ vsi_status vsi_nn_kernel_register_ext
     const char** resources
     )
 {
-    vsi_status status;
-    status = VSI_FAILURE;
-    status = _gpu_register_ext( graph, kernel,resources );
-    return status;
+    return _gpu_register_ext( graph, kernel, resources );
 } /* vsi_nn_kernel_register_ext */
 
 vsi_nn_kernel_node_t  vsi_nn_kernel_create_node
@@ -880,12 +1158,14 @@ vsi_nn_kernel_node_t  vsi_nn_kernel_create_node
 
     ctx = vxGetContext( (vx_reference)graph->g );
 
+    _KERNEL_REGISTER_LOCK();
     obj = vxGetKernelByName( ctx, info->name );
+    _KERNEL_REGISTER_UNLOCK();
     status = vxGetStatus( (vx_reference)obj );
     if (VSI_SUCCESS != status)
     {
         /* Register kernel */
-        status = vsi_nn_kernel_register( graph, kernel );
+        status = _kernel_register( graph, kernel );
         if( VSI_SUCCESS != status )
         {
             VSILOGE( "Register client kernel %s fail with %d.",
@@ -899,7 +1179,9 @@ vsi_nn_kernel_node_t  vsi_nn_kernel_create_node
         }
 
         /* Load kernel */
+        _KERNEL_REGISTER_LOCK();
         obj = vxGetKernelByName( ctx, info->name );
+        _KERNEL_REGISTER_UNLOCK();
         status = vxGetStatus( (vx_reference)obj );
     }
     if( VSI_SUCCESS != status )
@@ -965,13 +1247,15 @@ vsi_nn_kernel_node_t  vsi_nn_kernel_create_node_ext
 
     ctx = vxGetContext( (vx_reference)graph->g );
 
+    _KERNEL_REGISTER_LOCK();
     obj = vxGetKernelByName( ctx, info->name );
+    _KERNEL_REGISTER_UNLOCK();
     status = vxGetStatus( (vx_reference)obj );
     if (VSI_SUCCESS != status)
     {
         fprintf(stderr, "\n"); // TODO: This is a hack for driver msg
         /* Register kernel */
-        status = vsi_nn_kernel_register_ext( graph, kernel,resources );
+        status = _gpu_register_ext( graph, kernel,resources );
         if( VSI_SUCCESS != status )
         {
             VSILOGE( "Register client kernel %s fail with %d.",
@@ -985,7 +1269,9 @@ vsi_nn_kernel_node_t  vsi_nn_kernel_create_node_ext
         }
 
         /* Load kernel */
+        _KERNEL_REGISTER_LOCK();
         obj = vxGetKernelByName( ctx, info->name );
+        _KERNEL_REGISTER_UNLOCK();
         status = vxGetStatus( (vx_reference)obj );
     }
     if( VSI_SUCCESS != status )
@@ -1174,6 +1460,109 @@ void vsi_nn_kernel_reset
     }
 } /* vsi_nn_kernel_reset() */
 
+static vsi_bool _kernel_type_is_available
+    (
+    vsi_nn_graph_t* graph,
+    const vsi_nn_kernel_backend_t* backend,
+    vsi_nn_kernel_type_e type,
+    vsi_nn_tensor_t** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t** outputs,
+    size_t output_num
+    )
+{
+    /* Skip evis and cl when disable shader */
+    if ( (type == VSI_NN_KERNEL_TYPE_EVIS || type == VSI_NN_KERNEL_TYPE_CL)
+        && ( _check_shader_support(graph) == FALSE ||
+        vsi_nn_kernel_is_supported_types(inputs, input_num, outputs, output_num) == FALSE ) )
+    {
+        return FALSE;
+    }
+    /* Skip evis if not support */
+    if( type == VSI_NN_KERNEL_TYPE_EVIS
+            && graph->ctx->config.evis.ver == VSI_NN_HW_EVIS_NONE )
+    {
+        return FALSE;
+    }
+
+    /* Skip StreamProcesor if not support */
+    if( type == VSI_NN_KERNEL_TYPE_SP &&
+        vsi_nn_is_stream_process_supported_types(graph, inputs, input_num) == FALSE )
+    {
+        return FALSE;
+    }
+
+    /* Skip no kernel func */
+    return NULL != backend->setup[type];
+} /* _kernel_type_is_available() */
+
+/*
+ * Move the tuned kernel type to the head of selector, tune it first if
+ * tuning mode is enabled and there is no record in database.
+ */
+static void _kernel_tuning_apply
+    (
+    vsi_nn_graph_t* graph,
+    const char* kernel_name,
+    const vsi_nn_kernel_backend_t* backend,
+    vsi_nn_kernel_t* kernel,
+    vsi_nn_kernel_selector_t* selector,
+    vsi_nn_tensor_t** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t** outputs,
+    size_t output_num,
+    const vsi_nn_kernel_param_t* params
+    )
+{
+    char key[VSI_NN_KERNEL_TUNING_KEY_SIZE];
+    vsi_nn_kernel_type_e best = VSI_NN_KERNEL_TYPE_NONE;
+    double best_time = -1.0;
+    int32_t i;
+
+    if( !vsi_nn_kernel_tuning_active( graph->ctx ) )
+    {
+        return;
+    }
+    if( !vsi_nn_kernel_tuning_make_key( key, sizeof(key), kernel_name,
+            inputs, input_num, outputs, output_num, params ) )
+    {
+        VSILOGD("Kernel tuning key too long for \"%s\"", kernel_name);
+        return;
+    }
+    if( vsi_nn_kernel_tuning_reorder( key, selector )
+     || !graph->ctx->options.enable_kernel_tuning )
+    {
+        return;
+    }
+    for( i = 0; i < selector->allow_kernel_num; i ++ )
+    {
+        vsi_nn_kernel_type_e type = selector->pirority[i].kernel_type;
+        double time;
+        if( !_kernel_type_is_available( graph, backend, type,
+                inputs, input_num, outputs, output_num ) )
+        {
+            continue;
+        }
+        vsi_nn_kernel_reset( kernel, type );
+        kernel->unique_id = KERNEL_ID_OVXLIB_START + backend->unique_id;
+        time = vsi_nn_kernel_tuning_measure( graph, backend->setup[type], kernel,
+                inputs, input_num, outputs, output_num, params );
+        VSILOGD("Tune %s kernel \"%s\": %.2fus",
+            vsi_nn_kernel_type_str(type), kernel_name, time);
+        if( time >= 0.0 && ( best_time < 0.0 || time < best_time ) )
+        {
+            best_time = time;
+            best = type;
+        }
+    }
+    if( best == VSI_NN_KERNEL_TYPE_NONE )
+    {
+        return;
+    }
+    vsi_nn_kernel_tuning_update( key, best );
+    vsi_nn_kernel_tuning_reorder( key, selector );
+} /* _kernel_tuning_apply() */
+
 vsi_nn_kernel_node_t vsi_nn_kernel_selector
     (
     vsi_nn_graph_t* graph,
@@ -1231,6 +1620,8 @@ vsi_nn_kernel_node_t vsi_nn_kernel_selector
         vsi_nn_kernel_pirority_set( &selector,
                 default_pirority, _cnt_of_array(default_pirority) );
     }
+    _kernel_tuning_apply( graph, kernel_name, backend, kernel, &selector,
+            inputs, input_num, outputs, output_num, params );
     /**
      * All kernels for one operation will share the same id.
      */
@@ -1242,34 +1633,12 @@ vsi_nn_kernel_node_t vsi_nn_kernel_selector
         for( i = 0; i < (uint32_t)selector.allow_kernel_num; i ++ )
         {
             type = selector.pirority[i].kernel_type;
-
-            /* Skip evis and cl when disable shader */
-            if ( (type == VSI_NN_KERNEL_TYPE_EVIS || type == VSI_NN_KERNEL_TYPE_CL)
-                && ( _check_shader_support(graph) == FALSE ||
-                vsi_nn_kernel_is_supported_types(inputs, input_num, outputs, output_num) == FALSE ) )
-            {
-                continue;
-            }
-            /* Skip evis if not support */
-            if( type == VSI_NN_KERNEL_TYPE_EVIS
-                    && graph->ctx->config.evis.ver == VSI_NN_HW_EVIS_NONE )
-            {
-                continue;
-            }
-
-            /* Skip StreamProcesor if not support */
-            if( type == VSI_NN_KERNEL_TYPE_SP &&
-                vsi_nn_is_stream_process_supported_types(graph, inputs, input_num) == FALSE )
+            if( !_kernel_type_is_available( graph, backend, type,
+                    inputs, input_num, outputs, output_num ) )
             {
                 continue;
             }
-
             kernel_func = backend->setup[type];
-            /* Skip no kernel func */
-            if( NULL == kernel_func )
-            {
-                continue;
-            }
             vsi_nn_kernel_reset( kernel, type );
             kernel->unique_id = KERNEL_ID_OVXLIB_START + backend->unique_id;
             node = kernel_func( graph, inputs, input_num,
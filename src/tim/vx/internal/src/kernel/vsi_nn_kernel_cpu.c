@@ -0,0 +1,311 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "vsi_nn_types.h"
+#include "vsi_nn_log.h"
+#include "utils/vsi_nn_math.h"
+#include "utils/vsi_nn_util.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
+
+/* Chunks per thread, so uneven chunks still balance across the pool. */
+#define _CHUNKS_PER_THREAD     (4)
+
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+/*
+ * No worker pool on Windows hosts, parallel_for runs serially there.
+ */
+size_t vsi_nn_kernel_cpu_thread_num
+    (
+    void
+    )
+{
+    return 1;
+} /* vsi_nn_kernel_cpu_thread_num() */
+
+void vsi_nn_kernel_cpu_parallel_for
+    (
+    size_t count,
+    size_t grain,
+    vsi_nn_kernel_cpu_task_t task,
+    void * data
+    )
+{
+    VSI_UNREFERENCED(grain);
+    if ( count > 0 )
+    {
+        task( data, 0, count );
+    }
+} /* vsi_nn_kernel_cpu_parallel_for() */
+#else
+typedef struct
+{
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t  wakeup;
+    pthread_cond_t  finished;
+    pthread_t       workers[VSI_NN_KERNEL_CPU_MAX_THREADS];
+    size_t          worker_num;
+    /* Current job, guarded by lock */
+    uint64_t        generation;
+    vsi_nn_kernel_cpu_task_t task;
+    void          * data;
+    size_t          count;
+    size_t          chunk_size;
+    size_t          chunk_num;
+    size_t          next_chunk;
+    size_t          done_chunk;
+} _cpu_pool_t;
+
+static _cpu_pool_t _pool;
+static pthread_once_t _pool_once = PTHREAD_ONCE_INIT;
+static __thread vsi_bool _in_parallel_region = FALSE;
+
+/*
+ * Claim and run chunks of the current job until none is left.
+ * Must be called with lock held, returns with lock held.
+ */
+static void _run_chunks
+    (
+    _cpu_pool_t * pool
+    )
+{
+    while ( pool->next_chunk < pool->chunk_num )
+    {
+        size_t chunk = pool->next_chunk ++;
+        size_t begin = chunk * pool->chunk_size;
+        size_t end = vsi_nn_min( begin + pool->chunk_size, pool->count );
+        vsi_nn_kernel_cpu_task_t task = pool->task;
+        void * data = pool->data;
+
+        pthread_mutex_unlock( &pool->lock );
+        task( data, begin, end );
+        pthread_mutex_lock( &pool->lock );
+
+        pool->done_chunk ++;
+        if ( pool->done_chunk == pool->chunk_num )
+        {
+            pthread_cond_broadcast( &pool->finished );
+        }
+    }
+} /* _run_chunks() */
+
+static void * _worker_loop
+    (
+    void * arg
+    )
+{
+    _cpu_pool_t * pool = (_cpu_pool_t *)arg;
+    uint64_t seen = 0;
+
+    _in_parallel_region = TRUE;
+    pthread_mutex_lock( &pool->lock );
+    for ( ;; )
+    {
+        while ( pool->generation == seen )
+        {
+            pthread_cond_wait( &pool->wakeup, &pool->lock );
+        }
+        seen = pool->generation;
+        _run_chunks( pool );
+    }
+    pthread_mutex_unlock( &pool->lock );
+    return NULL;
+} /* _worker_loop() */
+
+static void _pool_init
+    (
+    void
+    )
+{
+    long cores = sysconf( _SC_NPROCESSORS_ONLN );
+    char * env = getenv( "VSI_NN_CPU_THREAD_NUM" );
+    size_t threads = cores > 0 ? (size_t)cores : 1;
+    size_t i = 0;
+
+    if ( env && atoi( env ) > 0 )
+    {
+        threads = (size_t)atoi( env );
+    }
+    threads = vsi_nn_min( threads, VSI_NN_KERNEL_CPU_MAX_THREADS );
+
+    pthread_mutex_init( &_pool.submit_lock, NULL );
+    pthread_mutex_init( &_pool.lock, NULL );
+    pthread_cond_init( &_pool.wakeup, NULL );
+    pthread_cond_init( &_pool.finished, NULL );
+
+    /* The caller of parallel_for is one of the threads. */
+    for ( i = 0; i + 1 < threads; i++ )
+    {
+        pthread_attr_t attr;
+        pthread_attr_init( &attr );
+        pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+        if ( pthread_create( &_pool.workers[i], &attr, _worker_loop, &_pool ) != 0 )
+        {
+            pthread_attr_destroy( &attr );
+            VSILOGW( "Create cpu kernel worker fail, use %d threads.", (int32_t)(i + 1) );
+            break;
+        }
+        pthread_attr_destroy( &attr );
+    }
+    _pool.worker_num = i;
+    VSILOGD( "Cpu kernel pool with %d threads.", (int32_t)(_pool.worker_num + 1) );
+} /* _pool_init() */
+
+size_t vsi_nn_kernel_cpu_thread_num
+    (
+    void
+    )
+{
+    pthread_once( &_pool_once, _pool_init );
+    return _pool.worker_num + 1;
+} /* vsi_nn_kernel_cpu_thread_num() */
+
+void vsi_nn_kernel_cpu_parallel_for
+    (
+    size_t count,
+    size_t grain,
+    vsi_nn_kernel_cpu_task_t task,
+    void * data
+    )
+{
+    size_t threads = 0;
+    size_t chunk_num = 0;
+
+    if ( count == 0 || NULL == task )
+    {
+        return;
+    }
+    grain = grain > 0 ? grain : 1;
+    threads = vsi_nn_kernel_cpu_thread_num();
+    chunk_num = vsi_nn_min( (count + grain - 1) / grain, threads * _CHUNKS_PER_THREAD );
+
+    if ( chunk_num <= 1 || threads <= 1 || _in_parallel_region
+        || pthread_mutex_trylock( &_pool.submit_lock ) != 0 )
+    {
+        task( data, 0, count );
+        return;
+    }
+
+    pthread_mutex_lock( &_pool.lock );
+    _pool.task = task;
+    _pool.data = data;
+    _pool.count = count;
+    _pool.chunk_size = (count + chunk_num - 1) / chunk_num;
+    _pool.chunk_num = (count + _pool.chunk_size - 1) / _pool.chunk_size;
+    _pool.next_chunk = 0;
+    _pool.done_chunk = 0;
+    _pool.generation ++;
+    pthread_cond_broadcast( &_pool.wakeup );
+
+    _in_parallel_region = TRUE;
+    _run_chunks( &_pool );
+    _in_parallel_region = FALSE;
+    while ( _pool.done_chunk < _pool.chunk_num )
+    {
+        pthread_cond_wait( &_pool.finished, &_pool.lock );
+    }
+    _pool.task = NULL;
+    _pool.data = NULL;
+    pthread_mutex_unlock( &_pool.lock );
+
+    pthread_mutex_unlock( &_pool.submit_lock );
+} /* vsi_nn_kernel_cpu_parallel_for() */
+#endif
+
+float vsi_nn_kernel_cpu_max_f32
+    (
+    const float * src,
+    size_t size
+    )
+{
+    size_t i = 0;
+    float result = size > 0 ? src[0] : 0.0f;
+
+    if ( size >= 4 )
+    {
+        vsi_nn_cpu_f32x4_t acc = vsi_nn_cpu_f32x4_load( src );
+        for ( i = 4; i + 4 <= size; i += 4 )
+        {
+            acc = vsi_nn_cpu_f32x4_max( acc, vsi_nn_cpu_f32x4_load( src + i ) );
+        }
+        result = vsi_nn_cpu_f32x4_reduce_max( acc );
+    }
+    for ( ; i < size; i++ )
+    {
+        result = src[i] > result ? src[i] : result;
+    }
+    return result;
+} /* vsi_nn_kernel_cpu_max_f32() */
+
+float vsi_nn_kernel_cpu_sum_f32
+    (
+    const float * src,
+    size_t size
+    )
+{
+    size_t i = 0;
+    float result = 0.0f;
+    vsi_nn_cpu_f32x4_t acc = vsi_nn_cpu_f32x4_set1( 0.0f );
+
+    for ( i = 0; i + 4 <= size; i += 4 )
+    {
+        acc = vsi_nn_cpu_f32x4_add( acc, vsi_nn_cpu_f32x4_load( src + i ) );
+    }
+    result = vsi_nn_cpu_f32x4_reduce_add( acc );
+    for ( ; i < size; i++ )
+    {
+        result += src[i];
+    }
+    return result;
+} /* vsi_nn_kernel_cpu_sum_f32() */
+
+void vsi_nn_kernel_cpu_scale_f32
+    (
+    const float * src,
+    float * dst,
+    size_t size,
+    float scale
+    )
+{
+    size_t i = 0;
+    vsi_nn_cpu_f32x4_t s = vsi_nn_cpu_f32x4_set1( scale );
+
+    for ( i = 0; i + 4 <= size; i += 4 )
+    {
+        vsi_nn_cpu_f32x4_store( dst + i,
+            vsi_nn_cpu_f32x4_mul( vsi_nn_cpu_f32x4_load( src + i ), s ) );
+    }
+    for ( ; i < size; i++ )
+    {
+        dst[i] = src[i] * scale;
+    }
+} /* vsi_nn_kernel_cpu_scale_f32() */
@@ -26,6 +26,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 #include "vsi_nn_context.h"
 #include "vsi_nn_prv.h"
 #include "vsi_nn_graph.h"
@@ -341,24 +346,55 @@ static float vsi_nn_kernel_lut_activation(float data, vsi_nn_kernel_lut_params *
     return result;
 }
 
-vsi_status vsi_nn_kernel_lut_positive
+/*
+ * Generated tables only depend on vsi_nn_kernel_lut_params, so they are
+ * cached process-wide and shared by all nodes and graphs.
+ * Cached entries are immutable and never released.
+ */
+#define VSI_NN_KERNEL_LUT_CACHE_MAX_NUM  (256)
+
+typedef struct
+{
+    vsi_enum act_type;
+    vsi_bool pwl_sign_remove_support;
+    vsi_bool positive;
+    float clamp_min;
+    float params[16];
+} _lut_cache_key_t;
+
+typedef struct _lut_cache_entry
+{
+    struct _lut_cache_entry * next;
+    _lut_cache_key_t key;
+    float index[VSI_NN_KERNEL_LUT_MAX_SIZE];
+    float value[VSI_NN_KERNEL_LUT_MAX_SIZE];
+} _lut_cache_entry_t;
+
+static _lut_cache_entry_t * _lut_cache = NULL;
+static uint32_t _lut_cache_num = 0;
+static uint32_t _lut_cache_hits = 0;
+
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+static SRWLOCK _lut_cache_lock = SRWLOCK_INIT;
+#define _LUT_CACHE_LOCK()      AcquireSRWLockExclusive( &_lut_cache_lock )
+#define _LUT_CACHE_UNLOCK()    ReleaseSRWLockExclusive( &_lut_cache_lock )
+#else
+static pthread_mutex_t _lut_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define _LUT_CACHE_LOCK()      pthread_mutex_lock( &_lut_cache_lock )
+#define _LUT_CACHE_UNLOCK()    pthread_mutex_unlock( &_lut_cache_lock )
+#endif
+
+static vsi_status _lut_generate_positive
     (
-    vx_lut index_lut,
-    vx_lut output_lut,
-    vsi_nn_kernel_lut_params *param
+    vsi_nn_kernel_lut_params *param,
+    float *index,
+    float *value
     )
 {
-    vsi_status status = VSI_SUCCESS;
+    vsi_status status = VSI_FAILURE;
     vsi_nn_kernel_lut_t *lut = NULL;
     uint32_t i = 0;
     float clamp_min = 0;
-    float index[VSI_NN_KERNEL_LUT_MAX_SIZE] = {0};
-    float value[VSI_NN_KERNEL_LUT_MAX_SIZE] = {0};
-
-    if (index_lut == NULL || output_lut == NULL || param == NULL)
-    {
-        return VSI_FAILURE;
-    }
 
     lut = (vsi_nn_kernel_lut_t *)calloc(VSI_NN_KERNEL_LUT_MAX_SIZE, sizeof(vsi_nn_kernel_lut_t));
     CHECK_PTR_FAIL_GOTO( lut, "Create LUT buffer fail.", final );
@@ -398,33 +434,24 @@ vsi_status vsi_nn_kernel_lut_positive
         index[i] = lut[i].index;
         value[i] = lut[i].val;
     }
-
-    status  = vxCopyLUT(index_lut, (void*)&index, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
-    status |= vxCopyLUT(output_lut, (void*)&value, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    status = VSI_SUCCESS;
 final:
     vsi_nn_safe_free(lut);
 
     return status;
 }
 
-vsi_status vsi_nn_kernel_lut_all
+static vsi_status _lut_generate_all
     (
-    vx_lut index_lut,
-    vx_lut output_lut,
-    vsi_nn_kernel_lut_params *param
+    vsi_nn_kernel_lut_params *param,
+    float *index,
+    float *value
     )
 {
-    vsi_status status = VSI_SUCCESS;
+    vsi_status status = VSI_FAILURE;
     vsi_nn_kernel_lut_t *lut = NULL;
     uint32_t i = 0;
     float clamp_min = 0;
-    float index[VSI_NN_KERNEL_LUT_MAX_SIZE] = {0};
-    float value[VSI_NN_KERNEL_LUT_MAX_SIZE] = {0};
-
-    if (index_lut == NULL || output_lut == NULL || param == NULL)
-    {
-        return VSI_FAILURE;
-    }
 
     lut = (vsi_nn_kernel_lut_t *)calloc(VSI_NN_KERNEL_LUT_MAX_SIZE, sizeof(vsi_nn_kernel_lut_t));
     CHECK_PTR_FAIL_GOTO( lut, "Create LUT buffer fail.", final );
@@ -484,15 +511,208 @@ vsi_status vsi_nn_kernel_lut_all
         index[i] = lut[i].index;
         value[i] = lut[i].val;
     }
-
-    status  = vxCopyLUT(index_lut, (void*)&index, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
-    status |= vxCopyLUT(output_lut, (void*)&value, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    status = VSI_SUCCESS;
 final:
     vsi_nn_safe_free(lut);
 
     return status;
 }
 
+static _lut_cache_entry_t * _lut_cache_find
+    (
+    const _lut_cache_key_t *key
+    )
+{
+    _lut_cache_entry_t * entry = _lut_cache;
+    while ( entry )
+    {
+        if (memcmp(&entry->key, key, sizeof(_lut_cache_key_t)) == 0)
+        {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+/*
+ * Cached tables of param, generated on a miss. When the cache is full the
+ * tables are generated into an entry returned in owned, which the caller
+ * frees.
+ */
+static _lut_cache_entry_t * _lut_cache_get
+    (
+    vsi_nn_kernel_lut_params *param,
+    vsi_bool positive,
+    _lut_cache_entry_t ** owned
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    _lut_cache_key_t key;
+    _lut_cache_entry_t * entry = NULL;
+    _lut_cache_entry_t * cached = NULL;
+
+    *owned = NULL;
+    memset(&key, 0, sizeof(_lut_cache_key_t));
+    key.act_type = param->act_type;
+    key.pwl_sign_remove_support = param->pwl_sign_remove_support;
+    key.positive = positive;
+    key.clamp_min = param->clamp_min;
+    memcpy(key.params, param->params, sizeof(key.params));
+
+    _LUT_CACHE_LOCK();
+    cached = _lut_cache_find(&key);
+    if (cached)
+    {
+        _lut_cache_hits ++;
+    }
+    _LUT_CACHE_UNLOCK();
+    if (cached)
+    {
+        return cached;
+    }
+
+    entry = (_lut_cache_entry_t *)calloc(1, sizeof(_lut_cache_entry_t));
+    CHECK_PTR_FAIL_GOTO( entry, "Create LUT cache entry fail.", final );
+    memcpy(&entry->key, &key, sizeof(_lut_cache_key_t));
+    if (positive)
+    {
+        status = _lut_generate_positive(param, entry->index, entry->value);
+    }
+    else
+    {
+        status = _lut_generate_all(param, entry->index, entry->value);
+    }
+    CHECK_STATUS_FAIL_GOTO( status, final );
+
+    _LUT_CACHE_LOCK();
+    /* Another thread may have generated the same table meanwhile. */
+    cached = _lut_cache_find(&key);
+    if (cached == NULL && _lut_cache_num < VSI_NN_KERNEL_LUT_CACHE_MAX_NUM)
+    {
+        entry->next = _lut_cache;
+        _lut_cache = entry;
+        _lut_cache_num ++;
+        cached = entry;
+        entry = NULL;
+        VSILOGD("Cache LUT for activation %d, %u cached, %u reused.",
+            key.act_type, _lut_cache_num, _lut_cache_hits);
+    }
+    _LUT_CACHE_UNLOCK();
+
+    if (cached == NULL)
+    {
+        *owned = entry;
+        return entry;
+    }
+final:
+    vsi_nn_safe_free(entry);
+
+    return cached;
+}
+
+static vsi_bool _lut_is_positive
+    (
+    const vsi_nn_kernel_lut_params *param
+    )
+{
+    return param->pwl_sign_remove_support && param->clamp_min >= 0;
+}
+
+static vsi_status _lut_copy
+    (
+    vx_lut index_lut,
+    vx_lut output_lut,
+    vsi_nn_kernel_lut_params *param,
+    vsi_bool positive
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    _lut_cache_entry_t * entry = NULL;
+    _lut_cache_entry_t * owned = NULL;
+
+    if (index_lut == NULL || output_lut == NULL || param == NULL)
+    {
+        return VSI_FAILURE;
+    }
+
+    entry = _lut_cache_get(param, positive, &owned);
+    CHECK_PTR_FAIL_GOTO( entry, "Generate LUT fail.", final );
+
+    status  = vxCopyLUT(index_lut, (void*)entry->index, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+    status |= vxCopyLUT(output_lut, (void*)entry->value, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST);
+final:
+    vsi_nn_safe_free(owned);
+
+    return status;
+}
+
+vsi_status vsi_nn_kernel_lut_generate
+    (
+    vsi_nn_kernel_lut_params *param,
+    float *index,
+    float *value
+    )
+{
+    if (param == NULL || index == NULL || value == NULL)
+    {
+        return VSI_FAILURE;
+    }
+
+    if (_lut_is_positive(param))
+    {
+        return _lut_generate_positive(param, index, value);
+    }
+    return _lut_generate_all(param, index, value);
+}
+
+vsi_status vsi_nn_kernel_lut_cached
+    (
+    vsi_nn_kernel_lut_params *param,
+    const float **index,
+    const float **value
+    )
+{
+    _lut_cache_entry_t * entry = NULL;
+    _lut_cache_entry_t * owned = NULL;
+
+    if (param == NULL || index == NULL || value == NULL)
+    {
+        return VSI_FAILURE;
+    }
+
+    entry = _lut_cache_get(param, _lut_is_positive(param), &owned);
+    if (entry == NULL || owned != NULL)
+    {
+        vsi_nn_safe_free(owned);
+        return VSI_FAILURE;
+    }
+    *index = entry->index;
+    *value = entry->value;
+
+    return VSI_SUCCESS;
+}
+
+vsi_status vsi_nn_kernel_lut_positive
+    (
+    vx_lut index_lut,
+    vx_lut output_lut,
+    vsi_nn_kernel_lut_params *param
+    )
+{
+    return _lut_copy(index_lut, output_lut, param, TRUE);
+}
+
+vsi_status vsi_nn_kernel_lut_all
+    (
+    vx_lut index_lut,
+    vx_lut output_lut,
+    vsi_nn_kernel_lut_params *param
+    )
+{
+    return _lut_copy(index_lut, output_lut, param, FALSE);
+}
+
 vsi_status vsi_nn_kernel_lut
     (
     vx_lut index_lut,
@@ -501,16 +721,13 @@ vsi_status vsi_nn_kernel_lut
     )
 {
     vsi_status status = VSI_SUCCESS;
-    float clamp_min = 0;
 
     if (param == NULL)
     {
         return VSI_FAILURE;
     }
 
-    clamp_min = param->clamp_min;
-
-    if (param->pwl_sign_remove_support && clamp_min >= 0)
+    if (_lut_is_positive(param))
     {
         status = vsi_nn_kernel_lut_positive(index_lut, output_lut, param);
     }
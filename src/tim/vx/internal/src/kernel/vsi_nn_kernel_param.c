@@ -26,6 +26,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <inttypes.h>
 #include "vsi_nn_prv.h"
 #include "vsi_nn_types.h"
 #include "vsi_nn_graph.h"
@@ -236,3 +238,83 @@ void vsi_nn_kernel_param_clear( vsi_nn_kernel_param_t * params )
         vsi_nn_hashmap_clear( hashmap );
     }
 } /* vsi_nn_kernel_param_clear() */
+
+static uint32_t _param_hash_buffer
+    (
+    const void * data,
+    size_t size
+    )
+{
+    const uint8_t * ptr = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for( i = 0; ptr && i < size; i ++ )
+    {
+        hash = ( hash ^ ptr[i] ) * 16777619u;
+    }
+    return hash;
+} /* _param_hash_buffer() */
+
+vsi_bool vsi_nn_kernel_param_to_str
+    (
+    const vsi_nn_kernel_param_t * params,
+    char * buf,
+    size_t buf_size
+    )
+{
+    vsi_nn_hashmap_t* hashmap = (vsi_nn_hashmap_t*)(params);
+    vsi_nn_hashmap_item_t* item;
+    size_t len = 0;
+    int ret = 0;
+    CHECK_PARAM_NULL( buf, FALSE, "Buffer is null ptr." );
+    if( buf_size == 0 )
+    {
+        return FALSE;
+    }
+    buf[0] = '\0';
+    if( !params )
+    {
+        return TRUE;
+    }
+    item = vsi_nn_hashmap_iter( hashmap, NULL );
+    while( item )
+    {
+        _param_type* p = (_param_type*)item->data;
+        switch( p->type )
+        {
+        case _PARAM_I32:
+            ret = snprintf( &buf[len], buf_size - len, "%s=%d;",
+                item->hash_key, p->value.int32 );
+            break;
+        case _PARAM_I64:
+            ret = snprintf( &buf[len], buf_size - len, "%s=%"PRId64";",
+                item->hash_key, p->value.int64 );
+            break;
+        case _PARAM_F32:
+            ret = snprintf( &buf[len], buf_size - len, "%s=%.9g;",
+                item->hash_key, p->value.float32 );
+            break;
+        case _PARAM_STR:
+            ret = snprintf( &buf[len], buf_size - len, "%s=%s;",
+                item->hash_key, p->value.str ? p->value.str : "" );
+            break;
+        case _PARAM_BUFFER:
+        case _PARAM_CONST_BUFFER:
+            /* Buffers are keyed by size and content hash. */
+            ret = snprintf( &buf[len], buf_size - len, "%s=%u#%08x;",
+                item->hash_key, (uint32_t)p->size,
+                _param_hash_buffer( p->value.const_buffer, p->size ) );
+            break;
+        default:
+            ret = -1;
+            break;
+        }
+        if( ret < 0 || (size_t)ret >= buf_size - len )
+        {
+            return FALSE;
+        }
+        len += (size_t)ret;
+        item = vsi_nn_hashmap_iter( hashmap, item );
+    }
+    return TRUE;
+} /* vsi_nn_kernel_param_to_str() */
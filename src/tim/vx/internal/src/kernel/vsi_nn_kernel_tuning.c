@@ -0,0 +1,523 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+#include "vsi_nn_context.h"
+#include "vsi_nn_prv.h"
+#include "vsi_nn_types.h"
+#include "vsi_nn_graph.h"
+#include "vsi_nn_log.h"
+#include "vsi_nn_error.h"
+#include "vsi_nn_tensor_util.h"
+#include "utils/vsi_nn_util.h"
+#include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_tuning.h"
+
+#if (defined(__ANDROID__)) && (ANDROID_SDK_VERSION >= 30)
+static const char* ENV_KERNEL_TUNING_DB = "vendor.VSI_NN_KERNEL_TUNING_DB";
+#else
+static const char* ENV_KERNEL_TUNING_DB = "VSI_NN_KERNEL_TUNING_DB";
+#endif
+
+#define _DB_NIL     ((size_t)-1)
+
+typedef struct
+{
+    char * key;
+    uint32_t hash;
+    vsi_nn_kernel_type_e type;
+    /* Next record index in the same bucket, _DB_NIL ends the chain. */
+    size_t next;
+} _tuning_record_t;
+
+typedef struct
+{
+    _tuning_record_t * records;
+    size_t num;
+    size_t capacity;
+    /* Head record index of each chain, bucket_num is a power of two. */
+    size_t * buckets;
+    size_t bucket_num;
+    vsi_bool loaded;
+    vsi_bool configured;
+} _tuning_db_t;
+
+static _tuning_db_t _db = { NULL, 0, 0, NULL, 0, FALSE, FALSE };
+
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+static SRWLOCK _db_lock = SRWLOCK_INIT;
+#define _DB_LOCK()      AcquireSRWLockExclusive( &_db_lock )
+#define _DB_UNLOCK()    ReleaseSRWLockExclusive( &_db_lock )
+#else
+static pthread_mutex_t _db_lock = PTHREAD_MUTEX_INITIALIZER;
+#define _DB_LOCK()      pthread_mutex_lock( &_db_lock )
+#define _DB_UNLOCK()    pthread_mutex_unlock( &_db_lock )
+#endif
+
+static double _now_us( void )
+{
+#if (defined(_MSC_VER) || defined(_WIN32) || defined(__MINGW32))
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &count );
+    return (double)count.QuadPart * 1000000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec * 1000000.0 + (double)ts.tv_nsec / 1000.0;
+#endif
+} /* _now_us() */
+
+static uint32_t _hash_key
+    (
+    const char * key
+    )
+{
+    uint32_t hash = 2166136261u;
+    while( *key )
+    {
+        hash = ( hash ^ (uint8_t)(*key) ) * 16777619u;
+        key ++;
+    }
+    return hash;
+} /* _hash_key() */
+
+static _tuning_record_t * _db_find
+    (
+    const char * key
+    )
+{
+    uint32_t hash = _hash_key( key );
+    size_t i;
+    if( _db.bucket_num == 0 )
+    {
+        return NULL;
+    }
+    for( i = _db.buckets[hash & ( _db.bucket_num - 1 )]; i != _DB_NIL;
+        i = _db.records[i].next )
+    {
+        if( _db.records[i].hash == hash && strcmp( _db.records[i].key, key ) == 0 )
+        {
+            return &_db.records[i];
+        }
+    }
+    return NULL;
+} /* _db_find() */
+
+static vsi_bool _db_rehash
+    (
+    size_t bucket_num
+    )
+{
+    size_t * buckets;
+    size_t i;
+    buckets = (size_t *)malloc( bucket_num * sizeof(size_t) );
+    if( !buckets )
+    {
+        VSILOGE("Out of memory, grow kernel tuning db fail.");
+        return FALSE;
+    }
+    for( i = 0; i < bucket_num; i ++ )
+    {
+        buckets[i] = _DB_NIL;
+    }
+    for( i = 0; i < _db.num; i ++ )
+    {
+        size_t slot = _db.records[i].hash & ( bucket_num - 1 );
+        _db.records[i].next = buckets[slot];
+        buckets[slot] = i;
+    }
+    vsi_nn_safe_free( _db.buckets );
+    _db.buckets = buckets;
+    _db.bucket_num = bucket_num;
+    return TRUE;
+} /* _db_rehash() */
+
+static vsi_bool _db_insert
+    (
+    const char * key,
+    vsi_nn_kernel_type_e type
+    )
+{
+    _tuning_record_t * record = _db_find( key );
+    size_t len;
+    size_t slot;
+    if( record )
+    {
+        record->type = type;
+        return TRUE;
+    }
+    if( _db.num == _db.capacity )
+    {
+        size_t capacity = _db.capacity == 0 ? 64 : _db.capacity * 2;
+        _tuning_record_t * records = (_tuning_record_t *)realloc( _db.records,
+                capacity * sizeof(_tuning_record_t) );
+        if( !records )
+        {
+            VSILOGE("Out of memory, grow kernel tuning db fail.");
+            return FALSE;
+        }
+        _db.records = records;
+        _db.capacity = capacity;
+    }
+    /* Keep the load factor under one record per bucket. */
+    if( _db.num >= _db.bucket_num
+     && !_db_rehash( _db.bucket_num == 0 ? 64 : _db.bucket_num * 2 ) )
+    {
+        return FALSE;
+    }
+    len = strlen( key );
+    record = &_db.records[_db.num];
+    record->key = (char *)malloc( len + 1 );
+    if( !record->key )
+    {
+        VSILOGE("Out of memory, add kernel tuning record fail.");
+        return FALSE;
+    }
+    memcpy( record->key, key, len + 1 );
+    record->hash = _hash_key( key );
+    record->type = type;
+    slot = record->hash & ( _db.bucket_num - 1 );
+    record->next = _db.buckets[slot];
+    _db.buckets[slot] = _db.num;
+    _db.num ++;
+    return TRUE;
+} /* _db_insert() */
+
+static vsi_bool _type_from_str
+    (
+    const char * str,
+    vsi_nn_kernel_type_e * type
+    )
+{
+    int32_t i;
+    for( i = 0; i < VSI_NN_KERNEL_TYPE_NUM; i ++ )
+    {
+        if( strcmp( str, vsi_nn_kernel_type_str( (vsi_nn_kernel_type_e)i ) ) == 0 )
+        {
+            *type = (vsi_nn_kernel_type_e)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+} /* _type_from_str() */
+
+/*
+ * Database file is plain text, one "<kernel type>\t<key>" record per line.
+ * Later records override earlier ones, so updates are simply appended.
+ */
+static void _db_load( void )
+{
+    char * path;
+    FILE * fp;
+    char line[VSI_NN_KERNEL_TUNING_KEY_SIZE + 32];
+    size_t count = 0;
+
+    _db.loaded = TRUE;
+    path = vsi_nn_getenv( ENV_KERNEL_TUNING_DB );
+    if( !path || path[0] == '\0' )
+    {
+        return;
+    }
+    _db.configured = TRUE;
+    fp = vsi_nn_fopen( path, "r" );
+    if( !fp )
+    {
+        VSILOGD("Kernel tuning db %s not found.", path);
+        return;
+    }
+    while( fgets( line, sizeof(line), fp ) )
+    {
+        char * sep = strchr( line, '\t' );
+        char * end;
+        vsi_nn_kernel_type_e type;
+        if( !sep )
+        {
+            continue;
+        }
+        *sep = '\0';
+        end = sep + 1 + strcspn( sep + 1, "\r\n" );
+        *end = '\0';
+        if( _type_from_str( line, &type ) && _db_insert( sep + 1, type ) )
+        {
+            count ++;
+        }
+    }
+    fclose( fp );
+    VSILOGI("Load %d kernel tuning records from %s.", (int32_t)count, path);
+} /* _db_load() */
+
+vsi_bool vsi_nn_kernel_tuning_active
+    (
+    const vsi_nn_context_t ctx
+    )
+{
+    vsi_bool configured;
+    if( ctx && ctx->options.enable_kernel_tuning )
+    {
+        return TRUE;
+    }
+    _DB_LOCK();
+    if( !_db.loaded )
+    {
+        _db_load();
+    }
+    configured = _db.configured;
+    _DB_UNLOCK();
+    return configured;
+} /* vsi_nn_kernel_tuning_active() */
+
+vsi_bool vsi_nn_kernel_tuning_make_key
+    (
+    char * key,
+    size_t key_size,
+    const char * kernel_name,
+    vsi_nn_tensor_t ** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t ** outputs,
+    size_t output_num,
+    const vsi_nn_kernel_param_t * params
+    )
+{
+    size_t len = 0;
+    size_t i;
+    uint32_t j;
+    int ret;
+
+    ret = snprintf( key, key_size, "%s|", kernel_name );
+    if( ret < 0 || (size_t)ret >= key_size )
+    {
+        return FALSE;
+    }
+    len = (size_t)ret;
+    for( i = 0; i < input_num + output_num; i ++ )
+    {
+        vsi_nn_tensor_t * t = i < input_num ? inputs[i] : outputs[i - input_num];
+        if( !t )
+        {
+            ret = snprintf( &key[len], key_size - len, "-|" );
+        }
+        else
+        {
+            for( j = 0; j < t->attr.dim_num; j ++ )
+            {
+                ret = snprintf( &key[len], key_size - len, "%"VSI_SIZE_T_SPECIFIER",",
+                        t->attr.size[j] );
+                if( ret < 0 || (size_t)ret >= key_size - len )
+                {
+                    return FALSE;
+                }
+                len += (size_t)ret;
+            }
+            ret = snprintf( &key[len], key_size - len, ":%d:%d%s|",
+                    t->attr.dtype.vx_type, t->attr.dtype.qnt_type,
+                    t->attr.is_const ? ":c" : "" );
+        }
+        if( ret < 0 || (size_t)ret >= key_size - len )
+        {
+            return FALSE;
+        }
+        len += (size_t)ret;
+    }
+    return vsi_nn_kernel_param_to_str( params, &key[len], key_size - len );
+} /* vsi_nn_kernel_tuning_make_key() */
+
+vsi_bool vsi_nn_kernel_tuning_query
+    (
+    const char * key,
+    vsi_nn_kernel_type_e * type
+    )
+{
+    _tuning_record_t * record;
+    vsi_bool ret = FALSE;
+    _DB_LOCK();
+    if( !_db.loaded )
+    {
+        _db_load();
+    }
+    record = _db_find( key );
+    if( record )
+    {
+        *type = record->type;
+        ret = TRUE;
+    }
+    _DB_UNLOCK();
+    return ret;
+} /* vsi_nn_kernel_tuning_query() */
+
+void vsi_nn_kernel_tuning_update
+    (
+    const char * key,
+    vsi_nn_kernel_type_e type
+    )
+{
+    char * path;
+    FILE * fp;
+    _DB_LOCK();
+    if( !_db.loaded )
+    {
+        _db_load();
+    }
+    _db_insert( key, type );
+    path = vsi_nn_getenv( ENV_KERNEL_TUNING_DB );
+    if( path && path[0] != '\0' )
+    {
+        fp = vsi_nn_fopen( path, "a" );
+        if( fp )
+        {
+            fprintf( fp, "%s\t%s\n", vsi_nn_kernel_type_str( type ), key );
+            fclose( fp );
+        }
+        else
+        {
+            VSILOGW("Open kernel tuning db %s fail.", path);
+        }
+    }
+    _DB_UNLOCK();
+} /* vsi_nn_kernel_tuning_update() */
+
+vsi_bool vsi_nn_kernel_tuning_reorder
+    (
+    const char * key,
+    vsi_nn_kernel_selector_t * selector
+    )
+{
+    vsi_nn_kernel_type_e best = VSI_NN_KERNEL_TYPE_NONE;
+    vsi_nn_kernel_pirority_t head;
+    int32_t i;
+
+    if( !vsi_nn_kernel_tuning_query( key, &best ) )
+    {
+        return FALSE;
+    }
+    for( i = 0; i < selector->allow_kernel_num; i ++ )
+    {
+        if( selector->pirority[i].kernel_type == best )
+        {
+            head = selector->pirority[i];
+            for( ; i > 0; i -- )
+            {
+                selector->pirority[i] = selector->pirority[i - 1];
+            }
+            selector->pirority[0] = head;
+            break;
+        }
+    }
+    return TRUE;
+} /* vsi_nn_kernel_tuning_reorder() */
+
+static vsi_nn_tensor_t * _clone_tensor
+    (
+    vsi_nn_graph_t * src_graph,
+    vsi_nn_graph_t * graph,
+    vsi_nn_tensor_t * src
+    )
+{
+    vsi_nn_tensor_attr_t attr;
+    vsi_nn_tensor_id_t id;
+    uint8_t * data = NULL;
+
+    memcpy( &attr, &src->attr, sizeof(vsi_nn_tensor_attr_t) );
+    attr.vtl = FALSE;
+    if( attr.is_const )
+    {
+        data = vsi_nn_ConvertTensorToData( src_graph, src );
+    }
+    id = vsi_nn_AddTensor( graph, VSI_NN_TENSOR_ID_AUTO, &attr, data );
+    vsi_nn_safe_free( data );
+    return vsi_nn_GetTensor( graph, id );
+} /* _clone_tensor() */
+
+double vsi_nn_kernel_tuning_measure
+    (
+    vsi_nn_graph_t * graph,
+    vsi_nn_kernel_setup_func_t setup,
+    vsi_nn_kernel_t * kernel,
+    vsi_nn_tensor_t ** inputs,
+    size_t input_num,
+    vsi_nn_tensor_t ** outputs,
+    size_t output_num,
+    const vsi_nn_kernel_param_t * params
+    )
+{
+    vsi_nn_graph_t * scratch = NULL;
+    vsi_nn_tensor_t ** tensors = NULL;
+    vsi_nn_kernel_node_t node = NULL;
+    vsi_status status = VSI_FAILURE;
+    double elapsed = -1.0;
+    double start;
+    size_t i;
+    int32_t run;
+
+    scratch = vsi_nn_CreateGraph( graph->ctx,
+            (uint32_t)(input_num + output_num), 1 );
+    CHECK_PTR_FAIL_GOTO( scratch, "Create scratch graph fail.", final );
+    tensors = (vsi_nn_tensor_t **)calloc( input_num + output_num,
+            sizeof(vsi_nn_tensor_t *) );
+    CHECK_PTR_FAIL_GOTO( tensors, "Out of memory.", final );
+    for( i = 0; i < input_num + output_num; i ++ )
+    {
+        vsi_nn_tensor_t * src = i < input_num ? inputs[i] : outputs[i - input_num];
+        if( src )
+        {
+            tensors[i] = _clone_tensor( graph, scratch, src );
+            CHECK_PTR_FAIL_GOTO( tensors[i], "Create scratch tensor fail.", final );
+        }
+    }
+
+    node = setup( scratch, tensors, input_num,
+            &tensors[input_num], output_num, params, kernel );
+    if( !node )
+    {
+        goto final;
+    }
+    status = vxVerifyGraph( scratch->g );
+    CHECK_STATUS_FAIL_GOTO( status, final );
+    /* Warm up, the first run may include kernel compilation. */
+    status = vxProcessGraph( scratch->g );
+    CHECK_STATUS_FAIL_GOTO( status, final );
+
+    start = _now_us();
+    for( run = 0; run < VSI_NN_KERNEL_TUNING_RUNS; run ++ )
+    {
+        status = vxProcessGraph( scratch->g );
+        CHECK_STATUS_FAIL_GOTO( status, final );
+    }
+    elapsed = ( _now_us() - start ) / VSI_NN_KERNEL_TUNING_RUNS;
+
+final:
+    vsi_nn_kernel_node_release( &node );
+    vsi_nn_safe_free( tensors );
+    vsi_nn_ReleaseGraph( &scratch );
+    return elapsed;
+} /* vsi_nn_kernel_tuning_measure() */
@@ -36,6 +36,7 @@
 #include "vsi_nn_log.h"
 #include "utils/vsi_nn_dtype_util.h"
 #include "utils/vsi_nn_constraint_check.h"
+#include "utils/vsi_nn_const_pipeline.h"
 
 #define LOCAL() (local)
 
@@ -394,6 +395,31 @@ static vsi_bool op_check
     return ret;
 } /* op_check() */
 
+static vsi_status _add_permute
+    (
+    vsi_nn_const_pipeline_t * pipeline,
+    vsi_nn_tensor_t * weight,
+    vsi_size_t * perm,
+    vsi_size_t dim_num,
+    vsi_bool permute_shape
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    vsi_nn_const_permute_param_t param;
+
+    memset( &param, 0, sizeof(param) );
+    memcpy( param.perm, perm, dim_num * sizeof(vsi_size_t) );
+    param.dim_num = dim_num;
+    status = vsi_nn_const_pipeline_add( pipeline, weight,
+        permute_shape ? vsi_nn_const_transform_permute : vsi_nn_const_transform_transpose,
+        &param, sizeof(param) );
+    if( VSI_SUCCESS != status )
+    {
+        VSILOGE( "Queue weight permute fail." );
+    }
+    return status;
+} /* _add_permute() */
+
 static vsi_bool op_setup
     (
     vsi_nn_node_t * self,
@@ -402,9 +428,18 @@ static vsi_bool op_setup
     )
 {
     vsi_nn_deconv_param *nn_param;
+    vsi_nn_const_pipeline_t *pipeline = NULL;
+    vsi_status status = VSI_SUCCESS;
     vsi_size_t perm[] = { 3, 2, 0, 1 };
     vsi_size_t perm1[] = { 0, 1, 3, 2 };
 
+    /* Weight rewrites are chained and applied in one pass over the data */
+    pipeline = vsi_nn_const_pipeline_create( self->graph );
+    if( NULL == pipeline )
+    {
+        return FALSE;
+    }
+
     /* TODO: Driver should handle this,
     * Check transpose
     * TODO: remove this
@@ -413,7 +448,14 @@ static vsi_bool op_setup
     {
         if (!((vsi_nn_tensor_prv_t*)inputs[1])->processed)
         {
-            vsi_nn_TransposeTensor(self->graph, inputs[1], perm, 4, NULL);
+            if (TRUE == inputs[1]->attr.is_const)
+            {
+                status = _add_permute( pipeline, inputs[1], perm, 4, FALSE );
+            }
+            else
+            {
+                vsi_nn_TransposeTensor(self->graph, inputs[1], perm, 4, NULL);
+            }
             inputs[1]->attr.dtype.fmt = VSI_NN_DIM_FMT_NCHW;
         }
     }
@@ -426,30 +468,49 @@ static vsi_bool op_setup
 #endif
 
 #ifdef VX_DECONVOLUTION_WEIGHT_LAYOUT_COMPATIBLE_KHRONOS
-    if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) == -1 && TRUE == inputs[1]->attr.is_const)
+    if ( VSI_SUCCESS == status &&
+         vsi_nn_compareVersion(self->graph, 1, 1, 21) == -1 && TRUE == inputs[1]->attr.is_const)
     {
         if (!((vsi_nn_tensor_prv_t*)inputs[1])->processed) {
             /* whnc->whcn */
-            vsi_nn_PermuteTensor(self->graph, inputs[1], perm1, 4);
+            status = _add_permute( pipeline, inputs[1], perm1, 4, TRUE );
         }
     }
     /* Rotate 180 degrees for weights data */
-    if (TRUE == inputs[1]->attr.is_const)
+    if (VSI_SUCCESS == status && TRUE == inputs[1]->attr.is_const)
     {
         if (!((vsi_nn_tensor_prv_t*)inputs[1])->processed) {
-            vsi_nn_reshuffle_weight_data(self->graph, inputs[1]);
+            status = vsi_nn_const_pipeline_add( pipeline, inputs[1],
+                vsi_nn_const_transform_rotate_180, NULL, 0 );
+            if( VSI_SUCCESS != status )
+            {
+                VSILOGE( "Queue weight rotate fail." );
+            }
         }
     }
 #else
-    if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) >= 0 && TRUE == inputs[1]->attr.is_const)
+    if ( VSI_SUCCESS == status &&
+         vsi_nn_compareVersion(self->graph, 1, 1, 21) >= 0 && TRUE == inputs[1]->attr.is_const)
     {
         /* whcn->whnc */
         if (!((vsi_nn_tensor_prv_t*)inputs[1])->processed) {
-            vsi_nn_PermuteTensor(self->graph, inputs[1], perm1, 4);
+            status = _add_permute( pipeline, inputs[1], perm1, 4, TRUE );
         }
     }
 #endif
 
+    /* Nothing is written unless every rewrite was queued */
+    if( VSI_SUCCESS == status )
+    {
+        status = vsi_nn_const_pipeline_run( pipeline, NULL );
+    }
+    vsi_nn_const_pipeline_release( &pipeline );
+    if( VSI_SUCCESS != status )
+    {
+        VSILOGE( "Process deconvolution weight fail." );
+        return FALSE;
+    }
+
     ((vsi_nn_tensor_prv_t*)inputs[1])->processed = TRUE;
 
     nn_param = &self->nn_param.deconv;
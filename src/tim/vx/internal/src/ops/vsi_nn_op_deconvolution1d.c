@@ -36,6 +36,7 @@
 #include "utils/vsi_nn_dtype_util.h"
 #include "kernel/vsi_nn_kernel.h"
 #include "vsi_nn_error.h"
+#include "utils/vsi_nn_const_pipeline.h"
 
 #define COMPUTE_DECONV_SZ( in, ksize, pad_1, pad_2, stride, output_padding )\
     (( in - 1 ) * stride + ksize - pad_1 - pad_2 + output_padding)
@@ -83,25 +84,46 @@ static vsi_status op_compute
         CHECK_PTR_FAIL_GOTO( weight_tensor, "create tensor fail.", final );
     }
 
-#ifdef VX_DECONVOLUTION_WEIGHT_LAYOUT_COMPATIBLE_KHRONOS
-    if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) == -1 && TRUE == weight_tensor->attr.is_const )
-    {
-        /* whnc->whcn */
-        vsi_nn_PermuteTensor( self->graph, weight_tensor, perm, 4 );
-    }
-
-    /* Rotate 180 degrees for weights data */
     if ( TRUE == weight_tensor->attr.is_const )
     {
-        vsi_nn_reshuffle_weight_data( self->graph, weight_tensor );
-    }
+        /* Weight rewrites are chained and applied in one pass over the data */
+        vsi_nn_const_permute_param_t permute_param;
+        vsi_nn_const_pipeline_t * pipeline = vsi_nn_const_pipeline_create( self->graph );
+        CHECK_PTR_FAIL_GOTO( pipeline, "Create const pipeline fail.", final );
+
+        memset( &permute_param, 0, sizeof(permute_param) );
+        memcpy( permute_param.perm, perm, sizeof(perm) );
+        permute_param.dim_num = 4;
+        status = VSI_SUCCESS;
+#ifdef VX_DECONVOLUTION_WEIGHT_LAYOUT_COMPATIBLE_KHRONOS
+        if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) == -1 )
+        {
+            /* whnc->whcn */
+            status = vsi_nn_const_pipeline_add( pipeline, weight_tensor,
+                vsi_nn_const_transform_permute, &permute_param, sizeof(permute_param) );
+        }
+
+        /* Rotate 180 degrees for weights data */
+        if ( VSI_SUCCESS == status )
+        {
+            status = vsi_nn_const_pipeline_add( pipeline, weight_tensor,
+                vsi_nn_const_transform_rotate_180, NULL, 0 );
+        }
 #else
-    if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) >= 0 && TRUE == weight_tensor->attr.is_const)
-    {
-        /* whcn->whnc */
-        vsi_nn_PermuteTensor( self->graph, weight_tensor, perm, 4 );
-    }
+        if ( vsi_nn_compareVersion(self->graph, 1, 1, 21) >= 0 )
+        {
+            /* whcn->whnc */
+            status = vsi_nn_const_pipeline_add( pipeline, weight_tensor,
+                vsi_nn_const_transform_permute, &permute_param, sizeof(permute_param) );
+        }
 #endif
+        if ( VSI_SUCCESS == status )
+        {
+            status = vsi_nn_const_pipeline_run( pipeline, NULL );
+        }
+        vsi_nn_const_pipeline_release( &pipeline );
+        CHECK_STATUS_FAIL_GOTO( status, final );
+    }
 
 #ifdef VX_DECONVOLUTION_WEIGHT_LAYOUT_COMPATIBLE_KHRONOS
     if (FALSE == inputs[1]->attr.is_const)
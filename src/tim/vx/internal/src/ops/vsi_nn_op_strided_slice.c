@@ -197,9 +197,14 @@ static vsi_bool _check_is_same_shape(
     vsi_ssize_t i = 0;
     vsi_ssize_t dims = (vsi_ssize_t)inputs[0]->attr.dim_num;
 
+    /*
+        The slice is a contiguous block of the input if every dimension below
+        the highest one that selects more than one element is taken whole,
+        e.g. one batch of a split or a range of rows within one batch.
+    */
     for (i = dims - 1; i >= 0; i --)
     {
-        if (inputs[0]->attr.size[i] == 1)
+        if (inputs[0]->attr.size[i] == 1 || stop[i] - start[i] == 1)
         {
             dims --;
             continue;
@@ -208,6 +213,11 @@ static vsi_bool _check_is_same_shape(
             break;
     }
 
+    if (dims == 0)
+    {
+        return TRUE;
+    }
+
     for (i = 0; i < dims - 1; i++)
     {
         if (stride[i] != 1 || start[i] != 0 || stop[i] != (vsi_ssize_t)inputs[0]->attr.size[i])
@@ -0,0 +1,537 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "vsi_nn_types.h"
+#include "vsi_nn_log.h"
+#include "vsi_nn_error.h"
+#include "utils/vsi_nn_math.h"
+#include "utils/vsi_nn_util.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
+#include "post/vsi_nn_post_detection.h"
+
+typedef struct
+{
+    float score;
+    uint32_t index;
+} _score_index_t;
+
+/* Descending score, ascending index on ties. */
+static VSI_INLINE_API vsi_bool _ranks_before
+    (
+    const _score_index_t * a,
+    const _score_index_t * b
+    )
+{
+    return a->score > b->score || (a->score == b->score && a->index < b->index);
+} /* _ranks_before() */
+
+static int _compare_score_index
+    (
+    const void * a,
+    const void * b
+    )
+{
+    const _score_index_t * sa = (const _score_index_t *)a;
+    const _score_index_t * sb = (const _score_index_t *)b;
+
+    if ( _ranks_before( sa, sb ) )
+    {
+        return -1;
+    }
+    return _ranks_before( sb, sa ) ? 1 : 0;
+} /* _compare_score_index() */
+
+static VSI_INLINE_API void _swap_score_index
+    (
+    _score_index_t * a,
+    _score_index_t * b
+    )
+{
+    _score_index_t t = *a;
+    *a = *b;
+    *b = t;
+} /* _swap_score_index() */
+
+/*
+ * Partition data so the k best entries come first, in any order.
+ * Quickselect with a median of three pivot.
+ */
+static void _select_topk
+    (
+    _score_index_t * data,
+    uint32_t num,
+    uint32_t k
+    )
+{
+    uint32_t lo = 0;
+    uint32_t hi = num - 1;
+
+    while ( lo < hi )
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t i = lo;
+        uint32_t j = 0;
+        _score_index_t pivot;
+
+        if ( _ranks_before( &data[mid], &data[lo] ) )
+        {
+            _swap_score_index( &data[mid], &data[lo] );
+        }
+        if ( _ranks_before( &data[hi], &data[lo] ) )
+        {
+            _swap_score_index( &data[hi], &data[lo] );
+        }
+        if ( _ranks_before( &data[hi], &data[mid] ) )
+        {
+            _swap_score_index( &data[hi], &data[mid] );
+        }
+        pivot = data[mid];
+        _swap_score_index( &data[mid], &data[hi] );
+        for ( j = lo; j < hi; j++ )
+        {
+            if ( _ranks_before( &data[j], &pivot ) )
+            {
+                _swap_score_index( &data[i], &data[j] );
+                i++;
+            }
+        }
+        _swap_score_index( &data[i], &data[hi] );
+
+        if ( i == k || i + 1 == k )
+        {
+            return;
+        }
+        else if ( i > k )
+        {
+            hi = i - 1;
+        }
+        else
+        {
+            lo = i + 1;
+        }
+    }
+} /* _select_topk() */
+
+vsi_nn_detection_boxes_t * vsi_nn_detection_boxes_create
+    (
+    uint32_t capacity
+    )
+{
+    vsi_nn_detection_boxes_t * boxes = NULL;
+    size_t lane = vsi_nn_max( (size_t)capacity, (size_t)1 );
+    uint8_t * buffer = NULL;
+
+    boxes = (vsi_nn_detection_boxes_t *)calloc( 1, sizeof(vsi_nn_detection_boxes_t) );
+    CHECK_PTR_FAIL_GOTO( boxes, "Create buffer fail.", final );
+    buffer = (uint8_t *)malloc( lane * (6 * sizeof(float) + sizeof(int32_t)) );
+    if ( NULL == buffer )
+    {
+        VSILOGE( "Create buffer fail." );
+        vsi_nn_safe_free( boxes );
+        goto final;
+    }
+    boxes->x1 = (float *)buffer;
+    boxes->y1 = boxes->x1 + lane;
+    boxes->x2 = boxes->y1 + lane;
+    boxes->y2 = boxes->x2 + lane;
+    boxes->score = boxes->y2 + lane;
+    boxes->area = boxes->score + lane;
+    boxes->class_id = (int32_t *)(boxes->area + lane);
+    boxes->capacity = capacity;
+
+final:
+    return boxes;
+} /* vsi_nn_detection_boxes_create() */
+
+void vsi_nn_detection_boxes_release
+    (
+    vsi_nn_detection_boxes_t ** boxes
+    )
+{
+    if ( boxes && *boxes )
+    {
+        free( (*boxes)->x1 );
+        free( *boxes );
+        *boxes = NULL;
+    }
+} /* vsi_nn_detection_boxes_release() */
+
+vsi_bool vsi_nn_detection_boxes_push
+    (
+    vsi_nn_detection_boxes_t * boxes,
+    float x1,
+    float y1,
+    float x2,
+    float y2,
+    float score,
+    int32_t class_id
+    )
+{
+    uint32_t n = 0;
+
+    if ( boxes->num >= boxes->capacity )
+    {
+        return FALSE;
+    }
+    n = boxes->num ++;
+    boxes->x1[n] = x1;
+    boxes->y1[n] = y1;
+    boxes->x2[n] = x2;
+    boxes->y2[n] = y2;
+    boxes->score[n] = score;
+    boxes->class_id[n] = class_id;
+    return TRUE;
+} /* vsi_nn_detection_boxes_push() */
+
+void vsi_nn_detection_boxes_gather
+    (
+    const vsi_nn_detection_boxes_t * src,
+    const uint32_t * order,
+    uint32_t num,
+    vsi_nn_detection_boxes_t * dst
+    )
+{
+    uint32_t i = 0;
+
+    for ( i = 0; i < num; i++ )
+    {
+        uint32_t s = order[i];
+        dst->x1[i] = src->x1[s];
+        dst->y1[i] = src->y1[s];
+        dst->x2[i] = src->x2[s];
+        dst->y2[i] = src->y2[s];
+        dst->score[i] = src->score[s];
+        dst->class_id[i] = src->class_id[s];
+    }
+    dst->num = num;
+} /* vsi_nn_detection_boxes_gather() */
+
+uint32_t vsi_nn_detection_topk
+    (
+    const float * score,
+    uint32_t num,
+    uint32_t stride,
+    float threshold,
+    uint32_t k,
+    uint32_t * index
+    )
+{
+    _score_index_t * candidates = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    if ( num == 0 )
+    {
+        return 0;
+    }
+    candidates = (_score_index_t *)malloc( sizeof(_score_index_t) * num );
+    CHECK_PTR_FAIL_GOTO( candidates, "Create buffer fail.", final );
+
+    for ( i = 0; i < num; i++ )
+    {
+        float s = score[(size_t)i * stride];
+        if ( s > threshold )
+        {
+            candidates[count].score = s;
+            candidates[count].index = i;
+            count ++;
+        }
+    }
+
+    if ( k > 0 && count > k )
+    {
+        _select_topk( candidates, count, k );
+        count = k;
+    }
+    qsort( candidates, count, sizeof(_score_index_t), _compare_score_index );
+    for ( i = 0; i < count; i++ )
+    {
+        index[i] = candidates[i].index;
+    }
+
+final:
+    vsi_nn_safe_free( candidates );
+    return count;
+} /* vsi_nn_detection_topk() */
+
+uint32_t vsi_nn_detection_nms
+    (
+    vsi_nn_detection_boxes_t * boxes,
+    float iou_threshold,
+    float offset,
+    uint32_t max_keep,
+    uint32_t * keep
+    )
+{
+    uint8_t * dead = NULL;
+    uint32_t num = boxes->num;
+    uint32_t kept = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    vsi_nn_cpu_f32x4_t v_zero = vsi_nn_cpu_f32x4_set1( 0.0f );
+    vsi_nn_cpu_f32x4_t v_offset = vsi_nn_cpu_f32x4_set1( offset );
+    vsi_nn_cpu_f32x4_t v_thresh = vsi_nn_cpu_f32x4_set1( iou_threshold );
+
+    if ( num == 0 )
+    {
+        return 0;
+    }
+    dead = (uint8_t *)calloc( num, sizeof(uint8_t) );
+    CHECK_PTR_FAIL_GOTO( dead, "Create buffer fail.", final );
+
+    for ( i = 0; i < num; i++ )
+    {
+        boxes->area[i] = (boxes->x2[i] - boxes->x1[i] + offset)
+            * (boxes->y2[i] - boxes->y1[i] + offset);
+    }
+
+    for ( i = 0; i < num; i++ )
+    {
+        vsi_nn_cpu_f32x4_t bx1, by1, bx2, by2, barea;
+
+        if ( dead[i] )
+        {
+            continue;
+        }
+        keep[kept ++] = i;
+        if ( max_keep > 0 && kept >= max_keep )
+        {
+            break;
+        }
+
+        bx1 = vsi_nn_cpu_f32x4_set1( boxes->x1[i] );
+        by1 = vsi_nn_cpu_f32x4_set1( boxes->y1[i] );
+        bx2 = vsi_nn_cpu_f32x4_set1( boxes->x2[i] );
+        by2 = vsi_nn_cpu_f32x4_set1( boxes->y2[i] );
+        barea = vsi_nn_cpu_f32x4_set1( boxes->area[i] );
+        for ( j = i + 1; j + 4 <= num; j += 4 )
+        {
+            float inter[4];
+            float bound[4];
+            uint32_t l = 0;
+            vsi_nn_cpu_f32x4_t w, h, vi, vu;
+
+            w = vsi_nn_cpu_f32x4_sub(
+                vsi_nn_cpu_f32x4_min( bx2, vsi_nn_cpu_f32x4_load( boxes->x2 + j ) ),
+                vsi_nn_cpu_f32x4_max( bx1, vsi_nn_cpu_f32x4_load( boxes->x1 + j ) ) );
+            h = vsi_nn_cpu_f32x4_sub(
+                vsi_nn_cpu_f32x4_min( by2, vsi_nn_cpu_f32x4_load( boxes->y2 + j ) ),
+                vsi_nn_cpu_f32x4_max( by1, vsi_nn_cpu_f32x4_load( boxes->y1 + j ) ) );
+            w = vsi_nn_cpu_f32x4_max( v_zero, vsi_nn_cpu_f32x4_add( w, v_offset ) );
+            h = vsi_nn_cpu_f32x4_max( v_zero, vsi_nn_cpu_f32x4_add( h, v_offset ) );
+            vi = vsi_nn_cpu_f32x4_mul( w, h );
+            vu = vsi_nn_cpu_f32x4_sub(
+                vsi_nn_cpu_f32x4_add( barea, vsi_nn_cpu_f32x4_load( boxes->area + j ) ), vi );
+            vsi_nn_cpu_f32x4_store( inter, vi );
+            vsi_nn_cpu_f32x4_store( bound, vsi_nn_cpu_f32x4_mul( v_thresh, vu ) );
+            for ( l = 0; l < 4; l++ )
+            {
+                /* iou > thresh, without the division */
+                dead[j + l] |= (uint8_t)(inter[l] > 0.0f && inter[l] > bound[l]);
+            }
+        }
+        for ( ; j < num; j++ )
+        {
+            float w = vsi_nn_min( boxes->x2[i], boxes->x2[j] )
+                - vsi_nn_max( boxes->x1[i], boxes->x1[j] ) + offset;
+            float h = vsi_nn_min( boxes->y2[i], boxes->y2[j] )
+                - vsi_nn_max( boxes->y1[i], boxes->y1[j] ) + offset;
+            float inter = vsi_nn_max( 0.0f, w ) * vsi_nn_max( 0.0f, h );
+            float uni = boxes->area[i] + boxes->area[j] - inter;
+            dead[j] |= (uint8_t)(inter > 0.0f && inter > iou_threshold * uni);
+        }
+    }
+
+final:
+    vsi_nn_safe_free( dead );
+    return kept;
+} /* vsi_nn_detection_nms() */
+
+vsi_status vsi_nn_detection_multiclass_nms
+    (
+    const vsi_nn_detection_boxes_t * boxes,
+    vsi_bool box_per_class,
+    const float * score,
+    uint32_t class_num,
+    uint32_t class_start,
+    float score_threshold,
+    float iou_threshold,
+    float offset,
+    uint32_t max_per_class,
+    uint32_t max_total,
+    vsi_nn_detection_boxes_t * out
+    )
+{
+    uint32_t num = box_per_class ? boxes->num / vsi_nn_max( class_num, 1 ) : boxes->num;
+    uint32_t * order = NULL;
+    uint32_t * keep = NULL;
+    uint32_t * merged_order = NULL;
+    vsi_nn_detection_boxes_t * sorted = NULL;
+    vsi_nn_detection_boxes_t * merged = NULL;
+    uint32_t c = 0;
+    uint32_t i = 0;
+    uint32_t count = 0;
+    vsi_status status = VSI_FAILURE;
+
+    out->num = 0;
+    if ( num == 0 || class_num <= class_start )
+    {
+        return VSI_SUCCESS;
+    }
+    order = (uint32_t *)malloc( sizeof(uint32_t) * num );
+    CHECK_PTR_FAIL_GOTO( order, "Create buffer fail.", final );
+    keep = (uint32_t *)malloc( sizeof(uint32_t) * num );
+    CHECK_PTR_FAIL_GOTO( keep, "Create buffer fail.", final );
+    sorted = vsi_nn_detection_boxes_create( num );
+    CHECK_PTR_FAIL_GOTO( sorted, "Create buffer fail.", final );
+    merged = vsi_nn_detection_boxes_create( (class_num - class_start)
+        * (max_per_class > 0 ? vsi_nn_min( max_per_class, num ) : num) );
+    CHECK_PTR_FAIL_GOTO( merged, "Create buffer fail.", final );
+
+    for ( c = class_start; c < class_num; c++ )
+    {
+        uint32_t selected = vsi_nn_detection_topk( score + c, num, class_num,
+            score_threshold, 0, order );
+        uint32_t kept = 0;
+
+        for ( i = 0; i < selected; i++ )
+        {
+            uint32_t s = box_per_class ? order[i] * class_num + c : order[i];
+            sorted->x1[i] = boxes->x1[s];
+            sorted->y1[i] = boxes->y1[s];
+            sorted->x2[i] = boxes->x2[s];
+            sorted->y2[i] = boxes->y2[s];
+            sorted->score[i] = score[(size_t)order[i] * class_num + c];
+            sorted->class_id[i] = (int32_t)c;
+        }
+        sorted->num = selected;
+
+        kept = vsi_nn_detection_nms( sorted, iou_threshold, offset, max_per_class, keep );
+        /* NMS keeps at least the best box, nothing kept means it failed. */
+        if ( selected > 0 && kept == 0 )
+        {
+            VSILOGE("NMS of class %u fail.", c);
+            goto final;
+        }
+        for ( i = 0; i < kept; i++ )
+        {
+            uint32_t k = keep[i];
+            vsi_nn_detection_boxes_push( merged, sorted->x1[k], sorted->y1[k],
+                sorted->x2[k], sorted->y2[k], sorted->score[k], sorted->class_id[k] );
+        }
+    }
+
+    /* Merge all classes by score, capped by max_total and out capacity. */
+    if ( max_total == 0 || max_total > out->capacity )
+    {
+        max_total = out->capacity;
+    }
+    merged_order = (uint32_t *)malloc( sizeof(uint32_t) * vsi_nn_max( merged->num, 1 ) );
+    CHECK_PTR_FAIL_GOTO( merged_order, "Create buffer fail.", final );
+    count = vsi_nn_detection_topk( merged->score, merged->num, 1, -FLT_MAX,
+        max_total, merged_order );
+    vsi_nn_detection_boxes_gather( merged, merged_order, count, out );
+    status = VSI_SUCCESS;
+
+final:
+    vsi_nn_safe_free( order );
+    vsi_nn_safe_free( keep );
+    vsi_nn_safe_free( merged_order );
+    vsi_nn_detection_boxes_release( &sorted );
+    vsi_nn_detection_boxes_release( &merged );
+    return status;
+} /* vsi_nn_detection_multiclass_nms() */
+
+void vsi_nn_detection_decode_center_size
+    (
+    const float * deltas,
+    const float * anchors,
+    uint32_t num,
+    const vsi_nn_detection_box_coder_t * coder,
+    vsi_nn_detection_boxes_t * boxes
+    )
+{
+    uint32_t i = 0;
+
+    num = vsi_nn_min( num, boxes->capacity );
+    for ( i = 0; i < num; i++ )
+    {
+        const float * d = deltas + (size_t)i * 4;
+        const float * a = anchors + (size_t)i * 4;
+        float yc = d[0] / coder->y_scale * a[2] + a[0];
+        float xc = d[1] / coder->x_scale * a[3] + a[1];
+        float half_h = 0.5f * expf( d[2] / coder->h_scale ) * a[2];
+        float half_w = 0.5f * expf( d[3] / coder->w_scale ) * a[3];
+
+        boxes->x1[i] = xc - half_w;
+        boxes->y1[i] = yc - half_h;
+        boxes->x2[i] = xc + half_w;
+        boxes->y2[i] = yc + half_h;
+        boxes->score[i] = 0.0f;
+        boxes->class_id[i] = -1;
+    }
+    boxes->num = num;
+} /* vsi_nn_detection_decode_center_size() */
+
+void vsi_nn_detection_decode_roi
+    (
+    const float * roi,
+    uint32_t roi_stride,
+    const float * delta,
+    uint32_t delta_stride,
+    uint32_t num,
+    float width,
+    float height,
+    vsi_nn_detection_boxes_t * boxes
+    )
+{
+    uint32_t i = 0;
+
+    num = vsi_nn_min( num, boxes->capacity );
+    for ( i = 0; i < num; i++ )
+    {
+        const float * r = roi + (size_t)i * roi_stride;
+        const float * d = delta + (size_t)i * delta_stride;
+        float w = r[2] - r[0] + 1.0f;
+        float h = r[3] - r[1] + 1.0f;
+        float ctr_x = r[0] + 0.5f * w;
+        float ctr_y = r[1] + 0.5f * h;
+        float pred_ctr_x = d[0] * w + ctr_x;
+        float pred_ctr_y = d[1] * h + ctr_y;
+        float pred_w = expf( d[2] ) * w;
+        float pred_h = expf( d[3] ) * h;
+
+        boxes->x1[i] = vsi_nn_max( 0.0f, vsi_nn_min( pred_ctr_x - 0.5f * pred_w, width - 1.0f ) );
+        boxes->y1[i] = vsi_nn_max( 0.0f, vsi_nn_min( pred_ctr_y - 0.5f * pred_h, height - 1.0f ) );
+        boxes->x2[i] = vsi_nn_max( 0.0f, vsi_nn_min( pred_ctr_x + 0.5f * pred_w, width - 1.0f ) );
+        boxes->y2[i] = vsi_nn_max( 0.0f, vsi_nn_min( pred_ctr_y + 0.5f * pred_h, height - 1.0f ) );
+        boxes->score[i] = 0.0f;
+        boxes->class_id[i] = -1;
+    }
+    boxes->num = num;
+} /* vsi_nn_detection_decode_roi() */
@@ -37,6 +37,7 @@
 #include "utils/vsi_nn_dtype_util.h"
 #include "utils/vsi_nn_util.h"
 #include "post/vsi_nn_post_fasterrcnn.h"
+#include "post/vsi_nn_post_detection.h"
 #include "vsi_nn_error.h"
 
 /*
@@ -76,36 +77,6 @@ static vsi_status _unscale_roi
     vsi_nn_fasterrcnn_param_t *param
     );
 
-static vsi_status _bbox_transform_inv
-    (
-    float *rois,
-    float *bbox,
-    vsi_nn_fasterrcnn_param_t *param,
-    float **boxes
-    );
-
-static float detection_box_iou
-    (
-    float *A,
-    float *B
-    );
-
-static void detection_box_nms
-    (
-    float *box,
-    float thresh,
-    uint32_t rois_num,
-    uint32_t *keep,
-    uint32_t *num
-    );
-
-static void detection_box_qsort
-    (
-    float *box,
-    int32_t start,
-    int32_t end
-    );
-
 static void _init_box
     (
     vsi_nn_link_list_t *node
@@ -253,232 +224,6 @@ static vsi_status _unscale_roi
     return VSI_SUCCESS;
 }
 
-static vsi_status _bbox_transform_inv
-    (
-    float *rois,
-    float *bbox,
-    vsi_nn_fasterrcnn_param_t *param,
-    float **boxes
-    )
-{
-    float *pred_boxes = NULL, *ppred = NULL;
-    float *proi,*pbbox;
-    uint32_t i,j,rois_num,bbox_num,class_num;
-    float img_w,img_h;
-    vsi_status status = VSI_FAILURE;
-
-    float w,h,ctr_x,ctr_y;
-    float dx,dy,dw,dh;
-    float pred_ctr_x,pred_ctr_y,pred_w,pred_h;
-
-    img_w = param->iminfo.size[0];
-    img_h = param->iminfo.size[1];
-    rois_num = param->rois_num;
-    class_num = param->classes_num;
-    bbox_num = class_num * 4;
-    pred_boxes = (float *)malloc(sizeof(float) * rois_num * bbox_num);
-    CHECK_PTR_FAIL_GOTO( pred_boxes, "Create buffer fail.", final );
-    status = VSI_SUCCESS;
-
-    proi = rois;
-    pbbox = bbox;
-    ppred = pred_boxes;
-    for(i=0; i<rois_num; i++)
-    {
-        /* roi_data {0,x1,y1,x2,y2} */
-        w = proi[3] - proi[1] + 1.0f;
-        h = proi[4] - proi[2] + 1.0f;
-        ctr_x = proi[1] + 0.5f * w;
-        ctr_y = proi[2] + 0.5f * h;
-
-        /* bbox {rois_num,84} */
-        for(j=0; j<class_num; j++)
-        {
-            dx = pbbox[0];
-            dy = pbbox[1];
-            dw = pbbox[2];
-            dh = pbbox[3];
-
-            pred_ctr_x = dx * w + ctr_x;
-            pred_ctr_y = dy * h + ctr_y;
-            pred_w = expf(dw) * w;
-            pred_h = expf(dh) * h;
-
-            /* update upper-left corner location */
-            ppred[0] = pred_ctr_x - 0.5f * pred_w;
-            ppred[1] = pred_ctr_y - 0.5f * pred_h;
-
-            /* update lower-right corner location */
-            ppred[2] = pred_ctr_x + 0.5f * pred_w;
-            ppred[3] = pred_ctr_y + 0.5f * pred_h;
-
-            /* adjust new corner locations to be within the image region */
-            ppred[0] = vsi_nn_max(0.0f, vsi_nn_min(ppred[0], img_w - 1.0f));
-            ppred[1] = vsi_nn_max(0.0f, vsi_nn_min(ppred[1], img_h - 1.0f));
-            ppred[2] = vsi_nn_max(0.0f, vsi_nn_min(ppred[2], img_w - 1.0f));
-            ppred[3] = vsi_nn_max(0.0f, vsi_nn_min(ppred[3], img_h - 1.0f));
-
-            pbbox += 4;
-            ppred += 4;
-        }
-
-        proi += 5;
-    }
-
-    *boxes = pred_boxes;
-
-final:
-    return status;
-}
-
-static float detection_box_iou
-    (
-    float *A,
-    float *B
-    )
-{
-    float x1,y1,x2,y2,width,height,area,A_area,B_area;
-
-    if (A[0] > B[2] || A[1] > B[3] || A[2] < B[0] || A[3] < B[1])
-    {
-        return 0;
-    }
-
-    /* overlapped region (=box) */
-    x1 = vsi_nn_max(A[0], B[0]);
-    y1 = vsi_nn_max(A[1], B[1]);
-    x2 = vsi_nn_min(A[2], B[2]);
-    y2 = vsi_nn_min(A[3], B[3]);
-
-    /* intersection area */
-    width    = vsi_nn_max(0.0f, x2 - x1 + 1.0f);
-    height   = vsi_nn_max(0.0f, y2 - y1 + 1.0f);
-    area     = width * height;
-
-    /* area of A, B */
-    A_area   = (A[2] - A[0] + 1.0f) * (A[3] - A[1] + 1.0f);
-    B_area   = (B[2] - B[0] + 1.0f) * (B[3] - B[1] + 1.0f);
-
-    /* IOU */
-    return area / (A_area + B_area - area);
-}
-
-static void detection_box_nms
-    (
-    float *box,
-    float thresh,
-    uint32_t rois_num,
-    uint32_t *keep,
-    uint32_t *num
-    )
-{
-    uint32_t i,j;
-    uint32_t *is_dead = NULL;
-
-    is_dead = (uint32_t *)malloc(sizeof(uint32_t) * rois_num);
-    CHECK_PTR_FAIL_GOTO( is_dead, "Create buffer fail.", final );
-    memset(is_dead, 0, sizeof(uint32_t) * rois_num);
-
-    for(i = 0; i < rois_num; i++)
-    {
-        if(is_dead[i])
-        {
-            continue;
-        }
-
-        for(j = i + 1; j < rois_num; ++j)
-        {
-            if(!is_dead[j] && detection_box_iou(&box[i * 5], &box[j * 5]) > thresh)
-            {
-                is_dead[j] = 1;
-            }
-        }
-    }
-
-    j = 0;
-    for(i=0; i<rois_num; i++)
-    {
-        if(!is_dead[i])
-        {
-            keep[j] = i;
-            j++;
-        }
-    }
-    *num = j;
-
-final:
-    vsi_nn_safe_free(is_dead);
-}
-
-static void detection_box_qsort
-    (
-    float *box,
-    int32_t start,
-    int32_t end
-    )
-{
-    /*
-        box[x] = {x1, y1, x2, y2, score};
-    */
-    int i;
-    float pivot_score = box[start * 5 + 4];
-    int32_t left = start + 1, right = end;
-    float temp[5];
-
-    while (left <= right)
-    {
-        while(left <= end && box[left * 5 + 4] >= pivot_score)
-            ++left;
-        while (right > start && box[right * 5 + 4] <= pivot_score)
-            --right;
-
-        if (left <= right)
-        {
-            /* swap box */
-            for(i = 0; i < 5; ++i)
-            {
-                temp[i] = box[left * 5 + i];
-            }
-            for(i = 0; i < 5; ++i)
-            {
-                box[left * 5 + i] = box[right * 5 + i];
-            }
-            for(i = 0; i < 5; ++i)
-            {
-                box[right * 5 + i] = temp[i];
-            }
-
-            ++left;
-            --right;
-        }
-    }
-
-    if (right > start)
-    {
-        for(i = 0; i < 5; ++i)
-        {
-            temp[i] = box[start * 5 + i];
-        }
-        for(i = 0; i < 5; ++i)
-        {
-            box[start * 5 + i] = box[right * 5 + i];
-        }
-        for(i = 0; i < 5; ++i)
-        {
-            box[right * 5 + i] = temp[i];
-        }
-    }
-
-    if(start < right - 1)
-    {
-        detection_box_qsort(box, start, right - 1);
-    }
-    if(right + 1 < end)
-    {
-        detection_box_qsort(box, right + 1, end);
-    }
-}
-
 static void _init_box(vsi_nn_link_list_t *node)
 {
     vsi_nn_fasterrcnn_box_t *box = NULL;
@@ -496,13 +241,10 @@ static vsi_status _fasterrcnn_post_process
     )
 {
     vsi_status status;
-    uint32_t i,j,k;
+    uint32_t i,k,c;
     uint32_t rois_num,classes_num;
-    float *pred_boxes = NULL,*dets = NULL;
-    float *pdets = NULL, *ppred = NULL;
+    vsi_nn_detection_boxes_t *pred_boxes = NULL, *dets = NULL;
     vsi_nn_fasterrcnn_box_t *box = NULL;
-    uint32_t *keep = NULL,num;
-    float score;
 
     if(NULL == rois || NULL == bbox || NULL == cls || NULL == param)
     {
@@ -517,82 +259,69 @@ static vsi_status _fasterrcnn_post_process
         return status;
     }
 
-    status = _bbox_transform_inv(rois, bbox, param, &pred_boxes);
-    if(status != VSI_SUCCESS)
-    {
-        VSILOGE("transform bbox fail");
-        return status;
-    }
-
     rois_num = param->rois_num;
     classes_num = param->classes_num;
-    dets = (float *)malloc(sizeof(float) * 5 * rois_num);
-    if(NULL == dets)
-    {
-        status = VSI_FAILURE;
-        goto final;
-    }
+    status = VSI_FAILURE;
+    pred_boxes = vsi_nn_detection_boxes_create(rois_num * classes_num);
+    CHECK_PTR_FAIL_GOTO( pred_boxes, "Create buffer fail.", final );
+    dets = vsi_nn_detection_boxes_create(rois_num * classes_num);
+    CHECK_PTR_FAIL_GOTO( dets, "Create buffer fail.", final );
 
-    keep = NULL;
-    keep = (uint32_t *)malloc(sizeof(uint32_t) * rois_num);
-    if(NULL == keep)
+    /* roi_data {0,x1,y1,x2,y2}, bbox {rois_num,84}, dets {rois_num,21} */
+    for(i=0; i<rois_num; i++)
     {
-        status = VSI_FAILURE;
-        goto final;
+        vsi_nn_detection_boxes_t row = *dets;
+
+        row.x1 += i * classes_num;
+        row.y1 += i * classes_num;
+        row.x2 += i * classes_num;
+        row.y2 += i * classes_num;
+        row.score += i * classes_num;
+        row.class_id += i * classes_num;
+        row.capacity = classes_num;
+        vsi_nn_detection_decode_roi(rois + i * 5 + 1, 0, bbox + i * classes_num * 4, 4,
+            classes_num, param->iminfo.size[0], param->iminfo.size[1], &row);
     }
+    dets->num = rois_num * classes_num;
 
-    /* i=1, skip background */
-    for(i=1; i<param->classes_num; i++)
-    {
-        /* pred_boxes{rois_num,84} */
-        pdets = dets;
-        ppred = pred_boxes + 4 * i;
-        for(j=0; j<rois_num; j++)
-        {
-            pdets[0] = ppred[0];
-            pdets[1] = ppred[1];
-            pdets[2] = ppred[2];
-            pdets[3] = ppred[3];
-            pdets[4] = cls[j*classes_num + i];
-
-            pdets += 5;
-            ppred += classes_num*4;
-        }
-
-        detection_box_qsort(dets, 0, rois_num - 1);
-
-        num = 0;
-        memset(keep, 0, sizeof(int32_t) * rois_num);
-        detection_box_nms(dets, param->nms_thresh, rois_num, keep, &num);
+    /* class_start=1, skip background */
+    status = vsi_nn_detection_multiclass_nms(dets, TRUE, cls, classes_num, 1,
+        param->conf_thresh, param->nms_thresh, 1.0f, 0, 0, pred_boxes);
+    CHECK_STATUS_FAIL_GOTO( status, final );
+    status = VSI_FAILURE;
 
-        for(k=0; k<num; k++)
+    /*
+     * pred_boxes is merged by score over all classes. Keep the list order
+     * of dets_box as before: class by class, each class by score, pushed
+     * to the front.
+     */
+    for(c=1; c<classes_num && NULL != dets_box; c++)
+    {
+        for(k=0; k<pred_boxes->num; k++)
         {
-            score = dets[keep[k]*5+4];
-            if(score > param->conf_thresh)
+            if((uint32_t)pred_boxes->class_id[k] != c)
             {
-                if(NULL != dets_box)
-                {
-                    box = (vsi_nn_fasterrcnn_box_t *)
-                        vsi_nn_LinkListNewNode(sizeof(vsi_nn_fasterrcnn_box_t), _init_box);
-                    CHECK_PTR_FAIL_GOTO( box, "Create box fail.", final );
-                    box->score = dets[keep[k]*5+4];
-                    box->class_id = i;
-                    box->x1 = dets[keep[k]*5+0];
-                    box->y1 = dets[keep[k]*5+1];
-                    box->x2 = dets[keep[k]*5+2];
-                    box->y2 = dets[keep[k]*5+3];
-                    vsi_nn_LinkListPushStart(
-                        (vsi_nn_link_list_t **)dets_box,
-                        (vsi_nn_link_list_t *)box );
-                }
+                continue;
             }
+            box = (vsi_nn_fasterrcnn_box_t *)
+                vsi_nn_LinkListNewNode(sizeof(vsi_nn_fasterrcnn_box_t), _init_box);
+            CHECK_PTR_FAIL_GOTO( box, "Create box fail.", final );
+            box->score = pred_boxes->score[k];
+            box->class_id = (uint32_t)pred_boxes->class_id[k];
+            box->x1 = pred_boxes->x1[k];
+            box->y1 = pred_boxes->y1[k];
+            box->x2 = pred_boxes->x2[k];
+            box->y2 = pred_boxes->y2[k];
+            vsi_nn_LinkListPushStart(
+                (vsi_nn_link_list_t **)dets_box,
+                (vsi_nn_link_list_t *)box );
         }
     }
+    status = VSI_SUCCESS;
 
 final:
-    if(keep)free(keep);
-    if(dets)free(dets);
-    if(pred_boxes)free(pred_boxes);
+    vsi_nn_detection_boxes_release(&dets);
+    vsi_nn_detection_boxes_release(&pred_boxes);
     return status;
 } /* _fasterrcnn_post_process() */
 
@@ -0,0 +1,187 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "utils/vsi_nn_arena.h"
+#include "vsi_nn_log.h"
+
+#define _ARENA_ALIGN                (16)
+#define _ARENA_DEFAULT_BLOCK_SIZE   (16 * 1024)
+#define _ARENA_ALIGN_UP(x)          (((x) + _ARENA_ALIGN - 1) & ~((size_t)_ARENA_ALIGN - 1))
+
+typedef struct _vsi_nn_arena_block
+{
+    struct _vsi_nn_arena_block * next;
+    size_t size;
+    size_t used;
+} vsi_nn_arena_block_t;
+
+struct _vsi_nn_arena
+{
+    /* Current block is at the head, dedicated blocks are kept behind it. */
+    vsi_nn_arena_block_t * blocks;
+    size_t block_size;
+    vsi_nn_arena_stat_t stat;
+};
+
+#define _BLOCK_HEADER_SIZE      _ARENA_ALIGN_UP(sizeof(vsi_nn_arena_block_t))
+#define _BLOCK_DATA(_BLOCK)     ((uint8_t *)(_BLOCK) + _BLOCK_HEADER_SIZE)
+
+static vsi_nn_arena_block_t * _new_block
+    (
+    vsi_nn_arena_t * arena,
+    size_t size
+    )
+{
+    vsi_nn_arena_block_t * block = NULL;
+
+    block = (vsi_nn_arena_block_t *)calloc( 1, _BLOCK_HEADER_SIZE + size );
+    if( NULL == block )
+    {
+        VSILOGE( "Create arena block fail, size %"SIZE_T_SPECIFIER".", size );
+        return NULL;
+    }
+    block->size = size;
+    arena->stat.block_count += 1;
+    arena->stat.reserved_bytes += _BLOCK_HEADER_SIZE + size;
+
+    return block;
+} /* _new_block() */
+
+vsi_nn_arena_t * vsi_nn_arena_create
+    (
+    size_t block_size
+    )
+{
+    vsi_nn_arena_t * arena = NULL;
+
+    arena = (vsi_nn_arena_t *)calloc( 1, sizeof( vsi_nn_arena_t ) );
+    if( NULL != arena )
+    {
+        arena->block_size = _ARENA_ALIGN_UP( 0 == block_size ?
+            _ARENA_DEFAULT_BLOCK_SIZE : block_size );
+    }
+
+    return arena;
+} /* vsi_nn_arena_create() */
+
+void * vsi_nn_arena_alloc
+    (
+    vsi_nn_arena_t * arena,
+    size_t size
+    )
+{
+    vsi_nn_arena_block_t * block = NULL;
+    void * ptr = NULL;
+
+    if( NULL == arena )
+    {
+        return NULL;
+    }
+
+    size = _ARENA_ALIGN_UP( 0 == size ? 1 : size );
+    if( size > arena->block_size / 4 )
+    {
+        /* Dedicated block, linked after the current one so the
+         * remaining space of the current block is kept. */
+        block = _new_block( arena, size );
+        if( NULL == block )
+        {
+            return NULL;
+        }
+        block->used = size;
+        if( NULL != arena->blocks )
+        {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+        else
+        {
+            arena->blocks = block;
+        }
+    }
+    else
+    {
+        block = arena->blocks;
+        if( NULL == block || block->size - block->used < size )
+        {
+            block = _new_block( arena, arena->block_size );
+            if( NULL == block )
+            {
+                return NULL;
+            }
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+        block->used += size;
+    }
+    ptr = _BLOCK_DATA( block ) + block->used - size;
+
+    arena->stat.alloc_count += 1;
+    arena->stat.alloc_bytes += size;
+
+    return ptr;
+} /* vsi_nn_arena_alloc() */
+
+void vsi_nn_arena_release
+    (
+    vsi_nn_arena_t ** arena
+    )
+{
+    vsi_nn_arena_block_t * block = NULL;
+
+    if( NULL == arena || NULL == *arena )
+    {
+        return;
+    }
+
+    block = (*arena)->blocks;
+    while( NULL != block )
+    {
+        vsi_nn_arena_block_t * next = block->next;
+        free( block );
+        block = next;
+    }
+    free( *arena );
+    *arena = NULL;
+} /* vsi_nn_arena_release() */
+
+void vsi_nn_arena_get_stat
+    (
+    const vsi_nn_arena_t * arena,
+    vsi_nn_arena_stat_t * stat
+    )
+{
+    if( NULL == stat )
+    {
+        return;
+    }
+    if( NULL == arena )
+    {
+        memset( stat, 0, sizeof( vsi_nn_arena_stat_t ) );
+        return;
+    }
+    *stat = arena->stat;
+} /* vsi_nn_arena_get_stat() */
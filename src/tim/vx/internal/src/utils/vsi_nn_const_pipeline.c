@@ -0,0 +1,617 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "vsi_nn_graph.h"
+#include "vsi_nn_types_prv.h"
+#include "vsi_nn_log.h"
+#include "vsi_nn_tensor_util.h"
+#include "vsi_nn_graph_optimization.h"
+#include "utils/vsi_nn_math.h"
+#include "utils/vsi_nn_util.h"
+#include "utils/vsi_nn_dtype_util.h"
+#include "utils/vsi_nn_const_pipeline.h"
+#include "kernel/vsi_nn_kernel_cpu.h"
+
+/* Host bytes held at once, tensors are read in batches of this size. */
+#define _BATCH_BYTES        (64 * 1024 * 1024)
+
+typedef struct _vsi_nn_const_step
+{
+    vsi_nn_const_transform_t transform;
+    uint8_t param[VSI_NN_CONST_TRANSFORM_PARAM_SIZE];
+} vsi_nn_const_step_t;
+
+typedef struct _vsi_nn_const_entry
+{
+    vsi_nn_tensor_t * tensor;
+    vsi_nn_const_step_t steps[VSI_NN_CONST_PIPELINE_MAX_TRANSFORMS];
+    uint32_t step_num;
+    vsi_nn_tensor_attr_t attr;
+    uint8_t * data;
+    vsi_size_t size;
+    vsi_status status;
+} vsi_nn_const_entry_t;
+
+/* Steps kept per tensor for replay, e.g. i8 to u8 then a permute and a
+ * rotate by a deconvolution */
+#define _HISTORY_MAX_TRANSFORMS     (2 * VSI_NN_CONST_PIPELINE_MAX_TRANSFORMS)
+
+typedef struct _vsi_nn_const_history
+{
+    struct _vsi_nn_const_history * next;
+    const vsi_nn_tensor_t * tensor;
+    /* Attribute before the first transform */
+    vsi_nn_tensor_attr_t attr;
+    vsi_nn_const_step_t steps[_HISTORY_MAX_TRANSFORMS];
+    uint32_t step_num;
+    vsi_bool replayable;
+} vsi_nn_const_history_t;
+
+struct _vsi_nn_const_pipeline
+{
+    vsi_nn_graph_t * graph;
+    vsi_nn_const_entry_t * entries;
+    size_t count;
+    size_t capacity;
+};
+
+static vsi_nn_const_entry_t * _find_entry
+    (
+    const vsi_nn_const_pipeline_t * pipeline,
+    const vsi_nn_tensor_t * tensor
+    )
+{
+    size_t i;
+    for( i = 0; i < pipeline->count; i++ )
+    {
+        if( pipeline->entries[i].tensor == tensor )
+        {
+            return &pipeline->entries[i];
+        }
+    }
+    return NULL;
+} /* _find_entry() */
+
+static vsi_nn_const_history_t * _get_history
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_tensor_t * tensor,
+    vsi_bool create
+    )
+{
+    vsi_nn_graph_prv_t * graph_prv = (vsi_nn_graph_prv_t *)graph;
+    vsi_nn_const_history_t * history = NULL;
+
+    for( history = graph_prv->const_history; NULL != history; history = history->next )
+    {
+        if( history->tensor == tensor )
+        {
+            return history;
+        }
+    }
+    if( !create )
+    {
+        return NULL;
+    }
+    history = (vsi_nn_const_history_t *)vsi_nn_graph_arena_alloc( graph,
+        sizeof(vsi_nn_const_history_t) );
+    if( NULL == history )
+    {
+        return NULL;
+    }
+    memset( history, 0, sizeof(vsi_nn_const_history_t) );
+    history->tensor = tensor;
+    memcpy( &history->attr, &tensor->attr, sizeof(vsi_nn_tensor_attr_t) );
+    history->replayable = TRUE;
+    history->next = graph_prv->const_history;
+    graph_prv->const_history = history;
+    return history;
+} /* _get_history() */
+
+/* Called before the entry is written back, while the tensor still has the
+ * attribute the steps start from */
+static vsi_status _record_history
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_const_entry_t * entry
+    )
+{
+    vsi_nn_const_history_t * history = NULL;
+
+    history = _get_history( graph, entry->tensor, TRUE );
+    if( NULL == history )
+    {
+        VSILOGE( "Record const tensor history fail." );
+        ((vsi_nn_graph_prv_t *)graph)->const_history_incomplete = TRUE;
+        return VSI_FAILURE;
+    }
+    if( history->step_num + entry->step_num > _HISTORY_MAX_TRANSFORMS )
+    {
+        history->replayable = FALSE;
+        return VSI_SUCCESS;
+    }
+    memcpy( &history->steps[history->step_num], entry->steps,
+        entry->step_num * sizeof(vsi_nn_const_step_t) );
+    history->step_num += entry->step_num;
+    return VSI_SUCCESS;
+} /* _record_history() */
+
+static void _run_chain_task
+    (
+    void * data,
+    size_t begin,
+    size_t end
+    )
+{
+    vsi_nn_const_entry_t * entries = (vsi_nn_const_entry_t *)data;
+    size_t i;
+    uint32_t j;
+
+    for( i = begin; i < end; i++ )
+    {
+        vsi_nn_const_entry_t * entry = &entries[i];
+        entry->status = VSI_SUCCESS;
+        for( j = 0; j < entry->step_num && VSI_SUCCESS == entry->status; j++ )
+        {
+            entry->status = entry->steps[j].transform( &entry->attr,
+                entry->data, entry->size, entry->steps[j].param );
+        }
+    }
+} /* _run_chain_task() */
+
+static vsi_bool _is_dtype_changed
+    (
+    const vsi_nn_dtype_t * a,
+    const vsi_nn_dtype_t * b
+    )
+{
+    return a->vx_type != b->vx_type || a->qnt_type != b->qnt_type
+        || a->zero_point != b->zero_point || a->scale != b->scale
+        || a->fl != b->fl;
+} /* _is_dtype_changed() */
+
+static vsi_status _write_back
+    (
+    vsi_nn_graph_t * graph,
+    vsi_nn_const_entry_t * entry
+    )
+{
+    vsi_nn_tensor_t * tensor = entry->tensor;
+    vsi_nn_tensor_attr_t * attr = &entry->attr;
+
+    if( _is_dtype_changed( &tensor->attr.dtype, &attr->dtype ) )
+    {
+        /* The raw tensor is recreated with the new data type */
+        memcpy( &tensor->attr, attr, sizeof(vsi_nn_tensor_attr_t) );
+        if( tensor->t ) vxReleaseTensor( &tensor->t );
+        tensor->t = vsi_nn_CreateRawTensorFromData( graph, entry->data, &tensor->attr );
+        return NULL == tensor->t ? VSI_FAILURE : VSI_SUCCESS;
+    }
+
+    if( tensor->attr.dim_num != attr->dim_num
+     || memcmp( tensor->attr.size, attr->size, sizeof(attr->size) ) )
+    {
+        memcpy( tensor->attr.size, attr->size, sizeof(attr->size) );
+        tensor->attr.dim_num = attr->dim_num;
+        tensor->t = vsi_nn_safe_reshape_tensor( tensor->t, (void*)tensor->attr.size,
+            (vsi_size_t)tensor->attr.dim_num, sizeof(tensor->attr.size[0]) );
+        if( NULL == tensor->t )
+        {
+            return VSI_FAILURE;
+        }
+    }
+    return vsi_nn_CopyDataToTensor( graph, tensor, entry->data );
+} /* _write_back() */
+
+vsi_nn_const_pipeline_t * vsi_nn_const_pipeline_create
+    (
+    vsi_nn_graph_t * graph
+    )
+{
+    vsi_nn_const_pipeline_t * pipeline = NULL;
+
+    pipeline = (vsi_nn_const_pipeline_t *)calloc( 1, sizeof(vsi_nn_const_pipeline_t) );
+    if( NULL == pipeline )
+    {
+        VSILOGE( "Create const pipeline fail." );
+        return NULL;
+    }
+    pipeline->graph = graph;
+    return pipeline;
+} /* vsi_nn_const_pipeline_create() */
+
+vsi_status vsi_nn_const_pipeline_add
+    (
+    vsi_nn_const_pipeline_t * pipeline,
+    vsi_nn_tensor_t * tensor,
+    vsi_nn_const_transform_t transform,
+    const void * param,
+    size_t param_size
+    )
+{
+    vsi_nn_const_entry_t * entry = NULL;
+    vsi_nn_const_step_t * step = NULL;
+
+    if( NULL == pipeline || NULL == tensor || NULL == transform
+     || param_size > VSI_NN_CONST_TRANSFORM_PARAM_SIZE )
+    {
+        VSILOGE( "Invalid parameter." );
+        return VSI_FAILURE;
+    }
+    if( !tensor->attr.is_const )
+    {
+        VSILOGE( "Only constant tensors can be transformed." );
+        return VSI_FAILURE;
+    }
+
+    entry = _find_entry( pipeline, tensor );
+    if( NULL == entry )
+    {
+        if( pipeline->count == pipeline->capacity )
+        {
+            size_t capacity = pipeline->capacity ? pipeline->capacity * 2 : 16;
+            vsi_nn_const_entry_t * entries = (vsi_nn_const_entry_t *)realloc(
+                pipeline->entries, capacity * sizeof(vsi_nn_const_entry_t) );
+            if( NULL == entries )
+            {
+                VSILOGE( "Grow const pipeline fail." );
+                return VSI_FAILURE;
+            }
+            pipeline->entries = entries;
+            pipeline->capacity = capacity;
+        }
+        entry = &pipeline->entries[pipeline->count++];
+        memset( entry, 0, sizeof(vsi_nn_const_entry_t) );
+        entry->tensor = tensor;
+    }
+
+    if( entry->step_num >= VSI_NN_CONST_PIPELINE_MAX_TRANSFORMS )
+    {
+        VSILOGE( "Too many transforms for one tensor." );
+        return VSI_FAILURE;
+    }
+    step = &entry->steps[entry->step_num++];
+    step->transform = transform;
+    if( param && param_size > 0 )
+    {
+        memcpy( step->param, param, param_size );
+    }
+    return VSI_SUCCESS;
+} /* vsi_nn_const_pipeline_add() */
+
+vsi_bool vsi_nn_const_pipeline_contains
+    (
+    const vsi_nn_const_pipeline_t * pipeline,
+    const vsi_nn_tensor_t * tensor
+    )
+{
+    return NULL != pipeline && NULL != _find_entry( pipeline, tensor );
+} /* vsi_nn_const_pipeline_contains() */
+
+vsi_status vsi_nn_const_pipeline_run
+    (
+    vsi_nn_const_pipeline_t * pipeline,
+    vsi_nn_const_pipeline_stat_t * stat
+    )
+{
+    vsi_status status = VSI_SUCCESS;
+    vsi_nn_const_pipeline_stat_t total;
+    size_t start = 0;
+    size_t end = 0;
+    size_t i = 0;
+
+    memset( &total, 0, sizeof(total) );
+    if( NULL == pipeline )
+    {
+        return VSI_FAILURE;
+    }
+
+    for( start = 0; start < pipeline->count && VSI_SUCCESS == status; start = end )
+    {
+        size_t batch_bytes = 0;
+
+        /* Read a batch, OpenVX is only called from this thread */
+        for( end = start; end < pipeline->count
+            && ( end == start || batch_bytes < _BATCH_BYTES ); end++ )
+        {
+            vsi_nn_const_entry_t * entry = &pipeline->entries[end];
+            memcpy( &entry->attr, &entry->tensor->attr, sizeof(vsi_nn_tensor_attr_t) );
+            entry->size = vsi_nn_GetTensorSize( entry->attr.size,
+                entry->attr.dim_num, entry->attr.dtype.vx_type );
+            entry->data = vsi_nn_ConvertTensorToData( pipeline->graph, entry->tensor );
+            if( NULL == entry->data )
+            {
+                VSILOGE( "Convert data fail." );
+                status = VSI_FAILURE;
+                end++;
+                break;
+            }
+            batch_bytes += (size_t)entry->size;
+            total.bytes_read += (size_t)entry->size;
+        }
+
+        if( VSI_SUCCESS == status )
+        {
+            vsi_nn_kernel_cpu_parallel_for( end - start, 1, _run_chain_task,
+                &pipeline->entries[start] );
+        }
+
+        for( i = start; i < end; i++ )
+        {
+            vsi_nn_const_entry_t * entry = &pipeline->entries[i];
+            if( VSI_SUCCESS == status )
+            {
+                status = entry->status;
+                if( VSI_SUCCESS == status )
+                {
+                    status = _record_history( pipeline->graph, entry );
+                }
+                if( VSI_SUCCESS == status )
+                {
+                    status = _write_back( pipeline->graph, entry );
+                }
+                if( VSI_SUCCESS == status )
+                {
+                    total.tensor_count++;
+                    total.transform_count += entry->step_num;
+                    total.bytes_written += (size_t)entry->size;
+                }
+            }
+            vsi_nn_safe_free( entry->data );
+        }
+    }
+    for( i = end; i < pipeline->count; i++ )
+    {
+        vsi_nn_safe_free( pipeline->entries[i].data );
+    }
+    pipeline->count = 0;
+
+    if( total.tensor_count > 0 )
+    {
+        VSILOGD( "Const pipeline: %"SIZE_T_SPECIFIER" tensors, "
+            "%"SIZE_T_SPECIFIER" transforms, %"SIZE_T_SPECIFIER" bytes read, "
+            "%"SIZE_T_SPECIFIER" bytes written",
+            total.tensor_count, total.transform_count,
+            total.bytes_read, total.bytes_written );
+    }
+    if( stat )
+    {
+        memcpy( stat, &total, sizeof(total) );
+    }
+    return status;
+} /* vsi_nn_const_pipeline_run() */
+
+void vsi_nn_const_pipeline_release
+    (
+    vsi_nn_const_pipeline_t ** pipeline
+    )
+{
+    size_t i;
+    if( NULL == pipeline || NULL == *pipeline )
+    {
+        return;
+    }
+    for( i = 0; i < (*pipeline)->count; i++ )
+    {
+        vsi_nn_safe_free( (*pipeline)->entries[i].data );
+    }
+    vsi_nn_safe_free( (*pipeline)->entries );
+    vsi_nn_safe_free( *pipeline );
+} /* vsi_nn_const_pipeline_release() */
+
+void vsi_nn_const_pipeline_record_rewrite
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_tensor_t * tensor
+    )
+{
+    vsi_nn_const_history_t * history = NULL;
+
+    if( NULL == graph || NULL == tensor )
+    {
+        return;
+    }
+    history = _get_history( graph, tensor, TRUE );
+    if( NULL != history )
+    {
+        history->replayable = FALSE;
+    }
+    else
+    {
+        VSILOGE( "Record const tensor rewrite fail." );
+        ((vsi_nn_graph_prv_t *)graph)->const_history_incomplete = TRUE;
+    }
+} /* vsi_nn_const_pipeline_record_rewrite() */
+
+vsi_status vsi_nn_const_pipeline_replay
+    (
+    vsi_nn_graph_t * graph,
+    const vsi_nn_tensor_t * tensor,
+    uint8_t * data,
+    vsi_size_t size
+    )
+{
+    vsi_status status = VSI_SUCCESS;
+    vsi_nn_const_history_t * history = NULL;
+    vsi_nn_tensor_attr_t attr;
+    uint32_t i;
+
+    if( NULL == graph || NULL == tensor || NULL == data )
+    {
+        return VSI_FAILURE;
+    }
+    if( ((vsi_nn_graph_prv_t *)graph)->const_history_incomplete )
+    {
+        VSILOGE( "Const tensor history of the graph is incomplete." );
+        return VSI_FAILURE;
+    }
+    history = _get_history( graph, tensor, FALSE );
+    if( NULL == history )
+    {
+        return VSI_SUCCESS;
+    }
+    if( !history->replayable )
+    {
+        VSILOGE( "Const tensor was rewritten at setup and can't be replayed." );
+        return VSI_FAILURE;
+    }
+    memcpy( &attr, &history->attr, sizeof(vsi_nn_tensor_attr_t) );
+    for( i = 0; i < history->step_num && VSI_SUCCESS == status; i++ )
+    {
+        status = history->steps[i].transform( &attr, data, size,
+            history->steps[i].param );
+    }
+    return status;
+} /* vsi_nn_const_pipeline_replay() */
+
+vsi_status vsi_nn_const_transform_i8_to_u8
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    )
+{
+    vsi_size_t i;
+    VSI_UNREFERENCED(param);
+
+    for( i = 0; i < size; i++ )
+    {
+        data[i] = data[i] ^ 0x80;
+    }
+    attr->dtype.vx_type = VSI_NN_TYPE_UINT8;
+    attr->dtype.zero_point += 128;
+    return VSI_SUCCESS;
+} /* vsi_nn_const_transform_i8_to_u8() */
+
+vsi_status vsi_nn_const_transform_rotate_180
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    )
+{
+    vsi_size_t item_size = vsi_nn_TypeGetBytes( attr->dtype.vx_type );
+    vsi_size_t slice_size = attr->size[0] * attr->size[1];
+    vsi_size_t slice_bytes = slice_size * item_size;
+    vsi_size_t offset, i, k;
+    VSI_UNREFERENCED(param);
+
+    if( 0 == item_size || 0 == slice_size || attr->dim_num < 2 )
+    {
+        return VSI_FAILURE;
+    }
+    for( offset = 0; offset + slice_bytes <= size; offset += slice_bytes )
+    {
+        uint8_t * slice = data + offset;
+        for( i = 0; i < slice_size / 2; i++ )
+        {
+            uint8_t * a = slice + i * item_size;
+            uint8_t * b = slice + ( slice_size - 1 - i ) * item_size;
+            for( k = 0; k < item_size; k++ )
+            {
+                uint8_t t = a[k];
+                a[k] = b[k];
+                b[k] = t;
+            }
+        }
+    }
+    return VSI_SUCCESS;
+} /* vsi_nn_const_transform_rotate_180() */
+
+static vsi_status _permute_data
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const vsi_nn_const_permute_param_t * p,
+    vsi_bool permute_shape
+    )
+{
+    uint8_t * dst = NULL;
+    vsi_size_t dst_shape[VSI_NN_MAX_DIM_NUM] = { 0 };
+    vsi_size_t i;
+
+    if( NULL == p || 0 == p->dim_num || p->dim_num > VSI_NN_MAX_DIM_NUM )
+    {
+        VSILOGE( "Wrong perm parameters." );
+        return VSI_FAILURE;
+    }
+    for( i = 0; i < p->dim_num; i++ )
+    {
+        if( p->perm[i] >= p->dim_num )
+        {
+            VSILOGE( "Incorrect perm %d", (int32_t)p->perm[i] );
+            return VSI_FAILURE;
+        }
+        dst_shape[i] = attr->size[p->perm[i]];
+    }
+    dst = (uint8_t *)malloc( size );
+    if( NULL == dst )
+    {
+        VSILOGE( "Malloc dst buf fail." );
+        return VSI_FAILURE;
+    }
+    if( permute_shape )
+    {
+        vsi_nn_Permute( dst, data, attr->size, p->dim_num,
+            (vsi_size_t *)p->perm, attr->dtype.vx_type );
+        memcpy( attr->size, dst_shape, sizeof(dst_shape) );
+    }
+    else
+    {
+        vsi_nn_Transpose( dst, data, attr->size, p->dim_num,
+            (vsi_size_t *)p->perm, attr->dtype.vx_type );
+    }
+    memcpy( data, dst, size );
+    free( dst );
+    return VSI_SUCCESS;
+} /* _permute_data() */
+
+vsi_status vsi_nn_const_transform_permute
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    )
+{
+    return _permute_data( attr, data, size,
+        (const vsi_nn_const_permute_param_t *)param, TRUE );
+} /* vsi_nn_const_transform_permute() */
+
+vsi_status vsi_nn_const_transform_transpose
+    (
+    vsi_nn_tensor_attr_t * attr,
+    uint8_t * data,
+    vsi_size_t size,
+    const void * param
+    )
+{
+    return _permute_data( attr, data, size,
+        (const vsi_nn_const_permute_param_t *)param, FALSE );
+} /* vsi_nn_const_transform_transpose() */
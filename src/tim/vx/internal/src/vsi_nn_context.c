@@ -26,6 +26,7 @@
 #include "vsi_nn_test.h"
 #include "vsi_nn_context.h"
 #include "vsi_nn_platform.h"
+#include "kernel/vsi_nn_kernel.h"
 
 static vsi_status query_hardware_caps
     (
@@ -103,6 +104,8 @@ static const char* ENV_ENABLE_STREAM_PROCESSOR = "vendor.VSI_VX_ENABLE_STREAM_PR
 static const char* ENV_FORCE_RGB888_OUT_NHWC = "vendor.VSI_NN_FORCE_RGB888_OUT_NHWC";
 static const char* ENV_ENABLE_SLICE_OPTIMIZE = "vendor.VSI_NN_ENABLE_SLICE_OPTIMIZE";
 static const char* ENV_ENABLE_BATCH_OPT = "vendor.VSI_VX_ENABLE_BATCH_OPT";
+static const char* ENV_ENABLE_KERNEL_TUNING = "vendor.VSI_NN_ENABLE_KERNEL_TUNING";
+static const char* ENV_GRAPH_ARENA_BLOCK_SIZE = "vendor.VSI_NN_GRAPH_ARENA_BLOCK_SIZE";
 #else
 static const char* ENV_ENABLE_SHADER = "VIV_VX_ENABLE_SHADER";
 static const char* ENV_ENABLE_OPCHECK = "VSI_NN_ENABLE_OPCHECK";
@@ -113,6 +116,8 @@ static const char* ENV_ENABLE_STREAM_PROCESSOR = "VSI_VX_ENABLE_STREAM_PROCESSOR
 static const char* ENV_FORCE_RGB888_OUT_NHWC = "VSI_NN_FORCE_RGB888_OUT_NHWC";
 static const char* ENV_ENABLE_SLICE_OPTIMIZE = "VSI_NN_ENABLE_SLICE_OPTIMIZE";
 static const char* ENV_ENABLE_BATCH_OPT = "VSI_VX_ENABLE_BATCH_OPT";
+static const char* ENV_ENABLE_KERNEL_TUNING = "VSI_NN_ENABLE_KERNEL_TUNING";
+static const char* ENV_GRAPH_ARENA_BLOCK_SIZE = "VSI_NN_GRAPH_ARENA_BLOCK_SIZE";
 #endif
 static vsi_status vsi_nn_initOptions
     (
@@ -140,6 +145,8 @@ static vsi_status vsi_nn_initOptions
 #endif
     options->enable_slice_optimize = vsi_nn_getenv_asint(ENV_ENABLE_SLICE_OPTIMIZE, default_value);
     options->enable_batch_opt = vsi_nn_getenv_asint(ENV_ENABLE_BATCH_OPT, 0);
+    options->enable_kernel_tuning = vsi_nn_getenv_asint(ENV_ENABLE_KERNEL_TUNING, 0);
+    options->graph_arena_block_size = vsi_nn_getenv_asint(ENV_GRAPH_ARENA_BLOCK_SIZE, 0);
 
     return VSI_SUCCESS;
 }
@@ -188,6 +195,7 @@ void vsi_nn_ReleaseContext
         vsi_nn_context_t context = *ctx;
         if(context->c)
         {
+            vsi_nn_kernel_program_cache_release( context->c );
             vxReleaseContext( &context->c);
         }
         free(context);
@@ -39,6 +39,7 @@
 #include "utils/vsi_nn_util.h"
 #include "utils/vsi_nn_map.h"
 #include "utils/vsi_nn_dtype_util.h"
+#include "utils/vsi_nn_const_pipeline.h"
 #include "vsi_nn_graph_optimization.h"
 #include "vsi_nn_error.h"
 #include "vsi_nn_types_prv.h"
@@ -125,15 +126,14 @@ static vsi_status _set_parameter_for_swap_handle
        goto final;
     }
 
-    item = (vsi_nn_swap_handle_cache_item_t *)
-        malloc( sizeof(vsi_nn_swap_handle_cache_item_t) );
+    item = (vsi_nn_swap_handle_cache_item_t *)vsi_nn_graph_arena_alloc(
+        graph, sizeof(vsi_nn_swap_handle_cache_item_t) );
     if( NULL == item )
     {
         VSILOGE( "Create swap handle cache item fail." );
         goto final;
     }
 
-    memset( item, 0, sizeof(vsi_nn_swap_handle_cache_item_t) );
     item->node = node;
     item->idx = idx;
     item->tensor = tensor;
@@ -1415,21 +1415,41 @@ void vsi_nn_ReleaseGraph
         {
             vsi_nn_rnn_DeinitWksp( ptr );
         }
-        if( NULL != ((vsi_nn_graph_prv_t*)ptr)->swap_handle_cache.cache_list )
-        {
-            vsi_nn_swap_handle_cache_item_t* item = ((vsi_nn_graph_prv_t*)ptr)->swap_handle_cache.cache_list;
-            while( NULL != item )
-            {
-                vsi_nn_swap_handle_cache_item_t* tmp = (vsi_nn_swap_handle_cache_item_t *)
-                    vsi_nn_LinkListPopStart( (vsi_nn_link_list_t **)&item );
-                free( tmp );
-            }
-        }
+        /* Swap handle cache items and internal node structures
+         * live in the arena and go away with it. */
+        ((vsi_nn_graph_prv_t*)ptr)->swap_handle_cache.cache_list = NULL;
+        vsi_nn_arena_release( &((vsi_nn_graph_prv_t*)ptr)->arena );
         free( ptr );
         *graph = NULL;
     }
 } /* vsi_nn_ReleaseGraph() */
 
+void * vsi_nn_graph_arena_alloc
+    (
+    vsi_nn_graph_t* graph,
+    size_t size
+    )
+{
+    vsi_nn_graph_prv_t* graph_prv = (vsi_nn_graph_prv_t*)graph;
+
+    if( NULL == graph )
+    {
+        return NULL;
+    }
+    if( NULL == graph_prv->arena )
+    {
+        graph_prv->arena = vsi_nn_arena_create(
+            (size_t)vsi_nn_max( graph->ctx->options.graph_arena_block_size, 0 ) );
+        if( NULL == graph_prv->arena )
+        {
+            VSILOGE( "Create graph arena fail." );
+            return NULL;
+        }
+    }
+
+    return vsi_nn_arena_alloc( graph_prv->arena, size );
+} /* vsi_nn_graph_arena_alloc() */
+
 /*
 * Create vx tensor and nodes.
 * */
@@ -2144,6 +2164,187 @@ void vsi_nn_RemoveNode
     }
 } /* vsi_nn_RemoveNode() */
 
+static void _collect_const_consumers
+    (
+    vsi_nn_graph_t      * graph,
+    vsi_nn_tensor_id_t    id,
+    vsi_nn_node_t      ** nodes,
+    uint32_t            * count
+    )
+{
+    uint32_t i, j, num = 0;
+    vsi_nn_node_t ** consumers = NULL;
+
+    vsi_nn_get_tensor_consumers( graph, id, NULL, &num );
+    if( 0 == num )
+    {
+        return;
+    }
+    consumers = (vsi_nn_node_t **)malloc( num * sizeof( vsi_nn_node_t * ) );
+    CHECK_PTR_FAIL_GOTO( consumers, "Create buffer fail.", final );
+    vsi_nn_get_tensor_consumers( graph, id, consumers, &num );
+
+    for( i = 0; i < num; i++ )
+    {
+        for( j = 0; j < *count; j++ )
+        {
+            if( nodes[j] == consumers[i] )
+            {
+                break;
+            }
+        }
+        if( j < *count )
+        {
+            continue;
+        }
+        nodes[(*count)++] = consumers[i];
+        /* Reshapes alias the constant, their consumers read it as well */
+        if( VSI_NN_OP_RESHAPE == consumers[i]->op ||
+            VSI_NN_OP_RESHAPE2 == consumers[i]->op )
+        {
+            _collect_const_consumers( graph, consumers[i]->output.tensors[0],
+                nodes, count );
+        }
+    }
+
+final:
+    vsi_nn_safe_free( consumers );
+} /* _collect_const_consumers() */
+
+vsi_status vsi_nn_UpdateConstTensor
+    (
+    vsi_nn_graph_t      * graph,
+    vsi_nn_tensor_id_t    id,
+    uint8_t             * data,
+    uint32_t            * node_count
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    vsi_nn_tensor_t * tensor = NULL;
+    vsi_nn_node_t ** nodes = NULL;
+    vsi_nn_tensor_t ** inputs = NULL;
+    vsi_nn_tensor_t ** outputs = NULL;
+    uint8_t * replayed = NULL;
+    vsi_size_t size = 0;
+    uint32_t i, count = 0, refreshed = 0;
+
+    if( NULL != node_count )
+    {
+        *node_count = 0;
+    }
+    tensor = vsi_nn_GetTensor( graph, id );
+    if( NULL == tensor || NULL == data || FALSE == tensor->attr.is_const )
+    {
+        VSILOGE( "Tensor %u is not a const tensor.", id );
+        return VSI_FAILURE;
+    }
+
+    if( graph->node_num > 0 )
+    {
+        nodes = (vsi_nn_node_t **)malloc( graph->node_num * sizeof( vsi_nn_node_t * ) );
+        CHECK_PTR_FAIL_GOTO( nodes, "Create buffer fail.", final );
+        _collect_const_consumers( graph, id, nodes, &count );
+    }
+
+    /* Internal nodes may hold data derived from the constant at setup */
+    for( i = 0; i < count; i++ )
+    {
+        if( NULL == nodes[i]->n && NULL != nodes[i]->internal_node_wksp )
+        {
+            VSILOGE( "Node %s uid %u can't be refreshed, setup the graph again.",
+                vsi_nn_OpGetName( nodes[i]->op ), nodes[i]->uid );
+            goto final;
+        }
+    }
+
+    /* Setup may have rewritten the data, e.g. int8 to uint8 or a permuted
+       and rotated deconvolution weight, do the same to the new data */
+    if( !tensor->attr.is_created_from_handle &&
+        ( VSI_NN_TYPE_INT4 == tensor->attr.dtype.vx_type ||
+          VSI_NN_TYPE_UINT4 == tensor->attr.dtype.vx_type ) )
+    {
+        /* One element per byte, packed by vsi_nn_CopyDataToTensor() */
+        size = vsi_nn_GetElementNum( tensor );
+    }
+    else
+    {
+        size = vsi_nn_GetTensorSize( tensor->attr.size, tensor->attr.dim_num,
+            tensor->attr.dtype.vx_type );
+    }
+    replayed = (uint8_t *)malloc( size );
+    CHECK_PTR_FAIL_GOTO( replayed, "Create buffer fail.", final );
+    memcpy( replayed, data, size );
+    status = vsi_nn_const_pipeline_replay( graph, tensor, replayed, size );
+    if( VSI_SUCCESS != status )
+    {
+        VSILOGE( "Tensor %u was rewritten at setup, setup the graph again.", id );
+        goto final;
+    }
+
+    status = vsi_nn_CopyDataToTensor( graph, tensor, replayed );
+    if( VSI_SUCCESS != status )
+    {
+        goto final;
+    }
+
+    /*
+        The driver may consume constants when the node is created, recreate
+        the vx nodes reading this one. Nodes not computed yet pick the new
+        data up at setup.
+    */
+    for( i = 0; i < count; i++ )
+    {
+        vsi_nn_node_t * node = nodes[i];
+        if( NULL == node->n )
+        {
+            continue;
+        }
+        if( NULL == inputs )
+        {
+            inputs = allocate_io_buffer( graph );
+            outputs = allocate_io_buffer( graph );
+            if( NULL == inputs || NULL == outputs )
+            {
+                VSILOGE( "allocate io buffer fail" );
+                status = VSI_FAILURE;
+                goto final;
+            }
+        }
+        vxRemoveNode( &node->n );
+        memset( inputs, 0, graph->max_node_io * sizeof( vsi_nn_tensor_t * ) );
+        memset( outputs, 0, graph->max_node_io * sizeof( vsi_nn_tensor_t * ) );
+        vsi_nn_GetTensors( graph, node->input.tensors, node->input.num, inputs );
+        vsi_nn_GetTensors( graph, node->output.tensors, node->output.num, outputs );
+        status = vsi_nn_OpCompute( node->op, node, inputs, outputs );
+        if( VSI_SUCCESS != status )
+        {
+            VSILOGE( "Recreate node %s uid %u fail",
+                vsi_nn_OpGetName( node->op ), node->uid );
+            goto final;
+        }
+        if( VSI_SUCCESS != _set_reference_node_name( graph, node ) )
+        {
+            VSILOGW( "Set reference name fail" );
+        }
+        if( VSI_SUCCESS != vsi_nn_update_node_attr( node ) )
+        {
+            VSILOGW( "Update node attribute fail" );
+        }
+        refreshed++;
+    }
+    if( NULL != node_count )
+    {
+        *node_count = refreshed;
+    }
+
+final:
+    free_io_buffer( inputs );
+    free_io_buffer( outputs );
+    vsi_nn_safe_free( nodes );
+    vsi_nn_safe_free( replayed );
+    return status;
+} /* vsi_nn_UpdateConstTensor() */
+
 vsi_bool vsi_nn_SetGraphInputs
     (
     vsi_nn_graph_t      * graph,
@@ -3277,77 +3478,174 @@ final:
     return status;
 } /* vsi_nn_CopyTensorViaGraphs() */
 
-vsi_status vsi_nn_ExecuteGraphLoop
+static vsi_status _write_loop_index
     (
     vsi_nn_graph_t *graph,
-    vsi_nn_tensor_t *max_iteration_tensor
+    vsi_nn_tensor_t *tensor,
+    int32_t index
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    void *ptr = NULL;
+
+    status = vsi_nn_MapTensorPatch(graph, tensor, &ptr, VSI_NN_WRITE_ONLY);
+    if(VSI_SUCCESS == status && NULL != ptr)
+    {
+        memcpy(ptr, &index, sizeof(index));
+        return vsi_nn_UnmapTensorPatch(graph, tensor);
+    }
+    return vsi_nn_CopyDataToTensor(graph, tensor, &index);
+} /* _write_loop_index() */
+
+static vsi_status _read_loop_cond
+    (
+    vsi_nn_graph_t *graph,
+    vsi_nn_tensor_t *tensor,
+    int8_t *cond
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    void *ptr = NULL;
+    uint8_t buf[sizeof(int64_t)] = { 0 };
+    vsi_size_t stride_size[VSI_NN_MAX_DIM_NUM] = { 0 };
+
+    status = vsi_nn_MapTensorPatch(graph, tensor, &ptr, VSI_NN_READ_ONLY);
+    if(VSI_SUCCESS == status && NULL != ptr)
+    {
+        *cond = ((int8_t *)ptr)[0];
+        return vsi_nn_UnmapTensorPatch(graph, tensor);
+    }
+
+    if(vsi_nn_GetStrideSize(&tensor->attr, stride_size) > sizeof(buf))
+    {
+        VSILOGE("Invalid iteration_cond_out tensor.");
+        return VSI_FAILURE;
+    }
+    if(0 == vsi_nn_CopyTensorToBuffer(graph, tensor, buf))
+    {
+        return VSI_FAILURE;
+    }
+    *cond = (int8_t)buf[0];
+    return VSI_SUCCESS;
+} /* _read_loop_cond() */
+
+static vsi_status _carry_loop_var
+    (
+    vsi_nn_graph_t *graph,
+    vsi_nn_tensor_id_t src_id,
+    vsi_nn_tensor_id_t dst_id
+    )
+{
+    vsi_nn_tensor_t *src = vsi_nn_GetTensor(graph, src_id);
+    vsi_nn_tensor_t *dst = vsi_nn_GetTensor(graph, dst_id);
+    vsi_size_t stride_size[VSI_NN_MAX_DIM_NUM] = { 0 };
+
+    /* Handle backed tensors of equal size just exchange their buffers, the
+       output of this iteration becomes the input of the next one and the
+       old input buffer is reused as the next output. */
+    if(src && dst && src->attr.is_created_from_handle
+        && dst->attr.is_created_from_handle
+        && vsi_nn_GetStrideSize(&src->attr, stride_size)
+            == vsi_nn_GetStrideSize(&dst->attr, stride_size)
+        && vsi_nn_DtypeCompare(&src->attr.dtype, &dst->attr.dtype))
+    {
+        return vsi_nn_SwapTensorHandle(src, dst);
+    }
+    return vsi_nn_CopyTensorViaGraphs(graph, src_id, graph, dst_id);
+} /* _carry_loop_var() */
+
+vsi_status vsi_nn_ExecuteGraphLoopEx
+    (
+    vsi_nn_graph_t *graph,
+    int32_t max_iteration
     )
 {
-    int32_t i,j,loop_var_num,max_iteration;
+    int32_t i,j,loop_var_num;
     vsi_status status = VSI_FAILURE;
     vsi_nn_tensor_t *iteration_index = NULL;
     vsi_nn_tensor_t *iteration_cond_out = NULL;
-    uint8_t *data = NULL;
     int8_t cond = 0;
-    vsi_size_t sz = 0;
 
-    sz = vsi_nn_ShapeProduct(max_iteration_tensor->attr.size, max_iteration_tensor->attr.dim_num);
-    if(1 != sz) // it's shape should be 1.
+    /*
+        Loop Graph inputs: iteration_index, iteration_cond_in, loop_vars...
+        Loop Graph outputs: iteration_cond_out, loop_vars...
+    */
+    if(NULL == graph || graph->input.num < 2
+        || graph->output.num + 1 != graph->input.num)
     {
-        VSILOGE("Invalid max_iteration_tensor.");
+        VSILOGE("Invalid loop graph.");
         return status;
     }
 
     loop_var_num = graph->input.num - 2;
     iteration_index = vsi_nn_GetTensor(graph, graph->input.tensors[0]);
     iteration_cond_out = vsi_nn_GetTensor(graph, graph->output.tensors[0]);
+    TEST_CHECK_PTR(iteration_index, final);
+    TEST_CHECK_PTR(iteration_cond_out, final);
 
-    data = vsi_nn_ConvertTensorToData(NULL, max_iteration_tensor);
-    TEST_CHECK_PTR(data, final);
-    max_iteration = ((int32_t *)data)[0];
-    vsi_nn_safe_free(data);
-
+    status = VSI_SUCCESS;
     for(i=0; i<max_iteration; i++)
     {
-        status = vsi_nn_CopyDataToTensor(graph, iteration_index, &i);
+        if(i > 0)
+        {
+            // Update condition and loop_vars with the last iteration outputs
+            status = _carry_loop_var(graph,
+                graph->output.tensors[0], graph->input.tensors[1]);
+            TEST_CHECK_STATUS(status, final);
+            for(j=0; j<loop_var_num; j++)
+            {
+                status = _carry_loop_var(graph,
+                    graph->output.tensors[j + 1], graph->input.tensors[j + 2]);
+                TEST_CHECK_STATUS(status, final);
+            }
+        }
+
+        status = _write_loop_index(graph, iteration_index, i);
         TEST_CHECK_STATUS(status, final);
 
         status = vsi_nn_RunGraph(graph);
         TEST_CHECK_STATUS(status, final);
 
-        /*
-            Loop Graph inputs: iteration_index, iteration_cond_in, loop_vars...
-            Loop Graph outputs: iteration_cond_out, loop_vars...
-        */
-        data = vsi_nn_ConvertTensorToData(graph, iteration_cond_out);
-        TEST_CHECK_PTR(data, final);
-        cond = ((int8_t *)data)[0];
-        vsi_nn_safe_free(data);
+        status = _read_loop_cond(graph, iteration_cond_out, &cond);
+        TEST_CHECK_STATUS(status, final);
         if(cond == FALSE)
         {
             break;
         }
-
-        // Update condition
-        status = vsi_nn_CopyTensorViaGraphs(
-            graph, graph->output.tensors[0],
-            graph, graph->input.tensors[1]
-        );
-        TEST_CHECK_STATUS(status, final);
-        for(j=0; j<loop_var_num; j++)
-        {
-            // Update loop_vars
-            status = vsi_nn_CopyTensorViaGraphs(
-                graph, graph->output.tensors[j + 1],
-                graph, graph->input.tensors[j + 2]
-            );
-            TEST_CHECK_STATUS(status, final);
-        }
     }
 
 final:
-    vsi_nn_safe_free(data);
     return status;
+} /* vsi_nn_ExecuteGraphLoopEx() */
+
+vsi_status vsi_nn_ExecuteGraphLoop
+    (
+    vsi_nn_graph_t *graph,
+    vsi_nn_tensor_t *max_iteration_tensor
+    )
+{
+    vsi_status status = VSI_FAILURE;
+    int32_t max_iteration = 0;
+    uint8_t buf[sizeof(int64_t)] = { 0 };
+    vsi_size_t stride_size[VSI_NN_MAX_DIM_NUM] = { 0 };
+    vsi_size_t sz = 0;
+
+    sz = vsi_nn_ShapeProduct(max_iteration_tensor->attr.size, max_iteration_tensor->attr.dim_num);
+    if(1 != sz // it's shape should be 1.
+        || vsi_nn_GetStrideSize(&max_iteration_tensor->attr, stride_size) > sizeof(buf))
+    {
+        VSILOGE("Invalid max_iteration_tensor.");
+        return status;
+    }
+
+    if(0 == vsi_nn_CopyTensorToBuffer(NULL, max_iteration_tensor, buf))
+    {
+        VSILOGE("Read max_iteration_tensor fail.");
+        return status;
+    }
+    memcpy(&max_iteration, buf, sizeof(max_iteration));
+
+    return vsi_nn_ExecuteGraphLoopEx(graph, max_iteration);
 } /* vsi_nn_ExecuteGraphLoop() */
 
 
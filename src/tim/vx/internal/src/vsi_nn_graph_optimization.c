@@ -28,6 +28,7 @@
 #include "vsi_nn_graph.h"
 #include "vsi_nn_log.h"
 #include "vsi_nn_error.h"
+#include "utils/vsi_nn_const_pipeline.h"
 
 
 static vsi_bool _is_asymm_int8_norm_tensor
@@ -758,45 +759,6 @@ vx_tensor vsi_nn_CreateRawTensorFromData
     return tensor;
 }/* vsi_nn_CreateRawTensorFromData() */
 
-static void _convert_const_I8toU8
-    (
-    vsi_nn_graph_t* graph,
-    vsi_nn_tensor_id_t id
-    )
-{
-    uint8_t    * data = NULL;
-    vsi_nn_tensor_t * tensor = vsi_nn_GetTensor(graph, id);
-    vsi_nn_tensor_attr_t *attr = NULL;
-    vsi_size_t sz = 0;
-    vsi_size_t i = 0;
-
-    CHECK_PTR_FAIL_GOTO( tensor, "Get tensor fail.", final );
-    attr = &tensor->attr;
-
-    sz = vsi_nn_GetElementNum( tensor );
-
-    data = vsi_nn_ConvertTensorToData( graph, tensor );
-    if ( NULL == data )
-    {
-        VSILOGE( "Convert data fail." );
-        return ;
-    }
-
-    for ( i = 0; i < sz; i++ )
-    {
-        data[i] = data[i] ^ 0x80;
-    }
-
-    attr->dtype.vx_type = VSI_NN_TYPE_UINT8;
-    attr->dtype.zero_point += 128;
-
-    if ( tensor->t ) vxReleaseTensor(&tensor->t);
-    tensor->t = vsi_nn_CreateRawTensorFromData(graph, data, attr);
-
-final:
-    vsi_nn_safe_free( data );
-}/* _convert_const_I8toU8() */
-
 static vsi_status _convert_graph_const_tensor
     (
     vsi_nn_graph_t* graph
@@ -805,9 +767,13 @@ static vsi_status _convert_graph_const_tensor
     vsi_status status = VSI_FAILURE;
     uint32_t node_num = graph->node_num;
     vsi_nn_node_t* node = NULL;
+    vsi_nn_const_pipeline_t* pipeline = NULL;
     uint32_t i = 0;
     uint32_t j = 0;
 
+    pipeline = vsi_nn_const_pipeline_create( graph );
+    CHECK_PTR_FAIL_GOTO( pipeline, "Create const pipeline fail.", final );
+
     for(i = 0; i < node_num; i++)
     {
         node = vsi_nn_GetNode(graph, i);
@@ -818,15 +784,19 @@ static vsi_status _convert_graph_const_tensor
            vsi_nn_tensor_id_t id = node->input.tensors[j];
            vsi_nn_tensor_t * tensor = vsi_nn_GetTensor(graph, id);
 
-           if (_is_asymm_int8_const_tensor(tensor))
+           if (_is_asymm_int8_const_tensor(tensor)
+               && !vsi_nn_const_pipeline_contains(pipeline, tensor))
            {
-               _convert_const_I8toU8(graph, id);
+               status = vsi_nn_const_pipeline_add(pipeline, tensor,
+                   vsi_nn_const_transform_i8_to_u8, NULL, 0);
+               CHECK_STATUS_FAIL_GOTO(status, final);
            }
         }
     }
-    status = VSI_SUCCESS;
+    status = vsi_nn_const_pipeline_run(pipeline, NULL);
 
 final:
+    vsi_nn_const_pipeline_release(&pipeline);
     return status;
 } /* _convert_graph_const_tensor() */
 
@@ -61,58 +61,31 @@ static vsi_nn_internal_node_t* vsi_nn_internal_create_node
 {
     vsi_nn_internal_node_t* node = NULL;
     vsi_nn_node_t* n = NULL;
-    vsi_nn_tensor_t** inputs = NULL;
-    vsi_nn_tensor_t** outputs = NULL;
+    vsi_nn_tensor_t** io = NULL;
 
-    node = (vsi_nn_internal_node_t *)malloc( sizeof(vsi_nn_internal_node_t) );
-    if( node )
+    n = vsi_nn_NewNode( graph, op, input_num, output_num );
+    if( NULL == n )
     {
-        memset(node, 0x00, sizeof(vsi_nn_internal_node_t) );
-
-        n = vsi_nn_NewNode( graph, op, input_num, output_num );
-        if( n )
-        {
-            inputs = (vsi_nn_tensor_t **)malloc( n->input.num * sizeof(vsi_nn_tensor_t*));
-            if( inputs )
-            {
-                memset( inputs, 0x00, ( n->input.num * sizeof(vsi_nn_tensor_t*)) );
-            }
-            outputs = (vsi_nn_tensor_t **)malloc( n->output.num * sizeof(vsi_nn_tensor_t*));
-            if( outputs )
-            {
-                memset( outputs, 0x00, ( n->output.num * sizeof(vsi_nn_tensor_t*)) );
-            }
-        }
+        return NULL;
     }
 
-    if( node && n && inputs && outputs )
-    {
-        node->node = n;
-        node->inputs = inputs;
-        node->outputs = outputs;
-
-        return node;
-    }
-    else
+    /* Node and its input/output arrays share one graph-lifetime arena
+     * allocation, they are never freed one by one. */
+    node = (vsi_nn_internal_node_t *)vsi_nn_graph_arena_alloc( graph,
+        sizeof(vsi_nn_internal_node_t) +
+        ( n->input.num + n->output.num ) * sizeof(vsi_nn_tensor_t*) );
+    if( NULL == node )
     {
-        if(n)
-        {
-            vsi_nn_ReleaseNode(&n);
-            n = NULL;
-        }
-        if(inputs)
-        {
-            free(inputs);
-            inputs = NULL;
-        }
-        if(outputs)
-        {
-            free(outputs);
-            outputs = NULL;
-        }
-        vsi_nn_internal_release_node( &node );
+        vsi_nn_ReleaseNode( &n );
         return NULL;
     }
+
+    io = (vsi_nn_tensor_t **)(node + 1);
+    node->node = n;
+    node->inputs = io;
+    node->outputs = io + n->input.num;
+
+    return node;
 } /* vsi_nn_internal_create_node() */
 
 static vsi_nn_internal_tensor_t* vsi_nn_internal_create_tensor
@@ -129,10 +102,10 @@ static vsi_nn_internal_tensor_t* vsi_nn_internal_create_tensor
         return tensor;
     }
 
-    tensor = (vsi_nn_internal_tensor_t *)malloc( sizeof(vsi_nn_internal_tensor_t) );
+    tensor = (vsi_nn_internal_tensor_t *)vsi_nn_graph_arena_alloc( graph,
+        sizeof(vsi_nn_internal_tensor_t) );
     if( tensor )
     {
-        memset( tensor, 0x00, sizeof(vsi_nn_internal_tensor_t) );
         if( attr->is_const )
         {
             tensor->t = vsi_nn_CreateTensorWithDefault( graph, attr, default_value );
@@ -314,7 +287,6 @@ vsi_status vsi_nn_internal_deinit_node_wksp
             vsi_nn_internal_release_tensor( &tensor_curr );
         }
 
-        free( node->internal_node_wksp );
         node->internal_node_wksp = NULL;
     }
 
@@ -421,10 +393,10 @@ vsi_status vsi_nn_internal_init_node_wksp
         vsi_nn_internal_deinit_node_wksp( node );
     }
 
-    wksp = (vsi_nn_internal_node_wksp_t *)malloc( sizeof( vsi_nn_internal_node_wksp_t ) );
+    wksp = (vsi_nn_internal_node_wksp_t *)vsi_nn_graph_arena_alloc( node->graph,
+        sizeof( vsi_nn_internal_node_wksp_t ) );
     if( wksp )
     {
-        memset( wksp, 0x00, sizeof( vsi_nn_internal_node_wksp_t ) );
         wksp->curr_node_uid = 1;
 
         node->internal_node_wksp = wksp;
@@ -496,10 +468,10 @@ void* vsi_nn_internal_new_node_param
         return ptr;
     }
 
-    param = (vsi_nn_internal_node_param_t *)malloc(buf_sz);
+    param = (vsi_nn_internal_node_param_t *)vsi_nn_graph_arena_alloc(
+        inode->node->graph, buf_sz );
     if( param )
     {
-        memset( param, 0x00, buf_sz );
         ptr = (void *)(&param->param[0]);
         LINKLIST_APPEND(inode->param, param);
     }
@@ -535,26 +507,15 @@ vsi_status vsi_nn_internal_release_node
     {
         vsi_nn_internal_node_t* ptr = *node;
 
-        if( ptr->inputs && ptr->node->input.num )
-        {
-            free( ptr->inputs );
-            ptr->inputs = NULL;
-        }
-        if( ptr->outputs && ptr->node->output.num )
-        {
-            free( ptr->outputs );
-            ptr->outputs = NULL;
-        }
-        if( ptr->param )
-        {
-            vsi_nn_LinkListDeinit((vsi_nn_link_list_t *)(ptr->param), NULL);
-        }
+        /* The node, its io arrays and params are arena memory. */
+        ptr->inputs = NULL;
+        ptr->outputs = NULL;
+        ptr->param = NULL;
         if( ptr->node )
         {
             vsi_nn_ReleaseNode( &ptr->node );
         }
 
-        free( ptr );
         *node = NULL;
     }
 
@@ -574,7 +535,6 @@ vsi_status vsi_nn_internal_release_tensor
         {
             vsi_nn_ReleaseTensor( &ptr->t );
         }
-        free( ptr );
         *tensor = NULL;
     }
 
@@ -41,6 +41,7 @@
 #include "utils/vsi_nn_dtype_util_prv.h"
 #include "utils/vsi_nn_tensor_op.h"
 #include "vsi_nn_error.h"
+#include "utils/vsi_nn_const_pipeline.h"
 
 static vsi_bool _try_set_const_tensor
     (
@@ -1959,6 +1960,10 @@ void vsi_nn_TransposeTensor
         VSILOGE( "Wrong perm dims." );
         return;
     }
+    if( tensor->attr.is_const )
+    {
+        vsi_nn_const_pipeline_record_rewrite( graph, tensor );
+    }
     tensor_sz = vsi_nn_GetTensorSize( tensor->attr.size, tensor->attr.dim_num,
         tensor->attr.dtype.vx_type );
     shape_ptr = tensor->attr.size;
@@ -2071,6 +2076,10 @@ void vsi_nn_PermuteTensor
         VSILOGE( "Wrong perm parameters." );
         return;
     }
+    if( tensor->attr.is_const )
+    {
+        vsi_nn_const_pipeline_record_rewrite( graph, tensor );
+    }
     tensor_sz = vsi_nn_GetTensorSize( tensor->attr.size, tensor->attr.dim_num,
         tensor->attr.dtype.vx_type );
     shape_ptr = tensor->attr.size;
@@ -2787,68 +2796,24 @@ void vsi_nn_reshuffle_weight_data
     vsi_nn_tensor_t * weights
     )
 {
-    vsi_ssize_t b, sy, sx, c, h, w;
-    uint8_t* weight_data = NULL;
-    uint8_t* reshuffled_weights = NULL;
-    uint8_t* buffer = NULL;
-    vsi_ssize_t kernel_size_x = weights->attr.size[0];
-    vsi_ssize_t kernel_size_y = weights->attr.size[1];
-    vsi_ssize_t weight_size_c = weights->attr.size[2];
-    vsi_ssize_t weight_size_b = weights->attr.size[3];
-    vsi_ssize_t slice_size = kernel_size_x * kernel_size_y;
-    int32_t item_size = vsi_nn_TypeGetBytes(weights->attr.dtype.vx_type);
-
-    weight_data = vsi_nn_ConvertTensorToData(graph, weights);
-    CHECK_PTR_FAIL_GOTO( weight_data, "Create weight_data fail.", final );
-    buffer = (uint8_t*)malloc(item_size * slice_size * weight_size_c * weight_size_b);
-    CHECK_PTR_FAIL_GOTO( buffer, "Create buffer fail.", final );
-    memset(buffer, 0x00, item_size * slice_size * weight_size_c * weight_size_b);
-    memcpy(buffer, weight_data, item_size * slice_size * weight_size_c * weight_size_b);
-#if 0 // transpose whnc to whcn if need
-    for (b = 0; b < weight_size_b; b++)
-    {
-        for (c = 0; c < weight_size_c; c++)
-        {
-            memcpy(buffer + kernel_size_x * kernel_size_y * (c * weight_size_b + b) * item_size,
-                weight_data + kernel_size_x * kernel_size_y * (b * weight_size_c + c) * item_size,
-                item_size * slice_size);
-        }
-    }
-#endif
-    reshuffled_weights = weight_data;
-    for (b = 0; b < weight_size_b; b++)
-    {
-        for (sy = 0; sy < 1; sy++)
-        {
-            for (sx = 0; sx < 1; sx++)
-            {
-                for (c = 0; c < weight_size_c; c++)
-                {
-                    uint8_t* weight_output = reshuffled_weights +
-                        (b * slice_size * weight_size_c + slice_size * c) * item_size;
+    vsi_nn_const_pipeline_t * pipeline = NULL;
+    vsi_status status = VSI_FAILURE;
 
-                    uint8_t* data = buffer + (b * slice_size * weight_size_c + slice_size * c) * item_size;
+    pipeline = vsi_nn_const_pipeline_create( graph );
+    CHECK_PTR_FAIL_GOTO( pipeline, "Create const pipeline fail.", final );
 
-                    for (h = 0; h < kernel_size_y; h++)
-                    {
-                        for (w = 0; w < kernel_size_x; w++)
-                        {
-                            uint8_t* reshuffled_output = weight_output + (h * kernel_size_x + w) * item_size;
-                            vsi_ssize_t input_index = ((kernel_size_y - 1 - h) + sy) * kernel_size_x +
-                                ((kernel_size_x - 1 - w) + sx);
-
-                            memcpy(reshuffled_output, data + input_index * item_size, item_size);
-                        }
-                    }
-                }
-            }
-        }
+    /* Rotate 180 degrees for weights data */
+    status = vsi_nn_const_pipeline_add( pipeline, weights,
+        vsi_nn_const_transform_rotate_180, NULL, 0 );
+    CHECK_STATUS_FAIL_GOTO( status, final );
+    status = vsi_nn_const_pipeline_run( pipeline, NULL );
+    if( VSI_SUCCESS != status )
+    {
+        VSILOGE( "Reshuffle weight data fail." );
     }
-    vsi_nn_CopyDataToTensor( graph, weights, weight_data );
 
 final:
-    vsi_nn_Free( buffer );
-    vsi_nn_safe_free( weight_data );
+    vsi_nn_const_pipeline_release( &pipeline );
 }
 
 vsi_nn_tensor_t* vsi_nn_ConcatTensor_impl
@@ -28,6 +28,7 @@
 #include "vsi_nn_graph.h"
 #include "vsi_nn_node.h"
 #include "vsi_nn_tensor.h"
+#include "utils/vsi_nn_arena.h"
 
 #if defined(__cplusplus)
 extern "C"{
@@ -58,6 +59,18 @@ typedef struct _vsi_nn_graph_prv
 
     // Add graph internal attribute here...
     vsi_nn_swap_handle_cache_t swap_handle_cache;
+
+    /** Graph-lifetime allocations (internal nodes, link list items),
+     *  created on first use and freed in bulk by vsi_nn_ReleaseGraph. */
+    vsi_nn_arena_t* arena;
+
+    /** Rewrites applied to const tensors at setup, replayed on new data by
+     *  vsi_nn_UpdateConstTensor. Items live in the arena. */
+    struct _vsi_nn_const_history* const_history;
+
+    /** Set when a setup rewrite could not be recorded, const tensors of
+     *  the graph can't be replayed any more. */
+    vsi_bool const_history_incomplete;
 } vsi_nn_graph_prv_t;
 
 /** Internal Node structure, internal use only. */
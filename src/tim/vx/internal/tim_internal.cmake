@@ -35,8 +35,9 @@ aux_source_directory(./vx/internal/src/libnnext INTERNAL_LIBNNEXT)
 aux_source_directory(./vx/internal/src/quantization INTERNAL_QUANTIZATION)
 aux_source_directory(./vx/internal/src/custom/ops INTERNAL_CUSTOM_OPS)
 aux_source_directory(./vx/internal/src/custom/ops/kernel INTERNAL_CUSTOM_OPS_KERNEL)
+aux_source_directory(./vx/internal/src/custom/ops/kernel/cpu INTERNAL_CUSTOM_OPS_KERNEL_CPU)
 aux_source_directory(./vx/internal/src/utils INTERNAL_UTILS)
-aux_source_directory(./vx/internal/src/POST POST)
+aux_source_directory(./vx/internal/src/post POST)
 
 list(APPEND ${TARGET_NAME}_SRCS
     ${INTERNAL_SRC}
@@ -49,6 +50,7 @@ list(APPEND ${TARGET_NAME}_SRCS
     ${INTERNAL_QUANTIZATION}
     ${INTERNAL_CUSTOM_OPS}
     ${INTERNAL_CUSTOM_OPS_KERNEL}
+    ${INTERNAL_CUSTOM_OPS_KERNEL_CPU}
     ${INTERNAL_UTILS}
     ${POST}
 )
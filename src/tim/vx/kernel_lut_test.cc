@@ -0,0 +1,92 @@
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "vsi_nn_pub.h"
+#include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_lut.h"
+
+namespace {
+
+vsi_nn_kernel_lut_params HSigmoidParams(float alpha, float beta) {
+  vsi_nn_kernel_lut_params params;
+  memset(&params, 0, sizeof(params));
+  params.act_type = VSI_NN_KERNEL_LUT_HSIGMOID;
+  params.params[0] = alpha;
+  params.params[1] = beta;
+  return params;
+}
+
+void ExpectSameTable(vsi_nn_kernel_lut_params params) {
+  std::vector<float> index(VSI_NN_KERNEL_LUT_MAX_SIZE);
+  std::vector<float> value(VSI_NN_KERNEL_LUT_MAX_SIZE);
+  const float* cached_index = nullptr;
+  const float* cached_value = nullptr;
+  ASSERT_EQ(VSI_SUCCESS,
+            vsi_nn_kernel_lut_generate(&params, index.data(), value.data()));
+  ASSERT_EQ(VSI_SUCCESS,
+            vsi_nn_kernel_lut_cached(&params, &cached_index, &cached_value));
+  EXPECT_EQ(0, memcmp(index.data(), cached_index,
+                      index.size() * sizeof(float)));
+  EXPECT_EQ(0, memcmp(value.data(), cached_value,
+                      value.size() * sizeof(float)));
+}
+
+}  // namespace
+
+TEST(kernel_lut, cache_hit_matches_fresh_build) {
+  vsi_nn_kernel_lut_params params = HSigmoidParams(0.2f, 0.5f);
+  const float* index = nullptr;
+  const float* value = nullptr;
+  const float* hit_index = nullptr;
+  const float* hit_value = nullptr;
+
+  ASSERT_EQ(VSI_SUCCESS, vsi_nn_kernel_lut_cached(&params, &index, &value));
+  ASSERT_EQ(VSI_SUCCESS,
+            vsi_nn_kernel_lut_cached(&params, &hit_index, &hit_value));
+  EXPECT_EQ(index, hit_index);
+  EXPECT_EQ(value, hit_value);
+  ExpectSameTable(params);
+
+  // The positive only table of a clamped activation is cached as well.
+  vsi_nn_kernel_lut_params clip;
+  memset(&clip, 0, sizeof(clip));
+  clip.act_type = VSI_NN_KERNEL_LUT_CLIP;
+  clip.pwl_sign_remove_support = TRUE;
+  clip.params[0] = 0.0f;
+  clip.params[1] = 6.0f;
+  ExpectSameTable(clip);
+}
+
+TEST(kernel_lut, different_params_do_not_share_entry) {
+  // Same activation, different alpha, then different beta.
+  vsi_nn_kernel_lut_params a = HSigmoidParams(0.2f, 0.5f);
+  vsi_nn_kernel_lut_params b = HSigmoidParams(0.25f, 0.5f);
+  vsi_nn_kernel_lut_params c = HSigmoidParams(0.2f, 0.4f);
+  const float* index[3] = {nullptr, nullptr, nullptr};
+  const float* value[3] = {nullptr, nullptr, nullptr};
+
+  ASSERT_EQ(VSI_SUCCESS, vsi_nn_kernel_lut_cached(&a, &index[0], &value[0]));
+  ASSERT_EQ(VSI_SUCCESS, vsi_nn_kernel_lut_cached(&b, &index[1], &value[1]));
+  ASSERT_EQ(VSI_SUCCESS, vsi_nn_kernel_lut_cached(&c, &index[2], &value[2]));
+  EXPECT_NE(value[0], value[1]);
+  EXPECT_NE(value[0], value[2]);
+  EXPECT_NE(value[1], value[2]);
+  EXPECT_NE(0, memcmp(value[0], value[1],
+                      VSI_NN_KERNEL_LUT_MAX_SIZE * sizeof(float)));
+  EXPECT_NE(0, memcmp(value[0], value[2],
+                      VSI_NN_KERNEL_LUT_MAX_SIZE * sizeof(float)));
+  ExpectSameTable(a);
+  ExpectSameTable(b);
+  ExpectSameTable(c);
+
+  // The activation type is part of the key too.
+  vsi_nn_kernel_lut_params selu = a;
+  selu.act_type = VSI_NN_KERNEL_LUT_SELU;
+  const float* selu_index = nullptr;
+  const float* selu_value = nullptr;
+  ASSERT_EQ(VSI_SUCCESS,
+            vsi_nn_kernel_lut_cached(&selu, &selu_index, &selu_value));
+  EXPECT_NE(value[0], selu_value);
+  ExpectSameTable(selu);
+}
@@ -0,0 +1,142 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "vsi_nn_pub.h"
+#include "kernel/vsi_nn_kernel.h"
+#include "kernel/vsi_nn_kernel_tuning.h"
+
+namespace {
+
+struct TuningTensor {
+  TuningTensor(const std::vector<vsi_size_t>& shape, vsi_nn_type_e dtype) {
+    memset(&tensor, 0, sizeof(tensor));
+    tensor.attr.dim_num = shape.size();
+    for (size_t i = 0; i < shape.size(); i++) {
+      tensor.attr.size[i] = shape[i];
+    }
+    tensor.attr.dtype.vx_type = dtype;
+  }
+
+  vsi_nn_tensor_t tensor;
+};
+
+std::string MakeKey(const char* name, TuningTensor& input,
+                    TuningTensor& output, vsi_nn_kernel_param_t* params) {
+  char key[VSI_NN_KERNEL_TUNING_KEY_SIZE];
+  vsi_nn_tensor_t* inputs[] = {&input.tensor};
+  vsi_nn_tensor_t* outputs[] = {&output.tensor};
+  EXPECT_TRUE(vsi_nn_kernel_tuning_make_key(key, sizeof(key), name, inputs, 1,
+                                            outputs, 1, params));
+  return key;
+}
+
+vsi_nn_kernel_selector_t MakeSelector() {
+  vsi_nn_kernel_selector_t selector;
+  memset(&selector, 0, sizeof(selector));
+  selector.pirority[0] = {VSI_NN_KERNEL_TYPE_EVIS, 3};
+  selector.pirority[1] = {VSI_NN_KERNEL_TYPE_CL, 2};
+  selector.pirority[2] = {VSI_NN_KERNEL_TYPE_CPU, 1};
+  selector.allow_kernel_num = 3;
+  return selector;
+}
+
+// Records are appended to the configured database file, keep it clean.
+bool TuningDbConfigured() {
+  const char* path = getenv("VSI_NN_KERNEL_TUNING_DB");
+  return path && path[0] != '\0';
+}
+
+}  // namespace
+
+TEST(kernel_tuning, key_includes_shapes_dtypes_and_params) {
+  TuningTensor in_f32({4, 3}, VSI_NN_TYPE_FLOAT32);
+  TuningTensor in_f16({4, 3}, VSI_NN_TYPE_FLOAT16);
+  TuningTensor in_wide({8, 3}, VSI_NN_TYPE_FLOAT32);
+  TuningTensor out({4, 3}, VSI_NN_TYPE_FLOAT32);
+  vsi_nn_kernel_param_t* axis0 = vsi_nn_kernel_param_create();
+  vsi_nn_kernel_param_t* axis1 = vsi_nn_kernel_param_create();
+  vsi_nn_kernel_param_add_int32(axis0, "axis", 0);
+  vsi_nn_kernel_param_add_int32(axis1, "axis", 1);
+
+  std::string base = MakeKey("softmax", in_f32, out, axis0);
+  EXPECT_EQ(base, MakeKey("softmax", in_f32, out, axis0));
+  EXPECT_NE(base, MakeKey("softmax", in_wide, out, axis0));
+  EXPECT_NE(base, MakeKey("softmax", in_f16, out, axis0));
+  EXPECT_NE(base, MakeKey("softmax", in_f32, out, axis1));
+  EXPECT_NE(base, MakeKey("softmax", in_f32, out, nullptr));
+  EXPECT_NE(base, MakeKey("erf", in_f32, out, axis0));
+
+  vsi_nn_kernel_param_release(&axis0);
+  vsi_nn_kernel_param_release(&axis1);
+}
+
+TEST(kernel_tuning, record_reorders_selector) {
+  if (TuningDbConfigured()) {
+    GTEST_SKIP() << "VSI_NN_KERNEL_TUNING_DB is set";
+  }
+  TuningTensor input({16, 2}, VSI_NN_TYPE_FLOAT32);
+  TuningTensor output({16, 2}, VSI_NN_TYPE_FLOAT32);
+  std::string key =
+      MakeKey("kernel_tuning_test_reorder", input, output, nullptr);
+  vsi_nn_kernel_type_e type = VSI_NN_KERNEL_TYPE_NONE;
+  vsi_nn_kernel_selector_t selector = MakeSelector();
+
+  EXPECT_FALSE(vsi_nn_kernel_tuning_query(key.c_str(), &type));
+  vsi_nn_kernel_tuning_update(key.c_str(), VSI_NN_KERNEL_TYPE_CL);
+  ASSERT_TRUE(vsi_nn_kernel_tuning_query(key.c_str(), &type));
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CL, type);
+
+  EXPECT_TRUE(vsi_nn_kernel_tuning_reorder(key.c_str(), &selector));
+  EXPECT_EQ(3, selector.allow_kernel_num);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CL, selector.pirority[0].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_EVIS, selector.pirority[1].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CPU, selector.pirority[2].kernel_type);
+  EXPECT_EQ(2, selector.pirority[0].fps);
+
+  // A later record overrides the earlier one.
+  vsi_nn_kernel_tuning_update(key.c_str(), VSI_NN_KERNEL_TYPE_CPU);
+  EXPECT_TRUE(vsi_nn_kernel_tuning_reorder(key.c_str(), &selector));
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CPU, selector.pirority[0].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CL, selector.pirority[1].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_EVIS, selector.pirority[2].kernel_type);
+}
+
+TEST(kernel_tuning, many_records_stay_reachable) {
+  if (TuningDbConfigured()) {
+    GTEST_SKIP() << "VSI_NN_KERNEL_TUNING_DB is set";
+  }
+  const int count = 1000;
+  for (int i = 0; i < count; i++) {
+    std::string key = "kernel_tuning_test_many|" + std::to_string(i);
+    vsi_nn_kernel_tuning_update(key.c_str(), i % 2 ? VSI_NN_KERNEL_TYPE_CL
+                                                   : VSI_NN_KERNEL_TYPE_CPU);
+  }
+  for (int i = 0; i < count; i++) {
+    std::string key = "kernel_tuning_test_many|" + std::to_string(i);
+    vsi_nn_kernel_type_e type = VSI_NN_KERNEL_TYPE_NONE;
+    ASSERT_TRUE(vsi_nn_kernel_tuning_query(key.c_str(), &type)) << key;
+    EXPECT_EQ(i % 2 ? VSI_NN_KERNEL_TYPE_CL : VSI_NN_KERNEL_TYPE_CPU, type);
+  }
+}
+
+TEST(kernel_tuning, disabled_is_noop) {
+  if (TuningDbConfigured()) {
+    GTEST_SKIP() << "VSI_NN_KERNEL_TUNING_DB is set";
+  }
+  _vsi_nn_context_t ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  vsi_nn_kernel_selector_t selector = MakeSelector();
+
+  EXPECT_FALSE(vsi_nn_kernel_tuning_active(&ctx));
+  EXPECT_FALSE(
+      vsi_nn_kernel_tuning_reorder("kernel_tuning_test_missing|", &selector));
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_EVIS, selector.pirority[0].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CL, selector.pirority[1].kernel_type);
+  EXPECT_EQ(VSI_NN_KERNEL_TYPE_CPU, selector.pirority[2].kernel_type);
+
+  ctx.options.enable_kernel_tuning = 1;
+  EXPECT_TRUE(vsi_nn_kernel_tuning_active(&ctx));
+}
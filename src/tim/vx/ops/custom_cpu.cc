@@ -0,0 +1,405 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifdef TIM_VX_ENABLE_CUSTOM_OP
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "tim/vx/ops.h"
+#include "builtin_op_impl.h"
+#include "vsi_nn_pub.h"
+
+#include "kernel/vsi_nn_kernel.h"
+#include "libnnext/vsi_nn_vxkernel.h"
+
+namespace tim {
+namespace vx {
+namespace ops {
+
+namespace {
+
+class HostThreadPool {
+ public:
+  static HostThreadPool& Get() {
+    static HostThreadPool pool;
+    return pool;
+  }
+
+  size_t Concurrency() const { return workers_.size() + 1; }
+
+  void ParallelFor(size_t count,
+                   const std::function<void(size_t, size_t)>& func,
+                   size_t grain) {
+    if (count == 0) {
+      return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = std::min((count + grain - 1) / grain, Concurrency());
+    if (chunks <= 1 || in_parallel_region_) {
+      func(0, count);
+      return;
+    }
+
+    struct Job {
+      std::atomic<size_t> next{0};
+      std::atomic<bool> failed{false};
+      size_t done = 0;
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable finished;
+    };
+    auto job = std::make_shared<Job>();
+    size_t chunk_size = (count + chunks - 1) / chunks;
+    // Exceptions never leave run(): a worker would terminate, and the
+    // caller would return while workers still use func. The first one is
+    // rethrown on the caller thread once every chunk is accounted for.
+    auto run = [job, chunks, chunk_size, count, &func]() {
+      size_t chunk;
+      in_parallel_region_ = true;
+      while ((chunk = job->next++) < chunks) {
+        size_t begin = chunk * chunk_size;
+        size_t end = std::min(begin + chunk_size, count);
+        std::exception_ptr error;
+        if (begin < end && !job->failed) {
+          try {
+            func(begin, end);
+          } catch (...) {
+            error = std::current_exception();
+          }
+        }
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (error && !job->error) {
+          job->error = error;
+          job->failed = true;
+        }
+        if (++job->done == chunks) {
+          job->finished.notify_all();
+        }
+      }
+      in_parallel_region_ = false;
+    };
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 1; i < chunks; ++i) {
+        tasks_.push_back(run);
+      }
+    }
+    wakeup_.notify_all();
+    run();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job, chunks]() { return job->done == chunks; });
+    if (job->error) {
+      std::rethrow_exception(job->error);
+    }
+  }
+
+ private:
+  HostThreadPool() : stop_(false) {
+    size_t threads = std::thread::hardware_concurrency();
+    for (size_t i = 1; i < threads; ++i) {
+      workers_.emplace_back(&HostThreadPool::Work, this);
+    }
+  }
+
+  ~HostThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void Work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wakeup_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  static thread_local bool in_parallel_region_;
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool stop_;
+};
+
+thread_local bool HostThreadPool::in_parallel_region_ = false;
+
+std::mutex node_op_mutex_;
+std::map<void*, CustomCpuOp*> node_op_map_;
+
+DataType ToDataType(vsi_nn_kernel_dtype_e dtype) {
+  switch (dtype) {
+    case I4:
+      return DataType::INT4;
+    case U4:
+      return DataType::UINT4;
+    case I8:
+      return DataType::INT8;
+    case U8:
+      return DataType::UINT8;
+    case I16:
+      return DataType::INT16;
+    case U16:
+      return DataType::UINT16;
+    case I32:
+      return DataType::INT32;
+    case U32:
+      return DataType::UINT32;
+    case I64:
+      return DataType::INT64;
+    case F16:
+      return DataType::FLOAT16;
+    case F32:
+      return DataType::FLOAT32;
+    case BOOL8:
+      return DataType::BOOL8;
+    default:
+      break;
+  }
+  return DataType::UNKNOWN;
+}
+
+// Kernel ids of CPU custom ops live in the upper half of the ovxlib range
+uint32_t KernelId(const std::string& name) {
+  static std::mutex mutex;
+  static std::map<std::string, uint32_t> ids;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iter = ids.find(name);
+  if (iter != ids.end()) {
+    return iter->second;
+  }
+  uint32_t id = KERNEL_ID_OVXLIB_START + 0x800 + (uint32_t)ids.size();
+  ids.insert(std::make_pair(name, id));
+  return id;
+}
+
+}  // namespace
+
+static vsi_bool op_setup(vsi_nn_node_t* self, vsi_nn_tensor_t** inputs,
+                         vsi_nn_tensor_t** outputs);
+
+static vsi_bool op_compute(vsi_nn_node_t* self, vsi_nn_tensor_t** inputs,
+                           vsi_nn_tensor_t** outputs);
+
+DEF_KERNEL_EXECUTOR(cpu_kernel_function)
+(vsi_nn_kernel_node_t node, const vsi_nn_kernel_node_param_t* param,
+ size_t param_size) {
+  CustomCpuOp* op_this = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(node_op_mutex_);
+    auto iter = node_op_map_.find(reinterpret_cast<void*>(node));
+    if (iter != node_op_map_.end()) {
+      op_this = iter->second;
+    }
+  }
+  if (!op_this || param_size != op_this->input_num_ + op_this->output_num_) {
+    VSILOGE("Can not find cpu custom op for node");
+    return VSI_FAILURE;
+  }
+
+  vsi_status status = VSI_FAILURE;
+  std::vector<vsi_nn_kernel_tensor_attr_t*> attrs(param_size, nullptr);
+  std::vector<CpuTensorSpan> inputs(op_this->input_num_);
+  std::vector<CpuTensorSpan> outputs(op_this->output_num_);
+  for (size_t i = 0; i < param_size; i++) {
+    auto tensor = reinterpret_cast<vsi_nn_kernel_tensor_t>(param[i]);
+    attrs[i] = vsi_nn_kernel_tensor_attr_create(tensor);
+    if (!attrs[i]) {
+      VSILOGE("Create tensor attr fail");
+      goto final;
+    }
+    CpuTensorSpan& span = i < op_this->input_num_
+                              ? inputs[i]
+                              : outputs[i - op_this->input_num_];
+    span.size_in_bytes = vsi_nn_kernel_tensor_attr_get_bytes(attrs[i]);
+    span.type = ToDataType(attrs[i]->dtype);
+    span.shape.assign(attrs[i]->shape->data,
+                      attrs[i]->shape->data + attrs[i]->shape->size);
+    if (i < op_this->input_num_) {
+      span.data = vsi_nn_kernel_tensor_create_buffer(tensor, attrs[i], FALSE);
+    } else {
+      span.data = calloc(1, span.size_in_bytes);
+    }
+    if (!span.data) {
+      VSILOGE("Map tensor %zu of %s fail", i, op_this->func_name_);
+      goto final;
+    }
+  }
+
+  if (!op_this->Compute(inputs, outputs)) {
+    VSILOGE("Compute cpu custom op %s fail", op_this->func_name_);
+    goto final;
+  }
+
+  status = VSI_SUCCESS;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    size_t index = op_this->input_num_ + i;
+    status |= vsi_nn_kernel_tensor_write(
+        reinterpret_cast<vsi_nn_kernel_tensor_t>(param[index]), attrs[index],
+        outputs[i].data, outputs[i].size_in_bytes);
+  }
+
+final:
+  for (auto& span : inputs) {
+    free(span.data);
+  }
+  for (auto& span : outputs) {
+    free(span.data);
+  }
+  for (auto& attr : attrs) {
+    vsi_nn_kernel_tensor_attr_release(&attr);
+  }
+  return status;
+}
+
+CustomCpuOp::CustomCpuOp(Graph* graph, uint32_t input_num, uint32_t output_num,
+                         int32_t kernel_id, const char* kernel_name)
+    : func_name_(kernel_name),
+      vx_node_(nullptr),
+      input_num_(input_num),
+      output_num_(output_num) {
+  vsi_nn_op_proc_t proc = {NULL,     op_compute, NULL,       NULL,
+                           op_setup, NULL,       input_num_, output_num_};
+  this->impl() = std::make_unique<CustomOpBaseImpl>(
+      graph, kernel_id, reinterpret_cast<void*>(&proc), kernel_name);
+  this->impl()->node()->nn_param.client_param = reinterpret_cast<void*>(this);
+}
+
+CustomCpuOp::~CustomCpuOp() {
+  std::lock_guard<std::mutex> lock(node_op_mutex_);
+  node_op_map_.erase(this->vx_node_);
+}
+
+void CustomCpuOp::ParallelFor(size_t count,
+                              const std::function<void(size_t, size_t)>& func,
+                              size_t grain) {
+  HostThreadPool::Get().ParallelFor(count, func, grain);
+}
+
+size_t CustomCpuOp::Concurrency() {
+  return HostThreadPool::Get().Concurrency();
+}
+
+vsi_bool op_setup(vsi_nn_node_t* self, vsi_nn_tensor_t** inputs,
+                  vsi_nn_tensor_t** outputs) {
+  CustomCpuOp* op_this =
+      reinterpret_cast<CustomCpuOp*>(self->nn_param.client_param);
+
+  op_this->inputs_size_.clear();
+  op_this->outputs_size_.clear();
+  op_this->outputs_size_.resize(op_this->output_num_);
+  for (uint32_t i = 0; i < op_this->input_num_; i++) {
+    std::vector<uint32_t> input_size;
+    for (uint32_t j = 0; j < inputs[i]->attr.dim_num; j++) {
+      input_size.push_back(inputs[i]->attr.size[j]);
+    }
+    op_this->inputs_size_.push_back(input_size);
+  }
+
+  op_this->SetupShapeInfor();
+
+  for (uint32_t i = 0; i < op_this->outputs_size_.size(); i++) {
+    if (op_this->outputs_size_[i].empty()) {
+      // keep the shape given by the output tensor spec
+      continue;
+    }
+    outputs[i]->attr.dim_num = op_this->outputs_size_[i].size();
+    for (uint32_t j = 0; j < op_this->outputs_size_[i].size(); j++) {
+      outputs[i]->attr.size[j] = op_this->outputs_size_[i][j];
+    }
+  }
+  return TRUE;
+}
+
+vsi_bool op_compute(vsi_nn_node_t* self, vsi_nn_tensor_t** inputs,
+                    vsi_nn_tensor_t** outputs) {
+  vsi_status status = VSI_FAILURE;
+  CustomCpuOp* op_this =
+      reinterpret_cast<CustomCpuOp*>(self->nn_param.client_param);
+  uint32_t io_num = op_this->input_num_ + op_this->output_num_;
+
+  auto kernel = vsi_nn_KernelCreate(VSI_NN_KERNEL_TYPE_CPU);
+  if (!kernel) {
+    return status;
+  }
+  std::string name = std::string("com.vivantecorp.extension.cpu.") +
+                     op_this->func_name_ + "_" +
+                     std::to_string(op_this->input_num_) + "_" +
+                     std::to_string(op_this->output_num_);
+  snprintf(kernel->info.name, VX_MAX_KERNEL_NAME, "%s", name.c_str());
+  kernel->unique_id = KernelId(name);
+
+  std::vector<vx_param_description_t> kernel_param_def(io_num);
+  for (uint32_t i = 0; i < io_num; i++) {
+    kernel_param_def[i] = {i < op_this->input_num_ ? VX_INPUT : VX_OUTPUT,
+                           VX_TYPE_TENSOR, VX_PARAMETER_STATE_REQUIRED};
+  }
+  kernel->info.enumeration = KERNEL_ID_PLACEHOLDER;
+  kernel->info.function = cpu_kernel_function;
+  kernel->info.parameters = kernel_param_def.data();
+  kernel->info.numParams = io_num;
+  kernel->info.validate = vsi_nn_KernelValidator;
+  kernel->info.initialize = vsi_nn_KernelInitializer;
+  kernel->info.deinitialize = vsi_nn_KernelDeinitializer;
+
+  auto node = vsi_nn_kernel_create_node(self->graph, kernel);
+  if (node) {
+    std::vector<vsi_nn_kernel_node_param_t> node_params(io_num);
+    vsi_nn_kernel_node_pack_io(node_params.data(), io_num, inputs,
+                               op_this->input_num_, outputs,
+                               op_this->output_num_);
+    status = vsi_nn_kernel_node_pass_param(node, node_params.data(), io_num);
+  }
+  vsi_nn_kernel_release(&kernel);
+  self->n = (vx_node)node;
+
+  std::lock_guard<std::mutex> lock(node_op_mutex_);
+  node_op_map_[reinterpret_cast<void*>(self->n)] = op_this;
+  op_this->vx_node_ = reinterpret_cast<void*>(self->n);
+  return status == VSI_SUCCESS;
+}
+
+}  // namespace ops
+}  // namespace vx
+}  // namespace tim
+#endif
@@ -0,0 +1,234 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifdef TIM_VX_ENABLE_CUSTOM_OP
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/vx/ops/custom_base.h"
+#include "tim/vx/ops/custom_cpu.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// out = in * scale + bias, fails on anything but float32
+class CpuScale : public tim::vx::ops::CustomCpuOp {
+ public:
+  CpuScale(tim::vx::Graph* graph, float scale, float bias)
+      : CustomCpuOp(graph, 1, 1, kernel_id_, kernel_name_),
+        scale_(scale),
+        bias_(bias) {}
+
+ protected:
+  void SetupShapeInfor() override { outputs_size_[0] = inputs_size_[0]; }
+
+  bool Compute(const std::vector<tim::vx::ops::CpuTensorSpan>& inputs,
+               const std::vector<tim::vx::ops::CpuTensorSpan>& outputs)
+      override {
+    if (inputs[0].type != tim::vx::DataType::FLOAT32 ||
+        outputs[0].type != tim::vx::DataType::FLOAT32) {
+      return false;
+    }
+    const float* in = inputs[0].Data<float>();
+    float* out = outputs[0].Data<float>();
+    ParallelFor(outputs[0].ElementCount(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        out[i] = in[i] * scale_ + bias_;
+      }
+    });
+    return true;
+  }
+
+  std::shared_ptr<tim::vx::Operation> Clone(
+      std::shared_ptr<tim::vx::Graph>& graph) const override {
+    return graph->CreateOperation<CpuScale>(scale_, bias_);
+  }
+
+  float scale_;
+  float bias_;
+  static const char* kernel_name_;
+  static int32_t kernel_id_;
+};
+
+const char* CpuScale::kernel_name_ = "unit_test_cpu_scale";
+int32_t CpuScale::kernel_id_ = -1 * (++tim::vx::ops::gobal_kernel_id_);
+
+}  // namespace
+
+TEST(CustomCpuOp, parallel_for_covers_range_once) {
+    const size_t count = 1000;
+    std::vector<std::atomic<int>> visits(count);
+    for (auto& v : visits) {
+        v = 0;
+    }
+    tim::vx::ops::CustomCpuOp::ParallelFor(count, [&](size_t begin, size_t end) {
+        EXPECT_LT(begin, end);
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    }, 7);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(1, visits[i].load()) << "index " << i;
+    }
+}
+
+TEST(CustomCpuOp, parallel_for_respects_grain) {
+    std::atomic<int> calls(0);
+    tim::vx::ops::CustomCpuOp::ParallelFor(10, [&](size_t begin, size_t end) {
+        EXPECT_EQ(0u, begin);
+        EXPECT_EQ(10u, end);
+        calls++;
+    }, 10);
+    EXPECT_EQ(1, calls.load());
+
+    tim::vx::ops::CustomCpuOp::ParallelFor(0, [&](size_t, size_t) {
+        calls++;
+    });
+    EXPECT_EQ(1, calls.load());
+    EXPECT_GE(tim::vx::ops::CustomCpuOp::Concurrency(), 1u);
+}
+
+TEST(CustomCpuOp, nested_parallel_for_runs_serially) {
+    const size_t outer = 16, inner = 64;
+    std::vector<std::atomic<int>> visits(outer * inner);
+    for (auto& v : visits) {
+        v = 0;
+    }
+    tim::vx::ops::CustomCpuOp::ParallelFor(outer, [&](size_t begin, size_t end) {
+        for (size_t o = begin; o < end; o++) {
+            tim::vx::ops::CustomCpuOp::ParallelFor(inner, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; i++) {
+                    visits[o * inner + i]++;
+                }
+            });
+        }
+    });
+    for (size_t i = 0; i < visits.size(); i++) {
+        EXPECT_EQ(1, visits[i].load()) << "index " << i;
+    }
+}
+
+TEST(CustomCpuOp, parallel_for_rethrows_on_caller) {
+    const size_t count = 1024;
+    // Throw from the first chunk, which the caller runs, and from the last.
+    for (size_t bad : {size_t(0), count - 1}) {
+        std::atomic<int> calls(0);
+        EXPECT_THROW(tim::vx::ops::CustomCpuOp::ParallelFor(count,
+            [&](size_t begin, size_t end) {
+                calls++;
+                if (begin <= bad && bad < end) {
+                    throw std::runtime_error("chunk failed");
+                }
+            }), std::runtime_error) << "index " << bad;
+        EXPECT_GE(calls.load(), 1);
+    }
+
+    // The pool and its nesting state survive the failed calls.
+    std::vector<std::atomic<int>> visits(count);
+    for (auto& v : visits) {
+        v = 0;
+    }
+    tim::vx::ops::CustomCpuOp::ParallelFor(count, [&](size_t begin, size_t end) {
+        tim::vx::ops::CustomCpuOp::ParallelFor(end - begin, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) {
+                visits[begin + i]++;
+            }
+        });
+    });
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(1, visits[i].load()) << "index " << i;
+    }
+}
+
+TEST(CustomCpuOp, scale_after_add) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType shape({4, 2});
+    tim::vx::TensorSpec in_spec(tim::vx::DataType::FLOAT32,
+                                shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec tmp_spec(tim::vx::DataType::FLOAT32,
+                                 shape, tim::vx::TensorAttribute::TRANSIENT);
+    tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32,
+                                 shape, tim::vx::TensorAttribute::OUTPUT);
+
+    auto a_tensor = graph->CreateTensor(in_spec);
+    auto b_tensor = graph->CreateTensor(in_spec);
+    auto c_tensor = graph->CreateTensor(tmp_spec);
+    auto out_tensor = graph->CreateTensor(out_spec);
+
+    std::vector<float> a_data = {
+        1, 2, 3, 4,
+        -1, -2, -3, -4
+    };
+    std::vector<float> b_data = {
+        1, 1, 1, 1,
+        0, 0, 0, 0
+    };
+    std::vector<float> golden = {
+        5, 7, 9, 11,
+        -1, -3, -5, -7
+    };
+
+    EXPECT_TRUE(a_tensor->CopyDataToTensor(a_data.data(), a_data.size() * sizeof(float)));
+    EXPECT_TRUE(b_tensor->CopyDataToTensor(b_data.data(), b_data.size() * sizeof(float)));
+
+    auto op_add = graph->CreateOperation<tim::vx::ops::AddN>(2);
+    (*op_add).BindInputs({a_tensor, b_tensor}).BindOutputs({c_tensor});
+    auto op_scale = graph->CreateOperation<CpuScale>(2.0f, 1.0f);
+    (*op_scale).BindInputs({c_tensor}).BindOutputs({out_tensor});
+
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(graph->Run());
+
+    std::vector<float> output(golden.size());
+    EXPECT_TRUE(out_tensor->CopyDataFromTensor(output.data()));
+    EXPECT_EQ(golden, output);
+}
+
+TEST(CustomCpuOp, compute_failure_fails_run) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType shape({4});
+    tim::vx::TensorSpec in_spec(tim::vx::DataType::INT32,
+                                shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec out_spec(tim::vx::DataType::INT32,
+                                 shape, tim::vx::TensorAttribute::OUTPUT);
+    auto in_tensor = graph->CreateTensor(in_spec);
+    auto out_tensor = graph->CreateTensor(out_spec);
+
+    std::vector<int32_t> in_data = {1, 2, 3, 4};
+    EXPECT_TRUE(in_tensor->CopyDataToTensor(in_data.data(), in_data.size() * sizeof(int32_t)));
+
+    auto op_scale = graph->CreateOperation<CpuScale>(2.0f, 1.0f);
+    (*op_scale).BindInputs({in_tensor}).BindOutputs({out_tensor});
+
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_FALSE(graph->Run());
+}
+#endif
@@ -68,6 +68,14 @@ std::shared_ptr<Operation> Div::Clone(
       this->impl_->node()->nn_param.divide.scale);
 }
 
+ATimesBPlusC::ATimesBPlusC(Graph* graph)
+  : BuiltinOp(graph, VSI_NN_OP_A_TIMES_B_PLUS_C, 3, 1) {}
+
+std::shared_ptr<Operation> ATimesBPlusC::Clone(
+    std::shared_ptr<Graph>& graph) const {
+  return graph->CreateOperation<ATimesBPlusC>();
+}
+
 }  // namespace ops
 }  // namespace vx
 }  // namespace tim
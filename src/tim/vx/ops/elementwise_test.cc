@@ -406,4 +406,38 @@ TEST(Minimum, shape_1_1_2_1_1_3_broadcast_int32) {
 
     EXPECT_TRUE(output_tensor->CopyDataFromTensor(output.data()));
     EXPECT_EQ(golden, output);
-}
\ No newline at end of file
+}
+
+TEST(ATimesBPlusC, shape_2_2_fp32) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({2, 2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32,
+                            io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32,
+                            io_shape, tim::vx::TensorAttribute::OUTPUT);
+
+    auto input_tensor_a = graph->CreateTensor(input_spec);
+    auto input_tensor_b = graph->CreateTensor(input_spec);
+    auto input_tensor_c = graph->CreateTensor(input_spec);
+    auto output_tensor = graph->CreateTensor(output_spec);
+
+    std::vector<float> in_data_a = { 1, 2, 3, 4 };
+    std::vector<float> in_data_b = { 2, 2, -1, 0.5 };
+    std::vector<float> in_data_c = { 1, 0, 1, -1 };
+    std::vector<float> golden = { 3, 4, -2, 1 };
+
+    EXPECT_TRUE(input_tensor_a->CopyDataToTensor(in_data_a.data(), in_data_a.size()*4));
+    EXPECT_TRUE(input_tensor_b->CopyDataToTensor(in_data_b.data(), in_data_b.size()*4));
+    EXPECT_TRUE(input_tensor_c->CopyDataToTensor(in_data_c.data(), in_data_c.size()*4));
+    auto op = graph->CreateOperation<tim::vx::ops::ATimesBPlusC>();
+    (*op).BindInputs({input_tensor_a, input_tensor_b, input_tensor_c}).BindOutputs({output_tensor});
+
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output(4);
+
+    EXPECT_TRUE(output_tensor->CopyDataFromTensor(output.data()));
+    EXPECT_EQ(golden, output);
+}
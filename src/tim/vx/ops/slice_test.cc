@@ -141,4 +141,42 @@ TEST(Slice, shape_4_3_step_2_1) {
   std::vector<float> output(golden.size());
   EXPECT_TRUE(output_tensor->CopyDataFromTensor(output.data()));
   EXPECT_EQ(golden, output);
-}
\ No newline at end of file
+}
+
+TEST(Slice, rows_within_one_batch) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  // A contiguous block of the input, sliced as a view
+  tim::vx::ShapeType input_shape({2, 3, 2});
+  tim::vx::ShapeType output_shape({2, 2, 1});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, input_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, output_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  auto input_tensor = graph->CreateTensor(input_spec);
+  auto output_tensor = graph->CreateTensor(output_spec);
+
+  std::vector<float> in_data = {
+      1, 2,   3, 4,   5, 6,
+      7, 8,   9, 10,  11, 12,
+  };
+  std::vector<float> golden = {
+      9, 10,  11, 12,
+  };
+
+  EXPECT_TRUE(input_tensor->CopyDataToTensor(in_data.data(),
+                                             in_data.size() * sizeof(float)));
+  std::vector<int32_t> start = {0, 1, 1};
+  std::vector<int32_t> length = {2, 2, 1};
+  auto op = graph->CreateOperation<tim::vx::ops::Slice>(0, start, length);
+  (*op).BindInputs({input_tensor}).BindOutputs({output_tensor});
+
+  EXPECT_TRUE(graph->Compile());
+  EXPECT_TRUE(graph->Run());
+
+  std::vector<float> output(golden.size());
+  EXPECT_TRUE(output_tensor->CopyDataFromTensor(output.data()));
+  EXPECT_EQ(golden, output);
+}
@@ -26,6 +26,7 @@
 #include <cassert>
 
 #include "tim/vx/graph.h"
+#include "context_private.h"
 #include "graph_private.h"
 #include "vsi_nn_pub.h"
 
@@ -113,7 +114,12 @@ std::shared_ptr<IExecutable> LiteNativeExecutor::Compile(
   std::vector<char> nb_buf;
   nb_buf.resize(bin_size);
   graph->CompileToBinary(nb_buf.data(), &bin_size);
-  return std::make_shared<LiteNativeExecutable>(shared_from_this(), nb_buf);
+  auto executable =
+      std::make_shared<LiteNativeExecutable>(shared_from_this(), nb_buf);
+  if (!executable->prepared_) {
+    return nullptr;
+  }
+  return executable;
 }
 
 LiteNativeExecutable::LiteNativeExecutable(
@@ -131,6 +137,8 @@ LiteNativeExecutable::LiteNativeExecutable(
   memory_pool_ = nullptr;
   others_ = nullptr;
   pre_command_ = nullptr;
+  prepared_ = false;
+  memory_reserved_ = false;
 
   /* prepare vip network */
   vip_status_e status = VIP_SUCCESS;
@@ -143,6 +151,16 @@ LiteNativeExecutable::LiteNativeExecutable(
   vip_memory_t others_buffer;
   nbg_query_network(network_, VIP_NETWORK_PROP_MEMORY_SIZE, &buffer_size);
 
+  memory_.constant = buffer_size.coeff;
+  memory_.command = buffer_size.command + buffer_size.pre_command;
+  memory_.intermediate = buffer_size.memory_pool;
+  memory_.others = buffer_size.others;
+  auto context = std::dynamic_pointer_cast<ContextImpl>(context_);
+  if (context && !context->ReserveMemory(memory_, "NBG network")) {
+    return;
+  }
+  memory_reserved_ = nullptr != context;
+
   vip_allocate_videomemory(buffer_size.coeff, &coeff_);
   vip_allocate_videomemory(buffer_size.command, &command_);
   vip_allocate_videomemory(buffer_size.memory_pool, &memory_pool_);
@@ -169,6 +187,7 @@ LiteNativeExecutable::LiteNativeExecutable(
   vip_flush_videomemory(memory_pool_, VIP_BUFFER_OPER_TYPE_FLUSH);
   vip_flush_videomemory(others_, VIP_BUFFER_OPER_TYPE_FLUSH);
 
+  prepared_ = VIP_SUCCESS == status;
   if (status != VIP_SUCCESS) {
     VSILOGE("failed to prepare network");
     assert(false);
@@ -176,7 +195,9 @@ LiteNativeExecutable::LiteNativeExecutable(
 }
 
 LiteNativeExecutable::~LiteNativeExecutable() {
-  nbg_finish_network(network_);
+  if (prepared_) {
+    nbg_finish_network(network_);
+  }
   nbg_destroy_network(network_);
   if (coeff_) {
     vip_free_videomemory(coeff_);
@@ -198,6 +219,10 @@ LiteNativeExecutable::~LiteNativeExecutable() {
     vip_free_videomemory(pre_command_);
     pre_command_ = nullptr;
   }
+  if (memory_reserved_) {
+    std::dynamic_pointer_cast<ContextImpl>(context_)->ReleaseMemory(
+        memory_.Total());
+  }
 }
 
 void LiteNativeExecutable::SetInput(const std::shared_ptr<ITensorHandle>& th) {
@@ -249,6 +274,10 @@ bool LiteNativeExecutable::Trigger(bool async) {
 }
 
 bool LiteNativeExecutable::Verify() {
+  if (!prepared_) {
+    VSILOGE("network is not prepared");
+    return false;
+  }
   int32_t input_count = 0;
   nbg_query_network(network_, VIP_NETWORK_PROP_INPUT_COUNT, &input_count);
   if (input_count != input_count_) {
@@ -273,6 +302,10 @@ std::shared_ptr<ITensorHandle> LiteNativeExecutable::AllocateTensor(
   return std::make_shared<LiteNativeTensorHandle>(tensor);
 }
 
+MemoryReport LiteNativeExecutable::GetMemoryReport() const {
+  return memory_;
+}
+
 void LiteNativeExecutable::SetBuffer(vip_memory_t* dst,
                                      gcvip_videomemory_t* src) {
   if (dst && src) {
@@ -22,6 +22,13 @@
 *
 *****************************************************************************/
 #include "tim/vx/platform/native.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "native_device_private.h"
 #include "tim/vx/ops/nbg.h"
 
@@ -101,6 +108,10 @@ std::shared_ptr<IExecutor> IExecutable::Executor() const {
   return executor;
 }
 
+MemoryReport IExecutable::GetMemoryReport() const {
+  return nb_graph_ ? nb_graph_->GetMemoryReport() : MemoryReport();
+}
+
 NativeExecutable::NativeExecutable(const std::shared_ptr<IExecutor>& executor,
                                    const std::vector<char>& nb_buf,
                                    size_t inputs, size_t outputs) {
@@ -114,6 +125,8 @@ NativeExecutable::NativeExecutable(const std::shared_ptr<IExecutor>& executor,
   nb_buf_ = nb_buf;
   nb_node_ = nb_graph_->CreateOperation<tim::vx::ops::NBG>(nb_buf_.data(),
                                                            inputs, outputs);
+  // Accounted against the budget of the context when nb_graph_ is compiled
+  std::static_pointer_cast<GraphImpl>(nb_graph_)->AddBinarySize(nb_buf_.size());
 }
 
 void NativeExecutable::SetInput(const std::shared_ptr<ITensorHandle>& th) {
@@ -203,6 +216,21 @@ std::shared_ptr<ITensorHandle> ExecutableSet::AllocateTensor(
   return tensor_handle_sp;
 }
 
+MemoryReport ExecutableSet::GetMemoryReport() const {
+  MemoryReport report;
+  for (const auto& executable : executables_) {
+    auto memory = executable->GetMemoryReport();
+    report.constant += memory.constant;
+    report.input += memory.input;
+    report.output += memory.output;
+    report.intermediate += memory.intermediate;
+    report.command += memory.command;
+    report.binary += memory.binary;
+    report.others += memory.others;
+  }
+  return report;
+}
+
 std::vector<std::shared_ptr<IExecutable>> ExecutableSet::Executables() const {
   return executables_;
 }
@@ -280,12 +308,18 @@ std::shared_ptr<IExecutable> NativeExecutor::Compile(
   graph->SetCompileOption(option);
 
   size_t bin_size = -1;
-  graph->CompileToBinary(nullptr, &bin_size);
+  if (!graph->CompileToBinary(nullptr, &bin_size)) {
+    VSILOGE("Compile graph to NBG fail");
+    return nullptr;
+  }
   std::vector<char> nb_buf;
   nb_buf.resize(bin_size);
   size_t inputs = graph->InputsTensor().size();
   size_t outputs = graph->OutputsTensor().size();
-  graph->CompileToBinary(nb_buf.data(), &bin_size);
+  if (!graph->CompileToBinary(nb_buf.data(), &bin_size)) {
+    VSILOGE("Generate NBG fail");
+    return nullptr;
+  }
   std::shared_ptr<IExecutor> this_sp = shared_from_this();
   IExecutable* executable =
       new NativeExecutable(this_sp, nb_buf, inputs, outputs);
@@ -295,6 +329,122 @@ std::shared_ptr<IExecutable> NativeExecutor::Compile(
 
 std::shared_ptr<IDevice> IExecutor::Device() const { return device_; }
 
+ExecutableSlot::ExecutableSlot(const std::shared_ptr<IExecutable>& executable)
+    : executable_(executable) {}
+
+std::shared_ptr<IExecutable> ExecutableSlot::Get() const {
+  return std::atomic_load(&executable_);
+}
+
+std::shared_ptr<IExecutable> ExecutableSlot::Swap(
+    const std::shared_ptr<IExecutable>& executable) {
+  return std::atomic_exchange(&executable_, executable);
+}
+
+CompileTask::CompileTask(const std::shared_ptr<Graph>& graph,
+                         const std::shared_ptr<ExecutableSlot>& slot)
+    : graph_(graph),
+      slot_(slot),
+      cancelled_(false),
+      finished_(false),
+      future_(promise_.get_future().share()) {}
+
+void CompileTask::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!finished_) {
+    cancelled_ = true;
+  }
+}
+
+bool CompileTask::IsCancelled() const { return cancelled_; }
+
+std::shared_ptr<IExecutable> CompileTask::Get() const { return future_.get(); }
+
+std::shared_future<std::shared_ptr<IExecutable>> CompileTask::Future() const {
+  return future_;
+}
+
+void CompileTask::Finish(const std::shared_ptr<IExecutable>& executable) {
+  bool cancelled = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_.exchange(true)) {
+      return;
+    }
+    cancelled = cancelled_;
+    if (executable && !cancelled && slot_) {
+      slot_->Swap(executable);
+    }
+  }
+  promise_.set_value(cancelled ? nullptr : executable);
+  graph_.reset();
+}
+
+CompileQueue::CompileQueue(const std::shared_ptr<IExecutor>& executor,
+                           size_t workers)
+    : executor_(executor), stop_(false) {
+  if (workers == 0) {
+    workers = 1;
+  }
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back(&CompileQueue::Work, this);
+  }
+}
+
+CompileQueue::~CompileQueue() {
+  std::deque<std::shared_ptr<CompileTask>> dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    dropped.swap(queue_);
+  }
+  wakeup_.notify_all();
+  for (auto& task : dropped) {
+    task->Cancel();
+    task->Finish(nullptr);
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::shared_ptr<CompileTask> CompileQueue::Enqueue(
+    const std::shared_ptr<Graph>& graph,
+    const std::shared_ptr<ExecutableSlot>& slot) {
+  auto task = std::make_shared<CompileTask>(graph, slot);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(task);
+  }
+  wakeup_.notify_one();
+  return task;
+}
+
+size_t CompileQueue::Pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+void CompileQueue::Work() {
+  while (true) {
+    std::shared_ptr<CompileTask> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      task = queue_.front();
+      queue_.pop_front();
+    }
+    std::shared_ptr<IExecutable> executable;
+    if (!task->IsCancelled()) {
+      executable = executor_->Compile(task->graph_);
+    }
+    task->Finish(executable);
+  }
+}
+
 std::shared_ptr<Tensor> ITensorHandle::GetTensor() const { return tensor_; }
 
 NativeTensorHandle::NativeTensorHandle(const std::shared_ptr<Tensor>& tensor) {
@@ -310,6 +460,214 @@ bool NativeTensorHandle::CopyDataFromTensor(void* data) {
   return tensor_->CopyDataFromTensor(data);
 }
 
+struct ReplicatedExecutor::Request {
+  std::vector<const void*> inputs;
+  std::vector<void*> outputs;
+  std::promise<bool> done;
+};
+
+struct ReplicatedExecutor::Replica {
+  std::shared_ptr<IExecutor> executor;
+  std::shared_ptr<IExecutable> executable;
+  std::vector<std::shared_ptr<ITensorHandle>> inputs;
+  std::vector<std::shared_ptr<ITensorHandle>> outputs;
+
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::condition_variable idle;
+  std::deque<Request> queue;
+  std::atomic<size_t> pending{0};
+  bool exit{false};
+  std::thread worker;
+};
+
+ReplicatedExecutor::ReplicatedExecutor(
+    const std::vector<std::shared_ptr<IDevice>>& devices)
+    : ReplicatedExecutor(devices, Context::Create()) {}
+
+ReplicatedExecutor::ReplicatedExecutor(
+    const std::vector<std::shared_ptr<IDevice>>& devices,
+    const std::shared_ptr<Context>& context)
+    : devices_(devices), context_(context) {}
+
+ReplicatedExecutor::~ReplicatedExecutor() { Stop(); }
+
+void ReplicatedExecutor::Stop() {
+  for (auto& replica : replicas_) {
+    {
+      std::lock_guard<std::mutex> lock(replica->mutex);
+      replica->exit = true;
+    }
+    replica->wakeup.notify_all();
+  }
+  for (auto& replica : replicas_) {
+    if (replica->worker.joinable()) {
+      replica->worker.join();
+    }
+  }
+  replicas_.clear();
+}
+
+bool ReplicatedExecutor::Compile(const std::shared_ptr<Graph>& graph) {
+  if (devices_.empty()) {
+    VSILOGE("No device to replicate graph on.");
+    return false;
+  }
+  Stop();
+
+  // All replicas share one NBG, generated once against the first device
+  CompileOption option;
+  option.setDeviceId(devices_[0]->Id());
+  graph->SetCompileOption(option);
+
+  size_t bin_size = -1;
+  if (!graph->CompileToBinary(nullptr, &bin_size)) {
+    VSILOGE("Query NBG size failed.");
+    return false;
+  }
+  std::vector<char> nb_buf(bin_size);
+  if (!graph->CompileToBinary(nb_buf.data(), &bin_size)) {
+    VSILOGE("Generate NBG failed.");
+    return false;
+  }
+
+  auto input_tensors = graph->InputsTensor();
+  auto output_tensors = graph->OutputsTensor();
+  input_bytes_.clear();
+  for (const auto& t : input_tensors) {
+    input_bytes_.push_back(t->GetSpec().GetByteSize());
+  }
+
+  for (const auto& device : devices_) {
+    auto replica = std::make_unique<Replica>();
+    replica->executor = std::make_shared<NativeExecutor>(device, context_);
+    replica->executable = std::make_shared<NativeExecutable>(
+        replica->executor, nb_buf, input_tensors.size(),
+        output_tensors.size());
+    for (const auto& t : input_tensors) {
+      auto th = replica->executable->AllocateTensor(t->GetSpec());
+      replica->executable->SetInput(th);
+      replica->inputs.push_back(th);
+    }
+    for (const auto& t : output_tensors) {
+      auto th = replica->executable->AllocateTensor(t->GetSpec());
+      replica->executable->SetOutput(th);
+      replica->outputs.push_back(th);
+    }
+    if (!replica->executable->Verify()) {
+      VSILOGE("Verify NBG on device %u failed.", device->Id());
+      Stop();
+      return false;
+    }
+    replicas_.push_back(std::move(replica));
+  }
+
+  for (auto& replica : replicas_) {
+    replica->worker = std::thread(&ReplicatedExecutor::Work, this,
+                                  replica.get());
+  }
+  return true;
+}
+
+void ReplicatedExecutor::Work(Replica* replica) {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(replica->mutex);
+      replica->wakeup.wait(
+          lock, [replica]() { return replica->exit || !replica->queue.empty(); });
+      if (replica->queue.empty()) {
+        return;
+      }
+      request = std::move(replica->queue.front());
+      replica->queue.pop_front();
+    }
+
+    bool status = true;
+    for (size_t i = 0; i < replica->inputs.size(); i++) {
+      status = status && replica->inputs[i]->CopyDataToTensor(
+                             request.inputs[i], input_bytes_[i]);
+    }
+    status = status && replica->executable->Trigger();
+    for (size_t i = 0; i < replica->outputs.size(); i++) {
+      status =
+          status && replica->outputs[i]->CopyDataFromTensor(request.outputs[i]);
+    }
+    request.done.set_value(status);
+
+    {
+      std::lock_guard<std::mutex> lock(replica->mutex);
+      replica->pending--;
+    }
+    replica->idle.notify_all();
+  }
+}
+
+std::future<bool> ReplicatedExecutor::Submit(
+    const std::vector<const void*>& inputs,
+    const std::vector<void*>& outputs) {
+  Request request;
+  auto result = request.done.get_future();
+  if (replicas_.empty() || inputs.size() != replicas_[0]->inputs.size() ||
+      outputs.size() != replicas_[0]->outputs.size()) {
+    VSILOGE("Executor not compiled or inputs/outputs count mismatch.");
+    request.done.set_value(false);
+    return result;
+  }
+  request.inputs = inputs;
+  request.outputs = outputs;
+
+  // Pick and count under one lock, so that concurrent submits see each
+  // other's choice and don't pile onto the same replica
+  Replica* target = replicas_[0].get();
+  {
+    std::lock_guard<std::mutex> dispatch_lock(dispatch_mutex_);
+    for (auto& replica : replicas_) {
+      if (replica->pending < target->pending) {
+        target = replica.get();
+      }
+    }
+    target->pending++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(target->mutex);
+    target->queue.push_back(std::move(request));
+  }
+  target->wakeup.notify_one();
+  return result;
+}
+
+bool ReplicatedExecutor::Run(const std::vector<const void*>& inputs,
+                             const std::vector<void*>& outputs) {
+  return Submit(inputs, outputs).get();
+}
+
+void ReplicatedExecutor::WaitIdle() {
+  for (auto& replica : replicas_) {
+    std::unique_lock<std::mutex> lock(replica->mutex);
+    replica->idle.wait(lock, [&replica]() { return replica->pending == 0; });
+  }
+}
+
+size_t ReplicatedExecutor::ReplicaCount() const { return replicas_.size(); }
+
+size_t ReplicatedExecutor::QueueDepth() const {
+  size_t depth = 0;
+  for (const auto& replica : replicas_) {
+    depth += replica->pending;
+  }
+  return depth;
+}
+
+size_t ReplicatedExecutor::QueueDepth(size_t replica) const {
+  return replica < replicas_.size() ? replicas_[replica]->pending.load() : 0;
+}
+
+std::shared_ptr<IExecutable> ReplicatedExecutor::Executable(
+    size_t replica) const {
+  return replica < replicas_.size() ? replicas_[replica]->executable : nullptr;
+}
+
 }  // namespace platform
 }  // namespace vx
 }  // namespace tim
\ No newline at end of file
@@ -0,0 +1,248 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/vx/platform/native.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+std::shared_ptr<tim::vx::Graph> CreateAddGraph(
+    const std::shared_ptr<tim::vx::Context>& ctx) {
+    static std::vector<float> weight = {10.0f, 20.0f};
+    auto graph = ctx->CreateGraph();
+    tim::vx::ShapeType io_shape({2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::CONSTANT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({graph->CreateTensor(input_spec), graph->CreateTensor(const_spec, weight.data())})
+        .BindOutputs({graph->CreateTensor(output_spec)});
+    return graph;
+}
+
+class FakeExecutable : public tim::vx::platform::IExecutable {
+ public:
+    void SetInput(const std::shared_ptr<tim::vx::platform::ITensorHandle>&) override {}
+    void SetOutput(const std::shared_ptr<tim::vx::platform::ITensorHandle>&) override {}
+    void GetOutput(const std::vector<std::shared_ptr<tim::vx::platform::ITensorHandle>>&) override {}
+    bool Submit(const std::shared_ptr<IExecutable>&, bool) override { return true; }
+    bool Trigger(bool) override { return true; }
+    bool Verify() override { return true; }
+    std::shared_ptr<tim::vx::platform::ITensorHandle> AllocateTensor(
+        const tim::vx::TensorSpec&) override {
+        return nullptr;
+    }
+};
+
+// Compile() blocks until Release() so tests can act on a running task
+class GatedExecutor : public tim::vx::platform::IExecutor {
+ public:
+    bool Submit(const std::shared_ptr<tim::vx::platform::IExecutable>&,
+                const std::shared_ptr<tim::vx::platform::IExecutable>&, bool) override {
+        return true;
+    }
+    bool Trigger(bool) override { return true; }
+    std::shared_ptr<tim::vx::platform::IExecutable> Compile(
+        const std::shared_ptr<tim::vx::Graph>&) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        started_++;
+        cv_.notify_all();
+        cv_.wait(lock, [this]() { return released_; });
+        return std::make_shared<FakeExecutable>();
+    }
+    void WaitStarted(int count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this, count]() { return started_ >= count; });
+    }
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+    int Started() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return started_;
+    }
+
+ private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int started_ = 0;
+    bool released_ = false;
+};
+}  // namespace
+
+TEST(ExecutableSlot, swap_returns_previous) {
+    auto first = std::make_shared<FakeExecutable>();
+    auto second = std::make_shared<FakeExecutable>();
+    tim::vx::platform::ExecutableSlot slot(first);
+    EXPECT_EQ(first, slot.Get());
+    EXPECT_EQ(first, slot.Swap(second));
+    EXPECT_EQ(second, slot.Get());
+    EXPECT_EQ(second, slot.Swap(nullptr));
+    EXPECT_EQ(nullptr, slot.Get());
+}
+
+TEST(CompileQueue, installs_result_into_slot) {
+    auto executor = std::make_shared<GatedExecutor>();
+    auto slot = std::make_shared<tim::vx::platform::ExecutableSlot>();
+    tim::vx::platform::CompileQueue queue(executor);
+    executor->Release();
+    auto task = queue.Enqueue(nullptr, slot);
+    auto executable = task->Get();
+    ASSERT_NE(nullptr, executable);
+    EXPECT_EQ(executable, slot->Get());
+    EXPECT_FALSE(task->IsCancelled());
+}
+
+TEST(CompileQueue, cancelled_queued_task_never_compiles) {
+    auto executor = std::make_shared<GatedExecutor>();
+    auto slot = std::make_shared<tim::vx::platform::ExecutableSlot>();
+    tim::vx::platform::CompileQueue queue(executor, 1);
+    auto running = queue.Enqueue(nullptr, slot);
+    executor->WaitStarted(1);
+    auto queued = queue.Enqueue(nullptr, slot);
+    EXPECT_EQ(1u, queue.Pending());
+    queued->Cancel();
+    executor->Release();
+
+    EXPECT_EQ(nullptr, queued->Get());
+    auto executable = running->Get();
+    ASSERT_NE(nullptr, executable);
+    EXPECT_EQ(executable, slot->Get());
+    EXPECT_EQ(1, executor->Started());
+}
+
+TEST(CompileQueue, cancelled_running_task_drops_result) {
+    auto executor = std::make_shared<GatedExecutor>();
+    auto previous = std::make_shared<FakeExecutable>();
+    auto slot = std::make_shared<tim::vx::platform::ExecutableSlot>(previous);
+    tim::vx::platform::CompileQueue queue(executor);
+    auto task = queue.Enqueue(nullptr, slot);
+    executor->WaitStarted(1);
+    task->Cancel();
+    executor->Release();
+
+    EXPECT_EQ(nullptr, task->Get());
+    EXPECT_TRUE(task->IsCancelled());
+    EXPECT_EQ(previous, slot->Get());
+}
+
+TEST(CompileQueue, cancel_after_finish_keeps_result) {
+    auto executor = std::make_shared<GatedExecutor>();
+    auto slot = std::make_shared<tim::vx::platform::ExecutableSlot>();
+    tim::vx::platform::CompileQueue queue(executor);
+    executor->Release();
+    auto task = queue.Enqueue(nullptr, slot);
+    auto executable = task->Get();
+    task->Cancel();
+    EXPECT_FALSE(task->IsCancelled());
+    EXPECT_EQ(executable, task->Get());
+    EXPECT_EQ(executable, slot->Get());
+}
+
+TEST(CompileQueue, destructor_cancels_pending_tasks) {
+    auto executor = std::make_shared<GatedExecutor>();
+    std::shared_ptr<tim::vx::platform::CompileTask> running, queued;
+    std::thread release;
+    {
+        tim::vx::platform::CompileQueue queue(executor, 1);
+        running = queue.Enqueue(nullptr);
+        executor->WaitStarted(1);
+        queued = queue.Enqueue(nullptr);
+        // The destructor cancels the queued task before it waits for workers
+        release = std::thread([executor, queued]() {
+            while (!queued->IsCancelled()) {
+                std::this_thread::yield();
+            }
+            executor->Release();
+        });
+    }
+    release.join();
+    EXPECT_NE(nullptr, running->Get());
+    EXPECT_EQ(nullptr, queued->Get());
+    EXPECT_TRUE(queued->IsCancelled());
+    EXPECT_EQ(1, executor->Started());
+}
+
+TEST(ReplicatedExecutor, submit_before_compile_fails) {
+    tim::vx::platform::ReplicatedExecutor executor({});
+    std::vector<float> in(2), out(2);
+    EXPECT_FALSE(executor.Submit({in.data()}, {out.data()}).get());
+    EXPECT_EQ(0u, executor.ReplicaCount());
+    EXPECT_EQ(0u, executor.QueueDepth());
+}
+
+TEST(ReplicatedExecutor, concurrent_submits_on_all_devices) {
+    auto devices = tim::vx::platform::NativeDevice::Enumerate();
+    if (devices.empty()) {
+        GTEST_SKIP() << "No device";
+    }
+    auto ctx = tim::vx::Context::Create();
+    tim::vx::platform::ReplicatedExecutor executor(devices, ctx);
+    ASSERT_TRUE(executor.Compile(CreateAddGraph(ctx)));
+    ASSERT_EQ(devices.size(), executor.ReplicaCount());
+
+    std::vector<float> wrong(2);
+    EXPECT_FALSE(executor.Submit({}, {wrong.data()}).get()) << "Input count mismatch";
+
+    const size_t threads = 4, requests = 8;
+    std::vector<std::vector<float>> in(threads * requests), out(threads * requests);
+    std::vector<std::thread> clients;
+    std::vector<int> failures(threads, 0);
+    for (size_t t = 0; t < threads; t++) {
+        clients.emplace_back([&, t]() {
+            std::vector<std::future<bool>> results;
+            for (size_t r = 0; r < requests; r++) {
+                size_t i = t * requests + r;
+                in[i] = {float(i), float(2 * i)};
+                out[i].resize(2);
+                results.push_back(executor.Submit({in[i].data()}, {out[i].data()}));
+            }
+            for (auto& result : results) {
+                failures[t] += result.get() ? 0 : 1;
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    executor.WaitIdle();
+
+    EXPECT_EQ(std::vector<int>(threads, 0), failures);
+    for (size_t i = 0; i < in.size(); i++) {
+        EXPECT_EQ(std::vector<float>({in[i][0] + 10.0f, in[i][1] + 20.0f}), out[i]);
+    }
+    EXPECT_EQ(0u, executor.QueueDepth());
+    for (size_t r = 0; r < executor.ReplicaCount(); r++) {
+        EXPECT_EQ(0u, executor.QueueDepth(r));
+    }
+}
@@ -0,0 +1,88 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "vsi_nn_pub.h"
+#include "post/vsi_nn_post_detection.h"
+
+TEST(post_detection, topk_sorts_by_score_then_index) {
+  std::vector<float> score = {0.1f, 0.9f, 0.5f, 0.9f, 0.05f, 0.7f};
+  std::vector<uint32_t> index(score.size());
+
+  uint32_t n = vsi_nn_detection_topk(score.data(), score.size(), 1, 0.08f, 3,
+                                     index.data());
+  ASSERT_EQ(3u, n);
+  EXPECT_EQ(1u, index[0]);
+  EXPECT_EQ(3u, index[1]);
+  EXPECT_EQ(5u, index[2]);
+
+  n = vsi_nn_detection_topk(score.data(), score.size(), 1, 0.08f, 0,
+                            index.data());
+  EXPECT_EQ(5u, n);
+  EXPECT_EQ(0u, index[4]);
+}
+
+TEST(post_detection, nms_suppresses_overlapping_boxes) {
+  auto boxes = vsi_nn_detection_boxes_create(6);
+  // sorted by score, box 1 and 4 overlap box 0, box 3 overlaps box 2
+  vsi_nn_detection_boxes_push(boxes, 0, 0, 10, 10, 0.9f, 0);
+  vsi_nn_detection_boxes_push(boxes, 1, 1, 10, 10, 0.8f, 0);
+  vsi_nn_detection_boxes_push(boxes, 20, 20, 30, 30, 0.7f, 0);
+  vsi_nn_detection_boxes_push(boxes, 21, 20, 31, 30, 0.6f, 0);
+  vsi_nn_detection_boxes_push(boxes, 0, 1, 10, 11, 0.5f, 0);
+  vsi_nn_detection_boxes_push(boxes, 40, 40, 50, 50, 0.4f, 0);
+  std::vector<uint32_t> keep(6);
+
+  uint32_t n = vsi_nn_detection_nms(boxes, 0.5f, 0.0f, 0, keep.data());
+  ASSERT_EQ(3u, n);
+  EXPECT_EQ(0u, keep[0]);
+  EXPECT_EQ(2u, keep[1]);
+  EXPECT_EQ(5u, keep[2]);
+
+  EXPECT_EQ(2u, vsi_nn_detection_nms(boxes, 0.5f, 0.0f, 2, keep.data()));
+  vsi_nn_detection_boxes_release(&boxes);
+}
+
+TEST(post_detection, multiclass_nms_merges_classes_by_score) {
+  auto boxes = vsi_nn_detection_boxes_create(3);
+  vsi_nn_detection_boxes_push(boxes, 0, 0, 10, 10, 0, -1);
+  vsi_nn_detection_boxes_push(boxes, 1, 1, 10, 10, 0, -1);
+  vsi_nn_detection_boxes_push(boxes, 20, 20, 30, 30, 0, -1);
+  // [box, class], class 0 is background
+  std::vector<float> score = {
+      0.9f, 0.8f, 0.1f,
+      0.9f, 0.7f, 0.6f,
+      0.9f, 0.1f, 0.95f,
+  };
+  auto out = vsi_nn_detection_boxes_create(8);
+
+  ASSERT_EQ(VSI_SUCCESS,
+            vsi_nn_detection_multiclass_nms(boxes, FALSE, score.data(), 3, 1,
+                                            0.3f, 0.5f, 0.0f, 0, 0, out));
+  ASSERT_EQ(3u, out->num);
+  EXPECT_FLOAT_EQ(0.95f, out->score[0]);
+  EXPECT_EQ(2, out->class_id[0]);
+  EXPECT_FLOAT_EQ(0.8f, out->score[1]);
+  EXPECT_EQ(1, out->class_id[1]);
+  EXPECT_FLOAT_EQ(0.6f, out->score[2]);
+  EXPECT_EQ(2, out->class_id[2]);
+  EXPECT_FLOAT_EQ(1.0f, out->x1[2]);
+
+  vsi_nn_detection_boxes_release(&out);
+  vsi_nn_detection_boxes_release(&boxes);
+}
+
+TEST(post_detection, decode_center_size) {
+  vsi_nn_detection_box_coder_t coder = {10.0f, 10.0f, 5.0f, 5.0f};
+  std::vector<float> anchors = {0.5f, 0.5f, 0.2f, 0.4f};
+  std::vector<float> deltas = {1.0f, -1.0f, 0.0f, 0.0f};
+  auto boxes = vsi_nn_detection_boxes_create(1);
+
+  vsi_nn_detection_decode_center_size(deltas.data(), anchors.data(), 1, &coder,
+                                      boxes);
+  ASSERT_EQ(1u, boxes->num);
+  EXPECT_FLOAT_EQ(0.46f - 0.2f, boxes->x1[0]);
+  EXPECT_FLOAT_EQ(0.52f - 0.1f, boxes->y1[0]);
+  EXPECT_FLOAT_EQ(0.46f + 0.2f, boxes->x2[0]);
+  EXPECT_FLOAT_EQ(0.52f + 0.1f, boxes->y2[0]);
+  vsi_nn_detection_boxes_release(&boxes);
+}
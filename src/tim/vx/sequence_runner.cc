@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/vx/sequence_runner.h"
+
+#include <vector>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/tensor.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+
+SequenceRunner::SequenceRunner(const std::shared_ptr<Graph>& cell)
+    : cell_(cell), valid_(false) {
+  auto inputs = cell_->InputsTensor();
+  auto outputs = cell_->OutputsTensor();
+  if (inputs.empty() || inputs.size() != outputs.size()) {
+    VSILOGE("Cell graph needs x_t, y_t and the same number of state inputs "
+            "and outputs");
+    return;
+  }
+  step_input_ = inputs[0];
+  step_output_ = outputs[0];
+  for (size_t i = 1; i < inputs.size(); i++) {
+    const auto& in_spec = inputs[i]->GetSpec();
+    const auto& out_spec = outputs[i]->GetSpec();
+    if (in_spec.shape_ != out_spec.shape_ ||
+        in_spec.datatype_ != out_spec.datatype_) {
+      VSILOGE("State %zu input and output mismatch", i - 1);
+      return;
+    }
+    state_inputs_.push_back(inputs[i]);
+    state_outputs_.push_back(outputs[i]);
+  }
+  valid_ = true;
+}
+
+bool SequenceRunner::Run(const void* input, uint32_t time_step, void* output,
+                         bool return_sequences) {
+  if (!valid_ || !input || !output || !cell_->Compile()) {
+    return false;
+  }
+
+  const size_t input_bytes = step_input_->GetSpec().GetByteSize();
+  const size_t output_bytes = step_output_->GetSpec().GetByteSize();
+  auto src = static_cast<const uint8_t*>(input);
+  auto dst = static_cast<uint8_t*>(output);
+  std::vector<uint8_t> scratch;
+  for (uint32_t t = 0; t < time_step; t++) {
+    if (!step_input_->CopyDataToTensor(src + t * input_bytes, input_bytes) ||
+        !cell_->Run()) {
+      return false;
+    }
+    if (return_sequences || t == time_step - 1) {
+      if (!step_output_->CopyDataFromTensor(
+              return_sequences ? dst + t * output_bytes : dst)) {
+        return false;
+      }
+    }
+    // The new states become the next inputs, the old input buffers are
+    // written by the next step. Tensors not created from handle fall back
+    // to a host copy.
+    for (size_t i = 0; i < state_inputs_.size(); i++) {
+      if (!state_outputs_[i]->SwapHandle(state_inputs_[i])) {
+        scratch.resize(state_inputs_[i]->GetSpec().GetByteSize());
+        if (!state_outputs_[i]->CopyDataFromTensor(scratch.data()) ||
+            !state_inputs_[i]->CopyDataToTensor(scratch.data(),
+                                                scratch.size())) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool SequenceRunner::ResetStates() {
+  if (!valid_) {
+    return false;
+  }
+  for (const auto& state : state_inputs_) {
+    std::vector<uint8_t> zeros(state->GetSpec().GetByteSize(), 0);
+    if (!state->CopyDataToTensor(zeros.data(), zeros.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<Tensor> SequenceRunner::State(uint32_t index) const {
+  return index < state_inputs_.size() ? state_inputs_[index] : nullptr;
+}
+
+}  // namespace vx
+}  // namespace tim
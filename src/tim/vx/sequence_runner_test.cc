@@ -0,0 +1,145 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/vx/sequence_runner.h"
+
+TEST(sequence_runner, accumulate_states) {
+  auto ctx = tim::vx::Context::Create();
+  auto cell = ctx->CreateGraph();
+
+  // y_t = s_t = s_(t-1) + x_t
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {2},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto x = cell->CreateTensor(input_spec);
+  auto s_in = cell->CreateTensor(input_spec);
+  auto y = cell->CreateTensor(output_spec);
+  auto s_out = cell->CreateTensor(output_spec);
+  auto add0 = cell->CreateOperation<tim::vx::ops::Add>();
+  (*add0).BindInputs({x, s_in}).BindOutputs({y});
+  auto add1 = cell->CreateOperation<tim::vx::ops::Add>();
+  (*add1).BindInputs({x, s_in}).BindOutputs({s_out});
+
+  tim::vx::SequenceRunner runner(cell);
+  EXPECT_EQ(1u, runner.StateCount());
+  EXPECT_TRUE(runner.ResetStates());
+
+  std::vector<float> input = {1, 10, 2, 20, 3, 30, 4, 40};
+  std::vector<float> expected = {1, 10, 3, 30, 6, 60, 10, 100};
+  std::vector<float> output(input.size());
+  EXPECT_TRUE(runner.Run(input.data(), 4, output.data()));
+  EXPECT_EQ(expected, output);
+
+  // States carry over to the next call
+  std::vector<float> last(2);
+  EXPECT_TRUE(runner.Run(input.data(), 1, last.data(), false));
+  EXPECT_EQ(std::vector<float>({11, 110}), last);
+  EXPECT_TRUE(runner.State(0)->CopyDataFromTensor(last.data()));
+  EXPECT_EQ(std::vector<float>({11, 110}), last);
+}
+
+TEST(sequence_runner, lstm_cell_matches_unrolled) {
+  const uint32_t n_batch = 1, n_step = 8, n_input = 8, n_cell = 16;
+  std::vector<float> input(n_input * n_step * n_batch, 0.5f);
+  auto ctx = tim::vx::Context::Create();
+
+  // Both graphs read the same weights, after their input and states
+  tim::vx::TensorSpec i2x_weight_spec(tim::vx::DataType::FLOAT32,
+                                      {n_input, n_cell},
+                                      tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec r2x_weight_spec(tim::vx::DataType::FLOAT32,
+                                      {n_cell, n_cell},
+                                      tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {n_cell},
+                                tim::vx::TensorAttribute::CONSTANT);
+  std::vector<float> i2x_weight(n_input * n_cell, 0.01f);
+  std::vector<float> r2x_weight(n_cell * n_cell, 0.01f);
+  std::vector<float> bias(n_cell, 0.01f);
+  auto add_weights =
+      [&](const std::shared_ptr<tim::vx::Graph>& graph,
+          std::vector<std::shared_ptr<tim::vx::Tensor>>& inputs) {
+        for (int i = 0; i < 4; i++) {
+          inputs.push_back(
+              graph->CreateTensor(i2x_weight_spec, i2x_weight.data()));
+        }
+        for (int i = 0; i < 4; i++) {
+          inputs.push_back(
+              graph->CreateTensor(r2x_weight_spec, r2x_weight.data()));
+        }
+        for (int i = 0; i < 3; i++) {
+          inputs.push_back(graph->CreateTensorPlaceHolder()); /*weight_c2x*/
+        }
+        for (int i = 0; i < 4; i++) {
+          inputs.push_back(graph->CreateTensor(bias_spec, bias.data()));
+        }
+      };
+  tim::vx::TensorSpec seq_in_spec(tim::vx::DataType::FLOAT32,
+                                  {n_input, n_step, n_batch},
+                                  tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec seq_out_spec(tim::vx::DataType::FLOAT32,
+                                   {n_cell, n_step, n_batch},
+                                   tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec x_spec(tim::vx::DataType::FLOAT32, {n_input, 1, n_batch},
+                             tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec y_spec(tim::vx::DataType::FLOAT32, {n_cell, 1, n_batch},
+                             tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec state_in_spec(tim::vx::DataType::FLOAT32,
+                                    {n_cell, n_batch},
+                                    tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec state_out_spec(tim::vx::DataType::FLOAT32,
+                                     {n_cell, n_batch},
+                                     tim::vx::TensorAttribute::OUTPUT);
+
+  // Unrolled: one graph with every time step expanded
+  auto g = ctx->CreateGraph();
+  auto seq_in = g->CreateTensor(seq_in_spec);
+  auto seq_out = g->CreateTensor(seq_out_spec);
+  std::vector<std::shared_ptr<tim::vx::Tensor>> seq_inputs = {
+      seq_in, g->CreateTensorPlaceHolder(), g->CreateTensorPlaceHolder()};
+  add_weights(g, seq_inputs);
+  auto seq_op = g->CreateOperation<tim::vx::ops::UnidirectionalSequenceLstm>(
+      0.0, 0.0, tim::vx::ops::UnidirectionalSequenceLstm::ActivationType::kTANH,
+      0.0, false, tim::vx::ops::UnidirectionalSequenceLstm::kSIGMOID, true);
+  (*seq_op).BindInputs(seq_inputs).BindOutputs({
+      seq_out,
+      g->CreateTensor(state_out_spec),
+      g->CreateTensor(state_out_spec),
+  });
+
+  ASSERT_TRUE(g->Compile());
+  ASSERT_TRUE(seq_in->CopyDataToTensor(input.data()));
+  ASSERT_TRUE(g->Run());
+  std::vector<float> unrolled(n_cell * n_step * n_batch);
+  ASSERT_TRUE(seq_out->CopyDataFromTensor(unrolled.data()));
+
+  // Compact: one time step compiled once and run per step
+  auto cell = ctx->CreateGraph();
+  auto x = cell->CreateTensor(x_spec);
+  auto h_in = cell->CreateTensor(state_in_spec);
+  auto c_in = cell->CreateTensor(state_in_spec);
+  auto y = cell->CreateTensor(y_spec);
+  auto h_out = cell->CreateTensor(state_out_spec);
+  auto c_out = cell->CreateTensor(state_out_spec);
+  std::vector<std::shared_ptr<tim::vx::Tensor>> cell_inputs = {x, h_in, c_in};
+  add_weights(cell, cell_inputs);
+  auto cell_op =
+      cell->CreateOperation<tim::vx::ops::UnidirectionalSequenceLstm>(
+          0.0, 0.0,
+          tim::vx::ops::UnidirectionalSequenceLstm::ActivationType::kTANH, 0.0,
+          false, tim::vx::ops::UnidirectionalSequenceLstm::kSIGMOID, true);
+  (*cell_op).BindInputs(cell_inputs).BindOutputs({y, h_out, c_out});
+
+  tim::vx::SequenceRunner runner(cell);
+  ASSERT_TRUE(cell->Compile());
+  ASSERT_TRUE(runner.ResetStates());
+  std::vector<float> compact(n_cell * n_step * n_batch);
+  ASSERT_TRUE(runner.Run(input.data(), n_step, compact.data()));
+
+  for (size_t i = 0; i < unrolled.size(); i++) {
+    ASSERT_NEAR(unrolled[i], compact[i], 1e-3f) << "at " << i;
+  }
+}
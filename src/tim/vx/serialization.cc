@@ -0,0 +1,787 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/vx/serialization.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "graph_private.h"
+#include "op_impl.h"
+#include "tim/vx/builtin_op.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/tensor.h"
+#include "vsi_nn_pub.h"
+
+#ifndef ENABLE_TENSOR_HNDL
+#define ENABLE_TENSOR_HNDL 1
+#endif
+
+namespace tim {
+namespace vx {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'I', 'M', 'V', 'X', 'G', 'R', 'F'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kConstAlignment = 64;
+
+enum TensorFlag : uint32_t {
+  TENSOR_FLAG_PLACEHOLDER = 1 << 0,
+  TENSOR_FLAG_SCALAR = 1 << 1,
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tensor_count;
+  uint32_t op_count;
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t reserved;
+  uint64_t meta_size;     // bytes of metadata following the header
+  uint64_t const_offset;  // start of constant section, kConstAlignment aligned
+  uint64_t const_size;
+};
+
+// Scalar member of vsi_nn_nn_param_t, copied verbatim
+struct ParamField {
+  size_t offset;
+  size_t size;
+};
+
+// Pointer member of vsi_nn_nn_param_t together with its element count
+struct ParamArray {
+  size_t ptr_offset;
+  size_t count_offset;
+  size_t count_size;
+  size_t elem_size;
+};
+
+// Only the members written by tim::vx operations are recorded, local data
+// allocated by ovxlib when the node is created is left untouched.
+struct ParamCodec {
+  std::vector<ParamField> fields;
+  std::vector<ParamArray> arrays;
+};
+
+#define PARAM_MEMBER(m) (((vsi_nn_nn_param_t*)nullptr)->m)
+#define FIELD(m) \
+  ParamField { offsetof(vsi_nn_nn_param_t, m), sizeof(PARAM_MEMBER(m)) }
+#define ARRAY(m, ptr, cnt)                                         \
+  ParamArray {                                                     \
+    offsetof(vsi_nn_nn_param_t, m.ptr),                            \
+        offsetof(vsi_nn_nn_param_t, m.cnt), sizeof(PARAM_MEMBER(m.cnt)), \
+        sizeof(*PARAM_MEMBER(m.ptr))                               \
+  }
+
+const std::map<int32_t, ParamCodec>& ParamCodecs() {
+  static const std::map<int32_t, ParamCodec> codecs = {
+      {VSI_NN_OP_ELU, {{FIELD(elu.alpha)}, {}}},
+      {VSI_NN_OP_GELU, {{FIELD(gelu.approximate)}, {}}},
+      {VSI_NN_OP_HARD_SIGMOID,
+       {{FIELD(hard_sigmoid.alpha), FIELD(hard_sigmoid.beta)}, {}}},
+      {VSI_NN_OP_LINEAR, {{FIELD(linear.a), FIELD(linear.b)}, {}}},
+      {VSI_NN_OP_PRELU, {{FIELD(prelu.axis)}, {}}},
+#ifdef _VSI_NN_OP_SELU_H
+      {VSI_NN_OP_SELU, {{FIELD(selu.alpha), FIELD(selu.gamma)}, {}}},
+#endif
+#ifdef _VSI_NN_OP_CELU_H
+      {VSI_NN_OP_CELU, {{FIELD(selu.alpha)}, {}}},
+#endif
+      {VSI_NN_OP_SWISH, {{FIELD(swish.type), FIELD(swish.beta)}, {}}},
+      {VSI_NN_OP_TANH, {{FIELD(tanh.scale_a), FIELD(tanh.scale_b)}, {}}},
+      {VSI_NN_OP_LEAKY_RELU, {{FIELD(activation.leaky_ratio)}, {}}},
+      {VSI_NN_OP_ARGMAX, {{FIELD(argmax.axis)}, {}}},
+      {VSI_NN_OP_ARGMIN, {{FIELD(argmin.axis)}, {}}},
+      {VSI_NN_OP_BATCH2SPACE,
+       {{FIELD(batch2space.crop)},
+        {ARRAY(batch2space, block_size, block_size_num)}}},
+      {VSI_NN_OP_SPACE2BATCH,
+       {{FIELD(space2batch.pad)},
+        {ARRAY(space2batch, block_size, block_size_num)}}},
+      {VSI_NN_OP_BATCH_NORM, {{FIELD(batch_norm.eps)}, {}}},
+      {VSI_NN_OP_BIDIRECTIONAL_SEQUENCE_RNN,
+       {{FIELD(bidirectional_sequence_rnn.activation),
+         FIELD(bidirectional_sequence_rnn.merge_outputs),
+         FIELD(bidirectional_sequence_rnn.time_major)},
+        {}}},
+      {VSI_NN_OP_UNIDIRECTIONAL_SEQUENCE_RNN,
+       {{FIELD(unidirectional_sequence_rnn.activation),
+         FIELD(unidirectional_sequence_rnn.time_major)},
+        {}}},
+      {VSI_NN_OP_EXPAND_BROADCAST,
+       {{},
+        {ARRAY(expand_broadcast, shape, dim_num),
+#ifdef VSI_EXPAND_BROADCAST_ENABLE_DIMENSIONS
+         ARRAY(expand_broadcast, dimensions, dimensions_num),
+#endif
+        }}},
+      {VSI_NN_OP_CLIP, {{FIELD(clip.min), FIELD(clip.max)}, {}}},
+      {VSI_NN_OP_CONCAT, {{FIELD(concat.axis)}, {}}},
+      {VSI_NN_OP_CONV1D,
+       {{FIELD(conv1d.dilation), FIELD(conv1d.group),
+         FIELD(conv1d.multiplier), FIELD(conv1d.pad), FIELD(conv1d.pad_type),
+         FIELD(conv1d.stride)},
+        {}}},
+      {VSI_NN_OP_CONV2D,
+       {{FIELD(conv2d.dilation), FIELD(conv2d.group),
+         FIELD(conv2d.multiplier), FIELD(conv2d.pad), FIELD(conv2d.pad_type),
+         FIELD(conv2d.stride)},
+        {}}},
+      {VSI_NN_OP_CONV3D,
+       {{FIELD(conv3d.dilation), FIELD(conv3d.multiplier), FIELD(conv3d.pad),
+         FIELD(conv3d.pad_type), FIELD(conv3d.stride), FIELD(conv3d.weights)},
+        {}}},
+#ifdef VSI_FEAT_OP_CUMSUM
+      {VSI_NN_OP_CUMSUM,
+       {{FIELD(cumsum.axis), FIELD(cumsum.exclusive), FIELD(cumsum.reverse)},
+        {}}},
+#endif
+      {VSI_NN_OP_DECONVOLUTION,
+       {{FIELD(deconv.group), FIELD(deconv.ksize), FIELD(deconv.output_padding),
+         FIELD(deconv.pad), FIELD(deconv.pad_type), FIELD(deconv.stride),
+         FIELD(deconv.weights)},
+        {}}},
+      {VSI_NN_OP_DECONVOLUTION1D,
+       {{FIELD(deconvolution1d.group), FIELD(deconvolution1d.output_padding),
+         FIELD(deconvolution1d.pad), FIELD(deconvolution1d.pad_type),
+         FIELD(deconvolution1d.stride)},
+        {}}},
+      {VSI_NN_OP_DEPTH2SPACE,
+       {{FIELD(depth2space.block_size), FIELD(depth2space.mode)}, {}}},
+      {VSI_NN_OP_SPACE2DEPTH, {{FIELD(space2depth.block_size)}, {}}},
+      {VSI_NN_OP_DROPOUT, {{FIELD(dropout.ratio)}, {}}},
+      {VSI_NN_OP_DIVIDE, {{FIELD(divide.scale)}, {}}},
+      {VSI_NN_OP_MULTIPLY, {{FIELD(multiply.scale)}, {}}},
+      {VSI_NN_OP_FCL2, {{FIELD(fcl.axis), FIELD(fcl.weights)}, {}}},
+      {VSI_NN_OP_GATHER,
+       {{FIELD(gather.axis), FIELD(gather.batch_dims)}, {}}},
+#ifdef _VSI_NN_OP_GATHER_ELEMENTS_H
+      {VSI_NN_OP_GATHER_ELEMENTS, {{FIELD(gather_elements.axis)}, {}}},
+#endif
+      {VSI_NN_OP_GROUPED_CONV1D,
+       {{FIELD(grouped_conv1d.dilation), FIELD(grouped_conv1d.group),
+         FIELD(grouped_conv1d.pad), FIELD(grouped_conv1d.pad_type),
+         FIELD(grouped_conv1d.stride)},
+        {}}},
+      {VSI_NN_OP_GROUPED_CONV2D,
+       {{FIELD(grouped_conv2d.dilation), FIELD(grouped_conv2d.group),
+         FIELD(grouped_conv2d.pad), FIELD(grouped_conv2d.pad_type),
+         FIELD(grouped_conv2d.stride)},
+        {}}},
+      {VSI_NN_OP_GRUCELL,
+       {{FIELD(grucell.activation), FIELD(grucell.num_units),
+         FIELD(grucell.recurrent_activation), FIELD(grucell.reset_after)},
+        {}}},
+      {VSI_NN_OP_GRU,
+       {{FIELD(gru.activation), FIELD(gru.num_units),
+         FIELD(gru.recurrent_activation), FIELD(gru.reset_after),
+         FIELD(gru.return_sequences), FIELD(gru.time_major)},
+        {}}},
+      {VSI_NN_OP_LSTM_OVXLIB,
+       {{FIELD(lstm_ovxlib.activation), FIELD(lstm_ovxlib.cell_clip),
+         FIELD(lstm_ovxlib.forget_bias), FIELD(lstm_ovxlib.proj_clip),
+         FIELD(lstm_ovxlib.recurrent_activation),
+         FIELD(lstm_ovxlib.return_sequences), FIELD(lstm_ovxlib.time_major)},
+        {}}},
+      {VSI_NN_OP_INSTANCE_NORM, {{FIELD(instancenorm.eps)}, {}}},
+      {VSI_NN_OP_L2_NORMALIZE, {{FIELD(l2_normalize.axis)}, {}}},
+      {VSI_NN_OP_LAYER_NORM,
+       {{FIELD(layernorm.axis), FIELD(layernorm.eps)}, {}}},
+      {VSI_NN_OP_LRN2,
+       {{FIELD(lrn.alpha), FIELD(lrn.axis), FIELD(lrn.beta), FIELD(lrn.bias),
+         FIELD(lrn.size), FIELD(lrn.type)},
+        {}}},
+      {VSI_NN_OP_LOGICAL_OPS, {{FIELD(relational_ops.op)}, {}}},
+      {VSI_NN_OP_RELATIONAL_OPS, {{FIELD(relational_ops.op)}, {}}},
+      {VSI_NN_OP_LOG_SOFTMAX,
+       {{FIELD(log_softmax.axis), FIELD(log_softmax.betaValue)}, {}}},
+      {VSI_NN_OP_SOFTMAX, {{FIELD(softmax.axis), FIELD(softmax.beta)}, {}}},
+      {VSI_NN_OP_MATRIXMUL,
+       {{FIELD(matrixmul.adjoint), FIELD(matrixmul.transpose)}, {}}},
+#ifdef VSI_FEAT_OP_MAX_POOL3D
+      {VSI_NN_OP_MAX_POOL3D,
+       {{FIELD(max_pool3d.ksize), FIELD(max_pool3d.pad),
+         FIELD(max_pool3d.pad_type), FIELD(max_pool3d.round_type),
+         FIELD(max_pool3d.stride)},
+        {}}},
+#endif
+      {VSI_NN_OP_POOL,
+       {{FIELD(pool.ksize), FIELD(pool.pad), FIELD(pool.pad_type),
+         FIELD(pool.round_type), FIELD(pool.stride), FIELD(pool.type)},
+        {}}},
+      {VSI_NN_OP_POOLWITHARGMAX,
+       {{FIELD(pool.ksize), FIELD(pool.pad), FIELD(pool.pad_type),
+         FIELD(pool.round_type), FIELD(pool.stride), FIELD(pool.type)},
+        {}}},
+#ifdef VSI_FEAT_OP_MAXPOOLWITHARGMAX
+      {VSI_NN_OP_MAXPOOLWITHARGMAX,
+       {{FIELD(pool.ksize), FIELD(pool.pad), FIELD(pool.pad_type),
+         FIELD(pool.round_type), FIELD(pool.stride), FIELD(pool.type)},
+        {}}},
+#endif
+      {VSI_NN_OP_UPSAMPLE,
+       {{FIELD(upsample.scale), FIELD(upsample.size)}, {}}},
+#ifdef VSI_FEAT_OP_MOD
+      {VSI_NN_OP_MOD, {{FIELD(mod.fmod)}, {}}},
+#endif
+      {VSI_NN_OP_MOMENTS,
+       {{FIELD(moments.keep_dim)}, {ARRAY(moments, axis, axis_num)}}},
+      {VSI_NN_OP_ONE_HOT,
+       {{FIELD(one_hot.axis), FIELD(one_hot.depth), FIELD(one_hot.off_value),
+         FIELD(one_hot.on_value)},
+        {}}},
+      {VSI_NN_OP_PAD,
+       {{FIELD(pad.const_val), FIELD(pad.mode)},
+        {ARRAY(pad, front_size, dim_num), ARRAY(pad, back_size, dim_num)}}},
+      {VSI_NN_OP_PAD2,
+       {{FIELD(pad2.const_val), FIELD(pad2.mode)},
+        {ARRAY(pad2, front_size, dim_num), ARRAY(pad2, back_size, dim_num)}}},
+      {VSI_NN_OP_PERMUTE, {{}, {ARRAY(permute, perm, dim_num)}}},
+      {VSI_NN_OP_REDUCE,
+       {{FIELD(reduce.type), FIELD(reduce.keep_dim)},
+        {ARRAY(reduce, axis, axis_num)}}},
+      {VSI_NN_OP_REORG, {{FIELD(reorg.stride)}, {}}},
+#ifdef _VSI_NN_OP_RESHAPE2_H
+      {VSI_NN_OP_RESHAPE2, {{}, {ARRAY(reshape2, size, dim_num)}}},
+#else
+      {VSI_NN_OP_RESHAPE, {{}, {ARRAY(reshape, size, dim_num)}}},
+#endif
+      {VSI_NN_OP_RESIZE,
+       {{FIELD(resize.align_corners), FIELD(resize.factor),
+         FIELD(resize.half_pixel_centers), FIELD(resize.size),
+         FIELD(resize.type)},
+        {}}},
+      {VSI_NN_OP_RESIZE_1D,
+       {{FIELD(resize_1d.align_corners), FIELD(resize_1d.factor),
+         FIELD(resize_1d.half_pixel_centers), FIELD(resize_1d.size),
+         FIELD(resize_1d.type)},
+        {}}},
+      {VSI_NN_OP_REVERSE, {{}, {ARRAY(reverse, axis, axis_num)}}},
+      {VSI_NN_OP_ROI_ALIGN,
+       {{FIELD(roi_align.height_ratio), FIELD(roi_align.height_sample_num),
+         FIELD(roi_align.output_height), FIELD(roi_align.output_width),
+         FIELD(roi_align.width_ratio), FIELD(roi_align.width_sample_num)},
+        {}}},
+      {VSI_NN_OP_ROI_POOL,
+       {{FIELD(roi_pool.scale), FIELD(roi_pool.size), FIELD(roi_pool.type)},
+        {}}},
+      {VSI_NN_OP_SCATTER_ND, {{}, {ARRAY(scatter_nd, shape, dim_num)}}},
+      {VSI_NN_OP_SCATTER_ND_UPDATE, {{FIELD(scatter_nd_update.reduction)}, {}}},
+      {VSI_NN_OP_SHUFFLECHANNEL,
+       {{FIELD(shufflechannel.axis), FIELD(shufflechannel.group_number)}, {}}},
+      {VSI_NN_OP_SIGNAL_FRAME,
+       {{FIELD(signalframe.axis), FIELD(signalframe.pad_end),
+         FIELD(signalframe.step), FIELD(signalframe.window_length)},
+        {}}},
+      {VSI_NN_OP_SLICE,
+       {{FIELD(slice.dims)},
+        {ARRAY(slice, start, dims), ARRAY(slice, length, dims)}}},
+      {VSI_NN_OP_STRIDED_SLICE,
+       {{FIELD(strided_slice.begin_mask), FIELD(strided_slice.end_mask),
+         FIELD(strided_slice.shrink_axis_mask),
+         FIELD(strided_slice.new_axis_mask)},
+        {ARRAY(strided_slice, begin_dims, begin_dims_num),
+         ARRAY(strided_slice, end_dims, end_dims_num),
+         ARRAY(strided_slice, stride_dims, stride_dims_num)}}},
+      {VSI_NN_OP_SPATIAL_TRANSFORMER,
+       {{FIELD(spatial_transformer.output_H),
+         FIELD(spatial_transformer.output_W),
+         FIELD(spatial_transformer.has_theta_1_1),
+         FIELD(spatial_transformer.has_theta_1_2),
+         FIELD(spatial_transformer.has_theta_1_3),
+         FIELD(spatial_transformer.has_theta_2_1),
+         FIELD(spatial_transformer.has_theta_2_2),
+         FIELD(spatial_transformer.has_theta_2_3),
+         FIELD(spatial_transformer.theta_1_1),
+         FIELD(spatial_transformer.theta_1_2),
+         FIELD(spatial_transformer.theta_1_3),
+         FIELD(spatial_transformer.theta_2_1),
+         FIELD(spatial_transformer.theta_2_2),
+         FIELD(spatial_transformer.theta_2_3),
+         FIELD(spatial_transformer.align_corners)},
+        {}}},
+      {VSI_NN_OP_SPLIT,
+       {{FIELD(split.axis)}, {ARRAY(split, slices, slices_num)}}},
+      {VSI_NN_OP_SQUEEZE, {{}, {ARRAY(squeeze, axis, axis_num)}}},
+      {VSI_NN_OP_STACK, {{FIELD(stack.axis)}, {}}},
+      {VSI_NN_OP_UNSTACK, {{FIELD(unstack.axis)}, {}}},
+      {VSI_NN_OP_SVDF,
+       {{FIELD(svdf.num_units), FIELD(svdf.rank),
+         FIELD(svdf.spectrogram_length)},
+        {}}},
+      {VSI_NN_OP_TILE, {{}, {ARRAY(tile, multiples, multiples_num)}}},
+      {VSI_NN_OP_TOPK, {{FIELD(topk.axis), FIELD(topk.k)}, {}}},
+  };
+  return codecs;
+}
+
+#undef ARRAY
+#undef FIELD
+#undef PARAM_MEMBER
+
+const ParamCodec& GetParamCodec(int32_t kind) {
+  static const ParamCodec no_param;
+  auto it = ParamCodecs().find(kind);
+  return it == ParamCodecs().end() ? no_param : it->second;
+}
+
+uint64_t ReadCount(const uint8_t* base, const ParamArray& array) {
+  uint64_t count = 0;
+  memcpy(&count, base + array.count_offset, array.count_size);
+  return count;
+}
+
+void WriteCount(uint8_t* base, const ParamArray& array, uint64_t count) {
+  memcpy(base + array.count_offset, &count, array.count_size);
+}
+
+uint64_t AlignUp(uint64_t value) {
+  return (value + kConstAlignment - 1) / kConstAlignment * kConstAlignment;
+}
+
+class Writer {
+ public:
+  template <typename T>
+  void Put(const T& value) {
+    Put(&value, sizeof(T));
+  }
+  void Put(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+  template <typename T>
+  void PutVector(const std::vector<T>& values) {
+    Put(static_cast<uint32_t>(values.size()));
+    Put(values.data(), values.size() * sizeof(T));
+  }
+  const std::vector<uint8_t>& Buffer() const { return buffer_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+  template <typename T>
+  bool Get(T& value) {
+    return Get(&value, sizeof(T));
+  }
+  bool Get(void* data, size_t size) {
+    if (size > size_ - offset_) {
+      return false;
+    }
+    memcpy(data, data_ + offset_, size);
+    offset_ += size;
+    return true;
+  }
+  template <typename T>
+  bool GetVector(std::vector<T>& values) {
+    uint32_t count = 0;
+    if (!Get(count) || count > (size_ - offset_) / sizeof(T)) {
+      return false;
+    }
+    values.resize(count);
+    return Get(values.data(), count * sizeof(T));
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+/// Builtin operation restored from a serialized graph, it owns the arrays
+/// referenced by its nn_param.
+class SerializedOp : public BuiltinOp {
+ public:
+  SerializedOp(Graph* graph, int32_t kind, int input_cnt, int output_cnt,
+               DataLayout layout, const vsi_nn_vx_param_t& vx_param,
+               const std::vector<uint8_t>& fields,
+               const std::vector<std::vector<uint8_t>>& arrays)
+      : BuiltinOp(graph, kind, input_cnt, output_cnt, layout),
+        vx_param_(vx_param),
+        fields_(fields),
+        arrays_(arrays) {
+    auto node = this->impl()->node();
+    node->vx_param = vx_param_;
+    auto base = reinterpret_cast<uint8_t*>(&node->nn_param);
+    const auto& codec = GetParamCodec(kind);
+    size_t offset = 0;
+    for (const auto& field : codec.fields) {
+      memcpy(base + field.offset, fields_.data() + offset, field.size);
+      offset += field.size;
+    }
+    for (size_t i = 0; i < codec.arrays.size(); ++i) {
+      const auto& array = codec.arrays[i];
+      void* ptr = arrays_[i].empty() ? nullptr : arrays_[i].data();
+      memcpy(base + array.ptr_offset, &ptr, sizeof(ptr));
+      WriteCount(base, array, arrays_[i].size() / array.elem_size);
+    }
+  }
+
+  std::shared_ptr<Operation> Clone(
+      std::shared_ptr<Graph>& graph) const override {
+    return graph->CreateOperation<SerializedOp>(
+        impl_->kind_, impl_->input_cnt_, impl_->output_cnt_, impl_->layout_,
+        vx_param_, fields_, arrays_);
+  }
+
+ private:
+  vsi_nn_vx_param_t vx_param_;
+  std::vector<uint8_t> fields_;
+  std::vector<std::vector<uint8_t>> arrays_;
+};
+
+bool WriteTensor(Writer& meta, std::vector<uint8_t>& consts,
+                 const std::shared_ptr<Tensor>& tensor) {
+  uint32_t flags = 0;
+  if (tensor->IsPlaceHolder()) {
+    meta.Put(static_cast<uint32_t>(TENSOR_FLAG_PLACEHOLDER));
+    return true;
+  }
+  if (tensor->IsScalar()) {
+    flags |= TENSOR_FLAG_SCALAR;
+  }
+  const auto& spec = tensor->GetSpec();
+  const auto& quant = spec.quantization_;
+  meta.Put(flags);
+  meta.Put(static_cast<uint32_t>(spec.attr_));
+  meta.Put(static_cast<int32_t>(spec.datatype_));
+  meta.PutVector(spec.shape_);
+  meta.Put(static_cast<int32_t>(quant.Type()));
+  meta.Put(quant.ChannelDim());
+  meta.Put(quant.Fl());
+  meta.PutVector(quant.Scales());
+  meta.PutVector(quant.ZeroPoints());
+
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  if (spec.attr_ & TensorAttribute::CONSTANT) {
+    size = static_cast<uint64_t>(spec.GetByteSize());
+    offset = consts.size();
+    consts.resize(AlignUp(offset + size), 0);
+    if (!tensor->CopyDataFromTensor(consts.data() + offset)) {
+      VSILOGE("Read constant tensor %u fail", tensor->GetId());
+      return false;
+    }
+  }
+  meta.Put(offset);
+  meta.Put(size);
+  return true;
+}
+
+bool WriteOp(Writer& meta, const std::shared_ptr<Operation>& op,
+             std::map<std::shared_ptr<Tensor>, uint32_t>& tensor_ids) {
+  auto node = op->impl()->node();
+  int32_t kind = static_cast<int32_t>(node->op);
+  if (kind >= VSI_NN_OP_NUM || kind == VSI_NN_OP_NBG) {
+    VSILOGE("Operation kind %d can not be serialized", kind);
+    return false;
+  }
+  meta.Put(kind);
+  meta.Put(static_cast<int32_t>(op->impl()->input_cnt_));
+  meta.Put(static_cast<int32_t>(op->impl()->output_cnt_));
+  meta.Put(static_cast<int32_t>(op->impl()->layout_));
+  meta.Put(node->vx_param);
+
+  std::vector<uint32_t> inputs, outputs;
+  for (const auto& t : op->impl()->InputsTensor()) {
+    inputs.push_back(tensor_ids.at(t));
+  }
+  for (const auto& t : op->impl()->OutputsTensor()) {
+    outputs.push_back(tensor_ids.at(t));
+  }
+  meta.PutVector(inputs);
+  meta.PutVector(outputs);
+
+  const auto& codec = GetParamCodec(kind);
+  auto base = reinterpret_cast<const uint8_t*>(&node->nn_param);
+  std::vector<uint8_t> fields;
+  for (const auto& field : codec.fields) {
+    fields.insert(fields.end(), base + field.offset,
+                  base + field.offset + field.size);
+  }
+  meta.PutVector(fields);
+  for (const auto& array : codec.arrays) {
+    const uint8_t* ptr = nullptr;
+    memcpy(&ptr, base + array.ptr_offset, sizeof(ptr));
+    uint64_t count = ReadCount(base, array);
+    if (count && !ptr) {
+      VSILOGE("Operation kind %d has an unset parameter", kind);
+      return false;
+    }
+    meta.PutVector(std::vector<uint8_t>(ptr, ptr + count * array.elem_size));
+  }
+  return true;
+}
+
+std::shared_ptr<Tensor> ReadTensor(Reader& meta, Graph* graph,
+                                   const uint8_t* file, uint64_t file_size,
+                                   const FileHeader& header) {
+  uint32_t flags = 0;
+  if (!meta.Get(flags)) {
+    return nullptr;
+  }
+  if (flags & TENSOR_FLAG_PLACEHOLDER) {
+    return graph->CreateTensorPlaceHolder();
+  }
+  uint32_t attr = 0;
+  int32_t dtype = 0, qtype = 0, channel_dim = 0;
+  int8_t fl = 0;
+  ShapeType shape;
+  std::vector<float> scales;
+  std::vector<int32_t> zero_points;
+  uint64_t offset = 0, size = 0;
+  if (!meta.Get(attr) || !meta.Get(dtype) || !meta.GetVector(shape) ||
+      !meta.Get(qtype) || !meta.Get(channel_dim) || !meta.Get(fl) ||
+      !meta.GetVector(scales) || !meta.GetVector(zero_points) ||
+      !meta.Get(offset) || !meta.Get(size)) {
+    return nullptr;
+  }
+
+  Quantization quant(static_cast<QuantType>(qtype), fl);
+  quant.SetChannelDim(channel_dim).SetScales(scales).SetZeroPoints(zero_points);
+  TensorSpec spec(static_cast<DataType>(dtype), shape,
+                  static_cast<TensorAttribute>(attr), quant);
+
+  std::shared_ptr<Tensor> tensor;
+  if (attr & TensorAttribute::CONSTANT) {
+    if (offset + size > header.const_size ||
+        header.const_offset + header.const_size > file_size) {
+      VSILOGE("Constant data out of range");
+      return nullptr;
+    }
+    auto data = const_cast<uint8_t*>(file + header.const_offset + offset);
+#if (ENABLE_TENSOR_HNDL)
+    tensor = graph->CreateIOTensor(spec, data);
+#else
+    // Tensors can not wrap the mapping without handles, copy the data instead
+    tensor = graph->CreateTensor(spec, static_cast<const void*>(data));
+#endif
+  } else {
+    tensor = graph->CreateTensor(spec);
+  }
+  if (flags & TENSOR_FLAG_SCALAR) {
+    tensor->SetScalar(1);
+  }
+  return tensor;
+}
+
+bool ReadOp(Reader& meta, Graph* graph,
+            const std::vector<std::shared_ptr<Tensor>>& tensors) {
+  int32_t kind = 0, input_cnt = 0, output_cnt = 0, layout = 0;
+  vsi_nn_vx_param_t vx_param;
+  std::vector<uint32_t> inputs, outputs;
+  std::vector<uint8_t> fields;
+  if (!meta.Get(kind) || !meta.Get(input_cnt) || !meta.Get(output_cnt) ||
+      !meta.Get(layout) || !meta.Get(vx_param) || !meta.GetVector(inputs) ||
+      !meta.GetVector(outputs) || !meta.GetVector(fields)) {
+    return false;
+  }
+  if (kind < 0 || kind >= VSI_NN_OP_NUM) {
+    VSILOGE("Unknown operation kind %d", kind);
+    return false;
+  }
+
+  const auto& codec = GetParamCodec(kind);
+  size_t fields_size = 0;
+  for (const auto& field : codec.fields) {
+    fields_size += field.size;
+  }
+  if (fields.size() != fields_size) {
+    VSILOGE("Parameter size of operation kind %d mismatch", kind);
+    return false;
+  }
+  std::vector<std::vector<uint8_t>> arrays(codec.arrays.size());
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    if (!meta.GetVector(arrays[i]) ||
+        arrays[i].size() % codec.arrays[i].elem_size) {
+      return false;
+    }
+  }
+
+  auto op = graph->CreateOperation<SerializedOp>(
+      kind, input_cnt, output_cnt, static_cast<DataLayout>(layout), vx_param,
+      fields, arrays);
+  for (auto id : inputs) {
+    if (id >= tensors.size()) return false;
+    op->BindInput(tensors[id]);
+  }
+  for (auto id : outputs) {
+    if (id >= tensors.size()) return false;
+    op->BindOutput(tensors[id]);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool SaveGraph(const std::shared_ptr<Graph>& graph, const std::string& path) {
+  std::vector<std::shared_ptr<Operation>> ops;
+  for (const auto& op : graph->OpVector()) {
+    // Composed operations have no low-level node, the builtin operations they
+    // expand to are part of the graph already
+    if (op->impl()->kind_ != -1 && op->impl()->node()) {
+      ops.push_back(op);
+    }
+  }
+
+  // Graph inputs and outputs come first so that they are recreated in order
+  std::vector<std::shared_ptr<Tensor>> tensors;
+  std::map<std::shared_ptr<Tensor>, uint32_t> tensor_ids;
+  auto add_tensor = [&](const std::shared_ptr<Tensor>& t) {
+    if (tensor_ids.find(t) == tensor_ids.end()) {
+      tensor_ids[t] = static_cast<uint32_t>(tensors.size());
+      tensors.push_back(t);
+    }
+  };
+  for (const auto& t : graph->InputsTensor()) add_tensor(t);
+  for (const auto& t : graph->OutputsTensor()) add_tensor(t);
+  for (const auto& op : ops) {
+    for (const auto& t : op->impl()->InputsTensor()) add_tensor(t);
+    for (const auto& t : op->impl()->OutputsTensor()) add_tensor(t);
+  }
+
+  Writer meta;
+  std::vector<uint8_t> consts;
+  for (const auto& t : graph->InputsTensor()) meta.Put(tensor_ids[t]);
+  for (const auto& t : graph->OutputsTensor()) meta.Put(tensor_ids[t]);
+  for (const auto& t : tensors) {
+    if (!WriteTensor(meta, consts, t)) return false;
+  }
+  for (const auto& op : ops) {
+    if (!WriteOp(meta, op, tensor_ids)) return false;
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.tensor_count = static_cast<uint32_t>(tensors.size());
+  header.op_count = static_cast<uint32_t>(ops.size());
+  header.input_count = static_cast<uint32_t>(graph->InputsTensor().size());
+  header.output_count = static_cast<uint32_t>(graph->OutputsTensor().size());
+  header.meta_size = meta.Buffer().size();
+  header.const_offset = AlignUp(sizeof(header) + header.meta_size);
+  header.const_size = consts.size();
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    VSILOGE("Open %s fail", path.c_str());
+    return false;
+  }
+  std::vector<char> padding(
+      header.const_offset - sizeof(header) - header.meta_size, 0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(meta.Buffer().data()),
+             meta.Buffer().size());
+  file.write(padding.data(), padding.size());
+  file.write(reinterpret_cast<const char*>(consts.data()), consts.size());
+  return static_cast<bool>(file);
+}
+
+std::shared_ptr<Graph> LoadGraph(const std::shared_ptr<Context>& ctx,
+                                 const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VSILOGE("Open %s fail", path.c_str());
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+    VSILOGE("Invalid graph file %s", path.c_str());
+    close(fd);
+    return nullptr;
+  }
+  size_t file_size = static_cast<size_t>(st.st_size);
+  // Private writable mapping: the driver may touch constant handles, such
+  // writes must never reach the file.
+  void* addr =
+      mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    VSILOGE("Map %s fail", path.c_str());
+    return nullptr;
+  }
+  std::shared_ptr<void> mapping(
+      addr, [file_size](void* p) { munmap(p, file_size); });
+  auto file = static_cast<const uint8_t*>(addr);
+
+  FileHeader header;
+  memcpy(&header, file, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      header.meta_size > file_size - sizeof(header)) {
+    VSILOGE("Invalid graph file %s", path.c_str());
+    return nullptr;
+  }
+
+  auto graph = ctx->CreateGraph();
+  std::static_pointer_cast<GraphImpl>(graph)->AttachResource(mapping);
+
+  Reader meta(file + sizeof(header), header.meta_size);
+  std::vector<uint32_t> io_ids(header.input_count + header.output_count);
+  for (auto& id : io_ids) {
+    if (!meta.Get(id)) return nullptr;
+  }
+  // Inputs and outputs have been placed in front of the tensor table
+  for (uint32_t i = 0; i < io_ids.size(); ++i) {
+    if (io_ids[i] > i) {
+      VSILOGE("Invalid graph io in %s", path.c_str());
+      return nullptr;
+    }
+  }
+
+  std::vector<std::shared_ptr<Tensor>> tensors;
+  for (uint32_t i = 0; i < header.tensor_count; ++i) {
+    auto tensor = ReadTensor(meta, graph.get(), file, file_size, header);
+    if (!tensor) {
+      VSILOGE("Read tensor %u fail", i);
+      return nullptr;
+    }
+    tensors.push_back(tensor);
+  }
+  for (uint32_t i = 0; i < header.op_count; ++i) {
+    if (!ReadOp(meta, graph.get(), tensors)) {
+      VSILOGE("Read operation %u fail", i);
+      return nullptr;
+    }
+  }
+  return graph;
+}
+
+}  // namespace vx
+}  // namespace tim
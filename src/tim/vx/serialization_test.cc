@@ -0,0 +1,127 @@
+#include "tim/vx/serialization.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "op_impl.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + name;
+}
+
+std::shared_ptr<tim::vx::Graph> BuildGraph(
+    const std::shared_ptr<tim::vx::Context>& ctx) {
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 3},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                 tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {6},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> const_data = {10, 20, 30, 40, 50, 60};
+
+  auto input = graph->CreateTensor(input_spec);
+  auto weight = graph->CreateTensor(const_spec, const_data.data());
+  auto transposed = graph->CreateTensor(transient_spec);
+  auto sum = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+
+  graph->CreateOperation<tim::vx::ops::Transpose>(std::vector<uint32_t>{1, 0})
+      ->BindInput(input)
+      .BindOutput(transposed);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({transposed, weight})
+      .BindOutput(sum);
+  graph->CreateOperation<tim::vx::ops::Reshape>(std::vector<uint32_t>{6})
+      ->BindInput(sum)
+      .BindOutput(output);
+  return graph;
+}
+
+std::vector<float> RunGraph(const std::shared_ptr<tim::vx::Graph>& graph,
+                            const std::vector<float>& in_data) {
+  std::vector<float> out_data(6);
+  EXPECT_TRUE(graph->Compile());
+  EXPECT_TRUE(graph->InputsTensor()[0]->CopyDataToTensor(
+      in_data.data(), in_data.size() * sizeof(float)));
+  EXPECT_TRUE(graph->Run());
+  EXPECT_TRUE(graph->OutputsTensor()[0]->CopyDataFromTensor(out_data.data()));
+  return out_data;
+}
+}  // namespace
+
+TEST(serialization, save_and_load) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = BuildGraph(ctx);
+  std::string path = TempPath("serialization_save_and_load.timvx");
+  ASSERT_TRUE(tim::vx::SaveGraph(graph, path));
+
+  auto loaded = tim::vx::LoadGraph(ctx, path);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->OpVector().size(), 3);
+  EXPECT_EQ(loaded->InputsTensor().size(), 1);
+  EXPECT_EQ(loaded->OutputsTensor().size(), 1);
+  EXPECT_EQ(loaded->OutputsTensor()[0]->GetShape(),
+            tim::vx::ShapeType({6}));
+
+  std::vector<float> in_data = {1, 2, 3, 4, 5, 6};
+  auto golden = RunGraph(graph, in_data);
+  EXPECT_EQ(golden, RunGraph(loaded, in_data));
+  std::remove(path.c_str());
+}
+
+TEST(serialization, op_param_round_trip) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 2},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::INT32, {2},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::ArgMax>(1)
+      ->BindInput(input)
+      .BindOutput(output);
+
+  std::string path = TempPath("serialization_op_param_round_trip.timvx");
+  ASSERT_TRUE(tim::vx::SaveGraph(graph, path));
+  auto loaded = tim::vx::LoadGraph(ctx, path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(loaded);
+  ASSERT_EQ(loaded->OpVector().size(), 1);
+  auto node = loaded->OpVector()[0]->impl()->node();
+  EXPECT_EQ(node->op, VSI_NN_OP_ARGMAX);
+  EXPECT_EQ(node->nn_param.argmax.axis, 1);
+
+  std::vector<float> in_data = {1, 5, 7, 2};
+  std::vector<int32_t> golden = {1, 0};
+  std::vector<int32_t> out_data(golden.size());
+  EXPECT_TRUE(loaded->Compile());
+  EXPECT_TRUE(loaded->InputsTensor()[0]->CopyDataToTensor(
+      in_data.data(), in_data.size() * sizeof(float)));
+  EXPECT_TRUE(loaded->Run());
+  EXPECT_TRUE(loaded->OutputsTensor()[0]->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(golden, out_data);
+}
+
+TEST(serialization, load_invalid_file) {
+  auto ctx = tim::vx::Context::Create();
+  std::string path = TempPath("serialization_load_invalid_file.timvx");
+  {
+    std::ofstream file(path, std::ios::binary);
+    std::vector<char> garbage(128, 0x5a);
+    file.write(garbage.data(), garbage.size());
+  }
+  EXPECT_FALSE(tim::vx::LoadGraph(ctx, path));
+  EXPECT_FALSE(tim::vx::LoadGraph(ctx, TempPath("does_not_exist.timvx")));
+  std::remove(path.c_str());
+}
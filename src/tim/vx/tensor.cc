@@ -128,14 +128,40 @@ TensorImpl::TensorImpl(Graph* graph, const TensorSpec& spec, void* data)
       id_(VSI_NN_TENSOR_ID_NA),
       spec_(spec),
       data_(nullptr) {
-  if (!(spec_.attr_ & (TensorAttribute::INPUT | TensorAttribute::OUTPUT))) {
+  if (!(spec_.attr_ & (TensorAttribute::INPUT | TensorAttribute::OUTPUT |
+                       TensorAttribute::CONSTANT))) {
     VSILOGE("TensorImpl with an external data got unexpected attr");
     return;
   }
   Init(data);
   data_ = data;
+#if (!ENABLE_TENSOR_HNDL)
+  // Without handle support the constant owns its memory, fill it here
+  if (data_ && (spec_.attr_ & TensorAttribute::CONSTANT) &&
+      !CopyDataToTensor(data_, 0)) {
+    VSILOGE("Copy data to tensor fail!");
+  }
+#endif
+}
+
+TensorImpl::TensorImpl(Graph* graph, const TensorSpec& spec,
+                       vsi_nn_tensor_t* shared)
+    : graph_(reinterpret_cast<GraphImpl*>(graph)),
+      id_(graph_->AttachSharedTensor(shared)),
+      spec_(spec),
+      data_(nullptr) {
+  if (VSI_NN_TENSOR_ID_NA == id_) {
+    VSILOGE("Attach shared tensor fail!");
+  }
 }
 
+TensorImpl::TensorImpl(Graph* graph, const TensorSpec& spec, ViewTag,
+                       vsi_nn_tensor_id_t view)
+    : graph_(reinterpret_cast<GraphImpl*>(graph)),
+      id_(view),
+      spec_(spec),
+      data_(nullptr) {}
+
 TensorImpl::~TensorImpl() {}
 
 bool TensorImpl::SaveTensorToTextByFp32(std::string filename) {
@@ -182,6 +208,15 @@ bool TensorImpl::CopyDataToTensor(const void* data, uint32_t size_in_bytes) {
         */
         const uint8_t* end = static_cast<const uint8_t*>(data) + tensor_bytes;
         std::vector<uint8_t> data_copy(static_cast<const uint8_t*>(data), end);
+        if (tensor->attr.dtype.vx_type == VSI_NN_TYPE_INT4 ||
+            tensor->attr.dtype.vx_type == VSI_NN_TYPE_UINT4) {
+          // 4-bit data is passed packed like the tensor handle holds it,
+          // vsi_nn_CopyDataToTensor expects one element per byte and packs it
+          std::vector<uint8_t> unpacked(vsi_nn_GetElementNum(tensor));
+          vsi_nn_Unpack4bitData(tensor, data_copy.data(), unpacked.data(),
+                                tensor->attr.dtype.vx_type);
+          data_copy.swap(unpacked);
+        }
 
         retn = (VSI_SUCCESS == vsi_nn_CopyDataToTensor(graph_->graph(), tensor,
                                                        data_copy.data()));
@@ -339,6 +374,68 @@ bool TensorImpl::InvalidateCacheForHandle() {
   return retn;
 }
 
+bool TensorImpl::ShareHandleWith(const std::shared_ptr<Tensor>& producer) {
+  auto src = std::dynamic_pointer_cast<TensorImpl>(producer);
+  if (!src || !(spec_.attr_ & TensorAttribute::INPUT) ||
+      !(src->spec_.attr_ & TensorAttribute::OUTPUT)) {
+    VSILOGE("ShareHandleWith requires an INPUT tensor and an OUTPUT producer");
+    return false;
+  }
+  if (spec_.shape_ != src->spec_.shape_ ||
+      spec_.datatype_ != src->spec_.datatype_ ||
+      !(spec_.quantization_ == src->spec_.quantization_)) {
+    VSILOGE("ShareHandleWith: shape, dtype or quantization mismatch");
+    return false;
+  }
+  if (VSI_NN_TENSOR_ID_NA == id_ || VSI_NN_TENSOR_ID_NA == src->id_) {
+    return false;
+  }
+
+  vsi_nn_tensor_t* dst_tensor = vsi_nn_GetTensor(graph_->graph(), id_);
+  vsi_nn_tensor_t* src_tensor =
+      vsi_nn_GetTensor(src->graph_->graph(), src->id_);
+  if (!dst_tensor || !dst_tensor->attr.is_created_from_handle || !src_tensor ||
+      !src_tensor->attr.is_created_from_handle) {
+    VSILOGE("ShareHandleWith requires tensors created from handle");
+    return false;
+  }
+  vsi_size_t stride_size[VSI_NN_MAX_DIM_NUM];
+  if (vsi_nn_GetStrideSize(&dst_tensor->attr, stride_size) !=
+      vsi_nn_GetStrideSize(&src_tensor->attr, stride_size)) {
+    VSILOGE("ShareHandleWith: buffer size mismatch");
+    return false;
+  }
+
+  void* shared_ptr = nullptr;
+  if (VSI_SUCCESS != vsi_nn_GetTensorHandle(src_tensor, &shared_ptr) ||
+      !shared_ptr) {
+    VSILOGE("GetTensorHandle fail");
+    return false;
+  }
+
+  // Write back dirty CPU cache lines of the buffer now, so they are not
+  // evicted on top of data the NPU produces into it later.
+  vsi_nn_FlushHandle(src_tensor);
+
+  bool own_old = dst_tensor->attr.is_handle_malloc_by_ovxlib;
+  void* old_ptr = nullptr;
+  if (VSI_SUCCESS !=
+      vsi_nn_SwapHandle(dst_tensor, shared_ptr, FALSE, &old_ptr)) {
+    VSILOGE("SwapHandle fail");
+    return false;
+  }
+  if (own_old && old_ptr) {
+    vsi_nn_FreeAlignedBuffer(static_cast<uint8_t*>(old_ptr));
+  }
+  // The external buffer, if any, is no longer backing this tensor
+  data_ = nullptr;
+
+  if (src->graph_ != graph_) {
+    graph_->AttachResource(src->graph_->shared_from_this());
+  }
+  return true;
+}
+
 void* TensorImpl::map(bool invalidate_cpu_cache) {
   if (!(spec_.attr_ & (TensorAttribute::INPUT | TensorAttribute::OUTPUT))) {
     return nullptr;
@@ -414,7 +511,8 @@ bool TensorImpl::Init(void* external_cache) {
 
 #if (ENABLE_TENSOR_HNDL)
   if ((spec_.attr_ & TensorAttribute::INPUT) ||
-      (spec_.attr_ & TensorAttribute::OUTPUT)) {
+      (spec_.attr_ & TensorAttribute::OUTPUT) ||
+      ((spec_.attr_ & TensorAttribute::CONSTANT) && external_cache)) {
 #ifdef VX_CREATE_TENSOR_SUPPORT_PHYSICAL
     if (fd_ != -1) {
       attr.vsi_memory_type = VSI_MEMORY_TYPE_DMABUF;
@@ -525,6 +623,7 @@ int64_t TensorSpec::GetElementByteSize() const {
     case DataType::INT16:
     case DataType::UINT16:
     case DataType::FLOAT16:
+    case DataType::BFLOAT16:
       return 2;
     case DataType::INT32:
     case DataType::UINT32:
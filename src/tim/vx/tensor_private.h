@@ -32,9 +32,17 @@ namespace vx {
 
 class TensorImpl : public Tensor {
  public:
+  /// Selects the view constructor, a bare id would also match `data`
+  struct ViewTag {};
+
   TensorImpl(Graph* graph, const TensorSpec& spec, const void* data = nullptr);
   TensorImpl(Graph* graph, const TensorSpec& spec, const DmaBufferDesc& dmafd);
   TensorImpl(Graph* graph, const TensorSpec& spec, void* data = nullptr);
+  /// Wrap a constant tensor owned by another graph of the same context
+  TensorImpl(Graph* graph, const TensorSpec& spec, vsi_nn_tensor_t* shared);
+  /// Wrap a view tensor already added to the graph
+  TensorImpl(Graph* graph, const TensorSpec& spec, ViewTag,
+             vsi_nn_tensor_id_t view);
   ~TensorImpl();
 
   bool Init(void* external_cache = nullptr);
@@ -54,6 +62,7 @@ class TensorImpl : public Tensor {
   bool SwapHandleWithCache(std::shared_ptr<tim::vx::Tensor> tensor) override;
   bool FlushCacheForHandle() override;
   bool InvalidateCacheForHandle() override;
+  bool ShareHandleWith(const std::shared_ptr<Tensor>& producer) override;
   void* map(bool invalidate_cpu_cache = false) override;
   void unmap() override;
   bool IsPlaceHolder() override { return false; }
@@ -110,6 +119,10 @@ class TensorPlaceholder : public Tensor {
   }
   bool InvalidateCacheForHandle() override { return false; }
   bool FlushCacheForHandle() override { return false; }
+  bool ShareHandleWith(const std::shared_ptr<Tensor>& producer) override {
+    (void)producer;
+    return false;
+  }
   void* map(bool invalidate_cpu_cache = false) override {
     (void)invalidate_cpu_cache;
     return nullptr;
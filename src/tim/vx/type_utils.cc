@@ -51,6 +51,8 @@ vsi_nn_type_e TranslateDataType(DataType dtype) {
       return VSI_NN_TYPE_FLOAT32;
     case DataType::BOOL8:
       return VSI_NN_TYPE_BOOL8;
+    case DataType::BFLOAT16:
+      return VSI_NN_TYPE_BFLOAT16;
     default:
       break;
   }